@@ -0,0 +1,234 @@
+#include "Benchmark.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <fstream>
+#include <sys/resource.h>
+#endif
+
+namespace HybridCAD {
+namespace Bench {
+
+namespace {
+
+constexpr char REPORT_FORMAT[] = "hybridcad-bench 1";
+constexpr uint64_t MEMORY_NOISE_FLOOR = 1024 * 1024;
+
+#if defined(__linux__)
+// A "VmHWM:" or "VmRSS:" line of /proc/self/status, in bytes
+uint64_t procStatusBytes(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    const size_t length = std::strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, field) == 0) {
+            return std::strtoull(line.c_str() + length, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+#endif
+
+} // namespace
+
+uint64_t currentResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#elif defined(__linux__)
+    return procStatusBytes("VmRSS:");
+#else
+    return 0;
+#endif
+}
+
+uint64_t peakResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#elif defined(__APPLE__)
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<uint64_t>(usage.ru_maxrss) : 0;
+#elif defined(__linux__)
+    return procStatusBytes("VmHWM:");
+#else
+    return 0;
+#endif
+}
+
+bool resetPeakResident() {
+#if defined(__linux__)
+    // Writing 5 to clear_refs resets VmHWM (Linux 4.0 and later)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+#else
+    return false;
+#endif
+}
+
+bool Runner::selected(const std::string& name) const {
+    return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+}
+
+bool Runner::anySelected(const std::vector<std::string>& names) const {
+    return std::any_of(names.begin(), names.end(), [this](const std::string& name) { return selected(name); });
+}
+
+void Runner::measure(const std::string& name, const std::string& dataset, uint64_t elements,
+                     const std::function<void()>& setup, const std::function<void()>& body) {
+    if (!selected(name)) return;
+
+    for (int i = 0; i < m_options.warmups; ++i) {
+        if (setup) setup();
+        body();
+    }
+
+    const bool reset = resetPeakResident();
+    const uint64_t peakBefore = reset ? currentResidentBytes() : peakResidentBytes();
+
+    std::vector<double> times;
+    times.reserve(std::max(m_options.repetitions, 1));
+    for (int i = 0; i < std::max(m_options.repetitions, 1); ++i) {
+        if (setup) setup();
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    Result result;
+    result.name = name;
+    result.dataset = dataset;
+    result.elements = elements;
+    result.repetitions = static_cast<int>(times.size());
+    result.meanMs = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+    std::sort(times.begin(), times.end());
+    result.minMs = times.front();
+    result.medianMs = times.size() % 2 ? times[times.size() / 2]
+                                       : 0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+    result.peakResidentBytes = peakResidentBytes();
+    result.peakGrowthBytes = result.peakResidentBytes > peakBefore ? result.peakResidentBytes - peakBefore : 0;
+
+    std::printf("%-32s %-24s %12llu  median %10.3f ms  min %10.3f ms  peak %8.1f MB (+%.1f)\n",
+                name.c_str(), dataset.c_str(), static_cast<unsigned long long>(elements),
+                result.medianMs, result.minMs, result.peakResidentBytes / 1048576.0,
+                result.peakGrowthBytes / 1048576.0);
+    std::fflush(stdout);
+    m_results.push_back(std::move(result));
+}
+
+bool writeReport(const std::string& path, const std::vector<Result>& results,
+                 const std::vector<std::pair<std::string, std::string>>& environment) {
+    QJsonObject context;
+    for (const auto& pair : environment) {
+        context.insert(QString::fromStdString(pair.first), QString::fromStdString(pair.second));
+    }
+
+    QJsonArray entries;
+    for (const Result& result : results) {
+        QJsonObject entry;
+        entry.insert("name", QString::fromStdString(result.name));
+        entry.insert("dataset", QString::fromStdString(result.dataset));
+        entry.insert("elements", static_cast<double>(result.elements));
+        entry.insert("repetitions", result.repetitions);
+        entry.insert("minMs", result.minMs);
+        entry.insert("medianMs", result.medianMs);
+        entry.insert("meanMs", result.meanMs);
+        entry.insert("peakResidentBytes", static_cast<double>(result.peakResidentBytes));
+        entry.insert("peakGrowthBytes", static_cast<double>(result.peakGrowthBytes));
+        entries.append(entry);
+    }
+
+    QJsonObject report;
+    report.insert("format", REPORT_FORMAT);
+    report.insert("environment", context);
+    report.insert("results", entries);
+
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(report).toJson());
+    return file.commit();
+}
+
+bool readReport(const std::string& path, std::vector<Result>& results) {
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QJsonObject report = QJsonDocument::fromJson(file.readAll()).object();
+    if (report.value("format").toString() != REPORT_FORMAT) return false;
+
+    results.clear();
+    for (const QJsonValue& value : report.value("results").toArray()) {
+        const QJsonObject entry = value.toObject();
+        Result result;
+        result.name = entry.value("name").toString().toStdString();
+        result.dataset = entry.value("dataset").toString().toStdString();
+        result.elements = static_cast<uint64_t>(entry.value("elements").toDouble());
+        result.repetitions = entry.value("repetitions").toInt();
+        result.minMs = entry.value("minMs").toDouble();
+        result.medianMs = entry.value("medianMs").toDouble();
+        result.meanMs = entry.value("meanMs").toDouble();
+        result.peakResidentBytes = static_cast<uint64_t>(entry.value("peakResidentBytes").toDouble());
+        result.peakGrowthBytes = static_cast<uint64_t>(entry.value("peakGrowthBytes").toDouble());
+        results.push_back(std::move(result));
+    }
+    return true;
+}
+
+int compareReports(const std::vector<Result>& baseline, const std::vector<Result>& current, double threshold) {
+    std::map<std::pair<std::string, std::string>, const Result*> previous;
+    for (const Result& result : baseline) {
+        previous[{ result.name, result.dataset }] = &result;
+    }
+
+    int regressions = 0;
+    std::printf("\n%-32s %-24s %12s %12s %8s %10s\n", "case", "dataset", "baseline ms", "median ms", "time", "peak +MB");
+    for (const Result& result : current) {
+        auto it = previous.find({ result.name, result.dataset });
+        if (it == previous.end()) {
+            std::printf("%-32s %-24s %12s %12.3f %8s\n", result.name.c_str(), result.dataset.c_str(), "-", result.medianMs, "new");
+            continue;
+        }
+
+        const Result& base = *it->second;
+        const double timeRatio = base.medianMs > 0.0 ? result.medianMs / base.medianMs : 1.0;
+        const bool slower = timeRatio > 1.0 + threshold;
+        const bool larger = base.peakGrowthBytes >= MEMORY_NOISE_FLOOR &&
+                            result.peakGrowthBytes > base.peakGrowthBytes * (1.0 + threshold);
+        if (slower || larger) ++regressions;
+
+        std::printf("%-32s %-24s %12.3f %12.3f %+7.1f%% %10.1f%s\n", result.name.c_str(), result.dataset.c_str(),
+                    base.medianMs, result.medianMs, (timeRatio - 1.0) * 100.0, result.peakGrowthBytes / 1048576.0,
+                    slower ? "  SLOWER" : larger ? "  MORE MEMORY" : "");
+    }
+    std::printf("\n%d regression%s beyond %.0f%%\n", regressions, regressions == 1 ? "" : "s", threshold * 100.0);
+    return regressions;
+}
+
+} // namespace Bench
+} // namespace HybridCAD
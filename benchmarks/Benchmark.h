@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace HybridCAD {
+namespace Bench {
+
+struct Result {
+    std::string name;
+    std::string dataset;
+    // Faces, triangles, objects or rays, whichever the case is sized by
+    uint64_t elements = 0;
+    int repetitions = 0;
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+    // Resident high-water mark at the end of the case, and its rise over the timed runs. The
+    // rise is only per case where the mark can be reset (Linux); elsewhere it is cumulative.
+    uint64_t peakResidentBytes = 0;
+    uint64_t peakGrowthBytes = 0;
+};
+
+class Runner {
+public:
+    struct Options {
+        int repetitions = 5;
+        int warmups = 1;
+        // Substring of the case names to run; empty runs all
+        std::string filter;
+    };
+
+    explicit Runner(const Options& options) : m_options(options) {}
+
+    bool selected(const std::string& name) const;
+    // Lets a group skip building its datasets when none of its cases will run
+    bool anySelected(const std::vector<std::string>& names) const;
+
+    // Times body over the repetitions after the warm-up runs; setup runs untimed before each
+    void measure(const std::string& name, const std::string& dataset, uint64_t elements,
+                 const std::function<void()>& setup, const std::function<void()>& body);
+    void measure(const std::string& name, const std::string& dataset, uint64_t elements,
+                 const std::function<void()>& body) {
+        measure(name, dataset, elements, nullptr, body);
+    }
+
+    const std::vector<Result>& results() const { return m_results; }
+
+private:
+    Options m_options;
+    std::vector<Result> m_results;
+};
+
+// Process memory probes; zero where unsupported
+uint64_t currentResidentBytes();
+uint64_t peakResidentBytes();
+// Lowers the high-water mark to the current resident size; false where the OS has no way to
+bool resetPeakResident();
+
+// Results as JSON, with a description of the run (scale, thread count, build) alongside
+bool writeReport(const std::string& path, const std::vector<Result>& results,
+                 const std::vector<std::pair<std::string, std::string>>& environment);
+bool readReport(const std::string& path, std::vector<Result>& results);
+
+// Prints each case against the baseline run of the same name and dataset. A case regresses when
+// its median time, or its peak growth where the baseline grew by a megabyte or more, rose by
+// more than threshold (0.1 for 10%). Returns the number of regressions.
+int compareReports(const std::vector<Result>& baseline, const std::vector<Result>& current, double threshold);
+
+} // namespace Bench
+} // namespace HybridCAD
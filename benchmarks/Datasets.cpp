@@ -0,0 +1,140 @@
+#include "Datasets.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace HybridCAD {
+namespace Bench {
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+// Latitude rings and longitude segments (twice as many) for roughly faceCount faces
+void sphereResolution(size_t faceCount, int& rings, int& segments) {
+    rings = std::max(2, static_cast<int>(std::lround(std::sqrt(faceCount / 2.0))));
+    segments = rings * 2;
+}
+
+QVector3D spherePoint(int ring, int segment, int rings, int segments) {
+    const float theta = PI * ring / rings;
+    const float phi = 2.0f * PI * segment / segments;
+    return QVector3D(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+}
+
+} // namespace
+
+std::shared_ptr<BenchmarkMesh> makeSphere(size_t faceCount, float radius, const QVector3D& center) {
+    int rings, segments;
+    sphereResolution(faceCount, rings, segments);
+
+    // Poles first and last, rings 1 .. rings - 1 in between
+    const int vertexCount = 2 + (rings - 1) * segments;
+    const int bottom = vertexCount - 1;
+    auto ringVertex = [segments](int ring, int segment) { return 1 + (ring - 1) * segments + segment % segments; };
+
+    std::vector<float> positions;
+    positions.reserve(vertexCount * 3);
+    auto addPosition = [&](const QVector3D& point) {
+        const QVector3D p = center + point * radius;
+        positions.insert(positions.end(), { p.x(), p.y(), p.z() });
+    };
+    addPosition(QVector3D(0.0f, 0.0f, 1.0f));
+    for (int ring = 1; ring < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
+            addPosition(spherePoint(ring, segment, rings, segments));
+        }
+    }
+    addPosition(QVector3D(0.0f, 0.0f, -1.0f));
+
+    std::vector<int> indices;
+    std::vector<int> offsets{ 0 };
+    indices.reserve(static_cast<size_t>(segments) * (rings - 2) * 4 + segments * 6);
+    offsets.reserve(static_cast<size_t>(segments) * rings + 1);
+    for (int segment = 0; segment < segments; ++segment) {
+        indices.insert(indices.end(), { 0, ringVertex(1, segment), ringVertex(1, segment + 1) });
+        offsets.push_back(static_cast<int>(indices.size()));
+    }
+    for (int ring = 1; ring + 1 < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
+            indices.insert(indices.end(), { ringVertex(ring, segment), ringVertex(ring + 1, segment),
+                                            ringVertex(ring + 1, segment + 1), ringVertex(ring, segment + 1) });
+            offsets.push_back(static_cast<int>(indices.size()));
+        }
+    }
+    for (int segment = 0; segment < segments; ++segment) {
+        indices.insert(indices.end(), { bottom, ringVertex(rings - 1, segment + 1), ringVertex(rings - 1, segment) });
+        offsets.push_back(static_cast<int>(indices.size()));
+    }
+
+    auto mesh = std::make_shared<BenchmarkMesh>("Sphere");
+    mesh->setGeometry(std::move(positions), std::move(indices), std::move(offsets));
+    return mesh;
+}
+
+std::shared_ptr<BenchmarkMesh> makeSubdividedCube(size_t faceCount, int& levels) {
+    levels = 0;
+    while (6 * (size_t(4) << (2 * levels)) <= faceCount) ++levels;
+
+    const std::vector<Point3D> vertices = {
+        Point3D(-0.5, -0.5, -0.5), Point3D(0.5, -0.5, -0.5),
+        Point3D(0.5, 0.5, -0.5), Point3D(-0.5, 0.5, -0.5),
+        Point3D(-0.5, -0.5, 0.5), Point3D(0.5, -0.5, 0.5),
+        Point3D(0.5, 0.5, 0.5), Point3D(-0.5, 0.5, 0.5)
+    };
+    const std::vector<Face> faces = {
+        Face{{0, 1, 2, 3}}, Face{{4, 7, 6, 5}},
+        Face{{0, 4, 5, 1}}, Face{{2, 6, 7, 3}},
+        Face{{0, 3, 7, 4}}, Face{{1, 5, 6, 2}}
+    };
+
+    auto mesh = std::make_shared<BenchmarkMesh>("Cube");
+    mesh->createFromGeometry(vertices, faces);
+    if (levels > 0) {
+        MeshManager().applySubdivisionSurface(mesh, levels);
+    }
+    return mesh;
+}
+
+std::vector<Triangle> makeSphereTriangles(size_t triangleCount) {
+    // Each quad of the UV grid becomes two triangles
+    int rings, segments;
+    sphereResolution(triangleCount / 2, rings, segments);
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(static_cast<size_t>(rings) * segments * 2);
+    auto point = [&](int ring, int segment) {
+        const QVector3D p = spherePoint(ring, segment, rings, segments);
+        return Point3D(p.x(), p.y(), p.z());
+    };
+    auto addTriangle = [&](const Point3D& a, const Point3D& b, const Point3D& c) {
+        const QVector3D n = QVector3D::normal(a.toQVector3D(), b.toQVector3D(), c.toQVector3D());
+        triangles.push_back(Triangle{ a, b, c, Vector3D(n.x(), n.y(), n.z()) });
+    };
+
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
+            const Point3D p00 = point(ring, segment), p01 = point(ring, segment + 1);
+            const Point3D p10 = point(ring + 1, segment), p11 = point(ring + 1, segment + 1);
+            // The pole rows have one degenerate half each
+            if (ring > 0) addTriangle(p00, p10, p01);
+            if (ring + 1 < rings) addTriangle(p01, p10, p11);
+        }
+    }
+    return triangles;
+}
+
+std::string datasetName(const std::string& kind, size_t count) {
+    char buffer[32];
+    if (count >= 1000000) {
+        std::snprintf(buffer, sizeof(buffer), "%.3gM", count / 1e6);
+    } else if (count >= 1000) {
+        std::snprintf(buffer, sizeof(buffer), "%.3gk", count / 1e3);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%zu", count);
+    }
+    return kind + "-" + buffer;
+}
+
+} // namespace Bench
+} // namespace HybridCAD
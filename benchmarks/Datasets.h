@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QVector3D>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CADTypes.h"
+#include "MeshManager.h"
+
+namespace HybridCAD {
+namespace Bench {
+
+// Mesh with the normal pass callable on its own, so it can be timed apart from face normals
+class BenchmarkMesh : public MeshObject {
+public:
+    using MeshObject::MeshObject;
+    using MeshObject::updateNormals;
+};
+
+// UV sphere of close to faceCount faces: quads, with triangle fans at the poles
+std::shared_ptr<BenchmarkMesh> makeSphere(size_t faceCount, float radius = 1.0f,
+                                          const QVector3D& center = QVector3D());
+
+// Unit cube refined by Catmull-Clark to 6 * 4^levels quads, the most that fit in faceCount
+std::shared_ptr<BenchmarkMesh> makeSubdividedCube(size_t faceCount, int& levels);
+
+// Unwelded sphere triangles, the way STL files and primitive generators hand them over
+std::vector<Triangle> makeSphereTriangles(size_t triangleCount);
+
+// Name for reports, with the count abbreviated ("sphere-500k")
+std::string datasetName(const std::string& kind, size_t count);
+
+} // namespace Bench
+} // namespace HybridCAD
@@ -0,0 +1,344 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+
+#include "Benchmark.h"
+#include "Datasets.h"
+#include "GeometryManager.h"
+#include "MeshIO.h"
+#include "SpatialIndex.h"
+#include "Tessellator.h"
+#include "ThreadPool.h"
+
+using namespace HybridCAD;
+using namespace HybridCAD::Bench;
+
+namespace {
+
+// Results are folded in here so the optimizer cannot drop the work
+volatile size_t g_sink = 0;
+
+constexpr size_t SCENE_OBJECT_FACES = 512;
+constexpr size_t RAY_COUNT = 10000;
+constexpr int SMOOTH_ITERATIONS = 5;
+
+struct Sizes {
+    size_t faces = 0;
+    size_t sceneObjects = 0;
+    // Sphere tessellations grow with the square of the segment count, cylinders linearly
+    int sphereSegments = 0;
+    int cylinderSegments = 0;
+};
+
+Sizes sizesFor(size_t faces) {
+    Sizes sizes;
+    sizes.faces = faces;
+    // About as many faces in the picking scene as in the single-mesh cases
+    sizes.sceneObjects = std::max<size_t>(64, faces / SCENE_OBJECT_FACES);
+    sizes.sphereSegments = std::max(16, static_cast<int>(std::sqrt(static_cast<double>(faces))));
+    sizes.cylinderSegments = std::max(16, static_cast<int>(faces / 4));
+    return sizes;
+}
+
+void runMeshCases(Runner& runner, const Sizes& sizes) {
+    MeshManager manager;
+
+    if (runner.anySelected({ "mesh/buildTopology", "mesh/updateNormals", "mesh/recalculateNormals", "mesh/smooth" })) {
+        int levels = 0;
+        const auto cube = makeSubdividedCube(sizes.faces, levels);
+        const std::pair<std::string, std::shared_ptr<BenchmarkMesh>> meshes[] = {
+            { datasetName("sphere", sizes.faces), makeSphere(sizes.faces) },
+            { datasetName("cube", cube->faceCount()), cube },
+        };
+
+        for (const auto& dataset : meshes) {
+            const std::string& name = dataset.first;
+            const std::shared_ptr<BenchmarkMesh>& mesh = dataset.second;
+            const size_t faces = mesh->faceCount();
+
+            runner.measure("mesh/buildTopology", name, faces, [&] { mesh->buildTopology(); });
+            runner.measure("mesh/updateNormals", name, faces, [&] { mesh->updateNormals(); });
+            runner.measure("mesh/recalculateNormals", name, faces, [&] { mesh->recalculateNormals(); });
+            runner.measure("mesh/smooth", name, faces, [&] {
+                g_sink += manager.smoothMesh(mesh, SMOOTH_ITERATIONS, 0.5f);
+            });
+        }
+    }
+
+    if (runner.selected("mesh/createFromTriangles")) {
+        const std::vector<Triangle> soup = makeSphereTriangles(sizes.faces);
+        std::unique_ptr<MeshObject> mesh;
+        runner.measure("mesh/createFromTriangles", datasetName("soup", soup.size()), soup.size(),
+            [&] { mesh = std::make_unique<MeshObject>(); },
+            [&] {
+                mesh->createFromTriangles(soup);
+                g_sink += mesh->vertexCount();
+            });
+    }
+
+    if (runner.selected("mesh/subdivide")) {
+        // One Catmull-Clark level into a mesh of about the requested size
+        int levels = 0;
+        const auto base = makeSubdividedCube(sizes.faces / 4, levels);
+        std::shared_ptr<MeshObject> mesh;
+        runner.measure("mesh/subdivide", datasetName("cube", base->faceCount()), base->faceCount() * 4,
+            [&] {
+                mesh = std::make_shared<MeshObject>();
+                mesh->setGeometry(base->getPositionData(), base->getFaceIndexData(), base->getFaceOffsetData());
+            },
+            [&] { g_sink += manager.applySubdivisionSurface(mesh, 1); });
+    }
+}
+
+void runPrimitiveCases(Runner& runner, const Sizes& sizes) {
+    if (!runner.anySelected({ "primitive/generateMesh", "primitive/generateMesh/cached" })) return;
+
+    Tessellator& tessellator = Tessellator::instance();
+    const size_t budget = tessellator.memoryBudget();
+    const int sphereSegments = sizes.sphereSegments;
+    const int cylinderSegments = sizes.cylinderSegments;
+
+    const std::pair<std::string, std::function<std::unique_ptr<GeometryPrimitive>()>> primitives[] = {
+        { "sphere", [sphereSegments] { return std::make_unique<Sphere>(1.0f, sphereSegments); } },
+        { "cylinder", [cylinderSegments] { return std::make_unique<Cylinder>(0.5f, 1.0f, cylinderSegments); } },
+    };
+
+    for (const auto& primitive : primitives) {
+        std::unique_ptr<GeometryPrimitive> object = primitive.second();
+        object->generateMesh();
+        const size_t triangles = object->getTriangles().size();
+        const std::string name = datasetName(primitive.first, triangles);
+
+        // Cold: the cache is emptied before each run, so every call tessellates
+        runner.measure("primitive/generateMesh", name, triangles,
+            [&] {
+                object.reset();
+                tessellator.setMemoryBudget(0);
+                object = primitive.second();
+            },
+            [&] {
+                object->generateMesh();
+                g_sink += object->getTriangles().size();
+            });
+
+        // Warm: a new object with parameters already in the cache only converts the shared mesh
+        tessellator.setMemoryBudget(budget);
+        runner.measure("primitive/generateMesh/cached", name, triangles,
+            [&] { object = primitive.second(); },
+            [&] {
+                object->generateMesh();
+                g_sink += object->getTriangles().size();
+            });
+    }
+
+    tessellator.setMemoryBudget(budget);
+}
+
+void runPickingCases(Runner& runner, const Sizes& sizes) {
+    std::mt19937 random(29);
+
+    if (runner.anySelected({ "pick/sceneIndexBuild", "pick/sceneRaycast" })) {
+        // Small spheres on a square grid in the XY plane, picked from above
+        const size_t count = sizes.sceneObjects;
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+        const float spacing = 3.0f;
+        CADObjectList objects;
+        objects.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const QVector3D center(spacing * (i % side), spacing * (i / side), 0.0f);
+            objects.push_back(makeSphere(SCENE_OBJECT_FACES, 1.0f, center));
+        }
+
+        std::uniform_real_distribution<float> across(-spacing, spacing * side);
+        std::uniform_real_distribution<float> tilt(-0.2f, 0.2f);
+        std::vector<std::pair<QVector3D, QVector3D>> rays(RAY_COUNT);
+        for (auto& ray : rays) {
+            ray.first = QVector3D(across(random), across(random), 10.0f);
+            ray.second = QVector3D(tilt(random), tilt(random), -1.0f).normalized();
+        }
+
+        const std::string name = datasetName("spheres", count);
+        SceneSpatialIndex index;
+        runner.measure("pick/sceneIndexBuild", name, count,
+            [&] { index.clear(); },
+            [&] {
+                for (const auto& object : objects) index.addObject(object);
+                g_sink += index.size();
+            });
+
+        if (index.size() != count) {
+            for (const auto& object : objects) index.addObject(object);
+        }
+        runner.measure("pick/sceneRaycast", name, rays.size(), [&] {
+            for (const auto& ray : rays) {
+                float distance = 0.0f;
+                QVector3D hit;
+                g_sink += index.raycast(ray.first, ray.second, distance, &hit) != nullptr;
+            }
+        });
+    }
+
+    if (runner.anySelected({ "pick/meshBVHBuild", "pick/meshRaycast" })) {
+        RenderMesh renderMesh;
+        makeSphere(sizes.faces)->buildRenderMesh(renderMesh);
+        const std::string name = datasetName("sphere", sizes.faces);
+
+        MeshBVH bvh;
+        runner.measure("pick/meshBVHBuild", name, renderMesh.indices.size() / 3,
+            [&] { bvh.clear(); },
+            [&] { bvh.build(renderMesh); });
+
+        if (bvh.isEmpty()) bvh.build(renderMesh);
+
+        // From random points around the sphere towards jittered points near its centre
+        std::normal_distribution<float> gaussian;
+        std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+        std::vector<std::pair<QVector3D, QVector3D>> rays(RAY_COUNT);
+        for (auto& ray : rays) {
+            ray.first = QVector3D(gaussian(random), gaussian(random), gaussian(random)).normalized() * 5.0f;
+            const QVector3D target(jitter(random), jitter(random), jitter(random));
+            ray.second = (target - ray.first).normalized();
+        }
+
+        runner.measure("pick/meshRaycast", name, rays.size(), [&] {
+            MeshBVH::RayHit hit;
+            for (const auto& ray : rays) {
+                g_sink += bvh.raycast(ray.first, ray.second, 100.0f, hit);
+            }
+        });
+    }
+}
+
+bool runIOCases(Runner& runner, const Sizes& sizes, const QStringList& samples) {
+    const std::vector<std::string> generated = { "io/exportSTL", "io/importSTL", "io/exportOBJ", "io/importOBJ" };
+    if (runner.anySelected(generated)) {
+        QTemporaryDir directory;
+        if (!directory.isValid()) {
+            std::fprintf(stderr, "Cannot create a temporary directory for the I/O cases\n");
+            return false;
+        }
+
+        const auto sphere = makeSphere(sizes.faces);
+        const std::string name = datasetName("sphere", sizes.faces);
+        const std::string stlPath = directory.filePath("sphere.stl").toStdString();
+        const std::string objPath = directory.filePath("sphere.obj").toStdString();
+
+        // The export cases also leave the sample files for the import cases
+        runner.measure("io/exportSTL", name, sphere->faceCount(), [&] { g_sink += MeshIO::exportSTL(stlPath, *sphere); });
+        runner.measure("io/exportOBJ", name, sphere->faceCount(), [&] { g_sink += MeshIO::exportOBJ(objPath, *sphere); });
+        if (!QFileInfo::exists(QString::fromStdString(stlPath))) MeshIO::exportSTL(stlPath, *sphere);
+        if (!QFileInfo::exists(QString::fromStdString(objPath))) MeshIO::exportOBJ(objPath, *sphere);
+
+        std::unique_ptr<MeshObject> mesh;
+        auto fresh = [&] { mesh = std::make_unique<MeshObject>(); };
+        runner.measure("io/importSTL", name, sphere->faceCount(), fresh, [&] { g_sink += MeshIO::importSTL(stlPath, *mesh); });
+        runner.measure("io/importOBJ", name, sphere->faceCount(), fresh, [&] { g_sink += MeshIO::importOBJ(objPath, *mesh); });
+    }
+
+    // Sample files given on the command line, under their file names
+    if (!runner.selected("io/importSTL")) return true;
+    for (const QString& sample : samples) {
+        const std::string path = sample.toStdString();
+        MeshObject probe;
+        if (!MeshIO::importSTL(path, probe)) {
+            std::fprintf(stderr, "Cannot read STL sample %s\n", path.c_str());
+            return false;
+        }
+
+        std::unique_ptr<MeshObject> mesh;
+        runner.measure("io/importSTL", QFileInfo(sample).fileName().toStdString(), probe.faceCount(),
+            [&] { mesh = std::make_unique<MeshObject>(); },
+            [&] { g_sink += MeshIO::importSTL(path, *mesh); });
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("HybridCADBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times the HybridCAD geometry and mesh kernels without a GUI.");
+    parser.addHelpOption();
+    QCommandLineOption scaleOption("scale", "Dataset size: small (50k faces), medium (500k) or large (2M).", "scale", "small");
+    QCommandLineOption facesOption("faces", "Target face count, overriding --scale.", "count");
+    QCommandLineOption repetitionsOption("repetitions", "Timed runs per case.", "count", "5");
+    QCommandLineOption warmupsOption("warmups", "Untimed runs before the timed ones.", "count", "1");
+    QCommandLineOption filterOption("filter", "Run only cases whose name contains this text.", "text");
+    QCommandLineOption outputOption("output", "Write the results as JSON to this file.", "file");
+    QCommandLineOption baselineOption("baseline", "Compare against the JSON results in this file.", "file");
+    QCommandLineOption thresholdOption("threshold", "Relative increase counted as a regression.", "ratio", "0.1");
+    QCommandLineOption stlOption("stl", "Also time importing this STL file (repeatable).", "file");
+    parser.addOptions({ scaleOption, facesOption, repetitionsOption, warmupsOption, filterOption,
+                        outputOption, baselineOption, thresholdOption, stlOption });
+    parser.process(app);
+
+    const QString scale = parser.value(scaleOption);
+    size_t faces = scale == "large" ? 2000000 : scale == "medium" ? 500000 : scale == "small" ? 50000 : 0;
+    if (parser.isSet(facesOption)) {
+        faces = parser.value(facesOption).toULongLong();
+    }
+    if (faces == 0) {
+        std::fprintf(stderr, "Unknown scale or face count\n");
+        return 2;
+    }
+
+    std::vector<Result> baseline;
+    if (parser.isSet(baselineOption) && !readReport(parser.value(baselineOption).toStdString(), baseline)) {
+        std::fprintf(stderr, "Cannot read baseline %s\n", qPrintable(parser.value(baselineOption)));
+        return 2;
+    }
+
+    Runner::Options options;
+    options.repetitions = std::max(1, parser.value(repetitionsOption).toInt());
+    options.warmups = std::max(0, parser.value(warmupsOption).toInt());
+    options.filter = parser.value(filterOption).toStdString();
+    Runner runner(options);
+
+    const Sizes sizes = sizesFor(faces);
+    std::printf("HybridCADBench: %zu faces, %zu worker threads, %d repetitions\n\n",
+                faces, ThreadPool::instance().threadCount(), options.repetitions);
+
+    runMeshCases(runner, sizes);
+    runPrimitiveCases(runner, sizes);
+    runPickingCases(runner, sizes);
+    if (!runIOCases(runner, sizes, parser.values(stlOption))) {
+        return 2;
+    }
+
+    if (parser.isSet(outputOption)) {
+        const std::vector<std::pair<std::string, std::string>> environment = {
+            { "date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString() },
+            { "system", QSysInfo::prettyProductName().toStdString() },
+            { "cpu", QSysInfo::currentCpuArchitecture().toStdString() },
+            { "threads", std::to_string(ThreadPool::instance().threadCount()) },
+            { "faces", std::to_string(faces) },
+            { "qt", qVersion() },
+#ifdef NDEBUG
+            { "build", "release" },
+#else
+            { "build", "debug" },
+#endif
+        };
+        if (!writeReport(parser.value(outputOption).toStdString(), runner.results(), environment)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(outputOption)));
+            return 2;
+        }
+    }
+
+    if (parser.isSet(baselineOption)) {
+        return compareReports(baseline, runner.results(), parser.value(thresholdOption).toDouble()) > 0 ? 1 : 0;
+    }
+    return 0;
+}
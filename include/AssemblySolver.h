@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <cstddef>
+#include <vector>
+
+namespace HybridCAD {
+
+enum class ConstraintType;
+
+// Positions the bodies of an assembly so their constraints hold. Bodies linked by constraints
+// form components that share nothing but grounded bodies, so each component is solved on its
+// own, in parallel, by Levenberg-Marquardt over six rigid-motion parameters per free body. The
+// normal equations are never formed: conjugate gradients apply the sparse constraint Jacobian
+// directly, preconditioned by its 6x6 diagonal blocks. Every solve starts from the current
+// transforms, and only components with a moved body or an edited constraint are solved again.
+class AssemblySolver {
+public:
+    // Points and directions are in the body's own frame, or in world space for a missing body
+    struct Constraint {
+        ConstraintType type;
+        int bodyA = -1;
+        int bodyB = -1;
+        QVector3D pointA;
+        QVector3D pointB;
+        QVector3D directionA;
+        QVector3D directionB;
+        double value = 0.0; // Distance, or angle in degrees
+    };
+
+    struct Settings {
+        int maxIterations = 100;
+        double tolerance = 1e-6; // Largest constraint error accepted, in model units
+    };
+
+    struct Stats {
+        size_t solvedComponents = 0;
+        int iterations = 0;        // Most taken by any one component
+        double residual = 0.0;     // Largest error left in any solved component
+    };
+
+    // Partitions the constraints into components and marks them all for solving. Grounded
+    // bodies never move; FIXED constraints ground their first body.
+    void rebuild(const std::vector<char>& grounded, const std::vector<Constraint>& constraints);
+    void clear();
+
+    // Marks the components that depend on body for solving
+    void markBodyDirty(int body);
+    bool hasDirtyComponents() const;
+
+    // Solves the marked components in place; false if any was left unsatisfied
+    bool solve(std::vector<QMatrix4x4>& transforms);
+
+    Settings& settings() { return m_settings; }
+    const Stats& stats() const { return m_stats; }
+    size_t componentCount() const { return m_components.size(); }
+
+private:
+    struct Component {
+        std::vector<int> bodies;      // Free bodies, each in exactly one component
+        std::vector<int> constraints;
+        bool dirty = true;
+    };
+
+    std::vector<Constraint> m_constraints;
+    std::vector<char> m_grounded;
+    std::vector<Component> m_components;
+    // Components each body takes part in; several for a grounded body
+    std::vector<std::vector<int>> m_bodyComponents;
+    // Position of each free body within its component
+    std::vector<int> m_bodySlot;
+    Settings m_settings;
+    Stats m_stats;
+};
+
+} // namespace HybridCAD
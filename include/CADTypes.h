@@ -1,8 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <atomic>
+#include <cstdint>
 #include <QVector3D>
 #include <QMatrix4x4>
 #include <QColor>
@@ -37,6 +40,40 @@ struct Face {
     Vector3D normal;
 };
 
+// Interleaved triangle mesh uploaded to the GPU (position xyz, normal xyz)
+struct RenderMesh {
+    static constexpr int FLOATS_PER_VERTEX = 6;
+    
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    
+    void clear() { vertices.clear(); indices.clear(); }
+    bool isEmpty() const { return indices.empty(); }
+    unsigned int vertexCount() const { return static_cast<unsigned int>(vertices.size() / FLOATS_PER_VERTEX); }
+    
+    unsigned int addVertex(const QVector3D& position, const QVector3D& normal) {
+        unsigned int index = vertexCount();
+        vertices.insert(vertices.end(), { position.x(), position.y(), position.z(),
+                                          normal.x(), normal.y(), normal.z() });
+        return index;
+    }
+    
+    void addTriangle(unsigned int a, unsigned int b, unsigned int c) {
+        indices.insert(indices.end(), { a, b, c });
+    }
+    
+    // Corners are expected counter-clockwise when viewed from the side the normal points to
+    void addQuad(const QVector3D& p0, const QVector3D& p1, const QVector3D& p2, const QVector3D& p3,
+                 const QVector3D& normal) {
+        unsigned int i0 = addVertex(p0, normal);
+        unsigned int i1 = addVertex(p1, normal);
+        unsigned int i2 = addVertex(p2, normal);
+        unsigned int i3 = addVertex(p3, normal);
+        addTriangle(i0, i1, i2);
+        addTriangle(i0, i2, i3);
+    }
+};
+
 // CAD Object types
 enum class ObjectType {
     PRIMITIVE_BOX,
@@ -84,11 +121,35 @@ struct Material {
         name("Default") {}
 };
 
+// Told when an object it indexes by name is renamed; see CADObject::addNameObserver()
+class NameObserver {
+public:
+    virtual ~NameObserver() = default;
+    virtual void objectRenamed(CADObject* object, const std::string& oldName) = 0;
+};
+
 // Base class for all CAD objects
 class CADObject {
 public:
     CADObject(const std::string& name = "Object", CADObject* parent = nullptr) 
-        : m_name(name), m_visible(true), m_selected(false), m_parent(parent) {}
+        : m_name(name), m_visible(true), m_selected(false), m_parent(parent),
+          m_geometryRevision(nextGeometryRevision()) {}
+    // A copy is in no index yet, so observers stay with the original, and it gets a revision of
+    // its own so caches keyed by object never mistake it for the original
+    CADObject(const CADObject& other)
+        : m_name(other.m_name), m_visible(other.m_visible), m_selected(other.m_selected),
+          m_material(other.m_material), m_parent(other.m_parent),
+          m_geometryRevision(nextGeometryRevision()) {}
+    CADObject& operator=(const CADObject& other) {
+        setName(other.m_name);
+        m_visible = other.m_visible;
+        m_selected = other.m_selected;
+        m_material = other.m_material;
+        m_parent = other.m_parent;
+        markGeometryDirty();
+        markAppearanceDirty();
+        return *this;
+    }
     virtual ~CADObject() = default;
 
     CADObject* getParent() const { return m_parent; }
@@ -100,17 +161,58 @@ public:
     virtual Point3D getBoundingBoxMin() const = 0;
     virtual Point3D getBoundingBoxMax() const = 0;
     
+    // Retained-mode geometry; objects that return false are drawn through render()
+    virtual bool buildRenderMesh(RenderMesh& mesh) const { (void)mesh; return false; }
+    
+    // Revisions are unique across all objects, so caches keyed by object never see a stale match
+    virtual uint64_t getGeometryRevision() const { return m_geometryRevision; }
+    void markGeometryDirty() { m_geometryRevision = nextGeometryRevision(); }
+    // Changes only when this object itself is edited, not when something it is built from is
+    uint64_t getOwnGeometryRevision() const { return m_geometryRevision; }
+    
+    // Moves with visibility and material changes, which leave the geometry revision alone; for
+    // caches that bake an object's look into their data, such as assembly instance buffers
+    virtual uint64_t getAppearanceRevision() const { return m_appearanceRevision; }
+    
+    // Objects this one is built from, besides its children; see DependencyGraph
+    virtual std::vector<const CADObject*> getDependencies() const { return {}; }
+    // Brings results derived from the dependencies up to date. The dependency graph calls this
+    // once every dependency is evaluated, possibly on a worker thread.
+    virtual void evaluate() const {}
+    
     const std::string& getName() const { return m_name; }
-    void setName(const std::string& name) { m_name = name; }
+    void setName(const std::string& name) {
+        if (name == m_name) return;
+        const std::string oldName = std::move(m_name);
+        m_name = name;
+        for (NameObserver* observer : m_nameObservers) {
+            observer->objectRenamed(this, oldName);
+        }
+    }
+    
+    // Documents index their objects by name and re-key just the renamed object; renaming objects
+    // no index holds, e.g. while importing, costs nothing. Added once per index holding it.
+    void addNameObserver(NameObserver* observer) { m_nameObservers.push_back(observer); }
+    void removeNameObserver(NameObserver* observer) {
+        auto it = std::find(m_nameObservers.begin(), m_nameObservers.end(), observer);
+        if (it != m_nameObservers.end()) m_nameObservers.erase(it);
+    }
     
     bool isVisible() const { return m_visible; }
-    void setVisible(bool visible) { m_visible = visible; }
+    void setVisible(bool visible) {
+        if (visible == m_visible) return;
+        m_visible = visible;
+        markAppearanceDirty();
+    }
     
     bool isSelected() const { return m_selected; }
     void setSelected(bool selected) { m_selected = selected; }
     
     const Material& getMaterial() const { return m_material; }
-    void setMaterial(const Material& material) { m_material = material; }
+    void setMaterial(const Material& material) {
+        m_material = material;
+        markAppearanceDirty();
+    }
 
 protected:
     std::string m_name;
@@ -118,6 +220,19 @@ protected:
     bool m_selected;
     Material m_material;
     CADObject* m_parent;
+    uint64_t m_geometryRevision;
+    uint64_t m_appearanceRevision = 0;
+
+private:
+    // Drawn from the same counter, so appearance revisions are unique across objects as well
+    void markAppearanceDirty() { m_appearanceRevision = nextGeometryRevision(); }
+
+    static uint64_t nextGeometryRevision() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+    
+    std::vector<NameObserver*> m_nameObservers;
 };
 
 using CADObjectPtr = std::shared_ptr<CADObject>;
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <QOpenGLWidget>
-#include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
 #include <QOpenGLVertexArrayObject>
@@ -10,12 +10,15 @@
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QKeyEvent>
+#include <QElapsedTimer>
 #include <QSettings>
 #include <QMap>
 #include <QMenu>
 #include <QAction>
 #include <memory>
 #include <array>
+#include <future>
+#include <unordered_map>
 
 #include "CADTypes.h"
 
@@ -27,6 +30,12 @@ class ToolManager;
 
 class GeometryManager;
 class MeshManager;
+class GpuMeshCache;
+class SceneSpatialIndex;
+class DependencyGraph;
+class RenderProfiler;
+class PickBuffer;
+class MeshObject;
 
 // Navigation cube widget for viewport navigation like Blender
 class NavigationCube : public QWidget
@@ -130,7 +139,7 @@ enum class KeyAction {
     MOVE_OBJECT // New action for moving an object
 };
 
-class CADViewer : public QOpenGLWidget, protected QOpenGLFunctions
+class CADViewer : public QOpenGLWidget, protected QOpenGLExtraFunctions
 {
     Q_OBJECT
 
@@ -164,6 +173,12 @@ public:
     void setAxesVisible(bool visible);
     void setBackgroundColor(const QColor& color);
     
+    // Render statistics HUD; showing it starts recording per-frame timings and counters
+    void setProfilerOverlayVisible(bool visible);
+    bool isProfilerOverlayVisible() const;
+    // Writes the recorded frames as a Chrome trace for .json filenames, CSV otherwise
+    bool exportRenderProfile(const QString& filename) const;
+    
     // Grid control
     void setGridPlane(GridPlane plane);
     GridPlane getGridPlane() const { return m_gridPlane; }
@@ -211,16 +226,27 @@ public:
     // Object management
     void addObject(CADObjectPtr object);
     void removeObject(CADObjectPtr object);
+    // Re-indexes an object for picking and snapping after its geometry was edited
+    void updateObject(CADObjectPtr object);
+    // Redraws after property edits that kept each object's parts and operands; the objects and
+    // everything built from them are re-indexed if their geometry changed
+    void refreshObjects(const std::vector<CADObjectPtr>& objects);
     void clearObjects();
     const CADObjectList& getObjects() const { return m_objects; }
     
     // Selection
     void selectObject(CADObjectPtr object);
     void deselectAll();
+    // Replaces the selection with one selectionChanged, whatever its size
+    void setSelectedObjects(const std::vector<CADObjectPtr>& objects);
     void selectAll();
     void deleteSelected();
     CADObjectPtr getSelectedObject() const;
     const std::vector<CADObjectPtr>& getSelectedObjects() const { return m_selectedObjects; }
+    // Visible objects covering at least one pixel of a widget-space rectangle
+    std::vector<CADObjectPtr> pickObjectsInRect(const QRect& rect);
+    // Selects the vertex, edge or face under the cursor in the manager's selection mode
+    bool pickMeshElement(const QPoint& screenPos, MeshManager& manager, bool addToSelection = false);
     
     // Coordinate conversion
     QVector3D screenToWorld(const QPoint& screenPos, float depth = 0.0f);
@@ -243,6 +269,9 @@ signals:
     void objectSelected(CADObjectPtr object);
     void objectDeselected(CADObjectPtr object);
     void selectionChanged();
+    void objectAdded(CADObjectPtr object);
+    void objectRemoved(CADObjectPtr object);
+    void objectsCleared();
     void coordinatesChanged(const QVector3D& worldPos);
     void shapePlacementStarted(ObjectType shapeType);
     void shapePlacementFinished(CADObjectPtr object);
@@ -272,9 +301,11 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+    void focusOutEvent(QFocusEvent *event) override;
 
 private slots:
-    void animate();
+    // Schedules one repaint; any number of requests before it runs share the same frame
+    void requestFrame();
     void showObjectContextMenu(const QPoint& pos);
     void deleteSelectedObject();
     void reshapeSelectedObject();
@@ -292,14 +323,27 @@ private:
     // Rendering methods
     void renderGrid();
     void renderMultiPlaneGrid();
+    void drawInfiniteGrid(const GridPlane* planes, const float* const* colors, int planeCount);
     void renderAxes();
     void renderObjects();
     void renderSelectionOutline(CADObjectPtr object);
+    // Sets the object's color and draws it with its selection outline
+    void drawSceneObject(const CADObjectPtr& object, float alphaOverride);
+    void drawObjectGeometry(const CADObjectPtr& object, bool transient = false, float alphaOverride = -1.0f);
+    void setModelAttribute(const QMatrix4x4& model);
+    void setObjectColor(const QVector4D& color);
+    const CADObject* selectLevelOfDetail(const CADObjectPtr& object);
+    void releaseLevelsOfDetail(const CADObject* object);
+    // Queues object and everything built from it in the spatial index
+    void queueSpatialUpdate(const CADObject* object);
+    float projectedRadiusPixels(const QVector3D& boundsMin, const QVector3D& boundsMax) const;
     void renderPlacementPreview();
     void renderExtrusionPreview();
     void renderEraserPreview();
+    void renderPreviewObject(const CADObjectPtr& previewObject);
     void renderSketchPreview();
     void renderSizeRuler();
+    void renderProfilerOverlay();
     
     // Camera methods
     void updateCameraPosition();
@@ -307,9 +351,17 @@ private:
     void rotateCamera(float deltaX, float deltaY);
     void zoomCamera(float delta);
     void processKeyboardInput();
+    static bool isMovementKey(int key);
+    void stopKeyMotionIfIdle();
+    void requestFrameAfter(int msec);
     
     // Selection methods
     CADObjectPtr pickObject(const QPoint& screenPos);
+    // Reads object and optionally primitive IDs under a widget-space rectangle, re-rendering
+    // the ID target first if the scene or camera changed; false when it is unavailable
+    bool readPickIds(const QRect& rect, std::vector<uint32_t>& objectIds, std::vector<uint32_t>* primitiveIds = nullptr);
+    void renderPickBuffer();
+    void screenRay(const QPoint& screenPos, QVector3D& rayOrigin, QVector3D& rayDirection) const;
     bool rayIntersectsObject(const QVector3D& rayOrigin, const QVector3D& rayDirection, 
                            CADObjectPtr object, float& distance);
     
@@ -334,7 +386,6 @@ private:
     void handleEraserClick(const QPoint& screenPos);
     void performBooleanSubtraction(CADObjectPtr target, CADObjectPtr eraser);
     bool objectsIntersect(CADObjectPtr obj1, CADObjectPtr obj2);
-    bool objectContainsObject(CADObjectPtr outer, CADObjectPtr inner);
     
     // Grid rendering
     void renderGridPlane(GridPlane plane);
@@ -373,6 +424,7 @@ private:
     // Keyboard state for continuous movement
     QSet<int> m_pressedKeys;
     QTimer* m_keyUpdateTimer;
+    QElapsedTimer m_keyMotionClock;
     
     // View state
     bool m_wireframeMode;
@@ -419,22 +471,58 @@ private:
     // Objects and selection
     CADObjectList m_objects;
     std::vector<CADObjectPtr> m_selectedObjects;
+    std::unique_ptr<SceneSpatialIndex> m_spatialIndex;
+    // Booleans and assemblies over the objects, re-evaluated before each frame draws them
+    std::unique_ptr<DependencyGraph> m_dependencyGraph;
+    
+    // Blended objects, kept in scene order and far-to-near; re-sorted only when the camera
+    // moves or the blended set changes
+    struct TransparentDraw {
+        CADObjectPtr object;
+        uint64_t revision;
+        float alphaOverride;
+        float depth;
+    };
+    std::vector<TransparentDraw> m_transparentSceneOrder;
+    std::vector<TransparentDraw> m_transparentDrawOrder;
+    std::vector<TransparentDraw> m_transparentScratch;
+    QVector3D m_transparentSortCamera;
     
     // OpenGL resources
     std::unique_ptr<QOpenGLShaderProgram> m_shaderProgram;
     std::unique_ptr<QOpenGLShaderProgram> m_gridShaderProgram;
     std::unique_ptr<QOpenGLShaderProgram> m_lineShaderProgram;
-    QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer m_vertexBuffer;
-    QOpenGLBuffer m_indexBuffer;
+    std::unique_ptr<QOpenGLShaderProgram> m_infiniteGridProgram;
+    std::unique_ptr<QOpenGLVertexArrayObject> m_gridVao;
+    std::unique_ptr<GpuMeshCache> m_meshCache;
+    std::unique_ptr<RenderProfiler> m_profiler;
+    
+    // ID target for picking; entry i holds the object drawn with ID i + 1
+    struct PickEntry {
+        CADObjectPtr object;
+        // Primitive IDs index the object's own render mesh triangles
+        bool renderMeshTriangles;
+    };
+    std::unique_ptr<QOpenGLShaderProgram> m_pickShaderProgram;
+    std::unique_ptr<PickBuffer> m_pickBuffer;
+    std::vector<PickEntry> m_pickEntries;
+    
+    // Decimated stand-ins for dense meshes, built on the thread pool and picked by screen size
+    struct LodChain {
+        uint64_t revision = 0;
+        std::future<std::vector<std::shared_ptr<MeshObject>>> pending;
+        std::vector<std::shared_ptr<MeshObject>> levels;
+    };
+    std::unordered_map<const CADObject*, LodChain> m_lodChains;
     
     // Matrices
     QMatrix4x4 m_modelMatrix;
     QMatrix4x4 m_viewMatrix;
     QMatrix4x4 m_projectionMatrix;
     
-    // Animation
-    QTimer* m_animationTimer;
+    // Frame scheduling
+    bool m_framePending;
+    QTimer* m_deferredFrameTimer;
     
     // Navigation cube
     NavigationCube* m_navigationCube;
@@ -468,6 +556,23 @@ private:
     static constexpr float CAMERA_DISTANCE_MAX = 100.0f;
     static constexpr float DEFAULT_CAMERA_SPEED = 5.0f;
     static constexpr float DEFAULT_MOUSE_SENSITIVITY = 1.0f;
+    static constexpr float FIELD_OF_VIEW = 45.0f;
+    static constexpr float GRID_FAR_PLANE = 1000.0f;
+    // Grid lines fade out at this multiple of the camera distance
+    static constexpr float GRID_FADE_FACTOR = 8.0f;
+    static constexpr int KEY_MOTION_INTERVAL_MS = 16;
+    // Caps a single movement step after a stall so the camera does not jump
+    static constexpr float KEY_MOTION_MAX_STEP = 0.1f;
+    // How often a frame is requested while LODs build in the background
+    static constexpr int LOD_POLL_INTERVAL_MS = 100;
+    // How often a frame is requested while primitives retessellate in the background
+    static constexpr int TESSELLATION_POLL_INTERVAL_MS = 15;
+    // Meshes below this face count are always drawn at full detail
+    static constexpr size_t LOD_MIN_FACES = 20000;
+    // Projected radius below which the first LOD is used; each further level halves it
+    static constexpr float LOD_FULL_DETAIL_PIXELS = 400.0f;
+    // Objects whose projected bounding sphere radius is below this are skipped
+    static constexpr float CULL_MIN_PIXELS = 0.5f;
 };
 
 } // namespace HybridCAD 
\ No newline at end of file
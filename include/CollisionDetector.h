@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "CADTypes.h"
+#include "SpatialIndex.h"
+
+namespace HybridCAD {
+
+// Interference between rigidly placed parts, such as the instances of an assembly. Sweep and
+// prune over the placed bounds finds the candidate pairs, and each candidate is tested triangle
+// against triangle by walking both parts' BVHs in the first part's frame; the pair tests run in
+// parallel. A part inside another also counts. Faces that only touch, like mated parts, do not.
+// Results are cached per pair, so after one body moves only the pairs involving it are re-tested.
+class CollisionDetector {
+public:
+    struct Body {
+        const CADObject* part = nullptr;
+        QMatrix4x4 transform;
+        bool enabled = true; // Disabled bodies collide with nothing
+    };
+
+    struct Stats {
+        size_t candidatePairs = 0; // Overlapping bounds re-tested by the last update
+        size_t testedTriangles = 0;
+    };
+
+    // Brings the results up to date with bodies. Bodies are matched by index; a changed count or
+    // part starts over.
+    void update(const std::vector<Body>& bodies);
+    void clear();
+
+    // Colliding pairs of body indices, lower index first, sorted
+    std::vector<std::pair<int, int>> collisions() const;
+    const Stats& stats() const { return m_stats; }
+
+    // One-off test of two placed parts, sharing the detector's part cache
+    bool test(const Body& a, const Body& b);
+
+private:
+    // Part geometry in its own frame
+    struct Shape {
+        uint64_t revision = 0;
+        std::vector<QVector3D> positions;
+        std::vector<unsigned int> indices;
+        StaticBVH tree;
+        AABB bounds;
+    };
+
+    struct Proxy {
+        const CADObject* part = nullptr;
+        std::shared_ptr<const Shape> shape;
+        QMatrix4x4 transform;
+        AABB box;
+        bool enabled = false;
+    };
+
+    std::shared_ptr<const Shape> shapeFor(const CADObject* part);
+    bool intersect(const Shape& a, const QMatrix4x4& transformA, const Shape& b, const QMatrix4x4& transformB,
+                   size_t& testedTriangles) const;
+    void findPairs(std::vector<std::pair<int, int>>& candidates) const;
+
+    std::unordered_map<const CADObject*, std::shared_ptr<const Shape>> m_shapes;
+    std::vector<Proxy> m_proxies;
+    // Overlapping pairs by (lower << 32 | higher), and whether they collide
+    std::unordered_map<uint64_t, bool> m_pairs;
+    Stats m_stats;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "CADTypes.h"
+
+namespace HybridCAD {
+
+// Feature dependencies between CAD objects. An object depends on what getDependencies() returns
+// and a parent on its children, so editing a primitive reaches every boolean and assembly built
+// from it. Edits are picked up from the objects' own geometry revisions; a change marks the
+// object and everything downstream dirty, and evaluate() re-evaluates only those, inputs first.
+// Dirty objects whose inputs are all up to date are evaluated in parallel.
+class DependencyGraph {
+public:
+    // Rebuilds the links from the document's objects and everything they are built from.
+    // Objects already in the graph keep their state.
+    void rebuild(const CADObjectList& objects);
+    void clear();
+
+    // Incremental forms of rebuild(), costing only the links of the object concerned. Objects
+    // pulled in as something else's input or parent go again once nothing links to them.
+    void addNode(const CADObject* object);
+    void removeNode(const CADObject* object);
+    // Picks up changed dependencies or parent after object was edited
+    void relink(const CADObject* object);
+
+    // Marks object and everything built from it for re-evaluation
+    void markDirty(const CADObject* object);
+    bool isDirty(const CADObject* object) const;
+    // Marks the objects edited since they were last evaluated; returns how many were found
+    size_t collectChanges();
+    // Re-evaluates every dirty object in dependency order; returns how many were evaluated and
+    // appends them to evaluated when given
+    size_t evaluate(std::vector<const CADObject*>* evaluated = nullptr);
+
+    size_t size() const { return m_index.size(); }
+    // Objects that directly use object
+    std::vector<const CADObject*> dependents(const CADObject* object) const;
+    // False when the links form a cycle; objects on or after one are never evaluated
+    bool isAcyclic() const;
+
+private:
+    struct Node {
+        // Null for a free slot
+        const CADObject* object = nullptr;
+        std::vector<int> inputs;
+        std::vector<int> outputs;
+        // Own revision when last evaluated
+        uint64_t revision = 0;
+        bool dirty = true;
+        // Added for itself rather than as another node's input or parent
+        bool root = false;
+    };
+
+    // The object's node, created with its inputs and parent when missing
+    int findOrAddNode(const CADObject* object);
+    void linkInputs(int node);
+    void unlink(int input, int output);
+    // Frees node and then whichever implicit nodes that leaves unused
+    void eraseNode(int node);
+    void markDirty(int node);
+    // Recomputes m_levels after the links changed
+    void order() const;
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_freeNodes;
+    std::unordered_map<const CADObject*, int> m_index;
+    // Nodes grouped by their longest input chain; each level only reads earlier ones
+    mutable std::vector<std::vector<int>> m_levels;
+    mutable bool m_ordered = true;
+    mutable bool m_acyclic = true;
+};
+
+} // namespace HybridCAD
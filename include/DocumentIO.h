@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace HybridCAD {
+
+class CADObject;
+class PartDocument;
+
+// Where a document's chunks sit in the file it was last opened from or saved to. Kept with the
+// document so the next save to that file only appends the chunks that changed.
+struct DocumentStorage {
+    struct Chunk {
+        uint32_t kind = 0;
+        uint32_t flags = 0;
+        uint64_t offset = 0;
+        uint64_t storedSize = 0;
+        uint64_t rawSize = 0;
+    };
+
+    struct ObjectChunk {
+        Chunk chunk;
+        uint64_t revision = 0; // Geometry revision the chunk was written from
+    };
+
+    std::string filePath;
+    uint64_t fileSize = 0;  // As left by the last open or save; any other size means a foreign edit
+    uint64_t liveBytes = 0; // Bytes the current table of contents refers to
+    uint64_t featureTreeHash = 0;
+    std::unordered_map<const CADObject*, ObjectChunk> objectChunks;
+};
+
+// Native document files: a header, 16-byte aligned chunks and a table of contents at the end.
+// The feature tree is one small chunk holding every object's parameters; each mesh has a chunk
+// of raw little-endian arrays. Opening reads only the header, the table and the feature tree;
+// meshes keep their bounds and read their arrays from the mapped file on first use. Saving to
+// the file a document came from appends the changed chunks and a new table, then rewrites the
+// header; the file is rewritten whole once dead chunks outweigh live ones.
+//
+// A save is split so that only prepareSave() needs the GUI thread: it encodes the small feature
+// tree and copies the arrays of meshes that changed, and writeSave() then encodes, compresses and
+// writes on any thread while editing goes on.
+class DocumentIO {
+public:
+    struct SaveOptions {
+        // Deflates each chunk that shrinks; compressed mesh chunks cost a decompression when
+        // first used instead of a plain copy
+        bool compress = false;
+    };
+
+    struct SaveJob;
+
+    static bool load(const std::string& filePath, PartDocument& document);
+    // True when the file storage describes still holds everything in document, judged by
+    // geometry revisions and the feature tree without copying any mesh
+    static bool isSaved(const PartDocument& document, const DocumentStorage& storage);
+    // All three save stages on the calling thread
+    static bool save(const std::string& filePath, PartDocument& document, const SaveOptions& options);
+
+    // previous is the layout of filePath as last written, when known; null if the document holds
+    // something that cannot be saved
+    static std::shared_ptr<SaveJob> prepareSave(const std::string& filePath, const PartDocument& document,
+                                                std::shared_ptr<const DocumentStorage> previous,
+                                                const SaveOptions& options);
+    // progress gets growing percentages, possibly from several threads
+    static bool writeSave(SaveJob& job, const std::function<void(int)>& progress = nullptr);
+    // Layout of the file a successful writeSave() left, for the next save to it
+    static std::shared_ptr<DocumentStorage> savedStorage(const SaveJob& job);
+    static const std::string& savePath(const SaveJob& job);
+
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint64_t CHUNK_ALIGNMENT = 16;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <deque>
+#include <memory>
+#include "DocumentIO.h"
+
+class QTimer;
+
+namespace HybridCAD {
+
+class PartDocument;
+
+// Saves documents without blocking the GUI thread. Each save snapshots the document on the GUI
+// thread, then encodes, compresses and writes on the thread pool; saves run one at a time in
+// the order asked for. Autosave goes through the same queue into a file of its own, appending
+// only what changed since the previous autosave and skipping the write when nothing did.
+class DocumentSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentSaver(QObject* parent = nullptr);
+    ~DocumentSaver() override;
+
+    void setSaveOptions(const DocumentIO::SaveOptions& options) { m_options = options; }
+    const DocumentIO::SaveOptions& getSaveOptions() const { return m_options; }
+
+    // On success the document takes filePath and is no longer dirty, unless edited meanwhile
+    void save(std::shared_ptr<PartDocument> document, const QString& filePath);
+    bool isSaving() const { return m_active != nullptr; }
+    // Blocks until every queued save has finished, e.g. before quitting
+    void waitForFinished();
+
+    // Zero turns autosave off
+    void setAutosaveInterval(int milliseconds);
+    int getAutosaveInterval() const { return m_autosaveInterval; }
+    void setAutosaveDocument(std::shared_ptr<PartDocument> document);
+    // Next to the document's file, or in the application data folder while it has none
+    static QString autosavePath(const PartDocument& document);
+
+signals:
+    // Emitted on the GUI thread right before a document is snapshotted, so its owner can bring
+    // it up to date
+    void aboutToSave(PartDocument* document);
+    void saveProgress(const QString& filePath, int percent);
+    void saveFinished(const QString& filePath, bool success);
+    void autosaveFinished(const QString& filePath, bool success);
+
+private slots:
+    void autosave();
+
+private:
+    // Queued saves keep their document alive until it is written
+    struct Request {
+        std::shared_ptr<PartDocument> document;
+        QString filePath;
+        bool autosave = false;
+    };
+    struct ActiveSave;
+
+    void startNext();
+    void finish(const std::shared_ptr<ActiveSave>& active);
+    void complete();
+
+    std::deque<Request> m_queue;
+    std::shared_ptr<ActiveSave> m_active;
+    DocumentIO::SaveOptions m_options;
+
+    QTimer* m_autosaveTimer;
+    int m_autosaveInterval;
+    std::weak_ptr<PartDocument> m_autosaveDocument;
+    // Layout of the autosave file as last written
+    std::shared_ptr<DocumentStorage> m_autosaveStorage;
+};
+
+} // namespace HybridCAD
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "CADTypes.h"
+#include "Tessellator.h"
 
 #ifdef HAVE_OPENCASCADE
 #include <TopoDS_Shape.hxx>
@@ -19,17 +20,49 @@ public:
     GeometryPrimitive(const std::string& name = "Primitive") : CADObject(name) {}
     virtual ~GeometryPrimitive() = default;
     
-    virtual void generateMesh() = 0;
+    // Fills the vertex and triangle lists from the tessellation
+    virtual void generateMesh();
     virtual Point3D getBoundingBoxMin() const = 0;
     virtual Point3D getBoundingBoxMax() const = 0;
     
+    // Appends the tessellation for the current parameters, building it here if it is not shared yet
+    bool buildRenderMesh(RenderMesh& mesh) const override;
+    
+    // Canonical parameters of the current shape. Keys describe a unit shape where the proportions
+    // allow, so primitives differing only in size or position share one mesh.
+    TessellationKey tessellationKey() const;
+    // Maps the key's mesh into object space
+    QMatrix4x4 tessellationTransform() const;
+    // Latest finished background tessellation. After a parameter change a build is queued,
+    // superseding any stale one, and the previous mesh is returned until the new one lands;
+    // current tells whether the result matches the present parameters. The mesh is in the key's
+    // space; place it with tessellationTransform(). GUI thread only.
+    RenderMeshSnapshot tessellation(bool& current) const;
+    // Places tessellation()'s mesh while it is not current: stretched from the bounds it last
+    // matched to the present ones, so an edit shows before its rebuild lands
+    QMatrix4x4 previewTransform() const;
+    // Builds a key's mesh without touching any object, so it can run on a worker thread
+    static void tessellate(const TessellationKey& key, RenderMesh& mesh);
+    
     const std::vector<Point3D>& getVertices() const { return m_vertices; }
     const std::vector<Triangle>& getTriangles() const { return m_triangles; }
 
 protected:
+    virtual TessellationKey describeTessellation(QMatrix4x4& transform) const = 0;
+    
     std::vector<Point3D> m_vertices;
     std::vector<Triangle> m_triangles;
     bool m_meshGenerated = false;
+    
+    // Swapped on the GUI thread once the ticket's build finishes
+    mutable RenderMeshSnapshot m_tessellation;
+    mutable TessellationKey m_tessellationKey;
+    mutable TessellationTicket m_tessellationTicket;
+    mutable TessellationKey m_ticketKey;
+    // Placement and bounds as of the last time m_tessellation was current
+    mutable QMatrix4x4 m_tessellationPlacement;
+    mutable Point3D m_tessellationMin;
+    mutable Point3D m_tessellationMax;
 };
 
 class Box : public GeometryPrimitive {
@@ -40,7 +73,6 @@ public:
     ObjectType getType() const override { return ObjectType::PRIMITIVE_BOX; }
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
-    void generateMesh() override;
     Point3D getBoundingBoxMin() const override { return m_min; }
     Point3D getBoundingBoxMax() const override { return m_max; }
     
@@ -48,6 +80,9 @@ public:
     Point3D getMin() const { return m_min; }
     Point3D getMax() const { return m_max; }
 
+protected:
+    TessellationKey describeTessellation(QMatrix4x4& transform) const override;
+
 private:
     Point3D m_min, m_max;
 };
@@ -59,7 +94,6 @@ public:
     ObjectType getType() const override { return ObjectType::PRIMITIVE_CYLINDER; }
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
-    void generateMesh() override;
     Point3D getBoundingBoxMin() const override { return Point3D(-m_radius, -m_height/2, -m_radius); }
     Point3D getBoundingBoxMax() const override { return Point3D(m_radius, m_height/2, m_radius); }
     
@@ -68,6 +102,9 @@ public:
     float getHeight() const { return m_height; }
     int getSegments() const { return m_segments; }
 
+protected:
+    TessellationKey describeTessellation(QMatrix4x4& transform) const override;
+
 private:
     float m_radius;
     float m_height;
@@ -81,16 +118,18 @@ public:
     ObjectType getType() const override { return ObjectType::PRIMITIVE_SPHERE; }
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
-    void generateMesh() override;
     Point3D getBoundingBoxMin() const override { return Point3D(m_center.x - m_radius, m_center.y - m_radius, m_center.z - m_radius); }
     Point3D getBoundingBoxMax() const override { return Point3D(m_center.x + m_radius, m_center.y + m_radius, m_center.z + m_radius); }
     
     void setParameters(float radius, int segments);
-    void setCenter(const Point3D& center) { m_center = center; }
+    void setCenter(const Point3D& center) { m_center = center; m_meshGenerated = false; markGeometryDirty(); }
     Point3D getCenter() const { return m_center; }
     float getRadius() const { return m_radius; }
     int getSegments() const { return m_segments; }
 
+protected:
+    TessellationKey describeTessellation(QMatrix4x4& transform) const override;
+
 private:
     float m_radius;
     int m_segments;
@@ -104,7 +143,6 @@ public:
     ObjectType getType() const override { return ObjectType::PRIMITIVE_CONE; }
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
-    void generateMesh() override;
     Point3D getBoundingBoxMin() const override { float maxRadius = std::max(m_bottomRadius, m_topRadius); return Point3D(m_center.x - maxRadius, m_center.y - m_height/2, m_center.z - maxRadius); }
     Point3D getBoundingBoxMax() const override { float maxRadius = std::max(m_bottomRadius, m_topRadius); return Point3D(m_center.x + maxRadius, m_center.y + m_height/2, m_center.z + maxRadius); }
     
@@ -113,9 +151,12 @@ public:
     float getTopRadius() const { return m_topRadius; }
     float getHeight() const { return m_height; }
     int getSegments() const { return m_segments; }
-    void setCenter(const Point3D& center) { m_center = center; }
+    void setCenter(const Point3D& center) { m_center = center; m_meshGenerated = false; markGeometryDirty(); }
     Point3D getCenter() const { return m_center; }
 
+protected:
+    TessellationKey describeTessellation(QMatrix4x4& transform) const override;
+
 private:
     float m_bottomRadius;
     float m_topRadius;
@@ -134,18 +175,33 @@ public:
     ObjectType getType() const override; 
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
-    Point3D getBoundingBoxMin() const override { return m_result ? m_result->getBoundingBoxMin() : Point3D(); }
-    Point3D getBoundingBoxMax() const override { return m_result ? m_result->getBoundingBoxMax() : Point3D(); }
+    bool buildRenderMesh(RenderMesh& mesh) const override;
+    uint64_t getGeometryRevision() const override;
+    Point3D getBoundingBoxMin() const override;
+    Point3D getBoundingBoxMax() const override;
+    std::vector<const CADObject*> getDependencies() const override;
+    void evaluate() const override { updateResult(); }
     
     Operation getOperation() const { return m_operation; }
     CADObjectPtr getObjectA() const { return m_objectA; }
     CADObjectPtr getObjectB() const { return m_objectB; }
+    
+    // Evaluated boolean in world space, recomputed only after an operand changes. Null when an
+    // operand has no mesh to combine.
+    RenderMeshSnapshot getResult() const;
 
 private:
+    void updateResult() const;
+    
     CADObjectPtr m_objectA;
     CADObjectPtr m_objectB;
     Operation m_operation;
-    CADObjectPtr m_result;
+    
+    mutable RenderMeshSnapshot m_result;
+    mutable uint64_t m_resultRevision = 0;
+    mutable bool m_resultValid = false;
+    mutable Point3D m_resultMin;
+    mutable Point3D m_resultMax;
 };
 
 // Geometry manager class
@@ -177,6 +233,10 @@ public:
     
     // Mesh generation
     void generateMeshForObject(CADObjectPtr object);
+    // Memory budget of the primitive tessellation cache shared by all managers; meshes beyond it
+    // stay alive only while some primitive uses them
+    void setTessellationCacheBudget(size_t bytes);
+    size_t getTessellationCacheBudget() const;
     
 private:
     void initializeOpenCASCADE();
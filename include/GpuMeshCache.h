@@ -0,0 +1,130 @@
+#pragma once
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QMatrix4x4>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "CADTypes.h"
+#include "Tessellator.h"
+
+namespace HybridCAD {
+
+class Assembly;
+class RenderProfiler;
+
+// GPU copy of an object's RenderMesh: interleaved position/normal VBO plus IBO
+struct GpuMesh {
+    std::unique_ptr<QOpenGLVertexArrayObject> vao;
+    QOpenGLBuffer vertexBuffer{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer indexBuffer{QOpenGLBuffer::IndexBuffer};
+    int indexCount = 0;
+    uint64_t revision = 0;
+    bool hasMesh = false;
+    // Tessellation the buffers were filled from, for primitives built in the background
+    RenderMeshSnapshot snapshot;
+    // First background tessellation not finished yet; nothing is drawn meanwhile
+    bool pending = false;
+    // Primitives draw from buffers shared per tessellation, placed by transform
+    GpuMesh* shared = nullptr;
+    QMatrix4x4 transform;
+
+    void destroy();
+};
+
+// Per-instance transforms and colors of an assembly, one contiguous range per part
+struct GpuInstanceSet {
+    struct Range {
+        const CADObject* part;
+        int firstInstance;
+        int instanceCount;
+        // Shared primitive transform baked into the instances
+        QMatrix4x4 partTransform;
+    };
+
+    QOpenGLBuffer instanceBuffer{QOpenGLBuffer::VertexBuffer};
+    std::vector<Range> ranges;
+    uint64_t revision = 0;
+    // Part visibility and materials are baked into the instances as well
+    uint64_t appearanceRevision = 0;
+    float alphaOverride = -1.0f;
+
+    void destroy();
+};
+
+// Per-object cache of GPU meshes, rebuilt only when an object's geometry revision changes.
+// Primitives with the same tessellation share one set of buffers and differ only by the model
+// matrix. Every call that touches GL must be made with the owning context current.
+class GpuMeshCache {
+public:
+    // Attribute locations expected by the object shader; the model matrix takes four slots
+    static constexpr int POSITION_LOCATION = 0;
+    static constexpr int NORMAL_LOCATION = 1;
+    static constexpr int MODEL_LOCATION = 2;
+    static constexpr int COLOR_LOCATION = 6;
+
+    using InstanceFallback = std::function<void(const CADObject& part, const QMatrix4x4& transform, const QColor& color)>;
+
+    GpuMeshCache();
+    ~GpuMeshCache();
+
+    void initialize(QOpenGLExtraFunctions* gl);
+    // Draw calls and triangles are reported here when set
+    void setProfiler(RenderProfiler* profiler) { m_profiler = profiler; }
+    // Constant model matrix for non-instanced draws; shared primitive meshes are placed relative to it
+    void setModelAttribute(const QMatrix4x4& model);
+
+    // Draws the cached mesh; returns false if the object has no render mesh. Primitives are
+    // retessellated in the background and keep their previous mesh until the new one is ready.
+    bool draw(const CADObject* object);
+    // Draws an object that lives for a single frame (previews) without caching it
+    bool drawTransient(const CADObject* object);
+    // One instanced draw per unique part; parts without a render mesh go through the fallback.
+    // A non-negative alphaOverride replaces every instance's alpha.
+    void drawAssembly(const Assembly* assembly, float alphaOverride, const InstanceFallback& fallback);
+
+    // Safe without a current context; buffers are freed on the next draw or clear()
+    void release(const CADObject* object);
+    void releaseAll();
+
+    // Frees all GPU resources immediately
+    void clear();
+
+    size_t size() const { return m_meshes.size(); }
+    size_t sharedSize() const { return m_sharedMeshes.size(); }
+    // Background tessellations the draws since the last call were waiting on
+    int takePendingTessellations();
+
+private:
+    GpuMesh* acquire(const CADObject* object);
+    void upload(GpuMesh& mesh, const CADObject* object, QOpenGLBuffer::UsagePattern usage);
+    void uploadMesh(GpuMesh& mesh, const RenderMesh& source, QOpenGLBuffer::UsagePattern usage);
+    void drawMesh(const GpuMesh& mesh);
+    GpuMesh* acquireShared(const RenderMeshSnapshot& snapshot);
+    void releaseShared(GpuMesh& entry);
+    void applyModelAttribute(const QMatrix4x4& model);
+    void uploadInstances(GpuInstanceSet& set, const Assembly* assembly, float alphaOverride);
+    void destroyReleased();
+
+    QOpenGLExtraFunctions* m_gl;
+    RenderProfiler* m_profiler;
+    std::unordered_map<const CADObject*, std::unique_ptr<GpuMesh>> m_meshes;
+    std::unordered_map<const CADObject*, std::unique_ptr<GpuInstanceSet>> m_instanceSets;
+    struct SharedMesh {
+        std::unique_ptr<GpuMesh> mesh;
+        int users = 0;
+    };
+    std::unordered_map<const RenderMesh*, SharedMesh> m_sharedMeshes;
+    std::vector<std::unique_ptr<GpuMesh>> m_released;
+    std::vector<std::unique_ptr<GpuInstanceSet>> m_releasedInstanceSets;
+    std::unique_ptr<GpuMesh> m_transient;
+    RenderMesh m_scratch;
+    QMatrix4x4 m_model;
+    int m_pendingTessellations;
+};
+
+} // namespace HybridCAD
@@ -24,6 +24,8 @@ class CADViewer;
 class PropertyPanel;
 class TreeView;
 class ToolManager;
+class DocumentSaver;
+class PartDocument;
 
 class MainWindow : public QMainWindow
 {
@@ -66,6 +68,8 @@ private slots:
     void toggleWireframe();
     void toggleGrid();
     void toggleAxes();
+    void toggleRenderStatistics();
+    void exportRenderProfile();
     
     // Create menu actions
     void createBox();
@@ -110,8 +114,15 @@ private slots:
 
 private slots:
     void updateStatusMessage(const QString& message);
+    void syncDocument(PartDocument* document);
+    void documentSaved(const QString& filePath, bool success);
 
 private:
+    // Replaces the document, moving the undo actions and autosave over to it
+    void setDocument(std::shared_ptr<PartDocument> document);
+    void updateUndoActions();
+    // Shows the scene again after undo or redo changed it
+    void refreshScene();
     void createActions();
     void createMenus();
     void createToolBars();
@@ -186,6 +197,8 @@ private:
     QAction *m_wireframeAct;
     QAction *m_gridAct;
     QAction *m_axesAct;
+    QAction *m_renderStatsAct;
+    QAction *m_exportRenderProfileAct;
     
     // Actions - Create
     QAction *m_createBoxAct;
@@ -233,6 +246,10 @@ private:
     QLabel *m_statusLabel;
     QLabel *m_coordinateLabel;
     
+    // The document mirrors the viewer's objects and is saved in the background
+    std::shared_ptr<PartDocument> m_document;
+    DocumentSaver *m_documentSaver;
+    
     // Current file
     QString m_currentFile;
     QStringList m_recentFiles;
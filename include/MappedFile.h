@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <string>
+#include <vector>
+
+namespace HybridCAD {
+
+// Read-only view of a whole file, memory-mapped when the file system allows it
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename)
+        : m_file(QString::fromStdString(filename)), m_mapped(nullptr), m_data(nullptr), m_size(0) {}
+
+    ~MappedFile() {
+        if (m_mapped) {
+            m_file.unmap(m_mapped);
+        }
+    }
+
+    bool open() {
+        if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+        m_size = static_cast<size_t>(m_file.size());
+        if (m_size == 0) return true;
+
+        m_mapped = m_file.map(0, m_file.size());
+        if (m_mapped) {
+            m_data = reinterpret_cast<const char*>(m_mapped);
+            return true;
+        }
+
+        // Fallback for files that cannot be mapped (pipes, some network mounts)
+        m_buffer.resize(m_size);
+        if (m_file.read(m_buffer.data(), m_file.size()) != m_file.size()) return false;
+        m_data = m_buffer.data();
+        return true;
+    }
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    QFile m_file;
+    uchar* m_mapped;
+    const char* m_data;
+    size_t m_size;
+    std::vector<char> m_buffer;
+};
+
+} // namespace HybridCAD
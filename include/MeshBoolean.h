@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+#include "CADTypes.h"
+
+namespace HybridCAD {
+
+// Mesh CSG on closed triangle meshes. Both operands are snapped to one integer grid spanning
+// their bounds, so the predicates deciding which triangles touch and on which side of a plane a
+// vertex lies are evaluated exactly in 64-bit integers; only the split points are constructed in
+// floating point. Triangles that cross the other operand are split by its planes, every piece is
+// classified inside or outside the other operand, and the pieces the operation keeps form the
+// result. Cut points on shared edges are computed from the edge alone, so neighbouring triangles
+// stay conforming; seam points are merged across the operands and added to the pieces of both
+// sides, so a closed input gives a closed result.
+class MeshBoolean {
+public:
+    enum Operation { UNION, DIFFERENCE, INTERSECTION };
+
+    struct Stats {
+        size_t candidatePairs = 0;
+        size_t intersectingPairs = 0;
+        size_t splitTriangles = 0;
+        size_t outputTriangles = 0;
+    };
+
+    // Grid steps per axis over the operands' bounds. Coordinates below 2^19 keep the orientation
+    // determinant within 60 bits.
+    static constexpr int GRID_BITS = 19;
+
+    // Replaces result; returns false when the result is empty
+    static bool compute(const RenderMesh& a, const RenderMesh& b, Operation operation, RenderMesh& result,
+                        Stats* stats = nullptr);
+};
+
+} // namespace HybridCAD
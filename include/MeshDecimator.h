@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace HybridCAD {
+
+class MeshObject;
+
+// Quadric error metric edge-collapse decimation (Garland-Heckbert). Works on a private
+// triangulated copy of the input, so the source mesh may change while a decimation runs.
+class MeshDecimator {
+public:
+    explicit MeshDecimator(const MeshObject& mesh);
+
+    size_t inputTriangleCount() const { return m_inputTriangles; }
+    size_t triangleCount() const { return m_liveTriangles; }
+
+    // Collapses edges until at most targetTriangles remain; stops early when no collapse keeps the
+    // surface manifold. Returns the triangle count reached.
+    size_t decimateTo(size_t targetTriangles);
+
+    // Writes the current state as a compacted triangle mesh
+    void extract(MeshObject& mesh) const;
+
+    // Successive levels of one collapse run; ratios are fractions of the input triangle count
+    // and should decrease
+    std::vector<std::shared_ptr<MeshObject>> buildLodChain(const std::vector<float>& ratios, const std::string& name);
+
+private:
+    // Symmetric 4x4 plane quadric stored as its upper triangle
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+        void addPlane(double a, double b, double c, double d, double weight);
+        void add(const Quadric& other);
+        double evaluate(double x, double y, double z) const;
+    };
+
+    struct Collapse {
+        double cost;
+        int keep;
+        int remove;
+        uint32_t keepStamp;
+        uint32_t removeStamp;
+        float target[3];
+    };
+
+    static bool heapOrder(const Collapse& a, const Collapse& b);
+
+    void computeQuadrics();
+    void pushCollapse(int keep, int remove);
+    bool isStale(const Collapse& collapse) const;
+    bool canCollapse(const Collapse& collapse);
+    void applyCollapse(const Collapse& collapse);
+    void gatherNeighbours(int vertex, std::vector<int>& neighbours) const;
+
+    std::vector<float> m_positions;
+    std::vector<int> m_triangles;
+    std::vector<char> m_triangleAlive;
+    std::vector<std::vector<int>> m_vertexTriangles;
+    std::vector<Quadric> m_quadrics;
+    std::vector<uint32_t> m_stamps;
+    std::vector<char> m_vertexAlive;
+    std::vector<char> m_boundary;
+
+    // Binary min-heap with lazy invalidation: entries record the stamps of both vertices and are
+    // discarded when popped after either vertex changed
+    std::vector<Collapse> m_heap;
+
+    size_t m_inputTriangles;
+    size_t m_liveTriangles;
+
+    // Scratch buffers reused across collapse checks
+    std::vector<int> m_neighbours1;
+    std::vector<int> m_neighbours2;
+};
+
+} // namespace HybridCAD
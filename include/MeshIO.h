@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+namespace HybridCAD {
+
+class MeshObject;
+
+// Mesh interchange formats. Readers work on a memory-mapped view of the file, so memory use is
+// bounded by the resulting mesh; writers stream through a fixed-size buffer.
+class MeshIO {
+public:
+    // Binary and ASCII STL; coincident facet corners are welded while reading
+    static bool importSTL(const std::string& filename, MeshObject& mesh);
+    // Always writes binary STL, fan-triangulating polygons
+    static bool exportSTL(const std::string& filename, const MeshObject& mesh);
+
+    // Vertex positions and polygon faces; texture coordinates, normals and groups are skipped.
+    // Large files are parsed in parallel by line ranges.
+    static bool importOBJ(const std::string& filename, MeshObject& mesh);
+    static bool exportOBJ(const std::string& filename, const MeshObject& mesh);
+
+    // Output buffer size used by the writers
+    static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+};
+
+} // namespace HybridCAD
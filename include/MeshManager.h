@@ -2,41 +2,144 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <unordered_set>
 #include <unordered_map>
 #include "CADTypes.h"
 
 namespace HybridCAD {
 
-// Mesh editing structures
-struct Vertex {
-    Point3D position;
-    Vector3D normal;
-    int id;
-    bool selected;
+// Contiguous slice of a packed index array
+struct AdjacencyRange {
+    const int* first = nullptr;
+    const int* last = nullptr;
     
-    Vertex(const Point3D& pos = Point3D(), int vertexId = -1) 
-        : position(pos), id(vertexId), selected(false) {}
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    int operator[](size_t i) const { return first[i]; }
 };
 
-struct Edge {
-    int vertex1, vertex2;
-    int id;
-    bool selected;
-    std::vector<int> adjacentFaces;
+// Packed selection flags, one bit per element
+class SelectionBits {
+public:
+    // Existing flags are kept when growing
+    void resize(size_t count);
+    size_t size() const { return m_count; }
+    
+    bool test(size_t index) const { return index < m_count && ((m_words[index / 64] >> (index % 64)) & 1u); }
+    void set(size_t index, bool value = true);
+    void clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+    void setAll();
+    void flip();
     
-    Edge(int v1 = -1, int v2 = -1, int edgeId = -1) 
-        : vertex1(v1), vertex2(v2), id(edgeId), selected(false) {}
+    size_t count() const;
+    bool any() const;
+    std::vector<int> indices() const;
+
+private:
+    void maskTail();
+    
+    std::vector<uint64_t> m_words;
+    size_t m_count = 0;
 };
 
-struct MeshFace {
-    std::vector<int> vertices;
-    Vector3D normal;
-    int id;
-    bool selected;
+class MeshObject;
+class UndoHistory;
+
+// Immutable copy of a mesh's defining arrays; topology and vertex normals are derived again on
+// restore. Snapshots taken from the same base share the arrays that did not change.
+struct MeshSnapshot {
+    std::shared_ptr<const std::vector<float>> positions;
+    std::shared_ptr<const std::vector<int>> faceIndices;
+    std::shared_ptr<const std::vector<int>> faceOffsets;
+    std::shared_ptr<const std::vector<float>> faceNormals;
     
-    MeshFace(const std::vector<int>& verts = {}, int faceId = -1) 
-        : vertices(verts), id(faceId), selected(false) {}
+    // Bytes of the arrays not already in counted
+    size_t memoryUsage(std::unordered_set<const void*>& counted) const;
+};
+
+// Mesh arrays kept out of memory until first used, such as a mesh chunk of a document file
+class DeferredMeshGeometry {
+public:
+    virtual ~DeferredMeshGeometry() = default;
+    // Fills the arrays MeshObject::setGeometry() takes, plus the face normals; false on failure
+    virtual bool read(std::vector<float>& positions, std::vector<int>& faceIndices,
+                      std::vector<int>& faceOffsets, std::vector<float>& faceNormals) const = 0;
+};
+
+// Lightweight element views over MeshObject's packed arrays; ids are element indices
+class VertexRef {
+public:
+    VertexRef(const MeshObject* mesh, int index) : m_mesh(mesh), m_index(index) {}
+    int id() const { return m_index; }
+    QVector3D position() const;
+    QVector3D normal() const;
+    bool selected() const;
+
+private:
+    const MeshObject* m_mesh;
+    int m_index;
+};
+
+class EdgeRef {
+public:
+    EdgeRef(const MeshObject* mesh, int index) : m_mesh(mesh), m_index(index) {}
+    int id() const { return m_index; }
+    int vertex1() const;
+    int vertex2() const;
+    AdjacencyRange adjacentFaces() const;
+    bool selected() const;
+
+private:
+    const MeshObject* m_mesh;
+    int m_index;
+};
+
+class FaceRef {
+public:
+    FaceRef(const MeshObject* mesh, int index) : m_mesh(mesh), m_index(index) {}
+    int id() const { return m_index; }
+    AdjacencyRange vertices() const;
+    QVector3D normal() const;
+    bool selected() const;
+
+private:
+    const MeshObject* m_mesh;
+    int m_index;
+};
+
+// Indexable, iterable sequence of element refs
+template <typename Ref>
+class ElementView {
+public:
+    class iterator {
+    public:
+        iterator(const MeshObject* mesh, int index) : m_mesh(mesh), m_index(index) {}
+        Ref operator*() const { return Ref(m_mesh, m_index); }
+        iterator& operator++() { ++m_index; return *this; }
+        bool operator==(const iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const MeshObject* m_mesh;
+        int m_index;
+    };
+    
+    ElementView(const MeshObject* mesh, size_t count) : m_mesh(mesh), m_count(count) {}
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    Ref operator[](size_t index) const { return Ref(m_mesh, static_cast<int>(index)); }
+    iterator begin() const { return iterator(m_mesh, 0); }
+    iterator end() const { return iterator(m_mesh, static_cast<int>(m_count)); }
+
+private:
+    const MeshObject* m_mesh;
+    size_t m_count;
 };
 
 // Mesh selection modes
@@ -60,6 +163,8 @@ enum class MeshTool {
     BRIDGE
 };
 
+// Polygon mesh stored as structure-of-arrays: float32 xyz position/normal arrays per vertex,
+// a flat face corner array addressed through per-face offsets, and selection bitsets
 class MeshObject : public CADObject {
 public:
     MeshObject(const std::string& name = "Mesh");
@@ -68,19 +173,69 @@ public:
     ObjectType getType() const override { return ObjectType::MESH; }
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
+    bool buildRenderMesh(RenderMesh& mesh) const override;
+    // Face that produced a triangle of buildRenderMesh(), or -1; linear in the face count
+    int faceForRenderTriangle(int triangle) const;
+    
+    // Element views
+    ElementView<VertexRef> getVertices() const { return ElementView<VertexRef>(this, vertexCount()); }
+    ElementView<EdgeRef> getEdges() const { return ElementView<EdgeRef>(this, edgeCount()); }
+    ElementView<FaceRef> getFaces() const { return ElementView<FaceRef>(this, faceCount()); }
+    
+    size_t vertexCount() const { ensureLoaded(); return m_positions.size() / 3; }
+    size_t edgeCount() const { ensureLoaded(); return m_edgeVertices.size() / 2; }
+    size_t faceCount() const { ensureLoaded(); return m_faceOffsets.size() - 1; }
     
-    // Mesh data access
-    const std::vector<Vertex>& getVertices() const { return m_vertices; }
-    const std::vector<Edge>& getEdges() const { return m_edges; }
-    const std::vector<MeshFace>& getFaces() const { return m_faces; }
+    // Packed arrays; face f uses corners [faceOffsets[f], faceOffsets[f + 1]) of faceIndices
+    const std::vector<float>& getPositionData() const { ensureLoaded(); return m_positions; }
+    const std::vector<float>& getNormalData() const { ensureLoaded(); return m_normals; }
+    const std::vector<float>& getFaceNormalData() const { ensureLoaded(); return m_faceNormals; }
+    const std::vector<int>& getFaceIndexData() const { ensureLoaded(); return m_faceIndices; }
+    const std::vector<int>& getFaceOffsetData() const { ensureLoaded(); return m_faceOffsets; }
+    const std::vector<int>& getEdgeVertexData() const { ensureLoaded(); return m_edgeVertices; }
+    // Edge from each face corner to the next one, parallel to the face index array
+    const std::vector<int>& getCornerEdgeData() const { ensureLoaded(); return m_cornerEdges; }
     
-    std::vector<Vertex>& getVertices() { return m_vertices; }
-    std::vector<Edge>& getEdges() { return m_edges; }
-    std::vector<MeshFace>& getFaces() { return m_faces; }
+    QVector3D getVertexPosition(int vertexIndex) const;
+    QVector3D getVertexNormal(int vertexIndex) const;
+    QVector3D getFaceNormal(int faceIndex) const;
+    AdjacencyRange getFaceVertices(int faceIndex) const;
+    AdjacencyRange getEdgeFaces(int edgeIndex) const;
+    
+    // Editing; callers must rebuild topology after adding faces and call markGeometryDirty() when done
+    void setVertexPosition(int vertexIndex, const QVector3D& position);
+    float* getPositionBuffer() { ensureLoaded(); return m_positions.data(); }
+    int addVertex(const QVector3D& position);
+    int addFace(const int* vertexIndices, int cornerCount, const QVector3D& normal = QVector3D());
+    void reserve(size_t vertices, size_t faces, size_t corners);
     
     // Mesh creation from geometry
     void createFromTriangles(const std::vector<Triangle>& triangles);
     void createFromGeometry(const std::vector<Point3D>& vertices, const std::vector<Face>& faces);
+    // Takes packed arrays directly (faceOffsets has faceCount + 1 entries, starting at 0)
+    void setGeometry(std::vector<float> positions, std::vector<int> faceIndices, std::vector<int> faceOffsets);
+    void clear();
+    
+    // Undo support; arrays equal to base's are shared with it instead of copied
+    std::shared_ptr<const MeshSnapshot> takeSnapshot(const MeshSnapshot* base = nullptr) const;
+    void restoreSnapshot(const MeshSnapshot& snapshot);
+    
+    // Geometry whose bounds are known but whose arrays are read on first use. Counts, array
+    // getters and edits read it in; element accessors expect an index obtained from those.
+    // Loading does not change the geometry revision.
+    void setDeferredGeometry(std::shared_ptr<const DeferredMeshGeometry> geometry, const Point3D& min, const Point3D& max);
+    std::shared_ptr<const DeferredMeshGeometry> getDeferredGeometry() const;
+    bool isGeometryLoaded() const { return !m_deferredPending.load(std::memory_order_acquire); }
+    void ensureLoaded() const {
+        if (!isGeometryLoaded()) loadDeferredGeometry();
+    }
+    
+    // Connectivity (element indices); rebuild after changing faces
+    void buildTopology();
+    static uint64_t edgeKey(int vertex1, int vertex2);
+    int findEdge(int vertex1, int vertex2) const;
+    AdjacencyRange getVertexFaces(int vertexIndex) const;
+    AdjacencyRange getVertexEdges(int vertexIndex) const;
     
     // Selection
     void selectVertex(int vertexId, bool addToSelection = false);
@@ -88,37 +243,101 @@ public:
     void selectFace(int faceId, bool addToSelection = false);
     void deselectAll();
     
-    const std::unordered_set<int>& getSelectedVertices() const { return m_selectedVertices; }
-    const std::unordered_set<int>& getSelectedEdges() const { return m_selectedEdges; }
-    const std::unordered_set<int>& getSelectedFaces() const { return m_selectedFaces; }
+    const SelectionBits& getSelectedVertices() const { return m_vertexSelection; }
+    const SelectionBits& getSelectedEdges() const { return m_edgeSelection; }
+    const SelectionBits& getSelectedFaces() const { return m_faceSelection; }
+    SelectionBits& getSelectedVertices() { return m_vertexSelection; }
+    SelectionBits& getSelectedEdges() { return m_edgeSelection; }
+    SelectionBits& getSelectedFaces() { return m_faceSelection; }
     
     // Mesh validation and repair
     bool isValid() const;
     void recalculateNormals();
-    void removeDuplicateVertices(float tolerance = 1e-6f);
-    void removeUnusedVertices();
+    // Both return the number of vertices removed and rebuild topology when that is non-zero
+    size_t removeDuplicateVertices(float tolerance = 1e-6f);
+    size_t removeUnusedVertices();
+    // Points each corner at remap[vertex], where every target maps to itself; repeated corners
+    // and faces left with fewer than three are dropped, and vertices no longer used removed
+    size_t remapVertices(const std::vector<int>& remap);
     
     // Bounding box
     Point3D getBoundingBoxMin() const override;
     Point3D getBoundingBoxMax() const override;
 
 protected:
-    std::vector<Vertex> m_vertices;
-    std::vector<Edge> m_edges;
-    std::vector<MeshFace> m_faces;
+    std::vector<float> m_positions;
+    std::vector<float> m_normals;
+    std::vector<int> m_faceIndices;
+    std::vector<int> m_faceOffsets;
+    std::vector<float> m_faceNormals;
+    std::vector<int> m_edgeVertices;
     
-    std::unordered_set<int> m_selectedVertices;
-    std::unordered_set<int> m_selectedEdges;
-    std::unordered_set<int> m_selectedFaces;
+    SelectionBits m_vertexSelection;
+    SelectionBits m_edgeSelection;
+    SelectionBits m_faceSelection;
     
-    int m_nextVertexId;
-    int m_nextEdgeId;
-    int m_nextFaceId;
+    // Corner-to-edge map plus CSR edge-to-face, vertex-to-face and vertex-to-edge adjacency
+    std::vector<int> m_cornerEdges;
+    std::vector<int> m_edgeFaceOffsets;
+    std::vector<int> m_edgeFaces;
+    std::vector<int> m_vertexFaceOffsets;
+    std::vector<int> m_vertexFaces;
+    std::vector<int> m_vertexEdgeOffsets;
+    std::vector<int> m_vertexEdges;
+    // Edge by edgeKey()
+    std::unordered_map<uint64_t, int> m_edgeLookup;
     
-    void buildTopology();
     void updateNormals();
+
+private:
+    void loadDeferredGeometry() const;
+    
+    // Guards the switch from deferred to loaded, which may happen on a worker thread
+    mutable std::mutex m_deferredMutex;
+    mutable std::atomic<bool> m_deferredPending{false};
+    mutable std::shared_ptr<const DeferredMeshGeometry> m_deferred;
+    Point3D m_deferredMin;
+    Point3D m_deferredMax;
 };
 
+inline QVector3D MeshObject::getVertexPosition(int vertexIndex) const {
+    const float* p = &m_positions[vertexIndex * 3];
+    return QVector3D(p[0], p[1], p[2]);
+}
+
+inline QVector3D MeshObject::getVertexNormal(int vertexIndex) const {
+    const float* n = &m_normals[vertexIndex * 3];
+    return QVector3D(n[0], n[1], n[2]);
+}
+
+inline QVector3D MeshObject::getFaceNormal(int faceIndex) const {
+    const float* n = &m_faceNormals[faceIndex * 3];
+    return QVector3D(n[0], n[1], n[2]);
+}
+
+inline AdjacencyRange MeshObject::getFaceVertices(int faceIndex) const {
+    const int* data = m_faceIndices.data();
+    return AdjacencyRange{data + m_faceOffsets[faceIndex], data + m_faceOffsets[faceIndex + 1]};
+}
+
+inline AdjacencyRange MeshObject::getEdgeFaces(int edgeIndex) const {
+    const int* data = m_edgeFaces.data();
+    return AdjacencyRange{data + m_edgeFaceOffsets[edgeIndex], data + m_edgeFaceOffsets[edgeIndex + 1]};
+}
+
+inline QVector3D VertexRef::position() const { return m_mesh->getVertexPosition(m_index); }
+inline QVector3D VertexRef::normal() const { return m_mesh->getVertexNormal(m_index); }
+inline bool VertexRef::selected() const { return m_mesh->getSelectedVertices().test(m_index); }
+
+inline int EdgeRef::vertex1() const { return m_mesh->getEdgeVertexData()[m_index * 2]; }
+inline int EdgeRef::vertex2() const { return m_mesh->getEdgeVertexData()[m_index * 2 + 1]; }
+inline AdjacencyRange EdgeRef::adjacentFaces() const { return m_mesh->getEdgeFaces(m_index); }
+inline bool EdgeRef::selected() const { return m_mesh->getSelectedEdges().test(m_index); }
+
+inline AdjacencyRange FaceRef::vertices() const { return m_mesh->getFaceVertices(m_index); }
+inline QVector3D FaceRef::normal() const { return m_mesh->getFaceNormal(m_index); }
+inline bool FaceRef::selected() const { return m_mesh->getSelectedFaces().test(m_index); }
+
 class MeshManager {
 public:
     MeshManager();
@@ -137,7 +356,13 @@ public:
     void setActiveTool(MeshTool tool) { m_activeTool = tool; }
     MeshTool getActiveTool() const { return m_activeTool; }
     
-    // Mesh editing operations
+    // With a history set, each editing operation below that changes a mesh is recorded in it
+    // as one MeshSnapshotCommand
+    void setUndoHistory(UndoHistory* history) { m_undoHistory = history; }
+    
+    // Mesh editing operations. Extrusion moves the faces as one region and closes its rim with
+    // quads; a zero direction follows the faces' normals. Inset shrinks each face on its own
+    // towards its centroid inside a ring of quads. Both keep the moved faces selected.
     bool extrudeFaces(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& faceIds, 
                      const Vector3D& direction, float distance);
     bool insetFaces(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& faceIds, 
@@ -145,20 +370,25 @@ public:
     bool subdivideEdges(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds);
     bool subdivideSelected(std::shared_ptr<MeshObject> mesh);
     
-    // Vertex operations
+    // Vertex operations; merging collapses the vertices onto one at their centroid
     bool mergeVertices(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& vertexIds);
     bool dissolveVertices(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& vertexIds);
     
-    // Edge operations
+    // Edge operations; extruded edges become quads and the far edges are selected
     bool extrudeEdges(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds, 
                      const Vector3D& direction, float distance);
     bool bridgeEdgeLoops(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds1,
                         const std::unordered_set<int>& edgeIds2);
     bool knifeProject(std::shared_ptr<MeshObject> mesh, const Point3D& start, const Point3D& end);
     
-    // Smoothing and modifiers
+    // Smoothing and modifiers. Smoothing is Taubin's, one shrinking and one inflating Laplacian
+    // step per iteration; boundaries stay fixed, as does everything but the selected vertices
+    // while any are selected.
     bool smoothMesh(std::shared_ptr<MeshObject> mesh, int iterations = 1, float factor = 0.5f);
     bool decimateMesh(std::shared_ptr<MeshObject> mesh, float ratio);
+    // Decimated copies from one collapse run, one per ratio of the input triangle count
+    std::vector<std::shared_ptr<MeshObject>> buildLevelsOfDetail(std::shared_ptr<MeshObject> mesh,
+                                                                const std::vector<float>& ratios = { 0.5f, 0.25f, 0.1f });
     bool applySubdivisionSurface(std::shared_ptr<MeshObject> mesh, int levels = 1);
     
     // Boolean operations on meshes
@@ -172,6 +402,10 @@ public:
     // Utility functions
     bool selectByRay(std::shared_ptr<MeshObject> mesh, const Point3D& rayOrigin, 
                     const Vector3D& rayDirection);
+    // Selects the element of a face already known to be hit, e.g. read from the viewport's ID
+    // buffer: the face itself, or its vertex or edge nearest the ray's hit on the face plane
+    bool selectOnFace(std::shared_ptr<MeshObject> mesh, int faceId, const Point3D& rayOrigin,
+                      const Vector3D& rayDirection, bool addToSelection = false);
     void clearSelection(std::shared_ptr<MeshObject> mesh);
     void invertSelection(std::shared_ptr<MeshObject> mesh);
     void selectAll(std::shared_ptr<MeshObject> mesh);
@@ -185,6 +419,7 @@ public:
 private:
     SelectionMode m_selectionMode;
     MeshTool m_activeTool;
+    UndoHistory* m_undoHistory;
     
     // Helper functions
     void calculateFaceNormal(MeshObject* mesh, int faceId);
@@ -194,8 +429,8 @@ private:
     bool isEdgeManifold(const MeshObject* mesh, int edgeId);
     
     // Subdivision algorithms
-    void catmullClarkSubdivision(MeshObject* mesh);
-    void loopSubdivision(MeshObject* mesh);
+    bool catmullClarkSubdivision(MeshObject* mesh);
+    bool loopSubdivision(MeshObject* mesh);
     
     // Mesh analysis
     bool isMeshManifold(const MeshObject* mesh);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CADTypes.h"
+#include "DocumentIO.h"
+
+namespace HybridCAD {
+
+// Named parts grouped by category, looked up by hash. A library opened from a directory keeps
+// only its catalog in memory: every part is a document file of its own, read on first use, and
+// the least recently used parts are dropped again beyond a memory budget. Parts added while no
+// directory is open live in memory only.
+class PartLibrary {
+public:
+    struct Entry {
+        std::string name;
+        std::string category;
+        std::string description;
+        std::string thumbnailPath;
+        // Relative to the library directory; empty for parts held in memory only
+        std::string fileName;
+        uint64_t fileSize = 0;
+    };
+
+    PartLibrary();
+    ~PartLibrary();
+
+    // Reads the catalog, replacing any entries; a directory without one is an empty library
+    bool open(const std::string& directory);
+    const std::string& getDirectory() const { return m_directory; }
+    // Writes the catalog if entries changed since it was read; also done on destruction
+    bool flush();
+
+    // Replaces a part of the same name. With a directory open the part is written there first,
+    // and false means it could not be.
+    bool add(CADObjectPtr part, const std::string& name, const std::string& category,
+             const std::string& description = "");
+    bool remove(const std::string& name);
+
+    const Entry* findEntry(const std::string& name) const;
+    void setThumbnailPath(const std::string& name, const std::string& thumbnailPath);
+
+    // Reads the part on first use; null if it is unknown or its file is unreadable
+    CADObjectPtr get(const std::string& name);
+    bool isResident(const std::string& name) const;
+
+    std::vector<std::string> getCategories() const;
+    // In the order they were added
+    const std::vector<std::string>& getParts(const std::string& category) const;
+    size_t size() const { return m_slots.size(); }
+
+    // Parts read from disk are kept to roughly this many bytes of their files. Parts held in
+    // memory only are not counted and never dropped.
+    void setMemoryBudget(uint64_t bytes);
+    uint64_t getMemoryBudget() const { return m_memoryBudget; }
+    uint64_t getResidentBytes() const { return m_residentBytes; }
+
+    void setSaveOptions(const DocumentIO::SaveOptions& options) { m_saveOptions = options; }
+
+private:
+    struct Slot {
+        Entry entry;
+        CADObjectPtr part;
+        // Position in m_recent while a part read from disk is resident
+        std::list<std::string>::iterator recent;
+        bool isRecent = false;
+    };
+
+    void touch(Slot& slot);
+    void forget(Slot& slot);
+    void trim();
+    std::string partFileName(const std::string& name);
+    std::string filePath(const std::string& fileName) const;
+
+    std::string m_directory;
+    std::unordered_map<std::string, Slot> m_slots;
+    std::unordered_map<std::string, std::vector<std::string>> m_categories;
+    std::unordered_set<std::string> m_fileNames;
+    bool m_catalogDirty;
+
+    // Most recently used first
+    std::list<std::string> m_recent;
+    uint64_t m_memoryBudget;
+    uint64_t m_residentBytes;
+    DocumentIO::SaveOptions m_saveOptions;
+};
+
+} // namespace HybridCAD
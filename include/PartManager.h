@@ -1,13 +1,21 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include "AssemblySolver.h"
 #include "CADTypes.h"
+#include "CollisionDetector.h"
+#include "DocumentIO.h"
+#include "PartLibrary.h"
+#include "UndoHistory.h"
 
 namespace HybridCAD {
 
+class ThumbnailRenderer;
+
 // Assembly constraint types
 enum class ConstraintType {
     FIXED,
@@ -41,6 +49,7 @@ struct PartInstance {
     CADObjectPtr part;
     Transform transform;
     std::string instanceName;
+    QColor color; // Invalid color means the part's own material is used
     bool visible;
     bool locked;
     
@@ -48,8 +57,15 @@ struct PartInstance {
         : part(p), instanceName(name), visible(true), locked(false) {}
 };
 
+// All visible instances of one part, flattened out of an assembly hierarchy
+struct InstanceBatch {
+    CADObjectPtr part;
+    std::vector<QMatrix4x4> transforms;
+    std::vector<QColor> colors;
+};
+
 // Assembly class
-class Assembly : public CADObject {
+class Assembly : public CADObject, public std::enable_shared_from_this<Assembly> {
 public:
     Assembly(const std::string& name = "Assembly");
     ~Assembly() = default;
@@ -57,17 +73,32 @@ public:
     ObjectType getType() const override { return ObjectType::ASSEMBLY; }
     void render() const override;
     bool intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const override;
+    uint64_t getGeometryRevision() const override;
+    // Newest of its own and every part's, since instances are drawn in their parts' look
+    uint64_t getAppearanceRevision() const override;
+    // Each part once, however many instances it has
+    std::vector<const CADObject*> getDependencies() const override;
+    
+    // Groups visible instances by shared part so each part can be drawn with one instanced call
+    std::vector<InstanceBatch> buildInstanceBatches() const;
     
     // Part management
-    void addPart(CADObjectPtr part, const std::string& instanceName = "");
+    // The new instance, to fill in before further parts are added; names may repeat, so it cannot
+    // be looked up again by name. Null without a part.
+    PartInstance* addPart(CADObjectPtr part, const std::string& instanceName = "");
     void removePart(CADObjectPtr part);
     void removePartInstance(const std::string& instanceName);
     
     const std::vector<PartInstance>& getPartInstances() const { return m_partInstances; }
-    PartInstance* getPartInstance(const std::string& instanceName);
+    const PartInstance* getPartInstance(const std::string& instanceName) const;
+    // For changing an instance in place; the assembly's geometry and solver setup count as stale
+    // afterwards, so lookups that only read go through getPartInstance()
+    PartInstance* editPartInstance(const std::string& instanceName);
     
-    // Transform management
+    // Transform and appearance management. Each transform change is handed to the undo
+    // recorder, if one is set, as a TransformCommand.
     void setPartTransform(const std::string& instanceName, const Transform& transform);
+    void setPartColor(const std::string& instanceName, const QColor& color);
     Transform getPartTransform(const std::string& instanceName) const;
     
     // Constraint management
@@ -77,7 +108,12 @@ public:
     
     const std::vector<AssemblyConstraint>& getConstraints() const { return m_constraints; }
     
-    // Assembly operations
+    // Receives the undo commands of edits made through this assembly
+    void setUndoRecorder(std::function<void(UndoCommandPtr)> recorder) { m_undoRecorder = std::move(recorder); }
+    
+    // Moves unlocked instances until the enabled constraints hold; only the groups of constrained
+    // instances touched since the last solve are re-solved. A constraint binds the first instance
+    // of each of its parts, and a missing partB stands for the assembly's own frame.
     bool solveConstraints();
     void updateAssembly();
     
@@ -85,24 +121,36 @@ public:
     Point3D getBoundingBoxMin() const override;
     Point3D getBoundingBoxMax() const override;
     
-    // Collision detection
+    // Collision detection between visible instances; only instances moved since the last query
+    // are re-tested
     bool hasCollisions() const;
     std::vector<std::pair<std::string, std::string>> getCollisions() const;
 
 private:
     std::vector<PartInstance> m_partInstances;
     std::vector<AssemblyConstraint> m_constraints;
-    bool m_constraintsDirty;
-    
-    void applyConstraint(const AssemblyConstraint& constraint);
+    bool m_constraintsDirty; // Constraints or instances changed since the solver was set up
+    AssemblySolver m_solver;
+    mutable CollisionDetector m_collisionDetector;
+    std::function<void(UndoCommandPtr)> m_undoRecorder;
+    
+    int findInstanceIndex(const CADObject* part) const;
+    void collectInstances(const QMatrix4x4& parentTransform, std::vector<InstanceBatch>& batches,
+                          std::unordered_map<const CADObject*, size_t>& batchIndex) const;
     bool checkCollision(const PartInstance& instanceA, const PartInstance& instanceB) const;
+    void updateCollisions() const;
+    // Union of the visible parts' boxes under their instance transforms
+    void getPlacedBounds(Point3D& min, Point3D& max) const;
 };
 
 // Part document class
-class PartDocument {
+class PartDocument : private NameObserver {
 public:
     PartDocument(const std::string& name = "Document");
-    ~PartDocument() = default;
+    ~PartDocument() override;
+    // Its objects hold on to the document for renames
+    PartDocument(const PartDocument&) = delete;
+    PartDocument& operator=(const PartDocument&) = delete;
     
     // Document management
     const std::string& getName() const { return m_name; }
@@ -114,18 +162,28 @@ public:
     const std::string& getFilePath() const { return m_filePath; }
     void setFilePath(const std::string& path) { m_filePath = path; }
     
-    // Object management
+    // Object management; each change is recorded for undo
     void addObject(CADObjectPtr object);
+    void insertObject(size_t index, CADObjectPtr object);
     void removeObject(CADObjectPtr object);
     void clearObjects();
+    // Replaces the list without recording anything, for mirroring a scene kept elsewhere
+    void setObjects(const CADObjectList& objects);
     
     const CADObjectList& getObjects() const { return m_objects; }
+    // Hash lookup; the first in list order when several objects share the name
     CADObjectPtr findObject(const std::string& name) const;
+    // baseName if no object has it, otherwise baseName_N. N resumes after the last one handed
+    // out, so naming many objects from one base stays linear.
+    std::string generateUniqueName(const std::string& baseName);
     
-    // History and undo/redo
+    // History and undo/redo. Edits are made first and then recorded with addUndoCommand();
+    // commands added inside a group are undone together.
     void beginUndoGroup(const std::string& description);
     void endUndoGroup();
-    void addUndoCommand(const std::string& description);
+    void addUndoCommand(UndoCommandPtr command);
+    // Mesh state for a MeshSnapshotCommand, sharing unchanged arrays with earlier history states
+    std::shared_ptr<const MeshSnapshot> snapshotMesh(const MeshObject& mesh) { return m_history.snapshotMesh(mesh); }
     
     bool canUndo() const;
     bool canRedo() const;
@@ -133,9 +191,19 @@ public:
     void redo();
     void clearHistory();
     
+    // The oldest edits are forgotten beyond either limit
+    void setMaxUndoLevels(size_t levels) { m_history.setMaxCommands(levels); }
+    void setUndoMemoryBudget(size_t bytes) { m_history.setMemoryBudget(bytes); }
+    const UndoHistory& getHistory() const { return m_history; }
+    UndoHistory& getHistory() { return m_history; }
+    
     // Feature tree
     CADObjectPtr getRootObject() const { return m_rootObject; }
     void setRootObject(CADObjectPtr root) { m_rootObject = root; }
+    
+    // Chunk layout of the file last opened or saved, so the next save can skip unchanged chunks
+    std::shared_ptr<DocumentStorage> getStorage() const { return m_storage; }
+    void setStorage(std::shared_ptr<DocumentStorage> storage) { m_storage = std::move(storage); }
 
 private:
     std::string m_name;
@@ -145,15 +213,15 @@ private:
     CADObjectList m_objects;
     CADObjectPtr m_rootObject;
     
-    // Undo/Redo system
-    struct UndoCommand {
-        std::string description;
-        // Store the state or operations needed to undo
-    };
+    // Objects by name, re-keyed as each of them is renamed
+    void indexObject(const CADObjectPtr& object);
+    void unindexObject(const CADObjectPtr& object);
+    void objectRenamed(CADObject* object, const std::string& oldName) override;
+    std::unordered_multimap<std::string, CADObjectPtr> m_nameIndex;
+    std::unordered_map<std::string, int> m_nameCounters;
     
-    std::vector<UndoCommand> m_undoStack;
-    std::vector<UndoCommand> m_redoStack;
-    int m_maxUndoLevels;
+    UndoHistory m_history;
+    std::shared_ptr<DocumentStorage> m_storage;
 };
 
 // Part manager class
@@ -174,20 +242,32 @@ public:
     
     const std::vector<std::shared_ptr<PartDocument>>& getDocuments() const { return m_documents; }
     
+    void setSaveOptions(const DocumentIO::SaveOptions& options) { m_saveOptions = options; }
+    const DocumentIO::SaveOptions& getSaveOptions() const { return m_saveOptions; }
+    
     // Assembly management
     std::shared_ptr<Assembly> createAssembly(const std::string& name = "Assembly");
     
-    // Part library management
+    // Part library management. Once a library directory is opened, parts added are written to
+    // it and parts are read from it only when first asked for.
+    bool openLibrary(const std::string& directory);
     void addToLibrary(CADObjectPtr part, const std::string& category = "General");
     void removeFromLibrary(const std::string& name);
-    CADObjectPtr getFromLibrary(const std::string& name) const;
+    CADObjectPtr getFromLibrary(const std::string& name);
+    PartLibrary& getLibrary() { return m_library; }
     
     std::vector<std::string> getLibraryCategories() const;
     std::vector<std::string> getLibraryParts(const std::string& category) const;
     
+    // Library thumbnails come from a disk cache and are rendered in the background when missing;
+    // connect to getThumbnailRenderer()->thumbnailReady() to hear when one arrives
+    std::string getLibraryThumbnail(const std::string& name);
+    void requestLibraryThumbnails(const std::string& category);
+    ThumbnailRenderer* getThumbnailRenderer();
+    
     // Template management
     void saveAsTemplate(CADObjectPtr object, const std::string& name, const std::string& category = "General");
-    CADObjectPtr createFromTemplate(const std::string& name) const;
+    CADObjectPtr createFromTemplate(const std::string& name);
     
     // Import/Export
     bool importSTEP(const std::string& filePath, std::shared_ptr<PartDocument> document);
@@ -196,28 +276,20 @@ public:
     bool exportIGES(const std::string& filePath, std::shared_ptr<PartDocument> document);
     
     // Utility functions
-    void generateThumbnail(CADObjectPtr object, const std::string& imagePath);
+    // Renders through the thumbnail cache and copies the result to imagePath
+    bool generateThumbnail(CADObjectPtr object, const std::string& imagePath);
     void optimizeForPerformance(CADObjectPtr object);
     void validateGeometry(CADObjectPtr object, std::vector<std::string>& issues);
 
 private:
     std::vector<std::shared_ptr<PartDocument>> m_documents;
     std::shared_ptr<PartDocument> m_activeDocument;
+    DocumentIO::SaveOptions m_saveOptions;
     
-    // Part library
-    struct LibraryEntry {
-        CADObjectPtr part;
-        std::string name;
-        std::string category;
-        std::string description;
-        std::string thumbnailPath;
-    };
-    
-    std::vector<LibraryEntry> m_libraryParts;
-    std::unordered_map<std::string, std::vector<std::string>> m_libraryCategories;
-    
-    // Templates
-    std::vector<LibraryEntry> m_templates;
+    PartLibrary m_library;
+    PartLibrary m_templates;
+    // Created on first use, on the GUI thread
+    std::unique_ptr<ThumbnailRenderer> m_thumbnailRenderer;
     
     // Helper methods
     bool loadFromFile(const std::string& filePath, std::shared_ptr<PartDocument> document);
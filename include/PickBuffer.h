@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
+#include <QRect>
+#include <QSize>
+#include <QVector4D>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace HybridCAD {
+
+// Offscreen ID target for pixel-exact picking. Color attachment 0 holds an object ID and
+// attachment 1 a primitive ID, each a 24-bit integer packed into RGB8 with 0 meaning empty.
+// Reads go through a pixel pack buffer. Every call must be made with the owning context current.
+class PickBuffer {
+public:
+    static constexpr int OBJECT_ATTACHMENT = 0;
+    static constexpr int PRIMITIVE_ATTACHMENT = 1;
+    static constexpr uint32_t MAX_ID = 0xFFFFFF;
+
+    PickBuffer();
+    ~PickBuffer();
+
+    void initialize(QOpenGLExtraFunctions* gl);
+    void destroy();
+
+    // Reallocates the attachments when the size changes; contents are lost
+    bool resize(const QSize& size);
+    bool isValid() const;
+    QSize size() const;
+
+    // Binds the target with both attachments drawable and the viewport covering it
+    void bind();
+    void clear();
+    // Rebinds the framebuffer that was current before bind()
+    void release(GLuint framebuffer);
+
+    // Set after the IDs are rendered, cleared whenever the scene or camera may have changed
+    bool isCurrent() const { return m_current; }
+    void setCurrent(bool current) { m_current = current; }
+
+    // IDs under a rectangle in framebuffer pixels with a top-left origin, clipped to the target.
+    // Row-major from the top row; the target must be bound.
+    bool readIds(int attachment, const QRect& rect, std::vector<uint32_t>& ids);
+
+    // Color carrying an ID through an RGBA8 attachment
+    static QVector4D encodeId(uint32_t id);
+    static uint32_t decodeId(const unsigned char* rgba) {
+        return uint32_t(rgba[0]) | (uint32_t(rgba[1]) << 8) | (uint32_t(rgba[2]) << 16);
+    }
+
+private:
+    QOpenGLExtraFunctions* m_gl;
+    std::unique_ptr<QOpenGLFramebufferObject> m_fbo;
+    QOpenGLBuffer m_packBuffer{QOpenGLBuffer::PixelPackBuffer};
+    bool m_current;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QObject>
+#include <QtCore/QTimer>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CADTypes.h"
+#include "UndoHistory.h"
+
+namespace HybridCAD {
+
+// What applied edits touched, so listeners refresh only that
+enum PropertyChange {
+    PROPERTY_NAME = 1 << 0,
+    PROPERTY_VISIBILITY = 1 << 1,
+    PROPERTY_MATERIAL = 1 << 2,
+    PROPERTY_GEOMETRY = 1 << 3
+};
+
+// Coalesces property edits while a value is being dragged. Edits are staged per object and
+// property, a later value replacing one not yet applied; once a frame the survivors are applied
+// together and announced with a single objectsChanged(). The value each property had before the
+// gesture is kept until it ends (commit(), or a pause in editing), and the gesture is then
+// recorded as one undo step.
+class PropertyEditBatch : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FRAME_INTERVAL_MS = 16;
+    static constexpr int COMMIT_IDLE_MS = 500;
+
+    explicit PropertyEditBatch(QObject* parent = nullptr);
+
+    // Stages value for the property key of object; change is the PropertyChange it causes.
+    // getter and setter must only touch the object they are given.
+    template <typename Object, typename T>
+    void stage(const std::shared_ptr<Object>& object, int key, int change, const std::string& description,
+               std::function<T(const Object&)> getter, std::function<void(Object&, const T&)> setter, T value);
+
+    // Applies the staged edits now
+    void flush();
+    // Applies the staged edits and records the gesture so far as one undo step
+    void commit();
+
+    bool hasPending() const { return !m_pending.empty(); }
+    bool inGesture() const { return !m_gesture.empty(); }
+
+    // Receives each finished gesture; without one, gestures are not recorded
+    void setRecorder(std::function<void(UndoCommandPtr)> recorder) { m_recorder = std::move(recorder); }
+
+signals:
+    // Once per flush, listing every object an applied edit touched; changes ORs PropertyChange flags
+    void objectsChanged(const std::vector<CADObjectPtr>& objects, int changes);
+
+private:
+    using EditKey = std::pair<const CADObject*, int>;
+
+    struct Edit {
+        CADObjectPtr object;
+        int change = 0;
+        std::function<void()> apply;
+    };
+
+    void stageEdit(const EditKey& key, Edit edit);
+
+    // Staged values in staging order; the map finds an object's earlier edit of the same property
+    std::vector<Edit> m_pending;
+    std::map<EditKey, size_t> m_pendingIndex;
+    // Per property touched in the open gesture: builds the command from its first value to its current one
+    std::map<EditKey, std::function<UndoCommandPtr()>> m_gesture;
+    std::vector<EditKey> m_gestureOrder;
+
+    std::function<void(UndoCommandPtr)> m_recorder;
+    QTimer* m_frameTimer;
+    QTimer* m_idleTimer;
+};
+
+template <typename Object, typename T>
+void PropertyEditBatch::stage(const std::shared_ptr<Object>& object, int key, int change, const std::string& description,
+                              std::function<T(const Object&)> getter, std::function<void(Object&, const T&)> setter, T value) {
+    if (!object) return;
+
+    const EditKey editKey(object.get(), key);
+    std::weak_ptr<Object> weak = object;
+    auto set = [weak, setter](const T& newValue) {
+        if (auto target = weak.lock()) setter(*target, newValue);
+    };
+
+    if (m_gesture.find(editKey) == m_gesture.end()) {
+        // Read before anything of the gesture is applied; paired with the final value at commit
+        m_gesture.emplace(editKey, [weak, getter, set, description, before = getter(*object)]() -> UndoCommandPtr {
+            auto target = weak.lock();
+            if (!target) return nullptr;
+            return std::make_unique<ValueCommand<T>>(description, set, before, getter(*target));
+        });
+        m_gestureOrder.push_back(editKey);
+    }
+
+    Edit edit;
+    edit.object = object;
+    edit.change = change;
+    edit.apply = [set, value = std::move(value)]() { set(value); };
+    stageEdit(editKey, std::move(edit));
+}
+
+} // namespace HybridCAD
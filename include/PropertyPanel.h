@@ -15,11 +15,18 @@
 #include <QColorDialog>
 #include <QScrollArea>
 #include <memory>
+#include <vector>
 
 #include "CADTypes.h"
 
 namespace HybridCAD {
 
+class PartDocument;
+class PropertyEditBatch;
+
+// Properties of the selection. The first selected object's values are shown; edits apply to
+// every selected object they fit and reach the objects through a PropertyEditBatch, at most
+// once a frame.
 class PropertyPanel : public QWidget
 {
     Q_OBJECT
@@ -29,12 +36,20 @@ public:
     ~PropertyPanel();
     
     void setSelectedObject(CADObjectPtr object);
+    void setSelectedObjects(const std::vector<CADObjectPtr>& objects);
     void clearSelection();
     void updateProperties();
+    // Shows new values if the displayed object is among objects, unless an edit here is under way
+    void refreshObjects(const std::vector<CADObjectPtr>& objects);
+    PropertyEditBatch* getEditBatch() const { return m_editBatch; }
+    // Renames are kept unique among the document's objects
+    void setDocument(PartDocument* document) { m_document = document; }
 
 signals:
     void propertyChanged();
     void objectModified(CADObjectPtr object);
+    // Once per applied batch of edits; changes ORs PropertyChange flags
+    void objectsChanged(const std::vector<CADObjectPtr>& objects, int changes);
 
 private slots:
     void onNameChanged();
@@ -45,6 +60,8 @@ private slots:
     void onColorChanged();
     void onApplyChanges();
     void onResetChanges();
+    void onEditFinished();
+    void onEditsApplied(const std::vector<CADObjectPtr>& objects, int changes);
 
 private:
     void setupUI();
@@ -94,6 +111,11 @@ private:
     QWidget* m_geometryWidget;
     QVBoxLayout* m_geometryLayout;
     
+    QWidget* m_boxWidget;
+    QWidget* m_cylinderWidget;
+    QWidget* m_sphereWidget;
+    QWidget* m_coneWidget;
+    
     // Box-specific properties
     QDoubleSpinBox* m_boxMinXSpin;
     QDoubleSpinBox* m_boxMinYSpin;
@@ -122,8 +144,11 @@ private:
     QPushButton* m_applyButton;
     QPushButton* m_resetButton;
     
-    // Current object
+    // Selection, the first of which is shown
+    std::vector<CADObjectPtr> m_objects;
     CADObjectPtr m_currentObject;
+    PropertyEditBatch* m_editBatch;
+    PartDocument* m_document;
     bool m_updating;
     
     // Helper methods
@@ -139,6 +164,11 @@ private:
     
     void setSpinBoxValue(QDoubleSpinBox* spinBox, double value);
     void setIntSpinBoxValue(QSpinBox* spinBox, int value);
+    // Selected objects of the displayed object's type
+    template <typename Object>
+    std::vector<std::shared_ptr<Object>> selectedLikeCurrent() const;
+    std::vector<QDoubleSpinBox*> geometrySpinBoxes() const;
+    std::vector<QSpinBox*> segmentSpinBoxes() const;
 };
 
 } // namespace HybridCAD 
\ No newline at end of file
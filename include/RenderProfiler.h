@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QOpenGLTimeMonitor>
+#include <QString>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace HybridCAD {
+
+// Per-frame CPU and GPU timings of the viewport's render passes plus draw counters.
+// GPU times come from timestamp queries that are read back a few frames late so the
+// pipeline never stalls; frames whose queries are still in flight report gpuMs < 0.
+class RenderProfiler {
+public:
+    struct Counters {
+        int drawCalls = 0;
+        int64_t triangles = 0;
+        int stateChanges = 0;
+        int shaderBinds = 0;
+        // Scene objects submitted and rejected by the object pass
+        int objectsDrawn = 0;
+        int frustumCulled = 0;
+        int sizeCulled = 0;
+    };
+
+    struct Pass {
+        const char* name;
+        // Offset from the start of the frame
+        double cpuStartMs;
+        double cpuMs;
+        double gpuStartMs = -1.0;
+        double gpuMs = -1.0;
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        double startMs = 0.0;
+        double cpuMs = 0.0;
+        double gpuMs = -1.0;
+        std::vector<Pass> passes;
+        Counters counters;
+    };
+
+    // Times one pass for the lifetime of the scope; profiler may be null
+    class Scope {
+    public:
+        Scope(RenderProfiler* profiler, const char* name) : m_profiler(profiler) {
+            if (m_profiler) m_profiler->beginPass(name);
+        }
+        ~Scope() {
+            if (m_profiler) m_profiler->endPass();
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        RenderProfiler* m_profiler;
+    };
+
+    RenderProfiler();
+    ~RenderProfiler();
+
+    // Query objects need the owning context current for create and destroy
+    void initialize();
+    void destroy();
+
+    // Nothing is recorded while disabled; counters and scopes cost a branch
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    void beginFrame();
+    void endFrame();
+
+    // Passes must not nest
+    void beginPass(const char* name);
+    void endPass();
+
+    // Line and immediate-mode draws pass zero triangles
+    void countDraw(int64_t triangles, int instances = 1) {
+        if (!m_enabled) return;
+        ++m_current.counters.drawCalls;
+        m_current.counters.triangles += triangles * instances;
+    }
+    void countStateChange(int changes = 1) {
+        if (m_enabled) m_current.counters.stateChanges += changes;
+    }
+    void countShaderBind() {
+        if (m_enabled) ++m_current.counters.shaderBinds;
+    }
+    void countObjects(int drawn, int frustumCulled, int sizeCulled) {
+        if (!m_enabled) return;
+        m_current.counters.objectsDrawn += drawn;
+        m_current.counters.frustumCulled += frustumCulled;
+        m_current.counters.sizeCulled += sizeCulled;
+    }
+
+    // Oldest first; at most HISTORY_FRAMES entries
+    const std::deque<Frame>& history() const { return m_history; }
+    // Most recent frame with GPU results, or the most recent frame if none resolved yet
+    const Frame* latestFrame() const;
+    // Mean frame interval over the recent history
+    double averageFrameIntervalMs() const;
+    void clearHistory();
+
+    // One row per pass per frame, plus a "frame" row carrying totals and counters
+    bool exportCsv(const QString& filename) const;
+    // Trace Event Format, loadable in chrome://tracing or Perfetto; CPU and GPU passes
+    // appear as separate threads and counters as counter tracks
+    bool exportChromeTrace(const QString& filename) const;
+
+    static constexpr int MAX_PASSES = 16;
+    static constexpr size_t HISTORY_FRAMES = 600;
+    // Query sets in flight at once; a frame starting while all are pending gets no GPU times
+    static constexpr int GPU_QUERY_FRAMES = 4;
+
+private:
+    struct GpuQuerySet {
+        std::unique_ptr<QOpenGLTimeMonitor> monitor;
+        uint64_t frameIndex = 0;
+        // Sample indices of each pass's begin and end, -1 when the pass was not sampled
+        std::array<int, MAX_PASSES * 2> samples;
+        bool inFlight = false;
+    };
+
+    double nowMs() const;
+    void resolveGpuQueries();
+    Frame* findFrame(uint64_t index);
+
+    bool m_enabled;
+    bool m_initialized;
+    bool m_inFrame;
+    int m_openPass;
+    uint64_t m_nextFrameIndex;
+    std::chrono::steady_clock::time_point m_epoch;
+
+    Frame m_current;
+    std::deque<Frame> m_history;
+
+    std::array<GpuQuerySet, GPU_QUERY_FRAMES> m_querySets;
+    GpuQuerySet* m_activeQuerySet;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QIcon>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CADTypes.h"
+
+namespace HybridCAD {
+
+// Item model over a scene's object list. Rows are created only when a view asks for them:
+// top-level objects are handed out a batch at a time as the view scrolls, and the parts of an
+// assembly or the operands of a boolean only once it is expanded. Changes arrive as lists and
+// are reported as one notification per contiguous run of rows.
+class SceneTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        NAME_COLUMN = 0,
+        TYPE_COLUMN = 1,
+        VISIBILITY_COLUMN = 2,
+        COLUMN_COUNT = 3
+    };
+
+    // Top-level rows handed to the view per fetch
+    static constexpr int FETCH_BATCH = 1000;
+
+    explicit SceneTreeModel(QObject* parent = nullptr);
+    ~SceneTreeModel() override;
+
+    void setObjects(const CADObjectList& objects);
+    void appendObjects(const CADObjectList& objects);
+    void removeObjects(const std::vector<CADObjectPtr>& objects);
+    void clear();
+    // Refreshes the rows of objects whose name, visibility, parts or operands changed; without
+    // childrenChanged the expanded rows below them are kept
+    void updateObjects(const std::vector<CADObjectPtr>& objects, bool childrenChanged = true);
+    void refreshAll();
+
+    const CADObjectList& getObjects() const { return m_objects; }
+    CADObjectPtr objectAt(const QModelIndex& index) const;
+    // Top-level objects only; fetches rows up to the object's if the view has not yet
+    QModelIndex indexOf(const CADObject* object, int column = NAME_COLUMN);
+
+    static QString getObjectTypeName(ObjectType type);
+    static QIcon getObjectTypeIcon(ObjectType type);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+signals:
+    void objectRenamed(CADObjectPtr object, const QString& newName);
+
+private:
+    struct Node;
+
+    Node* nodeFor(const QModelIndex& index) const;
+    QModelIndex indexFor(const Node* node, int column) const;
+    void fetchTopLevel(size_t count);
+    void fetchChildren(Node* node);
+    void resetChildren(Node* node);
+    // Emits dataChanged once per run of consecutive rows
+    void emitRowRuns(std::vector<int>& rows);
+    const std::unordered_map<const CADObject*, int>& topLevelRows() const;
+
+    std::unique_ptr<Node> m_root;
+    // Every top-level object; the root's children cover a prefix of it
+    CADObjectList m_objects;
+    // Row of each top-level object, rebuilt after removals
+    mutable std::unordered_map<const CADObject*, int> m_rows;
+    mutable bool m_rowsValid;
+};
+
+} // namespace HybridCAD
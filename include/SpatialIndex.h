@@ -0,0 +1,220 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector4D>
+#include <array>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "CADTypes.h"
+
+namespace HybridCAD {
+
+// Axis-aligned bounding box
+struct AABB {
+    QVector3D min;
+    QVector3D max;
+
+    AABB() : min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()),
+             max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()) {}
+    AABB(const QVector3D& minPoint, const QVector3D& maxPoint) : min(minPoint), max(maxPoint) {}
+
+    bool isValid() const { return min.x() <= max.x() && min.y() <= max.y() && min.z() <= max.z(); }
+    QVector3D center() const { return (min + max) * 0.5f; }
+    QVector3D extent() const { return max - min; }
+
+    void expand(const QVector3D& point);
+    void merge(const AABB& other);
+    static AABB merged(const AABB& a, const AABB& b);
+
+    bool contains(const AABB& other) const;
+    bool overlaps(const AABB& other) const;
+    float surfaceArea() const;
+    float distanceSquaredTo(const QVector3D& point) const;
+
+    // Slab test; invDirection is the component-wise reciprocal of the ray direction
+    bool intersectsRay(const QVector3D& origin, const QVector3D& invDirection, float maxDistance, float& entryDistance) const;
+};
+
+// Six clip planes of a view-projection matrix, normals pointing inwards
+struct Frustum {
+    std::array<QVector4D, 6> planes;
+
+    static Frustum fromMatrix(const QMatrix4x4& viewProjection);
+
+    // Conservative: boxes near a frustum corner may pass without being visible
+    bool intersects(const AABB& box) const;
+};
+
+// Incrementally updated tree of object bounds (scene level). Leaves store enlarged boxes so
+// small geometry edits do not force a re-insert.
+class DynamicAABBTree {
+public:
+    static constexpr int NULL_NODE = -1;
+
+    // Receives a leaf's object and the distance the ray enters its box; returns the new max distance
+    using RayVisitor = std::function<float(const CADObject* object, float entryDistance)>;
+    using ObjectVisitor = std::function<void(const CADObject* object)>;
+
+    DynamicAABBTree();
+
+    int insert(const AABB& box, const CADObject* object);
+    void remove(int proxy);
+    // Returns true if the leaf had to be re-inserted
+    bool update(int proxy, const AABB& box);
+    void clear();
+
+    const CADObject* getObject(int proxy) const { return m_nodes[proxy].object; }
+    const AABB& getFatBox(int proxy) const { return m_nodes[proxy].box; }
+    int getHeight() const { return m_root == NULL_NODE ? 0 : m_nodes[m_root].height; }
+
+    void raycast(const QVector3D& origin, const QVector3D& direction, float maxDistance, const RayVisitor& visitor) const;
+    void querySphere(const QVector3D& center, float radius, const ObjectVisitor& visitor) const;
+    void queryBox(const AABB& box, const ObjectVisitor& visitor) const;
+
+private:
+    struct Node {
+        AABB box;
+        const CADObject* object = nullptr;
+        int parent = NULL_NODE; // Next free node while on the free list
+        int left = NULL_NODE;
+        int right = NULL_NODE;
+        int height = -1;        // -1 for free nodes, 0 for leaves
+
+        bool isLeaf() const { return left == NULL_NODE; }
+    };
+
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int node);
+    void refitUpwards(int node);
+
+    std::vector<Node> m_nodes;
+    int m_root;
+    int m_freeList;
+};
+
+// Immutable BVH over a fixed set of primitive bounds (centroid median split)
+class StaticBVH {
+public:
+    struct Node {
+        AABB box;
+        int start = 0;  // First entry in primitives() for leaves
+        int count = 0;  // Zero for interior nodes
+        int right = 0;  // Left child is always the next node
+    };
+
+    static constexpr int LEAF_SIZE = 4;
+
+    void build(const std::vector<AABB>& bounds);
+    void clear();
+
+    bool isEmpty() const { return m_nodes.empty(); }
+    const std::vector<Node>& nodes() const { return m_nodes; }
+    const std::vector<int>& primitives() const { return m_primitives; }
+
+private:
+    int buildNode(const std::vector<AABB>& bounds, const std::vector<QVector3D>& centroids, int start, int count);
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_primitives;
+};
+
+// Acceleration structure for one object's tessellation: triangles for ray hits, welded
+// vertices and feature edges (creases and boundaries, not triangulation diagonals) for snapping
+class MeshBVH {
+public:
+    struct RayHit {
+        float distance = 0.0f;
+        QVector3D point;
+        QVector3D normal;
+    };
+
+    void build(const RenderMesh& mesh);
+    void buildFromPoints(const std::vector<QVector3D>& points);
+    void clear();
+
+    bool isEmpty() const { return m_positions.empty(); }
+    bool hasTriangles() const { return !m_triangles.empty(); }
+    const AABB& getBounds() const { return m_bounds; }
+
+    bool raycast(const QVector3D& origin, const QVector3D& direction, float maxDistance, RayHit& hit) const;
+    bool nearestVertex(const QVector3D& point, float maxDistance, QVector3D& vertex) const;
+    bool nearestEdgePoint(const QVector3D& point, float maxDistance, QVector3D& edgePoint) const;
+
+private:
+    void extractFeatureEdges();
+    void buildTrees();
+
+    std::vector<QVector3D> m_positions;
+    std::vector<unsigned int> m_triangles;
+    std::vector<std::pair<unsigned int, unsigned int>> m_edges;
+    StaticBVH m_triangleTree;
+    StaticBVH m_vertexTree;
+    StaticBVH m_edgeTree;
+    AABB m_bounds;
+};
+
+// Scene-level index used by the viewer for picking, snapping and transparency. Object bounds
+// live in a DynamicAABBTree; each object's MeshBVH and its containment links are rebuilt when
+// the object is reported edited and its geometry revision has changed.
+class SceneSpatialIndex {
+public:
+    void addObject(const CADObjectPtr& object);
+    void removeObject(const CADObject* object);
+    // Queues an edited object for the next refresh(); objects built from it have to be queued too
+    void updateObject(const CADObject* object);
+    void clear();
+
+    // Re-indexes the queued objects whose geometry revision moved, and primitives whose
+    // tessellation was still pending; untouched objects cost nothing
+    void refresh();
+
+    size_t size() const { return m_entries.size(); }
+
+    // Closest object hit by the ray; hitPoint is on the tessellated surface when one exists
+    CADObjectPtr raycast(const QVector3D& origin, const QVector3D& direction, float& distance,
+                         QVector3D* hitPoint = nullptr);
+    bool nearestVertex(const QVector3D& point, float maxDistance, QVector3D& vertex);
+    bool nearestEdgePoint(const QVector3D& point, float maxDistance, QVector3D& edgePoint);
+    bool nearestCenter(const QVector3D& point, float maxDistance, QVector3D& center);
+
+    // True if the reported bounds of some other visible object lie inside this object's bounds.
+    // Reflects the last refresh().
+    bool containsVisibleObject(const CADObject* object) const;
+
+    // Cached world bounds of an indexed object, covering its tessellation. Reflects the last refresh().
+    bool getBounds(const CADObject* object, AABB& bounds) const;
+
+private:
+    struct Entry {
+        CADObjectPtr object;
+        int proxy = DynamicAABBTree::NULL_NODE;
+        uint64_t revision = 0;
+        MeshBVH mesh;
+        AABB worldBounds;
+        // Reported bounds, which containment is defined on
+        AABB bounds;
+        // Objects whose bounds lie inside this one's, and those whose bounds hold this one
+        std::vector<const CADObject*> contains;
+        std::vector<const CADObject*> containedBy;
+    };
+
+    void rebuildEntry(Entry& entry);
+    void linkContainment(Entry& entry);
+    void unlinkContainment(Entry& entry);
+    const Entry* findEntry(const CADObject* object) const;
+
+    DynamicAABBTree m_tree;
+    std::unordered_map<const CADObject*, Entry> m_entries;
+    std::unordered_set<const CADObject*> m_dirty;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "CADTypes.h"
+
+namespace HybridCAD {
+
+// Finished tessellations are immutable and shared by every primitive with the same parameters
+using RenderMeshSnapshot = std::shared_ptr<const RenderMesh>;
+
+// Canonical primitive parameters; equal keys tessellate to identical meshes
+struct TessellationKey {
+    ObjectType type = ObjectType::PRIMITIVE_BOX;
+    std::array<float, 7> values{};
+    int segments = 0;
+
+    bool operator==(const TessellationKey& other) const {
+        return type == other.type && values == other.values && segments == other.segments;
+    }
+    bool operator!=(const TessellationKey& other) const { return !(*this == other); }
+};
+
+struct TessellationKeyHash {
+    size_t operator()(const TessellationKey& key) const;
+};
+
+struct TessellationJob;
+
+// Interest in one background tessellation. Dropping the last ticket for a job that has not
+// started yet cancels it.
+class TessellationTicket {
+public:
+    TessellationTicket() = default;
+    TessellationTicket(TessellationTicket&& other) noexcept;
+    TessellationTicket& operator=(TessellationTicket&& other) noexcept;
+    TessellationTicket(const TessellationTicket&) = delete;
+    TessellationTicket& operator=(const TessellationTicket&) = delete;
+    ~TessellationTicket();
+
+    bool valid() const { return m_job || m_ready; }
+    bool ready() const;
+    // Null for a job that was cancelled; only call once ready()
+    RenderMeshSnapshot get() const;
+    void reset();
+
+private:
+    friend class Tessellator;
+
+    std::shared_ptr<TessellationJob> m_job;
+    // Set instead of a job when the mesh was already shared
+    RenderMeshSnapshot m_ready;
+};
+
+// Builds primitive tessellations on the thread pool. Requests for the same key share one job,
+// and finished meshes are tracked weakly so identical primitives alive at the same time share
+// a single copy. The most recently used meshes are also kept alive up to a memory budget, so
+// parameters that come back (undo, duplicated sizes) skip the rebuild.
+class Tessellator {
+public:
+    static Tessellator& instance();
+
+    // Queues a background build unless the mesh is already shared or being built
+    TessellationTicket request(const TessellationKey& key);
+    // Blocking variant for callers that need the mesh now; reuses a shared copy when one exists
+    RenderMeshSnapshot tessellate(const TessellationKey& key);
+
+    size_t pendingCount() const;
+    size_t sharedCount() const;
+
+    // Bytes of vertex and index data the recently used list may hold; 0 disables it
+    void setMemoryBudget(size_t bytes);
+    size_t memoryBudget() const;
+    size_t cachedBytes() const;
+
+    static size_t meshBytes(const RenderMesh& mesh);
+
+private:
+    Tessellator() = default;
+
+    void run(const std::shared_ptr<TessellationJob>& job);
+    RenderMeshSnapshot findShared(const TessellationKey& key);
+    void publish(const TessellationKey& key, const RenderMeshSnapshot& mesh);
+    void touch(const TessellationKey& key, const RenderMeshSnapshot& mesh);
+    void evict();
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<TessellationKey, std::weak_ptr<const RenderMesh>, TessellationKeyHash> m_shared;
+    std::unordered_map<TessellationKey, std::shared_ptr<TessellationJob>, TessellationKeyHash> m_pending;
+    size_t m_publishedSinceSweep = 0;
+
+    // Strong references in use order, front most recent
+    using RecentList = std::list<std::pair<TessellationKey, RenderMeshSnapshot>>;
+    RecentList m_recent;
+    std::unordered_map<TessellationKey, RecentList::iterator, TessellationKeyHash> m_recentIndex;
+    size_t m_recentBytes = 0;
+    size_t m_budgetBytes = DEFAULT_MEMORY_BUDGET;
+
+    // Expired shared entries are swept after this many publications
+    static constexpr size_t SWEEP_INTERVAL = 256;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace HybridCAD {
+
+// Fixed-size worker pool shared by the data-parallel mesh and I/O code
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool sized to the hardware
+    static ThreadPool& instance();
+
+    size_t threadCount() const { return m_workers.size(); }
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())>;
+
+    // Runs body(chunkBegin, chunkEnd) over [begin, end) in chunks of at least grainSize items.
+    // The calling thread takes part, so nested calls from inside a task cannot deadlock.
+    // The first exception thrown by a chunk is rethrown here.
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t grainSize, F&& body);
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stopping;
+};
+
+template <typename F>
+auto ThreadPool::submit(F&& task) -> std::future<decltype(task())> {
+    using Result = decltype(task());
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+    std::future<Result> future = packaged->get_future();
+    enqueue([packaged]() { (*packaged)(); });
+    return future;
+}
+
+template <typename F>
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grainSize, F&& body) {
+    if (begin >= end) return;
+
+    const size_t count = end - begin;
+    grainSize = std::max<size_t>(grainSize, 1);
+    // A few chunks per thread keeps the load balanced when chunk costs differ
+    const size_t maxChunks = std::max<size_t>(threadCount() * 4, 1);
+    const size_t chunkCount = std::min(maxChunks, (count + grainSize - 1) / grainSize);
+
+    if (chunkCount <= 1 || threadCount() == 0) {
+        body(begin, end);
+        return;
+    }
+
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+    struct State {
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> finishedChunks{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that start after every chunk is claimed return without touching body
+    auto runChunks = [state, &body, begin, end, chunkSize, chunkCount]() {
+        for (;;) {
+            size_t chunk = state->nextChunk.fetch_add(1);
+            if (chunk >= chunkCount) return;
+
+            size_t chunkBegin = begin + chunk * chunkSize;
+            size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+            try {
+                body(chunkBegin, chunkEnd);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) state->error = std::current_exception();
+            }
+
+            if (state->finishedChunks.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(threadCount(), chunkCount - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->finishedChunks.load() == chunkCount; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+} // namespace HybridCAD
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QObject>
+#include <QColor>
+#include <QMatrix4x4>
+#include <QString>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "CADTypes.h"
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QThread;
+
+namespace HybridCAD {
+
+// Renders part thumbnails offscreen, on a GL context and thread of its own, into a disk cache
+// keyed by a hash of what is drawn. A part keeps its file across sessions for as long as its
+// geometry and colors are unchanged, so only new or edited parts are ever rendered.
+class ThumbnailRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Thumbnails are size x size PNGs with a transparent background
+    explicit ThumbnailRenderer(const QString& cacheDirectory, int size = 128, QObject* parent = nullptr);
+    ~ThumbnailRenderer() override;
+
+    // False when no offscreen GL context could be created; nothing is rendered then
+    bool isAvailable() const { return m_thread != nullptr; }
+    const QString& getCacheDirectory() const { return m_cacheDirectory; }
+    int getSize() const { return m_size; }
+
+    // The part's cached thumbnail, or empty with a render queued and thumbnailReady() to follow
+    QString request(const CADObjectPtr& part);
+    // Queues all parts that need it under one lock, so a category renders as one batch
+    void requestBatch(const std::vector<CADObjectPtr>& parts);
+    // Blocks until the part's thumbnail is on disk; empty on failure
+    QString render(const CADObjectPtr& part);
+
+signals:
+    // Emitted from the render thread, so connections to GUI objects are queued
+    void thumbnailReady(const HybridCAD::CADObject* part, const QString& filePath);
+
+private:
+    // A part flattened into meshes placed by transform, captured on the calling thread
+    struct Piece {
+        std::shared_ptr<const RenderMesh> mesh;
+        std::vector<QMatrix4x4> transforms;
+        std::vector<QColor> colors;
+    };
+
+    struct Job {
+        const CADObject* part = nullptr;
+        std::vector<Piece> pieces;
+        // Hashed from the pieces on the render thread; read under the mutex once done
+        QString filePath;
+        bool done = false;
+        bool success = false;
+    };
+
+    // Last file per object, so unchanged ones are not flattened again; the job until it is done
+    struct CachedKey {
+        uint64_t revision = 0;
+        QRgb color = 0;
+        QString filePath;
+        std::shared_ptr<Job> job;
+    };
+
+    class Painter;
+
+    // Null when the thumbnail is on disk; otherwise the part's job, with queued set when it is
+    // already on its way and must not be queued again
+    std::shared_ptr<Job> prepare(const CADObjectPtr& part, QString& filePath, bool& queued);
+    // Cache file for exactly what the pieces draw
+    QString cacheFilePath(const std::vector<Piece>& pieces) const;
+    void run();
+
+    QString m_cacheDirectory;
+    int m_size;
+    std::unordered_map<const CADObject*, CachedKey> m_keys;
+
+    QOffscreenSurface* m_surface;
+    QOpenGLContext* m_context;
+    QThread* m_thread;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    std::deque<std::shared_ptr<Job>> m_queue;
+    bool m_stopping;
+};
+
+} // namespace HybridCAD
@@ -1,8 +1,8 @@
 #pragma once
 
 #include <QWidget>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QTreeView>
+#include <QItemSelection>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
@@ -10,12 +10,17 @@
 #include <QAction>
 #include <QtCore/QTimer>
 #include <memory>
-#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "CADTypes.h"
 
 namespace HybridCAD {
 
+class SceneTreeModel;
+
+// Scene outline over a SceneTreeModel. Single additions, removals and updates are collected and
+// applied to the model together once control returns to the event loop.
 class TreeView : public QWidget
 {
     Q_OBJECT
@@ -27,14 +32,21 @@ public:
     void addObject(CADObjectPtr object);
     void removeObject(CADObjectPtr object);
     void updateObject(CADObjectPtr object);
+    // Only the rows' own name and visibility changed, so their children are left alone
+    void refreshObjects(const std::vector<CADObjectPtr>& objects);
     void clearObjects();
     void selectObject(CADObjectPtr object);
     void deselectAll();
+    // Selects all of them with one selection change, as ranges of consecutive rows
+    void setSelectedObjects(const std::vector<CADObjectPtr>& objects);
     
     void setObjects(const CADObjectList& objects);
-    QTreeWidgetItem* findItem(CADObjectPtr object);
+    QModelIndex findIndex(CADObjectPtr object);
+    SceneTreeModel* getModel() const { return m_model; }
 
 signals:
+    // The whole selection after each change, made in the tree
+    void selectionChanged(const std::vector<CADObjectPtr>& objects);
     void objectSelected(CADObjectPtr object);
     void objectDeselected(CADObjectPtr object);
     void objectVisibilityChanged(CADObjectPtr object, bool visible);
@@ -45,9 +57,8 @@ signals:
     void ungroupRequested(CADObjectPtr group);
 
 private slots:
-    void onItemSelectionChanged();
-    void onItemChanged(QTreeWidgetItem* item, int column);
-    void onItemDoubleClicked(QTreeWidgetItem* item, int column);
+    void onSelectionChanged();
+    void onItemDoubleClicked(const QModelIndex& index);
     void onCustomContextMenuRequested(const QPoint& pos);
     void onVisibilityToggled();
     void onRenameRequested();
@@ -58,20 +69,20 @@ private slots:
     void onExpandAll();
     void onCollapseAll();
     void onRefresh();
+    void flushPending();
 
 private:
     void setupUI();
     void createContextMenu();
-    void updateItemIcon(QTreeWidgetItem* item, CADObjectPtr object);
-    void updateItemText(QTreeWidgetItem* item, CADObjectPtr object);
-    void updateItemVisibility(QTreeWidgetItem* item, CADObjectPtr object);
-    
-    QString getObjectTypeName(ObjectType type) const;
-    QIcon getObjectTypeIcon(ObjectType type) const;
+    void schedulePending();
+    // The context menu's row, or the current one
+    QModelIndex actionIndex() const;
+    std::vector<CADObjectPtr> selectedObjects() const;
     
     // UI components
     QVBoxLayout* m_layout;
-    QTreeWidget* m_treeWidget;
+    QTreeView* m_treeView;
+    SceneTreeModel* m_model;
     QHBoxLayout* m_buttonLayout;
     QPushButton* m_expandAllButton;
     QPushButton* m_collapseAllButton;
@@ -86,20 +97,16 @@ private:
     QAction* m_ungroupAction;
     QAction* m_visibilityAction;
     
-    // Object mapping
-    std::unordered_map<CADObjectPtr, QTreeWidgetItem*> m_objectToItem;
-    std::unordered_map<QTreeWidgetItem*, CADObjectPtr> m_itemToObject;
+    // Changes not yet handed to the model
+    CADObjectList m_pendingAdds;
+    std::unordered_set<CADObjectPtr> m_pendingRemoves;
+    std::unordered_set<CADObjectPtr> m_pendingUpdates;
+    std::unordered_set<CADObjectPtr> m_pendingRefreshes;
+    QTimer* m_flushTimer;
     
     // State
     bool m_updating;
-    QTreeWidgetItem* m_contextMenuItem;
-    
-    // Tree columns
-    enum Column {
-        NAME_COLUMN = 0,
-        TYPE_COLUMN = 1,
-        VISIBILITY_COLUMN = 2
-    };
+    QPersistentModelIndex m_contextMenuIndex;
 };
 
 } // namespace HybridCAD 
\ No newline at end of file
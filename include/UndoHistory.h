@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CADTypes.h"
+
+namespace HybridCAD {
+
+class Assembly;
+struct MeshSnapshot;
+
+// One recorded edit. Commands are pushed after the edit is made, so the first redo() only
+// happens after an undo(). Each holds just what it needs to go both ways.
+class UndoCommand {
+public:
+    explicit UndoCommand(const std::string& description) : m_description(description) {}
+    virtual ~UndoCommand() = default;
+
+    virtual void undo() = 0;
+    virtual void redo() = 0;
+
+    // Bytes held by this command; buffers already in counted are shared and left out
+    virtual size_t memoryUsage(std::unordered_set<const void*>& counted) const;
+
+    const std::string& getDescription() const { return m_description; }
+
+private:
+    std::string m_description;
+};
+
+using UndoCommandPtr = std::unique_ptr<UndoCommand>;
+
+// Commands recorded between beginGroup() and endGroup(), undone as one
+class UndoGroup : public UndoCommand {
+public:
+    using UndoCommand::UndoCommand;
+
+    void undo() override;
+    void redo() override;
+    size_t memoryUsage(std::unordered_set<const void*>& counted) const override;
+
+    void add(UndoCommandPtr command) { m_commands.push_back(std::move(command)); }
+    bool isEmpty() const { return m_commands.empty(); }
+
+private:
+    std::vector<UndoCommandPtr> m_commands;
+};
+
+// A single parameter change, such as a radius or a material, applied through a setter
+template <typename T>
+class ValueCommand : public UndoCommand {
+public:
+    ValueCommand(const std::string& description, std::function<void(const T&)> setter, T before, T after)
+        : UndoCommand(description), m_setter(std::move(setter)), m_before(std::move(before)), m_after(std::move(after)) {}
+
+    void undo() override { m_setter(m_before); }
+    void redo() override { m_setter(m_after); }
+
+private:
+    std::function<void(const T&)> m_setter;
+    T m_before;
+    T m_after;
+};
+
+// Moves an assembly instance between two placements
+class TransformCommand : public UndoCommand {
+public:
+    TransformCommand(const std::string& description, const std::shared_ptr<Assembly>& assembly,
+                     const std::string& instanceName, const Transform& before, const Transform& after);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    std::weak_ptr<Assembly> m_assembly;
+    std::string m_instanceName;
+    Transform m_before;
+    Transform m_after;
+};
+
+// Moved vertices of a mesh whose topology stayed the same
+class MeshVertexCommand : public UndoCommand {
+public:
+    MeshVertexCommand(const std::string& description, const std::shared_ptr<MeshObject>& mesh);
+
+    void addVertex(int vertex, const QVector3D& before, const QVector3D& after);
+    bool isEmpty() const { return m_vertices.empty(); }
+
+    void undo() override;
+    void redo() override;
+    size_t memoryUsage(std::unordered_set<const void*>& counted) const override;
+
+private:
+    void apply(const std::vector<float>& positions);
+
+    std::weak_ptr<MeshObject> m_mesh;
+    std::vector<int> m_vertices;
+    std::vector<float> m_before; // xyz per entry of m_vertices
+    std::vector<float> m_after;
+};
+
+// Whole-mesh states around an edit that changed topology. The snapshots share every array the
+// edit left alone, so the cost is only what actually changed.
+class MeshSnapshotCommand : public UndoCommand {
+public:
+    MeshSnapshotCommand(const std::string& description, const std::shared_ptr<MeshObject>& mesh,
+                        std::shared_ptr<const MeshSnapshot> before, std::shared_ptr<const MeshSnapshot> after);
+
+    void undo() override;
+    void redo() override;
+    size_t memoryUsage(std::unordered_set<const void*>& counted) const override;
+
+private:
+    std::weak_ptr<MeshObject> m_mesh;
+    std::shared_ptr<const MeshSnapshot> m_before;
+    std::shared_ptr<const MeshSnapshot> m_after;
+};
+
+// Undo and redo stacks bounded by a command count and a memory budget; the oldest commands
+// are dropped first when either is exceeded
+class UndoHistory {
+public:
+    static constexpr size_t DEFAULT_MAX_COMMANDS = 50;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(256) << 20;
+
+    // Records an edit that has already been made and discards everything that could be redone
+    void push(UndoCommandPtr command);
+    void beginGroup(const std::string& description);
+    void endGroup();
+
+    bool canUndo() const { return !m_undoStack.empty(); }
+    bool canRedo() const { return !m_redoStack.empty(); }
+    bool undo();
+    bool redo();
+    void clear();
+
+    std::string undoDescription() const;
+    std::string redoDescription() const;
+    // Called after anything that can change canUndo(), canRedo() or the descriptions
+    void setChangedCallback(std::function<void()> callback) { m_changed = std::move(callback); }
+    // True while a command is being undone or redone; edits made then must not be recorded
+    bool isReplaying() const { return m_replaying; }
+
+    void setMaxCommands(size_t count);
+    size_t getMaxCommands() const { return m_maxCommands; }
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return m_memoryBudget; }
+    // Bytes held by both stacks, shared buffers counted once
+    size_t memoryUsage() const;
+
+    // Copies mesh for a MeshSnapshotCommand, sharing the arrays that match the last snapshot
+    // taken of it
+    std::shared_ptr<const MeshSnapshot> snapshotMesh(const MeshObject& mesh);
+
+private:
+    void enforceLimits();
+    void notifyChanged() { if (m_changed) m_changed(); }
+
+    std::vector<UndoCommandPtr> m_undoStack; // Oldest first
+    std::vector<UndoCommandPtr> m_redoStack; // Next to redo last
+    std::vector<std::unique_ptr<UndoGroup>> m_openGroups;
+    std::unordered_map<const MeshObject*, std::weak_ptr<const MeshSnapshot>> m_lastSnapshots;
+    size_t m_maxCommands = DEFAULT_MAX_COMMANDS;
+    size_t m_memoryBudget = DEFAULT_MEMORY_BUDGET;
+    bool m_replaying = false;
+    std::function<void()> m_changed;
+};
+
+} // namespace HybridCAD
@@ -0,0 +1,567 @@
+#include "AssemblySolver.h"
+#include "PartManager.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace HybridCAD {
+
+namespace {
+
+constexpr int DOF = 6;
+// COINCIDENT and CONCENTRIC contribute the most equations
+constexpr int MAX_EQUATIONS = 6;
+// Central differences in double precision stay accurate to about the square of this
+constexpr double DIFFERENCE_STEP = 1e-5;
+// Keeps the damped blocks invertible along directions no constraint restrains
+constexpr double DAMPING_FLOOR = 1e-8;
+
+struct Vec3 {
+    double x = 0.0, y = 0.0, z = 0.0;
+
+    Vec3() = default;
+    Vec3(double x, double y, double z) : x(x), y(y), z(z) {}
+    explicit Vec3(const QVector3D& v) : x(v.x()), y(v.y()), z(v.z()) {}
+
+    Vec3 operator+(const Vec3& o) const { return Vec3(x + o.x, y + o.y, z + o.z); }
+    Vec3 operator-(const Vec3& o) const { return Vec3(x - o.x, y - o.y, z - o.z); }
+    Vec3 operator*(double s) const { return Vec3(x * s, y * s, z * s); }
+    double dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+    Vec3 cross(const Vec3& o) const { return Vec3(y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x); }
+    double length() const { return std::sqrt(dot(*this)); }
+    Vec3 normalized() const {
+        const double l = length();
+        return l > 0.0 ? *this * (1.0 / l) : *this;
+    }
+};
+
+// Placement in double precision; the linear part keeps any scale the transform had
+struct Pose {
+    double linear[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    Vec3 translation;
+
+    static Pose fromMatrix(const QMatrix4x4& m) {
+        Pose pose;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) pose.linear[i][j] = m(i, j);
+        }
+        pose.translation = Vec3(m(0, 3), m(1, 3), m(2, 3));
+        return pose;
+    }
+
+    QMatrix4x4 toMatrix() const {
+        return QMatrix4x4(linear[0][0], linear[0][1], linear[0][2], translation.x,
+                          linear[1][0], linear[1][1], linear[1][2], translation.y,
+                          linear[2][0], linear[2][1], linear[2][2], translation.z,
+                          0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    Vec3 mapVector(const Vec3& v) const {
+        return Vec3(linear[0][0] * v.x + linear[0][1] * v.y + linear[0][2] * v.z,
+                    linear[1][0] * v.x + linear[1][1] * v.y + linear[1][2] * v.z,
+                    linear[2][0] * v.x + linear[2][1] * v.y + linear[2][2] * v.z);
+    }
+    Vec3 mapPoint(const Vec3& p) const { return mapVector(p) + translation; }
+
+    // Rotates by the rotation vector delta[0..2] about the body's origin, then moves by delta[3..5]
+    Pose moved(const double* delta) const {
+        const double angle = std::sqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+        // Rodrigues: R = I + a K + b K^2 with K the cross-product matrix of delta
+        const double a = angle > 1e-12 ? std::sin(angle) / angle : 1.0;
+        const double b = angle > 1e-12 ? (1.0 - std::cos(angle)) / (angle * angle) : 0.5;
+        const double k[3][3] = { { 0.0, -delta[2], delta[1] },
+                                 { delta[2], 0.0, -delta[0] },
+                                 { -delta[1], delta[0], 0.0 } };
+        double rotation[3][3];
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                double kk = 0.0;
+                for (int n = 0; n < 3; ++n) kk += k[i][n] * k[n][j];
+                rotation[i][j] = (i == j ? 1.0 : 0.0) + a * k[i][j] + b * kk;
+            }
+        }
+
+        Pose result;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                result.linear[i][j] = rotation[i][0] * linear[0][j] + rotation[i][1] * linear[1][j] +
+                                      rotation[i][2] * linear[2][j];
+            }
+        }
+        result.translation = translation + Vec3(delta[3], delta[4], delta[5]);
+        return result;
+    }
+};
+
+// A null pose means the constraint's data for that side is already in world space
+Vec3 worldDirection(const QVector3D& direction, const Pose* pose) {
+    return (pose ? pose->mapVector(Vec3(direction)) : Vec3(direction)).normalized();
+}
+
+// Which way aligned directions should face: the way they face to begin with
+double alignmentSense(const AssemblySolver::Constraint& constraint, const Pose* a, const Pose* b) {
+    return worldDirection(constraint.directionA, a).dot(worldDirection(constraint.directionB, b)) < 0.0 ? -1.0 : 1.0;
+}
+
+// Errors of one constraint, zero when it holds; returns how many were written
+int evaluate(const AssemblySolver::Constraint& constraint, const Pose* a, const Pose* b, double sense, double* error) {
+    const Vec3 pointA = a ? a->mapPoint(Vec3(constraint.pointA)) : Vec3(constraint.pointA);
+    const Vec3 pointB = b ? b->mapPoint(Vec3(constraint.pointB)) : Vec3(constraint.pointB);
+    const Vec3 directionA = worldDirection(constraint.directionA, a);
+    const Vec3 directionB = worldDirection(constraint.directionB, b);
+    const Vec3 offset = pointB - pointA;
+    // Unlike the cross product this keeps its slope when the directions start out perpendicular
+    const Vec3 alignment = directionB - directionA * sense;
+
+    auto write = [error](int at, const Vec3& v) {
+        error[at] = v.x;
+        error[at + 1] = v.y;
+        error[at + 2] = v.z;
+    };
+
+    switch (constraint.type) {
+    case ConstraintType::COINCIDENT:
+        write(0, offset);
+        return 3;
+    case ConstraintType::CONCENTRIC:
+        // Aligned axes, and B's point on A's axis
+        write(0, alignment);
+        write(3, offset.cross(directionA));
+        return 6;
+    case ConstraintType::PARALLEL:
+        write(0, alignment);
+        return 3;
+    case ConstraintType::PERPENDICULAR:
+        error[0] = directionA.dot(directionB);
+        return 1;
+    case ConstraintType::DISTANCE:
+        error[0] = offset.length() - constraint.value;
+        return 1;
+    case ConstraintType::ANGLE:
+        error[0] = directionA.dot(directionB) - std::cos(constraint.value * M_PI / 180.0);
+        return 1;
+    case ConstraintType::TANGENT:
+        // B's point at the given distance from the plane through A's point along A's normal
+        error[0] = offset.dot(directionA) - constraint.value;
+        return 1;
+    case ConstraintType::FIXED:
+        break;
+    }
+    return 0;
+}
+
+using Block = std::array<double, DOF * DOF>;
+
+// In-place lower Cholesky factor of a symmetric positive definite block
+bool choleskyFactor(Block& m) {
+    for (int j = 0; j < DOF; ++j) {
+        double diagonal = m[j * DOF + j];
+        for (int k = 0; k < j; ++k) diagonal -= m[j * DOF + k] * m[j * DOF + k];
+        if (diagonal <= 0.0) return false;
+        m[j * DOF + j] = std::sqrt(diagonal);
+        for (int i = j + 1; i < DOF; ++i) {
+            double value = m[i * DOF + j];
+            for (int k = 0; k < j; ++k) value -= m[i * DOF + k] * m[j * DOF + k];
+            m[i * DOF + j] = value / m[j * DOF + j];
+        }
+    }
+    return true;
+}
+
+void choleskySolve(const Block& l, const double* b, double* x) {
+    double y[DOF];
+    for (int i = 0; i < DOF; ++i) {
+        double value = b[i];
+        for (int k = 0; k < i; ++k) value -= l[i * DOF + k] * y[k];
+        y[i] = value / l[i * DOF + i];
+    }
+    for (int i = DOF - 1; i >= 0; --i) {
+        double value = y[i];
+        for (int k = i + 1; k < DOF; ++k) value -= l[k * DOF + i] * x[k];
+        x[i] = value / l[i * DOF + i];
+    }
+}
+
+// One constraint linearized about the current poses
+struct Row {
+    int slotA = -1; // Free bodies' positions in the component; -1 for grounded or world
+    int slotB = -1;
+    int count = 0;
+    double sense = 1.0;
+    double error[MAX_EQUATIONS] = {};
+    double jacobianA[MAX_EQUATIONS][DOF] = {};
+    double jacobianB[MAX_EQUATIONS][DOF] = {};
+};
+
+struct ComponentResult {
+    bool converged = false;
+    int iterations = 0;
+    double residual = 0.0;
+};
+
+class ComponentSolver {
+public:
+    ComponentSolver(const std::vector<AssemblySolver::Constraint>& constraints, const std::vector<int>& rows,
+                    const std::vector<int>& bodies, const std::vector<char>& grounded,
+                    const std::vector<int>& bodySlot, std::vector<Pose>& poses)
+        : m_constraints(constraints), m_rowConstraints(rows), m_bodies(bodies), m_grounded(grounded),
+          m_bodySlot(bodySlot), m_poses(poses), m_rows(rows.size()) {
+        m_local.reserve(bodies.size());
+        for (int body : bodies) m_local.push_back(poses[body]);
+        for (size_t r = 0; r < m_rows.size(); ++r) {
+            const AssemblySolver::Constraint& constraint = m_constraints[m_rowConstraints[r]];
+            m_rows[r].slotA = slotOf(constraint.bodyA);
+            m_rows[r].slotB = constraint.bodyB == constraint.bodyA ? -1 : slotOf(constraint.bodyB);
+            m_rows[r].sense = alignmentSense(constraint, poseOf(constraint.bodyA), poseOf(constraint.bodyB));
+        }
+    }
+
+    ComponentResult solve(const AssemblySolver::Settings& settings) {
+        ComponentResult result;
+        double lambda = 1e-3;
+        double cost = linearize();
+
+        for (; result.iterations < settings.maxIterations; ++result.iterations) {
+            result.residual = maxError();
+            if (result.residual <= settings.tolerance) break;
+
+            std::vector<double> step;
+            if (!computeStep(lambda, step)) {
+                lambda *= 10.0;
+                continue;
+            }
+
+            std::vector<Pose> trial(m_local.size());
+            for (size_t s = 0; s < m_local.size(); ++s) trial[s] = m_local[s].moved(&step[s * DOF]);
+            std::swap(trial, m_local);
+            const double trialCost = measure();
+            if (trialCost < cost) {
+                cost = linearize();
+                lambda = std::max(lambda / 3.0, 1e-12);
+            } else {
+                // Put back the errors the trial overwrote
+                std::swap(trial, m_local);
+                measure();
+                lambda *= 4.0;
+                if (lambda > 1e12) break;
+            }
+        }
+
+        result.residual = maxError();
+        result.converged = result.residual <= settings.tolerance;
+        for (size_t s = 0; s < m_bodies.size(); ++s) m_poses[m_bodies[s]] = m_local[s];
+        return result;
+    }
+
+private:
+    int slotOf(int body) const {
+        return body < 0 || m_grounded[body] ? -1 : m_bodySlot[body];
+    }
+
+    const Pose* poseOf(int body) const {
+        if (body < 0) return nullptr;
+        return m_grounded[body] ? &m_poses[body] : &m_local[m_bodySlot[body]];
+    }
+
+    // Errors at the current poses; returns their squared sum
+    double measure() {
+        double cost = 0.0;
+        for (size_t r = 0; r < m_rows.size(); ++r) {
+            const AssemblySolver::Constraint& constraint = m_constraints[m_rowConstraints[r]];
+            Row& row = m_rows[r];
+            row.count = evaluate(constraint, poseOf(constraint.bodyA), poseOf(constraint.bodyB), row.sense, row.error);
+            for (int e = 0; e < row.count; ++e) cost += row.error[e] * row.error[e];
+        }
+        return cost;
+    }
+
+    // Errors and their derivatives by central differences; returns the squared error sum
+    double linearize() {
+        const double cost = measure();
+        for (size_t r = 0; r < m_rows.size(); ++r) {
+            const AssemblySolver::Constraint& constraint = m_constraints[m_rowConstraints[r]];
+            Row& row = m_rows[r];
+            differentiate(constraint, row.sense, constraint.bodyA, row.slotA, row.jacobianA);
+            if (row.slotB >= 0) differentiate(constraint, row.sense, constraint.bodyB, row.slotB, row.jacobianB);
+        }
+        return cost;
+    }
+
+    void differentiate(const AssemblySolver::Constraint& constraint, double sense, int body, int slot,
+                       double (&jacobian)[MAX_EQUATIONS][DOF]) const {
+        if (slot < 0) return;
+        for (int d = 0; d < DOF; ++d) {
+            double delta[DOF] = {};
+            delta[d] = DIFFERENCE_STEP;
+            const Pose forward = m_local[slot].moved(delta);
+            delta[d] = -DIFFERENCE_STEP;
+            const Pose backward = m_local[slot].moved(delta);
+
+            // A constraint between two features of one body moves both ends
+            double plus[MAX_EQUATIONS];
+            double minus[MAX_EQUATIONS];
+            const int count = evaluate(constraint, constraint.bodyA == body ? &forward : poseOf(constraint.bodyA),
+                                       constraint.bodyB == body ? &forward : poseOf(constraint.bodyB), sense, plus);
+            evaluate(constraint, constraint.bodyA == body ? &backward : poseOf(constraint.bodyA),
+                     constraint.bodyB == body ? &backward : poseOf(constraint.bodyB), sense, minus);
+            for (int e = 0; e < count; ++e) jacobian[e][d] = (plus[e] - minus[e]) / (2.0 * DIFFERENCE_STEP);
+        }
+    }
+
+    double maxError() const {
+        double largest = 0.0;
+        for (const Row& row : m_rows) {
+            for (int e = 0; e < row.count; ++e) largest = std::max(largest, std::abs(row.error[e]));
+        }
+        return largest;
+    }
+
+    // y = J x, one entry per equation
+    void applyJacobian(const std::vector<double>& x, std::vector<std::array<double, MAX_EQUATIONS>>& y) const {
+        for (size_t r = 0; r < m_rows.size(); ++r) {
+            const Row& row = m_rows[r];
+            for (int e = 0; e < row.count; ++e) {
+                double value = 0.0;
+                for (int d = 0; d < DOF; ++d) {
+                    if (row.slotA >= 0) value += row.jacobianA[e][d] * x[row.slotA * DOF + d];
+                    if (row.slotB >= 0) value += row.jacobianB[e][d] * x[row.slotB * DOF + d];
+                }
+                y[r][e] = value;
+            }
+        }
+    }
+
+    // x = J^T y
+    void applyTranspose(const std::vector<std::array<double, MAX_EQUATIONS>>& y, std::vector<double>& x) const {
+        std::fill(x.begin(), x.end(), 0.0);
+        for (size_t r = 0; r < m_rows.size(); ++r) {
+            const Row& row = m_rows[r];
+            for (int e = 0; e < row.count; ++e) {
+                for (int d = 0; d < DOF; ++d) {
+                    if (row.slotA >= 0) x[row.slotA * DOF + d] += row.jacobianA[e][d] * y[r][e];
+                    if (row.slotB >= 0) x[row.slotB * DOF + d] += row.jacobianB[e][d] * y[r][e];
+                }
+            }
+        }
+    }
+
+    // Solves (J^T J + lambda D) step = -J^T e by preconditioned conjugate gradients, where D
+    // scales with the curvature of each body's rotations and translations
+    bool computeStep(double lambda, std::vector<double>& step) const {
+        const size_t size = m_local.size() * DOF;
+
+        std::vector<Block> blocks(m_local.size());
+        for (Block& block : blocks) block.fill(0.0);
+        auto accumulate = [&](int slot, const double (&jacobian)[MAX_EQUATIONS][DOF], int count) {
+            if (slot < 0) return;
+            Block& block = blocks[slot];
+            for (int e = 0; e < count; ++e) {
+                for (int i = 0; i < DOF; ++i) {
+                    for (int j = 0; j < DOF; ++j) block[i * DOF + j] += jacobian[e][i] * jacobian[e][j];
+                }
+            }
+        };
+        for (const Row& row : m_rows) {
+            accumulate(row.slotA, row.jacobianA, row.count);
+            accumulate(row.slotB, row.jacobianB, row.count);
+        }
+
+        std::vector<double> damping(size);
+        std::vector<Block> preconditioner(blocks);
+        for (size_t s = 0; s < blocks.size(); ++s) {
+            // Same damping for all three rotations and all three translations; scaling each
+            // parameter by its own curvature would favour large moves along weakly held ones
+            const Block& block = blocks[s];
+            const double rotation = (block[0] + block[DOF + 1] + block[2 * DOF + 2]) / 3.0;
+            const double translation = (block[3 * DOF + 3] + block[4 * DOF + 4] + block[5 * DOF + 5]) / 3.0;
+            for (int d = 0; d < DOF; ++d) {
+                damping[s * DOF + d] = lambda * (d < 3 ? rotation : translation) + DAMPING_FLOOR;
+                preconditioner[s][d * DOF + d] += damping[s * DOF + d];
+            }
+            if (!choleskyFactor(preconditioner[s])) return false;
+        }
+
+        std::vector<std::array<double, MAX_EQUATIONS>> errors(m_rows.size());
+        for (size_t r = 0; r < m_rows.size(); ++r) {
+            for (int e = 0; e < MAX_EQUATIONS; ++e) errors[r][e] = -m_rows[r].error[e];
+        }
+        std::vector<double> residual(size);
+        applyTranspose(errors, residual);
+
+        std::vector<std::array<double, MAX_EQUATIONS>> scratch(m_rows.size());
+        auto multiply = [&](const std::vector<double>& x, std::vector<double>& y) {
+            applyJacobian(x, scratch);
+            applyTranspose(scratch, y);
+            for (size_t i = 0; i < size; ++i) y[i] += damping[i] * x[i];
+        };
+        auto precondition = [&](const std::vector<double>& r, std::vector<double>& z) {
+            for (size_t s = 0; s < preconditioner.size(); ++s) {
+                choleskySolve(preconditioner[s], &r[s * DOF], &z[s * DOF]);
+            }
+        };
+
+        step.assign(size, 0.0);
+        std::vector<double> z(size);
+        std::vector<double> direction(size);
+        std::vector<double> product(size);
+        precondition(residual, z);
+        direction = z;
+        double rz = std::inner_product(residual.begin(), residual.end(), z.begin(), 0.0);
+        // Further digits only chase rounding noise, which the unrestrained directions amplify
+        const double threshold = std::inner_product(residual.begin(), residual.end(), residual.begin(), 0.0) * 1e-16;
+
+        const size_t maxIterations = std::min<size_t>(size * 2, 200);
+        for (size_t iteration = 0; iteration < maxIterations; ++iteration) {
+            multiply(direction, product);
+            const double curvature = std::inner_product(direction.begin(), direction.end(), product.begin(), 0.0);
+            if (curvature <= 0.0) break;
+
+            const double alpha = rz / curvature;
+            for (size_t i = 0; i < size; ++i) {
+                step[i] += alpha * direction[i];
+                residual[i] -= alpha * product[i];
+            }
+            if (std::inner_product(residual.begin(), residual.end(), residual.begin(), 0.0) <= threshold) break;
+            precondition(residual, z);
+            const double next = std::inner_product(residual.begin(), residual.end(), z.begin(), 0.0);
+            for (size_t i = 0; i < size; ++i) direction[i] = z[i] + (next / rz) * direction[i];
+            rz = next;
+        }
+        return true;
+    }
+
+    const std::vector<AssemblySolver::Constraint>& m_constraints;
+    const std::vector<int>& m_rowConstraints;
+    const std::vector<int>& m_bodies;
+    const std::vector<char>& m_grounded;
+    const std::vector<int>& m_bodySlot;
+    // Grounded bodies are read from here; the component's own bodies are written back at the end
+    std::vector<Pose>& m_poses;
+    std::vector<Pose> m_local;
+    std::vector<Row> m_rows;
+};
+
+int findRoot(std::vector<int>& parents, int body) {
+    while (parents[body] != body) {
+        parents[body] = parents[parents[body]];
+        body = parents[body];
+    }
+    return body;
+}
+
+} // namespace
+
+void AssemblySolver::clear() {
+    m_constraints.clear();
+    m_grounded.clear();
+    m_components.clear();
+    m_bodyComponents.clear();
+    m_bodySlot.clear();
+    m_stats = Stats();
+}
+
+void AssemblySolver::rebuild(const std::vector<char>& grounded, const std::vector<Constraint>& constraints) {
+    clear();
+    m_grounded = grounded;
+    m_bodyComponents.resize(grounded.size());
+    m_bodySlot.assign(grounded.size(), -1);
+
+    const int bodyCount = static_cast<int>(grounded.size());
+    auto valid = [bodyCount](int body) { return body >= -1 && body < bodyCount; };
+    for (const Constraint& constraint : constraints) {
+        if (!valid(constraint.bodyA) || !valid(constraint.bodyB)) continue;
+        if (constraint.type == ConstraintType::FIXED) {
+            if (constraint.bodyA >= 0) m_grounded[constraint.bodyA] = 1;
+            continue;
+        }
+        m_constraints.push_back(constraint);
+    }
+
+    auto isFree = [this](int body) { return body >= 0 && !m_grounded[body]; };
+    std::vector<int> parents(grounded.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (const Constraint& constraint : m_constraints) {
+        if (isFree(constraint.bodyA) && isFree(constraint.bodyB)) {
+            parents[findRoot(parents, constraint.bodyA)] = findRoot(parents, constraint.bodyB);
+        }
+    }
+
+    // Constraints with no free body have nothing to move
+    std::vector<int> componentOfRoot(grounded.size(), -1);
+    for (size_t c = 0; c < m_constraints.size(); ++c) {
+        const Constraint& constraint = m_constraints[c];
+        const int body = isFree(constraint.bodyA) ? constraint.bodyA : constraint.bodyB;
+        if (!isFree(body)) continue;
+
+        int& component = componentOfRoot[findRoot(parents, body)];
+        if (component < 0) {
+            component = static_cast<int>(m_components.size());
+            m_components.emplace_back();
+        }
+        m_components[component].constraints.push_back(static_cast<int>(c));
+
+        for (int end : { constraint.bodyA, constraint.bodyB }) {
+            if (end < 0) continue;
+            std::vector<int>& list = m_bodyComponents[end];
+            if (std::find(list.begin(), list.end(), component) == list.end()) list.push_back(component);
+        }
+    }
+
+    for (int body = 0; body < bodyCount; ++body) {
+        if (m_grounded[body] || m_bodyComponents[body].empty()) continue;
+        Component& component = m_components[m_bodyComponents[body].front()];
+        m_bodySlot[body] = static_cast<int>(component.bodies.size());
+        component.bodies.push_back(body);
+    }
+}
+
+void AssemblySolver::markBodyDirty(int body) {
+    if (body < 0 || body >= static_cast<int>(m_bodyComponents.size())) return;
+    for (int component : m_bodyComponents[body]) m_components[component].dirty = true;
+}
+
+bool AssemblySolver::hasDirtyComponents() const {
+    return std::any_of(m_components.begin(), m_components.end(), [](const Component& c) { return c.dirty; });
+}
+
+bool AssemblySolver::solve(std::vector<QMatrix4x4>& transforms) {
+    m_stats = Stats();
+    if (transforms.size() != m_grounded.size()) return false;
+
+    std::vector<int> dirty;
+    for (size_t c = 0; c < m_components.size(); ++c) {
+        if (m_components[c].dirty) dirty.push_back(static_cast<int>(c));
+    }
+    if (dirty.empty()) return true;
+
+    std::vector<Pose> poses(transforms.size());
+    for (size_t b = 0; b < transforms.size(); ++b) poses[b] = Pose::fromMatrix(transforms[b]);
+
+    // Components only share grounded bodies, which nothing writes
+    std::vector<ComponentResult> results(dirty.size());
+    ThreadPool::instance().parallelFor(0, dirty.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const Component& component = m_components[dirty[i]];
+            ComponentSolver solver(m_constraints, component.constraints, component.bodies, m_grounded, m_bodySlot, poses);
+            results[i] = solver.solve(m_settings);
+        }
+    });
+
+    bool converged = true;
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        Component& component = m_components[dirty[i]];
+        for (int body : component.bodies) transforms[body] = poses[body].toMatrix();
+        // An unsatisfiable component is not retried until something in it changes
+        component.dirty = false;
+
+        converged = converged && results[i].converged;
+        m_stats.iterations = std::max(m_stats.iterations, results[i].iterations);
+        m_stats.residual = std::max(m_stats.residual, results[i].residual);
+    }
+    m_stats.solvedComponents = dirty.size();
+    return converged;
+}
+
+} // namespace HybridCAD
@@ -1,8 +1,18 @@
 #include "CADViewer.h"
+#include "DependencyGraph.h"
 #include "GeometryManager.h"
+#include "GpuMeshCache.h"
+#include "MeshDecimator.h"
+#include "MeshManager.h"
+#include "PartManager.h"
+#include "PickBuffer.h"
+#include "RenderProfiler.h"
+#include "SpatialIndex.h"
+#include "ThreadPool.h"
 #include "ToolManager.h"
 #include <QtOpenGL/QOpenGLShader>
 #include <QtCore/QTimer>
+#include <QFocusEvent>
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QKeyEvent>
@@ -10,8 +20,10 @@
 #include <QEnterEvent>
 #include <QSet>
 #include <QStandardPaths>
+#include <algorithm>
 #include <cmath>
-#include <set>
+#include <limits>
+#include <unordered_set>
 
 namespace HybridCAD {
 
@@ -43,6 +55,7 @@ CADViewer::CADViewer(QWidget *parent)
     , m_isDragging(false)
     , m_isRotating(false)
     , m_isPanning(false)
+    , m_framePending(false)
     , m_geometryManager(nullptr)
     , m_meshManager(nullptr)
     , m_navigationCube(nullptr)
@@ -73,6 +86,7 @@ CADViewer::CADViewer(QWidget *parent)
     preferences.beginGroup("Preferences");
     m_mouseSensitivity = preferences.value("mouseSensitivity", DEFAULT_MOUSE_SENSITIVITY).toFloat();
     m_cameraSpeed = preferences.value("cameraSpeed", DEFAULT_CAMERA_SPEED).toFloat();
+    const int tessellationCacheMB = preferences.value("tessellationCacheMB", -1).toInt();
     preferences.endGroup();
     
     // Setup default keybindings and load custom ones
@@ -84,16 +98,29 @@ CADViewer::CADViewer(QWidget *parent)
     
     // Initialize geometry manager
     m_geometryManager = new GeometryManager();
+    if (tessellationCacheMB >= 0) {
+        m_geometryManager->setTessellationCacheBudget(static_cast<size_t>(tessellationCacheMB) * 1024 * 1024);
+    }
+    
+    // Picking and snapping acceleration structure
+    m_spatialIndex = std::make_unique<SceneSpatialIndex>();
+    m_dependencyGraph = std::make_unique<DependencyGraph>();
+    
+    // Pass timings and draw counters, off until the HUD is shown
+    m_profiler = std::make_unique<RenderProfiler>();
+    
+    // Object and primitive IDs for picking, rendered only when a pick needs them
+    m_pickBuffer = std::make_unique<PickBuffer>();
     
-    // Animation timer for smooth updates
-    m_animationTimer = new QTimer(this);
-    connect(m_animationTimer, &QTimer::timeout, this, &CADViewer::animate);
-    m_animationTimer->start(16); // ~60 FPS
+    // Frames are drawn only when requested; this timer defers a request while background work finishes
+    m_deferredFrameTimer = new QTimer(this);
+    m_deferredFrameTimer->setSingleShot(true);
+    connect(m_deferredFrameTimer, &QTimer::timeout, this, &CADViewer::requestFrame);
     
-    // Keyboard input timer for continuous movement
+    // Keyboard input timer for continuous movement, running only while a movement key is held
     m_keyUpdateTimer = new QTimer(this);
+    m_keyUpdateTimer->setTimerType(Qt::PreciseTimer);
     connect(m_keyUpdateTimer, &QTimer::timeout, this, &CADViewer::processKeyboardInput);
-    m_keyUpdateTimer->start(16); // ~60 FPS for smooth movement
 }
 
 CADViewer::~CADViewer()
@@ -102,6 +129,14 @@ CADViewer::~CADViewer()
     delete m_geometryManager;
     makeCurrent();
     // Cleanup OpenGL resources
+    if (m_meshCache) {
+        m_meshCache->clear();
+    }
+    if (m_gridVao) {
+        m_gridVao->destroy();
+    }
+    m_pickBuffer->destroy();
+    m_profiler->destroy();
     doneCurrent();
 }
 
@@ -129,13 +164,27 @@ void CADViewer::initializeGL()
     // Setup shaders
     setupShaders();
     setupGeometry();
+    
+    m_pickBuffer->initialize(this);
+    m_profiler->initialize();
 }
 
 void CADViewer::paintGL()
 {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // Requests made while this frame draws schedule the next one
+    m_framePending = false;
+    
+    RenderProfiler* profiler = m_profiler.get();
+    profiler->beginFrame();
+    
+    {
+        RenderProfiler::Scope pass(profiler, "clear");
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
     
     updateMatrices();
+    // Object and line shaders read the model matrix from a vertex attribute
+    setModelAttribute(m_modelMatrix);
     
     // Set wireframe mode if enabled
     if (m_wireframeMode) {
@@ -143,9 +192,11 @@ void CADViewer::paintGL()
     } else {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
+    profiler->countStateChange();
     
     // Render grid on specified plane(s)
     if (m_showGrid) {
+        RenderProfiler::Scope pass(profiler, "grid");
         if (m_showMultiPlaneGrid) {
             renderMultiPlaneGrid();
         } else {
@@ -155,28 +206,58 @@ void CADViewer::paintGL()
     
     // Render axes
     if (m_showAxes) {
+        RenderProfiler::Scope pass(profiler, "axes");
         renderAxes();
     }
     
-    // Render objects
-    renderObjects();
-    
-    // Render placement preview
-    renderPlacementPreview();
-    
-    // Render sketch preview
-    renderSketchPreview();
+    // Features whose inputs were edited are rebuilt before anything draws them
+    {
+        RenderProfiler::Scope pass(profiler, "evaluate");
+        // Whatever the graph saw change is re-indexed too, however it was edited
+        std::vector<const CADObject*> evaluated;
+        m_dependencyGraph->collectChanges();
+        m_dependencyGraph->evaluate(&evaluated);
+        for (const CADObject* object : evaluated) {
+            m_spatialIndex->updateObject(object);
+        }
+    }
     
-    // Render extrusion preview
-    renderExtrusionPreview();
+    // Render objects
+    {
+        RenderProfiler::Scope pass(profiler, "objects");
+        renderObjects();
+    }
     
-    // Render eraser preview
-    renderEraserPreview();
+    // Previews return early unless their tool is active
+    {
+        RenderProfiler::Scope pass(profiler, "placement preview");
+        renderPlacementPreview();
+    }
+    {
+        RenderProfiler::Scope pass(profiler, "sketch preview");
+        renderSketchPreview();
+    }
+    {
+        RenderProfiler::Scope pass(profiler, "extrusion preview");
+        renderExtrusionPreview();
+    }
+    {
+        RenderProfiler::Scope pass(profiler, "eraser preview");
+        renderEraserPreview();
+    }
     
     // Render size ruler during shape placement
     if (m_placementState == PlacementState::WAITING_FOR_SECOND_CLICK) {
+        RenderProfiler::Scope pass(profiler, "size ruler");
         renderSizeRuler();
     }
+    
+    profiler->endFrame();
+    
+    // Drawn after the frame closes so the HUD does not measure itself
+    if (profiler->isEnabled()) {
+        renderProfilerOverlay();
+    }
 }
 
 void CADViewer::resizeGL(int width, int height)
@@ -186,7 +267,7 @@ void CADViewer::resizeGL(int width, int height)
     // Update projection matrix
     m_projectionMatrix.setToIdentity();
     float aspect = float(width) / float(height ? height : 1);
-    m_projectionMatrix.perspective(45.0f, aspect, 0.1f, 1000.0f);
+    m_projectionMatrix.perspective(FIELD_OF_VIEW, aspect, 0.1f, GRID_FAR_PLANE);
     
     // Reposition navigation cube
     if (m_navigationCube) {
@@ -250,33 +331,41 @@ void CADViewer::mousePressEvent(QMouseEvent *event)
             }
         }
     }
-    update();
+    requestFrame();
 }
 
 void CADViewer::mouseMoveEvent(QMouseEvent *event)
 {
     QPoint delta = event->pos() - m_lastMousePos;
     float sensitivityFactor = m_mouseSensitivity * 0.5f;
+    // Plain hovering only updates the coordinate readout and draws nothing
+    bool needsFrame = false;
 
     if ((event->buttons() & Qt::LeftButton && m_activeTool == ActiveTool::SELECT) || (event->buttons() & Qt::RightButton)) {
         rotateCamera(delta.x() * sensitivityFactor, delta.y() * sensitivityFactor);
+        needsFrame = true;
     } else if (event->buttons() & Qt::MiddleButton) {
         panCamera(delta.x(), delta.y());
+        needsFrame = true;
     }
 
     if (m_placementState == PlacementState::WAITING_FOR_SECOND_CLICK || m_isSketchingActive) {
         updatePlacementPreview(event->pos());
+        needsFrame = true;
     }
     
     if (m_activeTool == ActiveTool::EXTRUDE_2D && m_extrusionObject) {
         updateExtrusionPreview(event->pos());
+        needsFrame = true;
     }
     
     QVector3D worldPos = screenToWorld(event->pos());
     emit coordinatesChanged(worldPos);
 
     m_lastMousePos = event->pos();
-    update();
+    if (needsFrame) {
+        requestFrame();
+    }
 }
 
 void CADViewer::mouseReleaseEvent(QMouseEvent *event)
@@ -287,20 +376,24 @@ void CADViewer::mouseReleaseEvent(QMouseEvent *event)
     if (event->button() == Qt::MiddleButton) {
         m_isPanning = false;
     }
-    update();
+    requestFrame();
 }
 
 void CADViewer::wheelEvent(QWheelEvent *event)
 {
     float delta = event->angleDelta().y() / 120.0f;
     zoomCamera(delta);
-    update();
+    requestFrame();
 }
 
 void CADViewer::keyPressEvent(QKeyEvent *event)
 {
     // Add key to pressed keys set for continuous movement
     m_pressedKeys.insert(event->key());
+    if (isMovementKey(event->key()) && !m_keyUpdateTimer->isActive()) {
+        m_keyMotionClock.start();
+        m_keyUpdateTimer->start(KEY_MOTION_INTERVAL_MS);
+    }
     
     // Check for keybinding actions
     KeyAction action = getKeyActionFromEvent(event);
@@ -315,16 +408,69 @@ void CADViewer::keyPressEvent(QKeyEvent *event)
 
 void CADViewer::keyReleaseEvent(QKeyEvent *event)
 {
-    // Remove key from pressed keys set
-    m_pressedKeys.remove(event->key());
+    // Auto-repeat sends release/press pairs while the key is still held
+    if (!event->isAutoRepeat()) {
+        // Remove key from pressed keys set
+        m_pressedKeys.remove(event->key());
+        stopKeyMotionIfIdle();
+    }
     QOpenGLWidget::keyReleaseEvent(event);
 }
 
+void CADViewer::focusOutEvent(QFocusEvent *event)
+{
+    // Releases that happen while another widget has focus never reach us
+    m_pressedKeys.clear();
+    stopKeyMotionIfIdle();
+    QOpenGLWidget::focusOutEvent(event);
+}
+
+bool CADViewer::isMovementKey(int key)
+{
+    switch (key) {
+    case Qt::Key_W:
+    case Qt::Key_S:
+    case Qt::Key_A:
+    case Qt::Key_D:
+    case Qt::Key_Q:
+    case Qt::Key_E:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void CADViewer::stopKeyMotionIfIdle()
+{
+    for (int key : m_pressedKeys) {
+        if (isMovementKey(key)) return;
+    }
+    m_keyUpdateTimer->stop();
+}
+
+void CADViewer::requestFrame()
+{
+    // Whatever prompted the frame may have changed what lies under the cursor
+    m_pickBuffer->setCurrent(false);
+    
+    // update() would merge these too, but input and background polling can ask many times per tick
+    if (m_framePending) return;
+    m_framePending = true;
+    update();
+}
+
+void CADViewer::requestFrameAfter(int msec)
+{
+    if (!m_deferredFrameTimer->isActive()) {
+        m_deferredFrameTimer->start(msec);
+    }
+}
+
 void CADViewer::processKeyboardInput()
 {
-    // Process continuous WASD movement
+    // Process continuous WASD movement, scaled by the real time since the last step
     bool needsUpdate = false;
-    float deltaTime = 0.016f; // 60 FPS
+    float deltaTime = std::min(m_keyMotionClock.restart() / 1000.0f, KEY_MOTION_MAX_STEP);
     
     for (int key : m_pressedKeys) {
         switch (key) {
@@ -356,7 +502,7 @@ void CADViewer::processKeyboardInput()
     }
     
     if (needsUpdate) {
-        update();
+        requestFrame();
     }
 }
 
@@ -396,12 +542,6 @@ void CADViewer::moveCamera(CameraMovement direction, float deltaTime)
     m_cameraPosition += movement;
 }
 
-void CADViewer::animate()
-{
-    // Smooth camera updates or animations can go here
-    // Currently just ensures smooth rendering
-}
-
 void CADViewer::setupDefaultKeyBindings()
 {
     QMap<KeyAction, QKeySequence> defaults;
@@ -537,18 +677,22 @@ void CADViewer::setupShaders()
         #version 330 core
         layout (location = 0) in vec3 aPos;
         layout (location = 1) in vec3 aNormal;
+        // Per-instance for assemblies, constant attribute values for single objects
+        layout (location = 2) in mat4 aModel;
+        layout (location = 6) in vec4 aColor;
         
-        uniform mat4 model;
         uniform mat4 view;
         uniform mat4 projection;
         
         out vec3 FragPos;
         out vec3 Normal;
+        out vec4 ObjectColor;
         
         void main()
         {
-            FragPos = vec3(model * vec4(aPos, 1.0));
-            Normal = mat3(transpose(inverse(model))) * aNormal;
+            FragPos = vec3(aModel * vec4(aPos, 1.0));
+            Normal = mat3(transpose(inverse(aModel))) * aNormal;
+            ObjectColor = aColor;
             
             gl_Position = projection * view * vec4(FragPos, 1.0);
         }
@@ -561,11 +705,11 @@ void CADViewer::setupShaders()
         
         in vec3 FragPos;
         in vec3 Normal;
+        in vec4 ObjectColor;
         
         uniform vec3 lightPos;
         uniform vec3 viewPos;
         uniform vec3 lightColor;
-        uniform vec4 objectColor;
         
         void main()
         {
@@ -586,8 +730,8 @@ void CADViewer::setupShaders()
             float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
             vec3 specular = specularStrength * spec * lightColor;
             
-            vec3 result = (ambient + diffuse + specular) * objectColor.rgb;
-            FragColor = vec4(result, objectColor.a);
+            vec3 result = (ambient + diffuse + specular) * ObjectColor.rgb;
+            FragColor = vec4(result, ObjectColor.a);
         }
     )";
     
@@ -634,25 +778,173 @@ void CADViewer::setupShaders()
         qWarning() << "Grid shader program linking failed:" << m_gridShaderProgram->log();
     }
     
-    // Line shader (reuse grid shader for lines)
+    // Line shader (takes the model matrix as an attribute so assembly outlines can be instanced)
+    const char* lineVertexShaderSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+        layout (location = 2) in mat4 aModel;
+        
+        uniform mat4 view;
+        uniform mat4 projection;
+        
+        void main()
+        {
+            gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+        }
+    )";
+    
     m_lineShaderProgram = std::make_unique<QOpenGLShaderProgram>();
-    m_lineShaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, gridVertexShaderSource);
+    m_lineShaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, lineVertexShaderSource);
     m_lineShaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, gridFragmentShaderSource);
     
     if (!m_lineShaderProgram->link()) {
         qWarning() << "Line shader program linking failed:" << m_lineShaderProgram->log();
     }
+    
+    // Procedural grid: a full-screen triangle whose fragments are intersected with the grid
+    // planes, drawing lines analytically at a spacing chosen from the screen-space footprint
+    const char* infiniteGridVertexShaderSource = R"(
+        #version 330 core
+        uniform mat4 inverseViewProjection;
+        
+        out vec3 NearPoint;
+        out vec3 FarPoint;
+        
+        vec3 unproject(vec2 ndc, float depth)
+        {
+            vec4 point = inverseViewProjection * vec4(ndc, depth, 1.0);
+            return point.xyz / point.w;
+        }
+        
+        void main()
+        {
+            vec2 ndc = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+            NearPoint = unproject(ndc, -1.0);
+            FarPoint = unproject(ndc, 1.0);
+            gl_Position = vec4(ndc, 0.0, 1.0);
+        }
+    )";
+    
+    const char* infiniteGridFragmentShaderSource = R"(
+        #version 330 core
+        in vec3 NearPoint;
+        in vec3 FarPoint;
+        out vec4 FragColor;
+        
+        uniform mat4 viewProjection;
+        uniform vec3 cameraPosition;
+        uniform float gridSize;
+        uniform float fadeDistance;
+        // Index of each plane's normal axis (2 = XY, 1 = XZ, 0 = YZ) and its line color
+        uniform int planeCount;
+        uniform int planeAxis[3];
+        uniform vec4 planeColor[3];
+        
+        // Lines at least this many pixels apart; coarser levels are 10x the spacing
+        const float MIN_CELL_PIXELS = 8.0;
+        
+        float lineCoverage(vec2 coord, float spacing, vec2 footprint)
+        {
+            vec2 pixels = abs(fract(coord / spacing - 0.5) - 0.5) * spacing / footprint;
+            return 1.0 - min(min(pixels.x, pixels.y), 1.0);
+        }
+        
+        void main()
+        {
+            vec3 ray = FarPoint - NearPoint;
+            vec4 color = vec4(0.0);
+            float nearestT = 2.0;
+            
+            for (int i = 0; i < planeCount; ++i) {
+                int axis = planeAxis[i];
+                float t = -NearPoint[axis] / ray[axis];
+                vec3 point = NearPoint + t * ray;
+                vec2 coord = axis == 2 ? point.xy : (axis == 1 ? point.xz : point.yz);
+                // Derivatives are taken before any branch so neighbouring fragments agree
+                vec2 footprint = max(fwidth(coord), vec2(1e-6));
+                if (t <= 0.0 || t > 1.0) continue;
+                
+                // Level of detail from the world size of a pixel, blending out the finer level
+                float cellPixels = gridSize / max(footprint.x, footprint.y);
+                float lod = max(0.0, log(MIN_CELL_PIXELS / cellPixels) / log(10.0));
+                float spacing = gridSize * pow(10.0, floor(lod));
+                float coverage = max(lineCoverage(coord, spacing, footprint) * (1.0 - fract(lod)),
+                                     lineCoverage(coord, spacing * 10.0, footprint));
+                
+                float fade = 1.0 - smoothstep(0.5 * fadeDistance, fadeDistance, distance(point, cameraPosition));
+                float alpha = planeColor[i].a * coverage * fade;
+                if (alpha <= 0.0) continue;
+                
+                color.rgb += planeColor[i].rgb * alpha * (1.0 - color.a);
+                color.a += alpha * (1.0 - color.a);
+                nearestT = min(nearestT, t);
+            }
+            
+            if (color.a <= 0.0) discard;
+            
+            vec4 clip = viewProjection * vec4(NearPoint + nearestT * ray, 1.0);
+            gl_FragDepth = clamp(clip.z / clip.w * 0.5 + 0.5, 0.0, 1.0);
+            FragColor = vec4(color.rgb / color.a, color.a);
+        }
+    )";
+    
+    m_infiniteGridProgram = std::make_unique<QOpenGLShaderProgram>();
+    m_infiniteGridProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, infiniteGridVertexShaderSource);
+    m_infiniteGridProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, infiniteGridFragmentShaderSource);
+    
+    if (!m_infiniteGridProgram->link()) {
+        qWarning() << "Infinite grid shader program linking failed:" << m_infiniteGridProgram->log();
+    }
+    
+    // ID shader: the object ID comes from a uniform, the primitive ID is the triangle's index
+    // within its draw call
+    const char* pickVertexShaderSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 aPos;
+        layout (location = 2) in mat4 aModel;
+        
+        uniform mat4 view;
+        uniform mat4 projection;
+        
+        void main()
+        {
+            gl_Position = projection * view * aModel * vec4(aPos, 1.0);
+        }
+    )";
+    
+    const char* pickFragmentShaderSource = R"(
+        #version 330 core
+        layout (location = 0) out vec4 ObjectId;
+        layout (location = 1) out vec4 PrimitiveId;
+        
+        uniform vec4 objectId;
+        
+        void main()
+        {
+            uint id = uint(gl_PrimitiveID + 1) & 0xFFFFFFu;
+            ObjectId = objectId;
+            PrimitiveId = vec4(float(id & 255u), float((id >> 8) & 255u), float(id >> 16), 255.0) / 255.0;
+        }
+    )";
+    
+    m_pickShaderProgram = std::make_unique<QOpenGLShaderProgram>();
+    m_pickShaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, pickVertexShaderSource);
+    m_pickShaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, pickFragmentShaderSource);
+    
+    if (!m_pickShaderProgram->link()) {
+        qWarning() << "Pick shader program linking failed:" << m_pickShaderProgram->log();
+    }
 }
 
 void CADViewer::setupGeometry()
 {
-    m_vao.create();
-    m_vao.bind();
-    
-    m_vertexBuffer.create();
-    m_indexBuffer.create();
+    m_meshCache = std::make_unique<GpuMeshCache>();
+    m_meshCache->initialize(this);
+    m_meshCache->setProfiler(m_profiler.get());
     
-    m_vao.release();
+    // The grid triangle is generated from gl_VertexID, but core profiles still need a bound VAO
+    m_gridVao = std::make_unique<QOpenGLVertexArrayObject>();
+    m_gridVao->create();
 }
 
 void CADViewer::updateMatrices()
@@ -668,166 +960,87 @@ void CADViewer::updateMatrices()
 
 void CADViewer::renderGrid()
 {
-    if (!m_gridShaderProgram) return;
-    
-    m_gridShaderProgram->bind();
-    m_gridShaderProgram->setUniformValue("model", m_modelMatrix);
-    m_gridShaderProgram->setUniformValue("view", m_viewMatrix);
-    m_gridShaderProgram->setUniformValue("projection", m_projectionMatrix);
-    m_gridShaderProgram->setUniformValue("color", QVector3D(0.3f, 0.3f, 0.3f));
-    
-    // Draw grid lines
-    glLineWidth(1.0f);
-    glBegin(GL_LINES);
-    
-    float gridSize = m_gridSize;
-    int gridDivisions = 20;
-    float extent = gridSize * gridDivisions;
-    
-    // Draw based on current grid plane
-    switch (m_gridPlane) {
-    case GridPlane::XY_PLANE:
-        // Horizontal lines (X direction)
-        for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-            float y = i * gridSize;
-            glVertex3f(-extent, y, 0.0f);
-            glVertex3f(extent, y, 0.0f);
-        }
-        // Vertical lines (Y direction)
-        for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-            float x = i * gridSize;
-            glVertex3f(x, -extent, 0.0f);
-            glVertex3f(x, extent, 0.0f);
-        }
-        break;
-        
-    case GridPlane::XZ_PLANE:
-        // Lines in X direction
-        for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-            float z = i * gridSize;
-            glVertex3f(-extent, 0.0f, z);
-            glVertex3f(extent, 0.0f, z);
-        }
-        // Lines in Z direction
-        for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-            float x = i * gridSize;
-            glVertex3f(x, 0.0f, -extent);
-            glVertex3f(x, 0.0f, extent);
-        }
-        break;
-        
-    case GridPlane::YZ_PLANE:
-        // Lines in Y direction
-        for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-            float z = i * gridSize;
-            glVertex3f(0.0f, -extent, z);
-            glVertex3f(0.0f, extent, z);
-        }
-        // Lines in Z direction
-        for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-            float y = i * gridSize;
-            glVertex3f(0.0f, y, -extent);
-            glVertex3f(0.0f, y, extent);
-        }
-        break;
-    }
-    
-    glEnd();
-    m_gridShaderProgram->release();
+    const float primary[] = { 0.3f, 0.3f, 0.3f, 1.0f };
+    GridPlane planes[] = { m_gridPlane };
+    const float* colors[] = { primary };
+    drawInfiniteGrid(planes, colors, 1);
 }
 
 void CADViewer::renderMultiPlaneGrid()
 {
-    if (!m_gridShaderProgram) return;
-    
-    m_gridShaderProgram->bind();
-    m_gridShaderProgram->setUniformValue("model", m_modelMatrix);
-    m_gridShaderProgram->setUniformValue("view", m_viewMatrix);
-    m_gridShaderProgram->setUniformValue("projection", m_projectionMatrix);
-    
-    float gridSize = m_gridSize;
-    int gridDivisions = 20;
-    float extent = gridSize * gridDivisions;
-    
-    glLineWidth(1.0f);
+    GridPlane planes[3];
+    const float* colors[3];
+    int planeCount = 0;
     
     // Render each visible grid plane with different alpha values
+    static const float XY_COLOR[] = { 0.3f, 0.3f, 0.3f }; // Gray
+    static const float XZ_COLOR[] = { 0.3f, 0.2f, 0.2f }; // Reddish
+    static const float YZ_COLOR[] = { 0.2f, 0.3f, 0.2f }; // Greenish
+    float rgba[3][4];
     for (int planeIndex = 0; planeIndex < 3; ++planeIndex) {
         if (!m_visibleGridPlanes[planeIndex]) continue;
         
         GridPlane plane = static_cast<GridPlane>(planeIndex);
+        const float* rgb = plane == GridPlane::XY_PLANE ? XY_COLOR : (plane == GridPlane::XZ_PLANE ? XZ_COLOR : YZ_COLOR);
         
         // Set color with reduced alpha for non-primary planes
-        float alpha = (plane == m_gridPlane) ? 0.8f : 0.3f;
-        QVector3D color;
-        
-        switch (plane) {
-        case GridPlane::XY_PLANE:
-            color = QVector3D(0.3f, 0.3f, 0.3f); // Gray
-            break;
-        case GridPlane::XZ_PLANE:
-            color = QVector3D(0.3f, 0.2f, 0.2f); // Reddish
-            break;
-        case GridPlane::YZ_PLANE:
-            color = QVector3D(0.2f, 0.3f, 0.2f); // Greenish
-            break;
-        }
-        
-        m_gridShaderProgram->setUniformValue("color", color);
-        
-        glBegin(GL_LINES);
+        float* color = rgba[planeCount];
+        color[0] = rgb[0];
+        color[1] = rgb[1];
+        color[2] = rgb[2];
+        color[3] = (plane == m_gridPlane) ? 0.8f : 0.3f;
         
-        switch (plane) {
-        case GridPlane::XY_PLANE:
-            // Horizontal lines (X direction)
-            for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-                float y = i * gridSize;
-                glVertex3f(-extent, y, 0.0f);
-                glVertex3f(extent, y, 0.0f);
-            }
-            // Vertical lines (Y direction)
-            for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-                float x = i * gridSize;
-                glVertex3f(x, -extent, 0.0f);
-                glVertex3f(x, extent, 0.0f);
-            }
-            break;
-            
-        case GridPlane::XZ_PLANE:
-            // Lines in X direction
-            for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-                float z = i * gridSize;
-                glVertex3f(-extent, 0.0f, z);
-                glVertex3f(extent, 0.0f, z);
-            }
-            // Lines in Z direction
-            for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-                float x = i * gridSize;
-                glVertex3f(x, 0.0f, -extent);
-                glVertex3f(x, 0.0f, extent);
-            }
-            break;
-            
-        case GridPlane::YZ_PLANE:
-            // Lines in Y direction
-            for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-                float z = i * gridSize;
-                glVertex3f(0.0f, -extent, z);
-                glVertex3f(0.0f, extent, z);
-            }
-            // Lines in Z direction
-            for (int i = -gridDivisions; i <= gridDivisions; ++i) {
-                float y = i * gridSize;
-                glVertex3f(0.0f, y, -extent);
-                glVertex3f(0.0f, y, extent);
-            }
-            break;
+        planes[planeCount] = plane;
+        colors[planeCount] = color;
+        ++planeCount;
+    }
+    
+    drawInfiniteGrid(planes, colors, planeCount);
+}
+
+void CADViewer::drawInfiniteGrid(const GridPlane* planes, const float* const* colors, int planeCount)
+{
+    if (!m_infiniteGridProgram || !m_gridVao || planeCount <= 0) return;
+    
+    GLint axes[3];
+    QVector4D planeColors[3];
+    for (int i = 0; i < planeCount; ++i) {
+        switch (planes[i]) {
+        case GridPlane::XY_PLANE: axes[i] = 2; break;
+        case GridPlane::XZ_PLANE: axes[i] = 1; break;
+        case GridPlane::YZ_PLANE: axes[i] = 0; break;
         }
-        
-        glEnd();
+        planeColors[i] = QVector4D(colors[i][0], colors[i][1], colors[i][2], colors[i][3]);
     }
     
-    m_gridShaderProgram->release();
+    const QMatrix4x4 viewProjection = m_projectionMatrix * m_viewMatrix * m_modelMatrix;
+    
+    m_infiniteGridProgram->bind();
+    m_profiler->countShaderBind();
+    m_infiniteGridProgram->setUniformValue("viewProjection", viewProjection);
+    m_infiniteGridProgram->setUniformValue("inverseViewProjection", viewProjection.inverted());
+    m_infiniteGridProgram->setUniformValue("cameraPosition", m_cameraPosition);
+    m_infiniteGridProgram->setUniformValue("gridSize", m_gridSize);
+    // Far enough to reach the horizon when zoomed in, bounded by the far clip plane
+    m_infiniteGridProgram->setUniformValue("fadeDistance", std::min(std::max(m_cameraDistance * GRID_FADE_FACTOR, m_gridSize * 40.0f), GRID_FAR_PLANE));
+    m_infiniteGridProgram->setUniformValue("planeCount", planeCount);
+    m_infiniteGridProgram->setUniformValueArray("planeAxis", axes, planeCount);
+    m_infiniteGridProgram->setUniformValueArray("planeColor", planeColors, planeCount);
+    
+    // Both faces of the triangle must survive culling; wireframe mode must not apply to it
+    glDisable(GL_CULL_FACE);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    m_profiler->countStateChange(2);
+    
+    m_gridVao->bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_profiler->countDraw(1);
+    m_gridVao->release();
+    
+    glEnable(GL_CULL_FACE);
+    glPolygonMode(GL_FRONT_AND_BACK, m_wireframeMode ? GL_LINE : GL_FILL);
+    m_profiler->countStateChange(2);
+    m_infiniteGridProgram->release();
 }
 
 void CADViewer::renderAxes()
@@ -835,17 +1048,20 @@ void CADViewer::renderAxes()
     if (!m_gridShaderProgram) return;
     
     m_gridShaderProgram->bind();
+    m_profiler->countShaderBind();
     m_gridShaderProgram->setUniformValue("model", m_modelMatrix);
     m_gridShaderProgram->setUniformValue("view", m_viewMatrix);
     m_gridShaderProgram->setUniformValue("projection", m_projectionMatrix);
     
     glLineWidth(3.0f);
+    m_profiler->countStateChange();
     
     // X axis (red)
     m_gridShaderProgram->setUniformValue("color", QVector3D(1.0f, 0.0f, 0.0f));
     glBegin(GL_LINES);
     glVertex3f(0.0f, 0.0f, 0.0f);
     glVertex3f(2.0f, 0.0f, 0.0f);
+    m_profiler->countDraw(0);
     glEnd();
     
     // Y axis (green)
@@ -853,6 +1069,7 @@ void CADViewer::renderAxes()
     glBegin(GL_LINES);
     glVertex3f(0.0f, 0.0f, 0.0f);
     glVertex3f(0.0f, 2.0f, 0.0f);
+    m_profiler->countDraw(0);
     glEnd();
     
     // Z axis (blue)
@@ -860,9 +1077,11 @@ void CADViewer::renderAxes()
     glBegin(GL_LINES);
     glVertex3f(0.0f, 0.0f, 0.0f);
     glVertex3f(0.0f, 0.0f, 2.0f);
+    m_profiler->countDraw(0);
     glEnd();
     
     glLineWidth(1.0f);
+    m_profiler->countStateChange();
     m_gridShaderProgram->release();
 }
 
@@ -871,66 +1090,113 @@ void CADViewer::renderObjects()
     if (!m_shaderProgram) return;
     
     m_shaderProgram->bind();
-    m_shaderProgram->setUniformValue("model", m_modelMatrix);
+    m_profiler->countShaderBind();
     m_shaderProgram->setUniformValue("view", m_viewMatrix);
     m_shaderProgram->setUniformValue("projection", m_projectionMatrix);
     m_shaderProgram->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
     m_shaderProgram->setUniformValue("viewPos", m_cameraPosition);
     m_shaderProgram->setUniformValue("lightColor", QVector3D(1.0f, 1.0f, 1.0f));
+    setModelAttribute(m_modelMatrix);
     
-    // First pass: determine which objects should be transparent
-    std::set<CADObjectPtr> transparentObjects;
+    // Bounds and containment links of objects edited since the last frame
+    m_spatialIndex->refresh();
     
     // Make objects transparent during active shape placement or eraser mode
     bool isPlacingShape = (m_placementState != PlacementState::NONE || m_eraserMode);
     
-    // Check for objects that contain other objects (outer shapes should be transparent)
-    for (const auto& outerObject : m_objects) {
-        if (!outerObject || !outerObject->isVisible()) continue;
-        
-        for (const auto& innerObject : m_objects) {
-            if (!innerObject || !innerObject->isVisible() || outerObject == innerObject) continue;
-            
-            if (objectContainsObject(outerObject, innerObject)) {
-                transparentObjects.insert(outerObject);
-            }
-        }
-    }
+    // Culling uses the index's world bounds, which cover the tessellation
+    const Frustum frustum = Frustum::fromMatrix(m_projectionMatrix * m_viewMatrix * m_modelMatrix);
+    int visibleCount = 0;
+    int frustumCulled = 0;
+    int sizeCulled = 0;
     
-    // Render all objects
+    // Opaque objects draw in scene order; blended ones are collected and drawn afterwards
+    m_transparentScratch.clear();
     for (const auto& object : m_objects) {
         if (object && object->isVisible()) {
-            Material mat = object->getMaterial();
-            QVector4D color(mat.diffuseColor.redF(), mat.diffuseColor.greenF(), mat.diffuseColor.blueF(), 1.0f);
-
+            ++visibleCount;
+            AABB bounds;
+            if (m_spatialIndex->getBounds(object.get(), bounds) && bounds.isValid()) {
+                if (!frustum.intersects(bounds)) {
+                    ++frustumCulled;
+                    continue;
+                }
+                // Selected objects stay drawn so their outline remains findable
+                if (!object->isSelected() && projectedRadiusPixels(bounds.min, bounds.max) < CULL_MIN_PIXELS) {
+                    ++sizeCulled;
+                    continue;
+                }
+            }
+            
             // Apply transparency rules:
             // 1. During shape placement/eraser mode, make existing objects transparent
             // 2. Make outer objects transparent when they contain inner objects
-            if (isPlacingShape || transparentObjects.count(object) > 0) {
-                color.setW(0.5f); // Make transparent
-            } else {
-                color.setW(1.0f - mat.transparency);
+            float alphaOverride = -1.0f;
+            if (isPlacingShape || m_spatialIndex->containsVisibleObject(object.get())) {
+                alphaOverride = 0.5f;
             }
-            // Otherwise, objects remain fully opaque (alpha = 1.0f)
             
-            m_shaderProgram->setUniformValue("objectColor", color);
-            object->render();
-
-            if (object->isSelected()) {
-                renderSelectionOutline(object);
+            if (alphaOverride >= 0.0f || object->getMaterial().transparency > 0.0f) {
+                m_transparentScratch.push_back({ object, object->getGeometryRevision(), alphaOverride, 0.0f });
+                continue;
             }
+            drawSceneObject(object, alphaOverride);
         }
     }
     
+    // Blending needs far-to-near order; it only changes with the camera or the blended set
+    auto sameDraw = [](const TransparentDraw& a, const TransparentDraw& b) {
+        return a.object == b.object && a.revision == b.revision && a.alphaOverride == b.alphaOverride;
+    };
+    bool sameSet = m_transparentScratch.size() == m_transparentSceneOrder.size() &&
+                   std::equal(m_transparentScratch.begin(), m_transparentScratch.end(),
+                              m_transparentSceneOrder.begin(), sameDraw);
+    if (!sameSet || m_cameraPosition != m_transparentSortCamera) {
+        std::swap(m_transparentSceneOrder, m_transparentScratch);
+        m_transparentSortCamera = m_cameraPosition;
+        m_transparentDrawOrder = m_transparentSceneOrder;
+        for (auto& draw : m_transparentDrawOrder) {
+            QVector3D center = (draw.object->getBoundingBoxMin().toQVector3D() + draw.object->getBoundingBoxMax().toQVector3D()) * 0.5f;
+            draw.depth = (m_modelMatrix.map(center) - m_cameraPosition).lengthSquared();
+        }
+        std::stable_sort(m_transparentDrawOrder.begin(), m_transparentDrawOrder.end(),
+                         [](const TransparentDraw& a, const TransparentDraw& b) { return a.depth > b.depth; });
+    }
+    
+    for (const auto& draw : m_transparentDrawOrder) {
+        drawSceneObject(draw.object, draw.alphaOverride);
+    }
+    m_profiler->countObjects(visibleCount - frustumCulled - sizeCulled, frustumCulled, sizeCulled);
+    
+    // Primitives still retessellating show their previous mesh; look again shortly
+    if (m_meshCache && m_meshCache->takePendingTessellations() > 0) {
+        requestFrameAfter(TESSELLATION_POLL_INTERVAL_MS);
+    }
+    
     m_shaderProgram->release();
 }
 
+void CADViewer::drawSceneObject(const CADObjectPtr& object, float alphaOverride)
+{
+    const Material& mat = object->getMaterial();
+    QVector4D color(mat.diffuseColor.redF(), mat.diffuseColor.greenF(), mat.diffuseColor.blueF(),
+                    alphaOverride >= 0.0f ? alphaOverride : 1.0f - mat.transparency);
+    setObjectColor(color);
+    drawObjectGeometry(object, false, alphaOverride);
+    
+    if (object->isSelected()) {
+        renderSelectionOutline(object);
+        m_shaderProgram->bind();
+        m_profiler->countShaderBind();
+    }
+}
+
 void CADViewer::renderSelectionOutline(CADObjectPtr object)
 {
     if (!m_lineShaderProgram || !object) return;
 
     m_lineShaderProgram->bind();
-    m_lineShaderProgram->setUniformValue("model", m_modelMatrix);
+    m_profiler->countShaderBind();
     m_lineShaderProgram->setUniformValue("view", m_viewMatrix);
     m_lineShaderProgram->setUniformValue("projection", m_projectionMatrix);
     m_lineShaderProgram->setUniformValue("color", QVector3D(1.0f, 0.0f, 0.0f)); // Red color for selection
@@ -938,15 +1204,136 @@ void CADViewer::renderSelectionOutline(CADObjectPtr object)
     glLineWidth(5.0f); // Thicker line for glow effect
     glDepthMask(GL_FALSE); // Disable depth writes to ensure outline is always visible
     glDisable(GL_DEPTH_TEST); // Disable depth test
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    m_profiler->countStateChange(4);
 
-    object->render(); // Render the object's wireframe
+    drawObjectGeometry(object); // Render the object's wireframe
 
+    glPolygonMode(GL_FRONT_AND_BACK, m_wireframeMode ? GL_LINE : GL_FILL);
     glEnable(GL_DEPTH_TEST); // Re-enable depth test
     glDepthMask(GL_TRUE); // Re-enable depth writes
     glLineWidth(1.0f);
+    m_profiler->countStateChange(4);
     m_lineShaderProgram->release();
 }
 
+void CADViewer::drawObjectGeometry(const CADObjectPtr& object, bool transient, float alphaOverride)
+{
+    if (!object) return;
+    
+    // Assemblies draw each unique part once, instanced over its transforms
+    if (m_meshCache && object->getType() == ObjectType::ASSEMBLY) {
+        auto assembly = std::static_pointer_cast<Assembly>(object);
+        m_meshCache->drawAssembly(assembly.get(), alphaOverride,
+            [this](const CADObject& part, const QMatrix4x4& transform, const QColor& color) {
+                setModelAttribute(transform);
+                setObjectColor(QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF()));
+                part.render();
+            });
+        // Attribute values are undefined after drawing from an enabled instance array
+        setModelAttribute(m_modelMatrix);
+        return;
+    }
+    
+    // Objects without a render mesh fall back to their immediate-mode path
+    bool drawn = false;
+    if (m_meshCache) {
+        drawn = transient ? m_meshCache->drawTransient(object.get()) : m_meshCache->draw(selectLevelOfDetail(object));
+    }
+    if (!drawn) {
+        object->render();
+        // Immediate-mode geometry; its primitive count is not known here
+        m_profiler->countDraw(0);
+    }
+}
+
+void CADViewer::setModelAttribute(const QMatrix4x4& model)
+{
+    // The cache owns the constant model attribute so shared primitive meshes can be placed under it
+    if (m_meshCache) {
+        m_meshCache->setModelAttribute(model);
+        return;
+    }
+    for (int column = 0; column < 4; ++column) {
+        QVector4D values = model.column(column);
+        glVertexAttrib4f(GpuMeshCache::MODEL_LOCATION + column, values.x(), values.y(), values.z(), values.w());
+    }
+}
+
+void CADViewer::setObjectColor(const QVector4D& color)
+{
+    glVertexAttrib4f(GpuMeshCache::COLOR_LOCATION, color.x(), color.y(), color.z(), color.w());
+}
+
+const CADObject* CADViewer::selectLevelOfDetail(const CADObjectPtr& object)
+{
+    if (object->getType() != ObjectType::MESH) return object.get();
+    
+    auto mesh = std::static_pointer_cast<MeshObject>(object);
+    if (mesh->faceCount() < LOD_MIN_FACES) return object.get();
+    
+    LodChain& chain = m_lodChains[object.get()];
+    const uint64_t revision = object->getGeometryRevision();
+    if (chain.revision != revision) {
+        releaseLevelsOfDetail(object.get());
+        LodChain& fresh = m_lodChains[object.get()];
+        fresh.revision = revision;
+        
+        // The decimator copies the mesh here, so later edits cannot race the background run
+        auto decimator = std::make_shared<MeshDecimator>(*mesh);
+        std::string name = mesh->getName();
+        fresh.pending = ThreadPool::instance().submit([decimator, name]() {
+            return decimator->buildLodChain({ 0.5f, 0.25f, 0.1f }, name);
+        });
+        requestFrameAfter(LOD_POLL_INTERVAL_MS);
+        return object.get();
+    }
+    
+    if (chain.pending.valid()) {
+        if (chain.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            // Check back until the levels arrive
+            requestFrameAfter(LOD_POLL_INTERVAL_MS);
+            return object.get();
+        }
+        chain.levels = chain.pending.get();
+    }
+    if (chain.levels.empty()) return object.get();
+    
+    float pixels = projectedRadiusPixels(object->getBoundingBoxMin().toQVector3D(), object->getBoundingBoxMax().toQVector3D());
+    float threshold = LOD_FULL_DETAIL_PIXELS;
+    int level = -1;
+    while (level + 1 < static_cast<int>(chain.levels.size()) && pixels < threshold) {
+        ++level;
+        threshold *= 0.5f;
+    }
+    return level < 0 ? object.get() : chain.levels[level].get();
+}
+
+float CADViewer::projectedRadiusPixels(const QVector3D& boundsMin, const QVector3D& boundsMax) const
+{
+    // Projected radius of the bounding sphere; unbounded when the camera is inside it
+    QVector3D center = m_modelMatrix.map((boundsMin + boundsMax) * 0.5f);
+    float radius = (boundsMax - boundsMin).length() * 0.5f;
+    float distance = (center - m_cameraPosition).length();
+    if (distance <= radius) return std::numeric_limits<float>::max();
+    
+    return radius / (distance * std::tan(FIELD_OF_VIEW * 0.5f * M_PI / 180.0)) * height() * 0.5f;
+}
+
+void CADViewer::releaseLevelsOfDetail(const CADObject* object)
+{
+    auto it = m_lodChains.find(object);
+    if (it == m_lodChains.end()) return;
+    
+    if (m_meshCache) {
+        for (const auto& level : it->second.levels) {
+            m_meshCache->release(level.get());
+        }
+    }
+    // A pending build is abandoned; its future does not block
+    m_lodChains.erase(it);
+}
+
 void CADViewer::updateCameraPosition()
 {
     // Calculate camera position relative to target using spherical coordinates
@@ -990,8 +1377,165 @@ void CADViewer::zoomCamera(float delta)
 
 CADObjectPtr CADViewer::pickObject(const QPoint& screenPos)
 {
+    // The ID buffer picks exactly what was drawn at the pixel
+    std::vector<uint32_t> ids;
+    if (readPickIds(QRect(screenPos.x(), screenPos.y(), 1, 1), ids)) {
+        if (ids.empty() || ids[0] == 0 || ids[0] > m_pickEntries.size()) return nullptr;
+        return m_pickEntries[ids[0] - 1].object;
+    }
+    
+    // Without framebuffer objects, fall back to a triangle-exact ray cast through the index
     QVector3D rayOrigin, rayDirection;
+    screenRay(screenPos, rayOrigin, rayDirection);
+
+    m_spatialIndex->refresh();
+    float distance;
+    return m_spatialIndex->raycast(rayOrigin, rayDirection, distance);
+}
+
+std::vector<CADObjectPtr> CADViewer::pickObjectsInRect(const QRect& rect)
+{
+    std::vector<CADObjectPtr> objects;
+    QRect area = rect.normalized();
+    
+    std::vector<uint32_t> ids;
+    if (readPickIds(QRect(area.x(), area.y(), std::max(area.width(), 1), std::max(area.height(), 1)), ids)) {
+        std::vector<char> seen(m_pickEntries.size() + 1, 0);
+        for (uint32_t id : ids) {
+            if (id == 0 || id > m_pickEntries.size() || seen[id]) continue;
+            seen[id] = 1;
+            objects.push_back(m_pickEntries[id - 1].object);
+        }
+        return objects;
+    }
     
+    // Without the ID buffer, take objects whose bounds center projects into the rectangle
+    for (const auto& object : m_objects) {
+        if (!object || !object->isVisible()) continue;
+        QVector3D center = (object->getBoundingBoxMin().toQVector3D() + object->getBoundingBoxMax().toQVector3D()) * 0.5f;
+        if (area.contains(worldToScreen(center))) {
+            objects.push_back(object);
+        }
+    }
+    return objects;
+}
+
+bool CADViewer::pickMeshElement(const QPoint& screenPos, MeshManager& manager, bool addToSelection)
+{
+    QVector3D rayOrigin, rayDirection;
+    screenRay(screenPos, rayOrigin, rayDirection);
+    const Point3D origin(rayOrigin.x(), rayOrigin.y(), rayOrigin.z());
+    const Vector3D direction(rayDirection.x(), rayDirection.y(), rayDirection.z());
+    
+    bool selected = false;
+    std::vector<uint32_t> objectIds, primitiveIds;
+    if (readPickIds(QRect(screenPos.x(), screenPos.y(), 1, 1), objectIds, &primitiveIds)) {
+        if (objectIds.empty() || objectIds[0] == 0 || objectIds[0] > m_pickEntries.size()) return false;
+        
+        const PickEntry& entry = m_pickEntries[objectIds[0] - 1];
+        auto mesh = std::dynamic_pointer_cast<MeshObject>(entry.object);
+        if (!mesh) return false;
+        
+        if (entry.renderMeshTriangles && primitiveIds[0] != 0) {
+            int face = mesh->faceForRenderTriangle(static_cast<int>(primitiveIds[0] - 1));
+            selected = face >= 0 && manager.selectOnFace(mesh, face, origin, direction, addToSelection);
+        } else {
+            selected = manager.selectByRay(mesh, origin, direction);
+        }
+    } else {
+        m_spatialIndex->refresh();
+        float distance;
+        auto mesh = std::dynamic_pointer_cast<MeshObject>(m_spatialIndex->raycast(rayOrigin, rayDirection, distance));
+        selected = mesh && manager.selectByRay(mesh, origin, direction);
+    }
+    
+    if (selected) {
+        requestFrame();
+    }
+    return selected;
+}
+
+bool CADViewer::readPickIds(const QRect& rect, std::vector<uint32_t>& objectIds, std::vector<uint32_t>* primitiveIds)
+{
+    if (!m_meshCache || !m_pickShaderProgram || !m_pickShaderProgram->isLinked()) return false;
+    
+    makeCurrent();
+    const qreal ratio = devicePixelRatioF();
+    if (!m_pickBuffer->resize(QSize(qRound(width() * ratio), qRound(height() * ratio)))) {
+        doneCurrent();
+        return false;
+    }
+    
+    m_pickBuffer->bind();
+    if (!m_pickBuffer->isCurrent()) {
+        renderPickBuffer();
+        m_pickBuffer->setCurrent(true);
+    }
+    
+    // Widget coordinates to framebuffer pixels, keeping at least one pixel
+    QRect pixels(static_cast<int>(std::floor(rect.x() * ratio)), static_cast<int>(std::floor(rect.y() * ratio)),
+                 std::max(1, qRound(rect.width() * ratio)), std::max(1, qRound(rect.height() * ratio)));
+    bool read = m_pickBuffer->readIds(PickBuffer::OBJECT_ATTACHMENT, pixels, objectIds);
+    if (read && primitiveIds) {
+        read = m_pickBuffer->readIds(PickBuffer::PRIMITIVE_ATTACHMENT, pixels, *primitiveIds);
+    }
+    
+    m_pickBuffer->release(defaultFramebufferObject());
+    glViewport(0, 0, qRound(width() * ratio), qRound(height() * ratio));
+    doneCurrent();
+    
+    // A rectangle entirely outside the viewport reads nothing, which is not a failure
+    if (!read) objectIds.clear();
+    return true;
+}
+
+void CADViewer::renderPickBuffer()
+{
+    m_pickEntries.clear();
+    m_pickBuffer->clear();
+    // The camera may have moved since the last frame
+    updateMatrices();
+    
+    // IDs must reach the target unblended and with every triangle filled
+    glDisable(GL_BLEND);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    
+    m_pickShaderProgram->bind();
+    m_pickShaderProgram->setUniformValue("view", m_viewMatrix);
+    m_pickShaderProgram->setUniformValue("projection", m_projectionMatrix);
+    setModelAttribute(m_modelMatrix);
+    
+    m_spatialIndex->refresh();
+    const Frustum frustum = Frustum::fromMatrix(m_projectionMatrix * m_viewMatrix * m_modelMatrix);
+    
+    for (const auto& object : m_objects) {
+        if (!object || !object->isVisible()) continue;
+        AABB bounds;
+        if (m_spatialIndex->getBounds(object.get(), bounds) && bounds.isValid() && !frustum.intersects(bounds)) continue;
+        if (m_pickEntries.size() >= PickBuffer::MAX_ID) break;
+        
+        m_pickEntries.push_back({ object, false });
+        m_pickShaderProgram->setUniformValue("objectId", PickBuffer::encodeId(static_cast<uint32_t>(m_pickEntries.size())));
+        
+        // Full detail rather than a LOD, so primitive IDs map back to the object's faces
+        if (object->getType() == ObjectType::ASSEMBLY) {
+            drawObjectGeometry(object);
+        } else if (m_meshCache->draw(object.get())) {
+            m_pickEntries.back().renderMeshTriangles = true;
+        } else {
+            object->render();
+        }
+    }
+    
+    m_pickShaderProgram->release();
+    glPolygonMode(GL_FRONT_AND_BACK, m_wireframeMode ? GL_LINE : GL_FILL);
+    glEnable(GL_BLEND);
+    
+    glClearColor(m_backgroundColor.redF(), m_backgroundColor.greenF(), m_backgroundColor.blueF(), 1.0f);
+}
+
+void CADViewer::screenRay(const QPoint& screenPos, QVector3D& rayOrigin, QVector3D& rayDirection) const
+{
     QMatrix4x4 viewProjectionMatrix = m_projectionMatrix * m_viewMatrix;
     QMatrix4x4 invViewProjectionMatrix = viewProjectionMatrix.inverted();
 
@@ -1009,20 +1553,6 @@ CADObjectPtr CADViewer::pickObject(const QPoint& screenPos)
 
     rayOrigin = QVector3D(nearWorld);
     rayDirection = (QVector3D(farWorld) - rayOrigin).normalized();
-
-    float minDistance = std::numeric_limits<float>::max();
-    CADObjectPtr pickedObject = nullptr;
-
-    for (const auto& object : m_objects) {
-        float distance;
-        if (rayIntersectsObject(rayOrigin, rayDirection, object, distance)) {
-            if (distance < minDistance) {
-                minDistance = distance;
-                pickedObject = object;
-            }
-        }
-    }
-    return pickedObject;
 }
 
 bool CADViewer::rayIntersectsObject(const QVector3D& rayOrigin, const QVector3D& rayDirection, 
@@ -1130,74 +1660,74 @@ void CADViewer::resetView()
     m_cameraRotationX = 0.0f;
     m_cameraRotationY = 0.0f;
     m_cameraTarget = QVector3D(0, 0, 0);
-    update();
+    requestFrame();
 }
 
 void CADViewer::frontView()
 {
     m_cameraRotationX = 0.0f;
     m_cameraRotationY = 0.0f;
-    update();
+    requestFrame();
 }
 
 void CADViewer::backView()
 {
     m_cameraRotationX = M_PI;
     m_cameraRotationY = 0.0f;
-    update();
+    requestFrame();
 }
 
 void CADViewer::leftView()
 {
     m_cameraRotationX = -M_PI/2;
     m_cameraRotationY = 0.0f;
-    update();
+    requestFrame();
 }
 
 void CADViewer::rightView()
 {
     m_cameraRotationX = M_PI/2;
     m_cameraRotationY = 0.0f;
-    update();
+    requestFrame();
 }
 
 void CADViewer::topView()
 {
     m_cameraRotationX = 0.0f;
     m_cameraRotationY = M_PI/2;
-    update();
+    requestFrame();
 }
 
 void CADViewer::bottomView()
 {
     m_cameraRotationX = 0.0f;
     m_cameraRotationY = -M_PI/2;
-    update();
+    requestFrame();
 }
 
 void CADViewer::isometricView()
 {
     m_cameraRotationX = M_PI/4;
     m_cameraRotationY = M_PI/6;
-    update();
+    requestFrame();
 }
 
 void CADViewer::setWireframeMode(bool enabled)
 {
     m_wireframeMode = enabled;
-    update();
+    requestFrame();
 }
 
 void CADViewer::setGridVisible(bool visible)
 {
     m_showGrid = visible;
-    update();
+    requestFrame();
 }
 
 void CADViewer::setAxesVisible(bool visible)
 {
     m_showAxes = visible;
-    update();
+    requestFrame();
 }
 
 void CADViewer::setBackgroundColor(const QColor& color)
@@ -1206,14 +1736,17 @@ void CADViewer::setBackgroundColor(const QColor& color)
     makeCurrent();
     glClearColor(color.redF(), color.greenF(), color.blueF(), 1.0f);
     doneCurrent();
-    update();
+    requestFrame();
 }
 
 void CADViewer::addObject(CADObjectPtr object)
 {
     if (object) {
         m_objects.push_back(object);
-        update();
+        m_spatialIndex->addObject(object);
+        m_dependencyGraph->addNode(object.get());
+        emit objectAdded(object);
+        requestFrame();
     }
 }
 
@@ -1221,16 +1754,71 @@ void CADViewer::removeObject(CADObjectPtr object)
 {
     auto it = std::find(m_objects.begin(), m_objects.end(), object);
     if (it != m_objects.end()) {
+        if (m_meshCache) {
+            m_meshCache->release(object.get());
+        }
+        releaseLevelsOfDetail(object.get());
+        m_spatialIndex->removeObject(object.get());
+        // The blended draw lists hold references until they are rebuilt
+        m_transparentSceneOrder.clear();
+        m_transparentDrawOrder.clear();
         m_objects.erase(it);
-        update();
+        m_dependencyGraph->removeNode(object.get());
+        emit objectRemoved(object);
+        requestFrame();
+    }
+}
+
+void CADViewer::updateObject(CADObjectPtr object)
+{
+    if (object) {
+        // Edits can add parts or operands, not only change parameters
+        m_dependencyGraph->relink(object.get());
+        queueSpatialUpdate(object.get());
+        requestFrame();
+    }
+}
+
+void CADViewer::refreshObjects(const std::vector<CADObjectPtr>& objects)
+{
+    for (const auto& object : objects) {
+        if (object) queueSpatialUpdate(object.get());
+    }
+    if (!objects.empty()) {
+        requestFrame();
+    }
+}
+
+void CADViewer::queueSpatialUpdate(const CADObject* object)
+{
+    // Booleans and assemblies take their revision from what they are built from
+    std::unordered_set<const CADObject*> visited;
+    std::vector<const CADObject*> stack = { object };
+    while (!stack.empty()) {
+        const CADObject* current = stack.back();
+        stack.pop_back();
+        if (!visited.insert(current).second) continue;
+        m_spatialIndex->updateObject(current);
+        for (const CADObject* dependent : m_dependencyGraph->dependents(current)) {
+            stack.push_back(dependent);
+        }
     }
 }
 
 void CADViewer::clearObjects()
 {
+    if (m_meshCache) {
+        m_meshCache->releaseAll();
+    }
+    m_lodChains.clear();
+    m_spatialIndex->clear();
+    m_transparentSceneOrder.clear();
+    m_transparentDrawOrder.clear();
     m_objects.clear();
+    m_dependencyGraph->clear();
     m_selectedObjects.clear();
-    update();
+    emit objectsCleared();
+    requestFrame();
 }
 
 void CADViewer::selectObject(CADObjectPtr object)
@@ -1241,7 +1829,7 @@ void CADViewer::selectObject(CADObjectPtr object)
         object->setSelected(true);
         emit objectSelected(object);
         emit selectionChanged();
-        update();
+        requestFrame();
     }
 }
 
@@ -1255,7 +1843,25 @@ void CADViewer::deselectAll()
     }
     m_selectedObjects.clear();
     emit selectionChanged();
-    update();
+    requestFrame();
+}
+
+void CADViewer::setSelectedObjects(const std::vector<CADObjectPtr>& objects)
+{
+    for (auto& object : m_selectedObjects) {
+        if (object) {
+            object->setSelected(false);
+        }
+    }
+    m_selectedObjects.clear();
+    for (const auto& object : objects) {
+        if (object) {
+            m_selectedObjects.push_back(object);
+            object->setSelected(true);
+        }
+    }
+    emit selectionChanged();
+    requestFrame();
 }
 
 void CADViewer::selectAll()
@@ -1269,7 +1875,7 @@ void CADViewer::selectAll()
         }
     }
     emit selectionChanged();
-    update();
+    requestFrame();
 }
 
 void CADViewer::deleteSelected()
@@ -1279,7 +1885,7 @@ void CADViewer::deleteSelected()
     }
     m_selectedObjects.clear();
     emit selectionChanged();
-    update();
+    requestFrame();
 }
 
 // Sketching functionality
@@ -1342,7 +1948,7 @@ void CADViewer::cancelCurrentSketch()
 {
     m_isSketchingActive = false;
     m_sketchPoints.clear();
-    update();
+    requestFrame();
 }
 
 void CADViewer::handleSketchClick(const QPoint& screenPos)
@@ -1382,7 +1988,7 @@ void CADViewer::handleSketchClick(const QPoint& screenPos)
         break;
     }
     
-    update();
+    requestFrame();
 }
 
 void CADViewer::updateSketchPreview(const QPoint& screenPos)
@@ -1400,7 +2006,7 @@ void CADViewer::updateSketchPreview(const QPoint& screenPos)
         m_sketchPoints[1] = worldPos;
     }
     
-    update();
+    requestFrame();
 }
 
 CADObjectPtr CADViewer::createLineFromPoints(const QVector3D& startPoint, const QVector3D& endPoint)
@@ -1465,12 +2071,13 @@ void CADViewer::renderSketchPreview()
     if (!m_lineShaderProgram) return;
     
     m_lineShaderProgram->bind();
-    m_lineShaderProgram->setUniformValue("model", m_modelMatrix);
+    m_profiler->countShaderBind();
     m_lineShaderProgram->setUniformValue("view", m_viewMatrix);
     m_lineShaderProgram->setUniformValue("projection", m_projectionMatrix);
     m_lineShaderProgram->setUniformValue("color", QVector3D(1.0f, 1.0f, 0.0f)); // Yellow preview
     
     glLineWidth(2.0f);
+    m_profiler->countStateChange();
     
     switch (m_activeTool) {
     case ActiveTool::SKETCH_LINE:
@@ -1478,6 +2085,7 @@ void CADViewer::renderSketchPreview()
             glBegin(GL_LINES);
             glVertex3f(m_sketchPoints[0].x(), m_sketchPoints[0].y(), m_sketchPoints[0].z());
             glVertex3f(m_sketchPoints[1].x(), m_sketchPoints[1].y(), m_sketchPoints[1].z());
+            m_profiler->countDraw(0);
             glEnd();
         }
         break;
@@ -1491,6 +2099,7 @@ void CADViewer::renderSketchPreview()
             glVertex3f(p2.x(), p1.y(), p1.z());
             glVertex3f(p2.x(), p2.y(), p1.z());
             glVertex3f(p1.x(), p2.y(), p1.z());
+            m_profiler->countDraw(0);
             glEnd();
         }
         break;
@@ -1509,6 +2118,7 @@ void CADViewer::renderSketchPreview()
                 float y = center.y() + radius * sin(angle);
                 glVertex3f(x, y, center.z());
             }
+            m_profiler->countDraw(0);
             glEnd();
         }
         break;
@@ -1518,6 +2128,7 @@ void CADViewer::renderSketchPreview()
     }
     
     glLineWidth(1.0f);
+    m_profiler->countStateChange();
     m_lineShaderProgram->release();
 }
 
@@ -1526,17 +2137,20 @@ void CADViewer::renderLine(const QVector3D& start, const QVector3D& end, float t
     if (!m_lineShaderProgram) return;
     
     m_lineShaderProgram->bind();
-    m_lineShaderProgram->setUniformValue("model", m_modelMatrix);
+    m_profiler->countShaderBind();
     m_lineShaderProgram->setUniformValue("view", m_viewMatrix);
     m_lineShaderProgram->setUniformValue("projection", m_projectionMatrix);
     m_lineShaderProgram->setUniformValue("color", QVector3D(1.0f, 1.0f, 1.0f));
     
     glLineWidth(thickness);
+    m_profiler->countStateChange();
     glBegin(GL_LINES);
     glVertex3f(start.x(), start.y(), start.z());
     glVertex3f(end.x(), end.y(), end.z());
+    m_profiler->countDraw(0);
     glEnd();
     glLineWidth(1.0f);
+    m_profiler->countStateChange();
     
     m_lineShaderProgram->release();
 }
@@ -1568,20 +2182,20 @@ void CADViewer::setupNavigationCube()
 void CADViewer::setGridPlane(GridPlane plane)
 {
     m_gridPlane = plane;
-    update();
+    requestFrame();
 }
 
 void CADViewer::setMultiPlaneGridVisible(bool visible)
 {
     m_showMultiPlaneGrid = visible;
-    update();
+    requestFrame();
 }
 
 void CADViewer::toggleGridPlane(GridPlane plane)
 {
     int index = static_cast<int>(plane);
     m_visibleGridPlanes[index] = !m_visibleGridPlanes[index];
-    update();
+    requestFrame();
 }
 
 bool CADViewer::isGridPlaneVisible(GridPlane plane) const
@@ -1593,7 +2207,7 @@ bool CADViewer::isGridPlaneVisible(GridPlane plane) const
 void CADViewer::setGridSize(float size)
 {
     m_gridSize = size;
-    update();
+    requestFrame();
 }
 
 // Snap functionality
@@ -1641,7 +2255,7 @@ void CADViewer::setActiveTool(ActiveTool tool)
             emit statusMessageChanged("Navigation Mode");
         }
         
-        update();
+        requestFrame();
     }
 }
 
@@ -1660,7 +2274,7 @@ void CADViewer::cancelShapePlacement()
 {
     m_placementState = PlacementState::NONE;
     // Preview object removed
-    update();
+    requestFrame();
 }
 
 // Shape placement workflow
@@ -1694,7 +2308,7 @@ void CADViewer::updatePlacementPreview(const QPoint& screenPos)
         QVector3D worldPos = screenToWorld(screenPos);
         worldPos = applySnapping(worldPos, screenPos);
         m_placementEndPoint = worldPos;
-        update();
+        requestFrame();
     }
 }
 
@@ -1836,14 +2450,14 @@ void CADViewer::startExtrusionMode(CADObjectPtr object)
         m_extrusionObject = object;
         m_activeTool = ActiveTool::EXTRUDE_2D;
         emit extrusionStarted(object);
-        update();
+        requestFrame();
     }
 }
 
 void CADViewer::setExtrusionDistance(float distance)
 {
     m_extrusionDistance = distance;
-    update();
+    requestFrame();
 }
 
 void CADViewer::finishExtrusion()
@@ -1887,7 +2501,7 @@ void CADViewer::finishExtrusion()
         
         m_extrusionObject.reset();
         m_activeTool = ActiveTool::SELECT;
-        update();
+        requestFrame();
     }
 }
 
@@ -1915,7 +2529,7 @@ void CADViewer::updateExtrusionPreview(const QPoint& screenPos)
         // Limit the distance to reasonable bounds
         m_extrusionDistance = std::max(0.1f, std::min(10.0f, distance));
         
-        update();
+        requestFrame();
     }
 }
 
@@ -2015,20 +2629,6 @@ bool CADViewer::objectsIntersect(CADObjectPtr obj1, CADObjectPtr obj2)
            (min1.z <= max2.z && max1.z >= min2.z);
 }
 
-bool CADViewer::objectContainsObject(CADObjectPtr outer, CADObjectPtr inner)
-{
-    if (!outer || !inner) return false;
-    
-    Point3D min_outer = outer->getBoundingBoxMin();
-    Point3D max_outer = outer->getBoundingBoxMax();
-    Point3D min_inner = inner->getBoundingBoxMin();
-    Point3D max_inner = inner->getBoundingBoxMax();
-    
-    return (min_inner.x >= min_outer.x && max_inner.x <= max_outer.x &&
-            min_inner.y >= min_outer.y && max_inner.y <= max_outer.y &&
-            min_inner.z >= min_outer.z && max_inner.z <= max_outer.z);
-}
-
 void CADViewer::renderPlacementPreview()
 {
     if (m_placementState != PlacementState::WAITING_FOR_SECOND_CLICK) return;
@@ -2043,17 +2643,18 @@ void CADViewer::renderPlacementPreview()
 
     // Render the preview
     m_shaderProgram->bind();
-    m_shaderProgram->setUniformValue("model", m_modelMatrix);
+    m_profiler->countShaderBind();
     m_shaderProgram->setUniformValue("view", m_viewMatrix);
     m_shaderProgram->setUniformValue("projection", m_projectionMatrix);
     m_shaderProgram->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
     m_shaderProgram->setUniformValue("viewPos", m_cameraPosition);
     m_shaderProgram->setUniformValue("lightColor", QVector3D(1.0f, 1.0f, 1.0f));
+    setModelAttribute(m_modelMatrix);
     
     QVector4D color(mat.diffuseColor.redF(), mat.diffuseColor.greenF(), mat.diffuseColor.blueF(), 1.0f - mat.transparency);
-    m_shaderProgram->setUniformValue("objectColor", color);
+    setObjectColor(color);
     
-    previewObject->render();
+    drawObjectGeometry(previewObject, true);
     
     m_shaderProgram->release();
 }
@@ -2084,7 +2685,7 @@ void CADViewer::renderExtrusionPreview()
         Material mat;
         mat.diffuseColor = QColor(0, 255, 0, 100); // Green transparent for preview
         previewObject->setMaterial(mat);
-        previewObject->render();
+        renderPreviewObject(previewObject);
     }
 }
 
@@ -2097,15 +2698,113 @@ void CADViewer::renderEraserPreview()
         Material mat;
         mat.diffuseColor = QColor(255, 0, 0, 100); // Red transparent for eraser
         previewObject->setMaterial(mat);
-        previewObject->render();
+        renderPreviewObject(previewObject);
     }
 }
 
+void CADViewer::renderPreviewObject(const CADObjectPtr& previewObject)
+{
+    if (!m_shaderProgram || !previewObject) return;
+    
+    m_shaderProgram->bind();
+    m_profiler->countShaderBind();
+    m_shaderProgram->setUniformValue("view", m_viewMatrix);
+    m_shaderProgram->setUniformValue("projection", m_projectionMatrix);
+    m_shaderProgram->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
+    m_shaderProgram->setUniformValue("viewPos", m_cameraPosition);
+    m_shaderProgram->setUniformValue("lightColor", QVector3D(1.0f, 1.0f, 1.0f));
+    setModelAttribute(m_modelMatrix);
+    
+    const QColor& diffuse = previewObject->getMaterial().diffuseColor;
+    setObjectColor(QVector4D(diffuse.redF(), diffuse.greenF(), diffuse.blueF(), diffuse.alphaF()));
+    
+    drawObjectGeometry(previewObject, true);
+    
+    m_shaderProgram->release();
+}
+
 void CADViewer::renderSizeRuler()
 {
     // Render a line and text indicating the size of the shape being placed
 }
 
+void CADViewer::setProfilerOverlayVisible(bool visible)
+{
+    if (visible == m_profiler->isEnabled()) return;
+    m_profiler->setEnabled(visible);
+    if (visible) {
+        m_profiler->clearHistory();
+    }
+    requestFrame();
+}
+
+bool CADViewer::isProfilerOverlayVisible() const
+{
+    return m_profiler->isEnabled();
+}
+
+bool CADViewer::exportRenderProfile(const QString& filename) const
+{
+    if (filename.endsWith(".json", Qt::CaseInsensitive)) {
+        return m_profiler->exportChromeTrace(filename);
+    }
+    return m_profiler->exportCsv(filename);
+}
+
+void CADViewer::renderProfilerOverlay()
+{
+    const RenderProfiler::Frame* frame = m_profiler->latestFrame();
+    if (!frame) return;
+    
+    auto gpuText = [](double ms) {
+        return ms < 0.0 ? QString("--") : QString::number(ms, 'f', 2);
+    };
+    
+    QStringList lines;
+    const double interval = m_profiler->averageFrameIntervalMs();
+    lines << QString("Frame %1  CPU %2 ms  GPU %3 ms  %4 fps")
+                 .arg(frame->index)
+                 .arg(frame->cpuMs, 0, 'f', 2)
+                 .arg(gpuText(frame->gpuMs))
+                 .arg(interval > 0.0 ? 1000.0 / interval : 0.0, 0, 'f', 0);
+    lines << QString("Draws %1  Triangles %2  State %3  Binds %4")
+                 .arg(frame->counters.drawCalls)
+                 .arg(frame->counters.triangles)
+                 .arg(frame->counters.stateChanges)
+                 .arg(frame->counters.shaderBinds);
+    lines << QString("Objects %1  Frustum culled %2  Size culled %3")
+                 .arg(frame->counters.objectsDrawn)
+                 .arg(frame->counters.frustumCulled)
+                 .arg(frame->counters.sizeCulled);
+    for (const auto& pass : frame->passes) {
+        lines << QString("  %1  %2 / %3 ms")
+                     .arg(QString::fromUtf8(pass.name), -18)
+                     .arg(pass.cpuMs, 0, 'f', 3)
+                     .arg(gpuText(pass.gpuMs));
+    }
+    
+    // QPainter leaves its own GL state behind, so the 3D state set up in initializeGL is restored after it
+    QPainter painter(this);
+    QFont font("Monospace");
+    font.setStyleHint(QFont::TypeWriter);
+    font.setPointSize(9);
+    painter.setFont(font);
+    
+    const int lineHeight = painter.fontMetrics().height();
+    const QRect panel(10, 10, 360, lineHeight * lines.size() + 10);
+    painter.fillRect(panel, QColor(0, 0, 0, 160));
+    painter.setPen(QColor(220, 220, 220));
+    for (int i = 0; i < lines.size(); ++i) {
+        painter.drawText(panel.left() + 8, panel.top() + 5 + lineHeight * (i + 1) - painter.fontMetrics().descent(), lines[i]);
+    }
+    painter.end();
+    
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
 QVector3D CADViewer::getGridPlaneNormal(GridPlane plane) const
 {
     switch (plane) {
@@ -2229,53 +2928,49 @@ QVector3D CADViewer::applySnapping(const QVector3D& position, const QPoint& scre
 QVector3D CADViewer::snapToVertex(const QVector3D& position) const
 {
     QVector3D closestVertex = position;
-    float minDistance = 0.5f; // Snap within a certain radius
+    const float snapRadius = 0.5f; // Snap within a certain radius
 
-    for (const auto& object : m_objects) {
-        if (auto primitive = std::dynamic_pointer_cast<GeometryPrimitive>(object)) {
-            if (!primitive->getVertices().empty()) {
-                for (const auto& vertex : primitive->getVertices()) {
-                    QVector3D qvertex = vertex.toQVector3D();
-                    float distance = position.distanceToPoint(qvertex);
-                    if (distance < minDistance) {
-                        minDistance = distance;
-                        closestVertex = qvertex;
-                    }
-                }
-            }
-        }
-    }
+    m_spatialIndex->refresh();
+    m_spatialIndex->nearestVertex(position, snapRadius, closestVertex);
     return closestVertex;
 }
 
 QVector3D CADViewer::snapToEdge(const QVector3D& position, const QPoint& screenPos) const
 {
-    // Placeholder implementation
-    return position;
+    const float snapRadius = 0.5f;
+    m_spatialIndex->refresh();
+
+    // Prefer edges around the surface point under the cursor, otherwise around the plane position
+    QVector3D rayOrigin, rayDirection, hitPoint;
+    screenRay(screenPos, rayOrigin, rayDirection);
+    float distance;
+    QVector3D target = m_spatialIndex->raycast(rayOrigin, rayDirection, distance, &hitPoint) ? hitPoint : position;
+
+    QVector3D edgePoint = position;
+    m_spatialIndex->nearestEdgePoint(target, snapRadius, edgePoint);
+    return edgePoint;
 }
 
 QVector3D CADViewer::snapToFace(const QVector3D& position, const QPoint& screenPos) const
 {
-    // Placeholder implementation
+    m_spatialIndex->refresh();
+
+    QVector3D rayOrigin, rayDirection, hitPoint;
+    screenRay(screenPos, rayOrigin, rayDirection);
+    float distance;
+    if (m_spatialIndex->raycast(rayOrigin, rayDirection, distance, &hitPoint)) {
+        return hitPoint;
+    }
     return position;
 }
 
 QVector3D CADViewer::snapToCenter(const QVector3D& position) const
 {
     QVector3D closestCenter = position;
-    float minDistance = 0.5f; // Snap within a certain radius
+    const float snapRadius = 0.5f; // Snap within a certain radius
 
-    for (const auto& object : m_objects) {
-        Point3D min = object->getBoundingBoxMin();
-        Point3D max = object->getBoundingBoxMax();
-        QVector3D center((min.x + max.x) / 2, (min.y + max.y) / 2, (min.z + max.z) / 2);
-        
-        float distance = position.distanceToPoint(center);
-        if (distance < minDistance) {
-            minDistance = distance;
-            closestCenter = center;
-        }
-    }
+    m_spatialIndex->refresh();
+    m_spatialIndex->nearestCenter(position, snapRadius, closestCenter);
     return closestCenter;
 }
 
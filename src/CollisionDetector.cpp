@@ -0,0 +1,354 @@
+#include "CollisionDetector.h"
+#include "PartManager.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace HybridCAD {
+
+namespace {
+
+// Relative to the triangles' size; keeps touching faces and shared edges from counting
+constexpr float CONTACT_EPSILON = 1e-5f;
+// Bodies moving at once beyond which a full sweep is cheaper than re-testing each body
+constexpr size_t INCREMENTAL_FRACTION = 8;
+
+inline uint64_t pairKey(int a, int b) {
+    return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+}
+
+AABB transformBox(const AABB& box, const QMatrix4x4& transform) {
+    AABB result;
+    for (int corner = 0; corner < 8; ++corner) {
+        QVector3D point((corner & 1) ? box.max.x() : box.min.x(),
+                        (corner & 2) ? box.max.y() : box.min.y(),
+                        (corner & 4) ? box.max.z() : box.min.z());
+        result.expand(transform.map(point));
+    }
+    return result;
+}
+
+// True when the open segment p-q passes through the interior of triangle a-b-c
+bool segmentCrossesTriangle(const QVector3D& p, const QVector3D& q,
+                            const QVector3D& a, const QVector3D& b, const QVector3D& c) {
+    const QVector3D direction = q - p;
+    const QVector3D edge1 = b - a;
+    const QVector3D edge2 = c - a;
+    const QVector3D h = QVector3D::crossProduct(direction, edge2);
+    const float determinant = QVector3D::dotProduct(edge1, h);
+    // Parallel or coplanar: at most a touching contact
+    const float scale = direction.length() * edge1.length() * edge2.length();
+    if (std::abs(determinant) <= CONTACT_EPSILON * scale) return false;
+
+    const float inverse = 1.0f / determinant;
+    const QVector3D s = p - a;
+    const float u = QVector3D::dotProduct(s, h) * inverse;
+    if (u <= CONTACT_EPSILON || u >= 1.0f - CONTACT_EPSILON) return false;
+    const QVector3D r = QVector3D::crossProduct(s, edge1);
+    const float v = QVector3D::dotProduct(direction, r) * inverse;
+    if (v <= CONTACT_EPSILON || u + v >= 1.0f - CONTACT_EPSILON) return false;
+    const float t = QVector3D::dotProduct(edge2, r) * inverse;
+    return t > CONTACT_EPSILON && t < 1.0f - CONTACT_EPSILON;
+}
+
+// Two triangles that interpenetrate have an edge of one through the other
+bool trianglesIntersect(const QVector3D* a, const QVector3D* b) {
+    for (int i = 0; i < 3; ++i) {
+        if (segmentCrossesTriangle(a[i], a[(i + 1) % 3], b[0], b[1], b[2])) return true;
+        if (segmentCrossesTriangle(b[i], b[(i + 1) % 3], a[0], a[1], a[2])) return true;
+    }
+    return false;
+}
+
+// Whether ray origin + t * direction (t > 0) hits triangle a-b-c
+bool rayHitsTriangle(const QVector3D& origin, const QVector3D& direction,
+                     const QVector3D& a, const QVector3D& b, const QVector3D& c) {
+    const QVector3D edge1 = b - a;
+    const QVector3D edge2 = c - a;
+    const QVector3D h = QVector3D::crossProduct(direction, edge2);
+    const float determinant = QVector3D::dotProduct(edge1, h);
+    if (std::abs(determinant) < 1e-12f) return false;
+
+    const float inverse = 1.0f / determinant;
+    const QVector3D s = origin - a;
+    const float u = QVector3D::dotProduct(s, h) * inverse;
+    if (u < 0.0f || u > 1.0f) return false;
+    const QVector3D r = QVector3D::crossProduct(s, edge1);
+    const float v = QVector3D::dotProduct(direction, r) * inverse;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    return QVector3D::dotProduct(edge2, r) * inverse > 0.0f;
+}
+
+void appendMesh(const RenderMesh& mesh, const QMatrix4x4& transform,
+                std::vector<QVector3D>& positions, std::vector<unsigned int>& indices) {
+    const unsigned int base = static_cast<unsigned int>(positions.size());
+    for (size_t v = 0; v + 2 < mesh.vertices.size(); v += RenderMesh::FLOATS_PER_VERTEX) {
+        positions.push_back(transform.map(QVector3D(mesh.vertices[v], mesh.vertices[v + 1], mesh.vertices[v + 2])));
+    }
+    for (unsigned int index : mesh.indices) indices.push_back(base + index);
+}
+
+} // namespace
+
+void CollisionDetector::clear() {
+    m_shapes.clear();
+    m_proxies.clear();
+    m_pairs.clear();
+    m_stats = Stats();
+}
+
+std::shared_ptr<const CollisionDetector::Shape> CollisionDetector::shapeFor(const CADObject* part) {
+    const uint64_t revision = part->getGeometryRevision();
+    auto it = m_shapes.find(part);
+    if (it != m_shapes.end() && it->second->revision == revision) return it->second;
+
+    auto shape = std::make_shared<Shape>();
+    shape->revision = revision;
+
+    // A nested assembly is one rigid body made of its placed parts
+    RenderMesh mesh;
+    if (part->getType() == ObjectType::ASSEMBLY) {
+        for (const InstanceBatch& batch : static_cast<const Assembly*>(part)->buildInstanceBatches()) {
+            mesh.clear();
+            if (!batch.part->buildRenderMesh(mesh)) continue;
+            for (const QMatrix4x4& transform : batch.transforms) {
+                appendMesh(mesh, transform, shape->positions, shape->indices);
+            }
+        }
+    } else if (part->buildRenderMesh(mesh)) {
+        appendMesh(mesh, QMatrix4x4(), shape->positions, shape->indices);
+    }
+
+    std::vector<AABB> bounds(shape->indices.size() / 3);
+    for (size_t t = 0; t < bounds.size(); ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            bounds[t].expand(shape->positions[shape->indices[t * 3 + corner]]);
+        }
+        shape->bounds.merge(bounds[t]);
+    }
+    shape->tree.build(bounds);
+
+    m_shapes[part] = shape;
+    return shape;
+}
+
+void CollisionDetector::update(const std::vector<Body>& bodies) {
+    m_stats = Stats();
+
+    bool restart = bodies.size() != m_proxies.size();
+    for (size_t i = 0; !restart && i < bodies.size(); ++i) {
+        restart = bodies[i].part != m_proxies[i].part;
+    }
+    if (restart) {
+        m_proxies.assign(bodies.size(), Proxy());
+        m_pairs.clear();
+    }
+
+    // Parts dropped from the bodies would otherwise stay cached
+    std::unordered_map<const CADObject*, std::shared_ptr<const Shape>> shapes;
+    std::vector<char> moved(bodies.size(), 0);
+    size_t movedCount = 0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const Body& body = bodies[i];
+        Proxy& proxy = m_proxies[i];
+        std::shared_ptr<const Shape> shape = body.part ? shapeFor(body.part) : nullptr;
+        if (shape) shapes[body.part] = shape;
+
+        const bool enabled = body.enabled && shape && !shape->indices.empty();
+        if (!restart && proxy.shape == shape && proxy.enabled == enabled && proxy.transform == body.transform) continue;
+
+        proxy.part = body.part;
+        proxy.shape = shape;
+        proxy.transform = body.transform;
+        proxy.enabled = enabled;
+        proxy.box = enabled ? transformBox(shape->bounds, body.transform) : AABB();
+        moved[i] = 1;
+        ++movedCount;
+    }
+    m_shapes.swap(shapes);
+    if (movedCount == 0) return;
+
+    std::vector<std::pair<int, int>> candidates;
+    if (restart || movedCount * INCREMENTAL_FRACTION > bodies.size()) {
+        m_pairs.clear();
+        findPairs(candidates);
+    } else {
+        // Only pairs with a moved body can have changed
+        for (auto it = m_pairs.begin(); it != m_pairs.end();) {
+            const int a = static_cast<int>(it->first >> 32);
+            const int b = static_cast<int>(it->first & 0xffffffffu);
+            it = (moved[a] || moved[b]) ? m_pairs.erase(it) : std::next(it);
+        }
+        for (size_t i = 0; i < m_proxies.size(); ++i) {
+            if (!moved[i] || !m_proxies[i].enabled) continue;
+            for (size_t j = 0; j < m_proxies.size(); ++j) {
+                // Moved pairs are taken once, from their lower index
+                if (i == j || !m_proxies[j].enabled || (moved[j] && j < i)) continue;
+                if (!m_proxies[i].box.overlaps(m_proxies[j].box)) continue;
+                candidates.emplace_back(static_cast<int>(std::min(i, j)), static_cast<int>(std::max(i, j)));
+            }
+        }
+    }
+
+    std::vector<char> colliding(candidates.size(), 0);
+    std::vector<size_t> tested(candidates.size(), 0);
+    ThreadPool::instance().parallelFor(0, candidates.size(), 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            const Proxy& a = m_proxies[candidates[c].first];
+            const Proxy& b = m_proxies[candidates[c].second];
+            colliding[c] = intersect(*a.shape, a.transform, *b.shape, b.transform, tested[c]);
+        }
+    });
+
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        m_pairs[pairKey(candidates[c].first, candidates[c].second)] = colliding[c] != 0;
+        m_stats.testedTriangles += tested[c];
+    }
+    m_stats.candidatePairs = candidates.size();
+}
+
+void CollisionDetector::findPairs(std::vector<std::pair<int, int>>& candidates) const {
+    // Sweep along the axis the boxes spread most on
+    AABB extent;
+    std::vector<int> order;
+    for (size_t i = 0; i < m_proxies.size(); ++i) {
+        if (!m_proxies[i].enabled) continue;
+        order.push_back(static_cast<int>(i));
+        extent.expand(m_proxies[i].box.center());
+    }
+    if (order.size() < 2) return;
+
+    const QVector3D spread = extent.extent();
+    const int axis = spread.x() >= spread.y() && spread.x() >= spread.z() ? 0 : (spread.y() >= spread.z() ? 1 : 2);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return m_proxies[a].box.min[axis] < m_proxies[b].box.min[axis];
+    });
+
+    std::vector<int> active;
+    for (int body : order) {
+        const AABB& box = m_proxies[body].box;
+        active.erase(std::remove_if(active.begin(), active.end(), [&](int other) {
+            return m_proxies[other].box.max[axis] < box.min[axis];
+        }), active.end());
+        for (int other : active) {
+            if (box.overlaps(m_proxies[other].box)) {
+                candidates.emplace_back(std::min(body, other), std::max(body, other));
+            }
+        }
+        active.push_back(body);
+    }
+}
+
+bool CollisionDetector::intersect(const Shape& a, const QMatrix4x4& transformA, const Shape& b,
+                                  const QMatrix4x4& transformB, size_t& testedTriangles) const {
+    if (a.tree.isEmpty() || b.tree.isEmpty()) return false;
+
+    // Everything is compared in A's frame
+    bool invertible = false;
+    const QMatrix4x4 bToA = transformA.inverted(&invertible) * transformB;
+    if (!invertible) return false;
+
+    const auto& nodesA = a.tree.nodes();
+    const auto& nodesB = b.tree.nodes();
+    const auto& primitivesA = a.tree.primitives();
+    const auto& primitivesB = b.tree.primitives();
+
+    std::vector<AABB> boxesB(nodesB.size());
+    for (size_t n = 0; n < nodesB.size(); ++n) boxesB[n] = transformBox(nodesB[n].box, bToA);
+    std::vector<QVector3D> positionsB(b.positions.size());
+    for (size_t v = 0; v < b.positions.size(); ++v) positionsB[v] = bToA.map(b.positions[v]);
+
+    std::vector<std::pair<int, int>> stack = { { 0, 0 } };
+    while (!stack.empty()) {
+        const auto [nodeA, nodeB] = stack.back();
+        stack.pop_back();
+        const StaticBVH::Node& na = nodesA[nodeA];
+        const StaticBVH::Node& nb = nodesB[nodeB];
+        if (!na.box.overlaps(boxesB[nodeB])) continue;
+
+        if (na.count > 0 && nb.count > 0) {
+            for (int i = na.start; i < na.start + na.count; ++i) {
+                const unsigned int* ta = &a.indices[primitivesA[i] * 3];
+                const QVector3D triangleA[3] = { a.positions[ta[0]], a.positions[ta[1]], a.positions[ta[2]] };
+                for (int j = nb.start; j < nb.start + nb.count; ++j) {
+                    const unsigned int* tb = &b.indices[primitivesB[j] * 3];
+                    const QVector3D triangleB[3] = { positionsB[tb[0]], positionsB[tb[1]], positionsB[tb[2]] };
+                    ++testedTriangles;
+                    if (trianglesIntersect(triangleA, triangleB)) return true;
+                }
+            }
+            continue;
+        }
+
+        // Descend the larger box so both sides shrink evenly
+        const bool splitA = nb.count > 0 || (na.count == 0 && na.box.surfaceArea() >= boxesB[nodeB].surfaceArea());
+        if (splitA) {
+            stack.emplace_back(na.right, nodeB);
+            stack.emplace_back(nodeA + 1, nodeB);
+        } else {
+            stack.emplace_back(nodeA, nb.right);
+            stack.emplace_back(nodeA, nodeB + 1);
+        }
+    }
+
+    // No surfaces cross, but one part may still sit inside the other
+    auto contains = [](const Shape& outer, const QVector3D& point) {
+        // Odd crossings along a skewed ray put the point inside a closed mesh
+        const QVector3D direction = QVector3D(0.5773f, 0.5774f, 0.5775f);
+        const QVector3D invDirection(1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z());
+        const auto& nodes = outer.tree.nodes();
+        const auto& primitives = outer.tree.primitives();
+        int crossings = 0;
+        std::vector<int> stack = { 0 };
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            float entry = 0.0f;
+            if (!nodes[index].box.intersectsRay(point, invDirection, std::numeric_limits<float>::max(), entry)) continue;
+            if (nodes[index].count > 0) {
+                for (int i = nodes[index].start; i < nodes[index].start + nodes[index].count; ++i) {
+                    const unsigned int* t = &outer.indices[primitives[i] * 3];
+                    if (rayHitsTriangle(point, direction, outer.positions[t[0]], outer.positions[t[1]], outer.positions[t[2]])) {
+                        ++crossings;
+                    }
+                }
+            } else {
+                stack.push_back(nodes[index].right);
+                stack.push_back(index + 1);
+            }
+        }
+        return (crossings & 1) != 0;
+    };
+    auto centroid = [](const std::vector<QVector3D>& positions, const std::vector<unsigned int>& indices) {
+        return (positions[indices[0]] + positions[indices[1]] + positions[indices[2]]) / 3.0f;
+    };
+
+    const AABB boundsB = transformBox(b.bounds, bToA);
+    if (a.bounds.contains(boundsB) && contains(a, centroid(positionsB, b.indices))) return true;
+    if (boundsB.contains(a.bounds)) {
+        // Test A against B in B's own frame
+        const QMatrix4x4 aToB = bToA.inverted();
+        if (contains(b, aToB.map(centroid(a.positions, a.indices)))) return true;
+    }
+    return false;
+}
+
+std::vector<std::pair<int, int>> CollisionDetector::collisions() const {
+    std::vector<std::pair<int, int>> result;
+    for (const auto& [key, colliding] : m_pairs) {
+        if (colliding) result.emplace_back(static_cast<int>(key >> 32), static_cast<int>(key & 0xffffffffu));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool CollisionDetector::test(const Body& a, const Body& b) {
+    if (!a.part || !b.part || !a.enabled || !b.enabled) return false;
+    std::shared_ptr<const Shape> shapeA = shapeFor(a.part);
+    std::shared_ptr<const Shape> shapeB = shapeFor(b.part);
+    if (!transformBox(shapeA->bounds, a.transform).overlaps(transformBox(shapeB->bounds, b.transform))) return false;
+    size_t tested = 0;
+    return intersect(*shapeA, a.transform, *shapeB, b.transform, tested);
+}
+
+} // namespace HybridCAD
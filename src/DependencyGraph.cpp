@@ -0,0 +1,288 @@
+#include "DependencyGraph.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace HybridCAD {
+
+namespace {
+
+bool link(std::vector<int>& list, int node) {
+    if (std::find(list.begin(), list.end(), node) != list.end()) return false;
+    list.push_back(node);
+    return true;
+}
+
+void unlinkFrom(std::vector<int>& list, int node) {
+    list.erase(std::remove(list.begin(), list.end(), node), list.end());
+}
+
+} // namespace
+
+void DependencyGraph::rebuild(const CADObjectList& objects) {
+    std::unordered_map<const CADObject*, Node> previous;
+    for (Node& node : m_nodes) {
+        if (node.object) previous.emplace(node.object, std::move(node));
+    }
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_index.clear();
+
+    for (const auto& object : objects) {
+        if (object) m_nodes[findOrAddNode(object.get())].root = true;
+    }
+
+    for (Node& node : m_nodes) {
+        auto it = previous.find(node.object);
+        if (it == previous.end()) continue;
+        node.revision = it->second.revision;
+        node.dirty = it->second.dirty;
+    }
+    // A new input makes its users stale even if they were evaluated before
+    for (size_t n = 0; n < m_nodes.size(); ++n) {
+        if (m_nodes[n].dirty) {
+            m_nodes[n].dirty = false;
+            markDirty(static_cast<int>(n));
+        }
+    }
+    order();
+}
+
+void DependencyGraph::clear() {
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_index.clear();
+    m_levels.clear();
+    m_ordered = true;
+    m_acyclic = true;
+}
+
+void DependencyGraph::addNode(const CADObject* object) {
+    if (object) m_nodes[findOrAddNode(object)].root = true;
+}
+
+void DependencyGraph::removeNode(const CADObject* object) {
+    auto it = m_index.find(object);
+    if (it == m_index.end()) return;
+
+    // Still an input of something else, it stays as one
+    const int node = it->second;
+    m_nodes[node].root = false;
+    if (m_nodes[node].outputs.empty()) eraseNode(node);
+}
+
+void DependencyGraph::relink(const CADObject* object) {
+    auto it = m_index.find(object);
+    if (it == m_index.end()) return;
+    const int node = it->second;
+
+    // Links a child or a user of this object made stay; only its own are checked
+    const std::vector<const CADObject*> dependencies = object->getDependencies();
+    std::vector<int> staleInputs;
+    for (int input : m_nodes[node].inputs) {
+        const CADObject* inputObject = m_nodes[input].object;
+        if (inputObject->getParent() != object &&
+            std::find(dependencies.begin(), dependencies.end(), inputObject) == dependencies.end()) {
+            staleInputs.push_back(input);
+        }
+    }
+    std::vector<int> staleOutputs;
+    for (int output : m_nodes[node].outputs) {
+        const CADObject* outputObject = m_nodes[output].object;
+        if (outputObject == object->getParent()) continue;
+        const std::vector<const CADObject*> used = outputObject->getDependencies();
+        if (std::find(used.begin(), used.end(), object) == used.end()) staleOutputs.push_back(output);
+    }
+
+    for (int input : staleInputs) {
+        if (!m_nodes[input].object) continue;
+        unlink(input, node);
+        if (!m_nodes[input].root && m_nodes[input].outputs.empty()) eraseNode(input);
+    }
+    for (int output : staleOutputs) {
+        if (!m_nodes[output].object) continue;
+        unlink(node, output);
+        if (!m_nodes[output].root && m_nodes[output].inputs.empty()) eraseNode(output);
+    }
+    linkInputs(node);
+}
+
+int DependencyGraph::findOrAddNode(const CADObject* object) {
+    auto it = m_index.find(object);
+    if (it != m_index.end()) return it->second;
+
+    int node;
+    if (!m_freeNodes.empty()) {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    } else {
+        node = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    m_nodes[node].object = object;
+    m_index.emplace(object, node);
+
+    linkInputs(node);
+    return node;
+}
+
+void DependencyGraph::linkInputs(int node) {
+    // A new input makes its users stale even if they were evaluated before
+    const CADObject* object = m_nodes[node].object;
+    for (const CADObject* dependency : object->getDependencies()) {
+        if (!dependency) continue;
+        const int input = findOrAddNode(dependency);
+        if (link(m_nodes[node].inputs, input)) {
+            link(m_nodes[input].outputs, node);
+            markDirty(node);
+            m_ordered = false;
+        }
+    }
+    // Parents are built from their children
+    if (const CADObject* parent = object->getParent()) {
+        const int output = findOrAddNode(parent);
+        if (link(m_nodes[output].inputs, node)) {
+            link(m_nodes[node].outputs, output);
+            markDirty(output);
+            m_ordered = false;
+        }
+    }
+}
+
+void DependencyGraph::unlink(int input, int output) {
+    unlinkFrom(m_nodes[input].outputs, output);
+    unlinkFrom(m_nodes[output].inputs, input);
+    markDirty(output);
+    m_ordered = false;
+}
+
+void DependencyGraph::eraseNode(int node) {
+    std::vector<int> stack = { node };
+    while (!stack.empty()) {
+        const int current = stack.back();
+        stack.pop_back();
+        if (!m_nodes[current].object) continue;
+
+        // Implicit inputs no one else uses and implicit parents left without children go too
+        for (int input : m_nodes[current].inputs) {
+            unlinkFrom(m_nodes[input].outputs, current);
+            if (!m_nodes[input].root && m_nodes[input].outputs.empty()) stack.push_back(input);
+        }
+        for (int output : m_nodes[current].outputs) {
+            unlinkFrom(m_nodes[output].inputs, current);
+            markDirty(output);
+            if (!m_nodes[output].root && m_nodes[output].inputs.empty()) stack.push_back(output);
+        }
+
+        m_index.erase(m_nodes[current].object);
+        m_nodes[current] = Node();
+        m_freeNodes.push_back(current);
+    }
+    m_ordered = false;
+}
+
+void DependencyGraph::markDirty(const CADObject* object) {
+    auto it = m_index.find(object);
+    if (it != m_index.end()) markDirty(it->second);
+}
+
+void DependencyGraph::markDirty(int node) {
+    // Everything below a dirty node is already dirty, so the walk stops there
+    std::vector<int> stack = { node };
+    while (!stack.empty()) {
+        const int current = stack.back();
+        stack.pop_back();
+        if (m_nodes[current].dirty) continue;
+        m_nodes[current].dirty = true;
+        for (int output : m_nodes[current].outputs) stack.push_back(output);
+    }
+}
+
+void DependencyGraph::order() const {
+    m_levels.clear();
+
+    // Kahn's algorithm; a node's level is one past its deepest input
+    std::vector<int> pending(m_nodes.size());
+    std::vector<int> level(m_nodes.size(), 0);
+    std::vector<int> ready;
+    for (size_t n = 0; n < m_nodes.size(); ++n) {
+        if (!m_nodes[n].object) continue;
+        pending[n] = static_cast<int>(m_nodes[n].inputs.size());
+        if (pending[n] == 0) ready.push_back(static_cast<int>(n));
+    }
+
+    size_t ordered = 0;
+    while (!ready.empty()) {
+        const int node = ready.back();
+        ready.pop_back();
+        ++ordered;
+        if (level[node] >= static_cast<int>(m_levels.size())) m_levels.resize(level[node] + 1);
+        m_levels[level[node]].push_back(node);
+        for (int output : m_nodes[node].outputs) {
+            level[output] = std::max(level[output], level[node] + 1);
+            if (--pending[output] == 0) ready.push_back(output);
+        }
+    }
+    m_acyclic = ordered == m_index.size();
+    m_ordered = true;
+}
+
+bool DependencyGraph::isAcyclic() const {
+    if (!m_ordered) order();
+    return m_acyclic;
+}
+
+bool DependencyGraph::isDirty(const CADObject* object) const {
+    auto it = m_index.find(object);
+    return it != m_index.end() && m_nodes[it->second].dirty;
+}
+
+size_t DependencyGraph::collectChanges() {
+    size_t changed = 0;
+    for (size_t n = 0; n < m_nodes.size(); ++n) {
+        if (!m_nodes[n].object || m_nodes[n].object->getOwnGeometryRevision() == m_nodes[n].revision) continue;
+        m_nodes[n].revision = m_nodes[n].object->getOwnGeometryRevision();
+        markDirty(static_cast<int>(n));
+        ++changed;
+    }
+    return changed;
+}
+
+size_t DependencyGraph::evaluate(std::vector<const CADObject*>* evaluatedObjects) {
+    if (!m_ordered) order();
+
+    size_t evaluated = 0;
+    std::vector<int> dirty;
+    for (const auto& level : m_levels) {
+        dirty.clear();
+        for (int node : level) {
+            if (m_nodes[node].dirty) dirty.push_back(node);
+        }
+        if (dirty.empty()) continue;
+
+        // A level only reads earlier levels, which are already up to date
+        ThreadPool::instance().parallelFor(0, dirty.size(), 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                m_nodes[dirty[i]].object->evaluate();
+            }
+        });
+        for (int node : dirty) {
+            m_nodes[node].dirty = false;
+            m_nodes[node].revision = m_nodes[node].object->getOwnGeometryRevision();
+            if (evaluatedObjects) evaluatedObjects->push_back(m_nodes[node].object);
+        }
+        evaluated += dirty.size();
+    }
+    return evaluated;
+}
+
+std::vector<const CADObject*> DependencyGraph::dependents(const CADObject* object) const {
+    std::vector<const CADObject*> result;
+    auto it = m_index.find(object);
+    if (it == m_index.end()) return result;
+    for (int output : m_nodes[it->second].outputs) {
+        result.push_back(m_nodes[output].object);
+    }
+    return result;
+}
+
+} // namespace HybridCAD
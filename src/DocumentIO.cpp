@@ -0,0 +1,980 @@
+#include "DocumentIO.h"
+#include "GeometryManager.h"
+#include "MappedFile.h"
+#include "MeshManager.h"
+#include "PartManager.h"
+#include "ThreadPool.h"
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QString>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <string_view>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace HybridCAD {
+
+namespace {
+
+// Header: magic, version, reserved, table offset, table entry count, reserved
+constexpr char MAGIC[8] = { 'H', 'C', 'A', 'D', 'D', 'O', 'C', '\0' };
+constexpr size_t HEADER_SIZE = 32;
+// Table entry: kind, flags, offset, stored size, raw size
+constexpr size_t TOC_ENTRY_SIZE = 32;
+
+enum ChunkKind : uint32_t {
+    CHUNK_FEATURE_TREE = 1,
+    CHUNK_MESH = 2
+};
+
+enum ChunkFlags : uint32_t {
+    CHUNK_COMPRESSED = 1
+};
+
+using Chunk = DocumentStorage::Chunk;
+
+uint64_t alignChunk(uint64_t value) {
+    const uint64_t alignment = DocumentIO::CHUNK_ALIGNMENT;
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Little-endian encoder for chunk payloads
+class ByteWriter {
+public:
+    template <typename T>
+    void put(T value) {
+        char* at = grow(sizeof(T));
+        qToLittleEndian(value, at);
+    }
+
+    void putFloat(float value) {
+        quint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put(bits);
+    }
+
+    void putDouble(double value) {
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put(bits);
+    }
+
+    void putPoint(double x, double y, double z) {
+        putDouble(x);
+        putDouble(y);
+        putDouble(z);
+    }
+
+    void putString(const std::string& text) {
+        put<quint32>(static_cast<quint32>(text.size()));
+        std::memcpy(grow(text.size()), text.data(), text.size());
+    }
+
+    // 32-bit ints or floats, followed by padding to the chunk alignment so the next array is
+    // aligned in an uncompressed chunk
+    template <typename T>
+    void putArray(const std::vector<T>& values) {
+        static_assert(sizeof(T) == sizeof(quint32), "arrays hold 32-bit elements");
+        qToLittleEndian<quint32>(values.data(), static_cast<qsizetype>(values.size()), grow(values.size() * sizeof(T)));
+        m_data.resize(alignChunk(m_data.size()), 0);
+    }
+
+    std::vector<char>& data() { return m_data; }
+
+private:
+    char* grow(size_t bytes) {
+        const size_t at = m_data.size();
+        m_data.resize(at + bytes);
+        return m_data.data() + at;
+    }
+
+    std::vector<char> m_data;
+};
+
+// Bounds-checked decoder; once a read runs past the end every later read yields zero and ok()
+// stays false
+class ByteReader {
+public:
+    ByteReader(const char* data, size_t size) : m_data(data), m_size(size), m_offset(0), m_ok(true) {}
+
+    template <typename T>
+    T get() {
+        if (!take(sizeof(T))) return T(0);
+        return qFromLittleEndian<T>(m_data + m_offset - sizeof(T));
+    }
+
+    float getFloat() {
+        quint32 bits = get<quint32>();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double getDouble() {
+        quint64 bits = get<quint64>();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    Point3D getPoint() {
+        double x = getDouble();
+        double y = getDouble();
+        double z = getDouble();
+        return Point3D(x, y, z);
+    }
+
+    std::string getString() {
+        const quint32 length = get<quint32>();
+        if (!take(length)) return std::string();
+        return std::string(m_data + m_offset - length, length);
+    }
+
+    template <typename T>
+    bool getArray(std::vector<T>& values, uint64_t count) {
+        static_assert(sizeof(T) == sizeof(quint32), "arrays hold 32-bit elements");
+        if (count > (m_size - m_offset) / sizeof(T) || !take(count * sizeof(T))) {
+            m_ok = false;
+            return false;
+        }
+        values.resize(count);
+        qFromLittleEndian<quint32>(m_data + m_offset - count * sizeof(T), static_cast<qsizetype>(count), values.data());
+        m_offset = std::min<size_t>(alignChunk(m_offset), m_size);
+        return true;
+    }
+
+    bool ok() const { return m_ok; }
+
+private:
+    bool take(size_t bytes) {
+        if (!m_ok || bytes > m_size - m_offset) {
+            m_ok = false;
+            return false;
+        }
+        m_offset += bytes;
+        return true;
+    }
+
+    const char* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_ok;
+};
+
+// One chunk of the file being written: already in place, copied from an opened file, or freshly
+// encoded
+struct PendingChunk {
+    Chunk entry;
+    bool inPlace = false;
+    std::shared_ptr<const MappedFile> source; // Holds the stored bytes at entry.offset
+    std::vector<char> bytes;
+};
+
+PendingChunk makeChunk(uint32_t kind, std::vector<char> raw, bool compress) {
+    PendingChunk chunk;
+    chunk.entry.kind = kind;
+    chunk.entry.rawSize = raw.size();
+    chunk.bytes = std::move(raw);
+
+    if (compress && chunk.bytes.size() < static_cast<size_t>(INT_MAX)) {
+        QByteArray packed = qCompress(reinterpret_cast<const uchar*>(chunk.bytes.data()),
+                                      static_cast<int>(chunk.bytes.size()));
+        if (static_cast<size_t>(packed.size()) < chunk.bytes.size()) {
+            chunk.bytes.assign(packed.constData(), packed.constData() + packed.size());
+            chunk.entry.flags |= CHUNK_COMPRESSED;
+        }
+    }
+    chunk.entry.storedSize = chunk.bytes.size();
+    return chunk;
+}
+
+// Payload of a chunk as written, inflated when it was compressed; empty on damage
+QByteArray readChunk(const MappedFile& file, const Chunk& entry) {
+    if (entry.offset > file.size() || entry.storedSize > file.size() - entry.offset) return QByteArray();
+
+    const char* stored = file.data() + entry.offset;
+    if (!(entry.flags & CHUNK_COMPRESSED)) {
+        // Decoded straight from the mapping; nothing is copied before that
+        return QByteArray::fromRawData(stored, static_cast<qsizetype>(entry.storedSize));
+    }
+
+    QByteArray raw = qUncompress(reinterpret_cast<const uchar*>(stored), static_cast<qsizetype>(entry.storedSize));
+    return static_cast<uint64_t>(raw.size()) == entry.rawSize ? raw : QByteArray();
+}
+
+// Mesh chunk: vertex, face and corner counts, a face-normal flag and then the positions, face
+// offsets, corner indices and face normals, each array starting 16-byte aligned
+std::vector<char> encodeMesh(const MeshSnapshot& mesh) {
+    ByteWriter writer;
+    writer.put<quint64>(mesh.positions->size() / 3);
+    writer.put<quint64>(mesh.faceOffsets->size() - 1);
+    writer.put<quint64>(mesh.faceIndices->size());
+    writer.put<quint32>(1);
+    writer.put<quint32>(0);
+    writer.putArray(*mesh.positions);
+    writer.putArray(*mesh.faceOffsets);
+    writer.putArray(*mesh.faceIndices);
+    writer.putArray(*mesh.faceNormals);
+    return std::move(writer.data());
+}
+
+size_t snapshotBytes(const MeshSnapshot& mesh) {
+    return (mesh.positions->size() + mesh.faceOffsets->size() + mesh.faceIndices->size() + mesh.faceNormals->size()) * 4;
+}
+
+bool decodeMesh(const char* data, size_t size, std::vector<float>& positions, std::vector<int>& faceIndices,
+                std::vector<int>& faceOffsets, std::vector<float>& faceNormals) {
+    ByteReader reader(data, size);
+    const uint64_t vertexCount = reader.get<quint64>();
+    const uint64_t faceCount = reader.get<quint64>();
+    const uint64_t cornerCount = reader.get<quint64>();
+    const bool hasFaceNormals = reader.get<quint32>() != 0;
+    reader.get<quint32>();
+    if (!reader.ok() || vertexCount > size || faceCount > size || cornerCount > size) return false;
+
+    if (!reader.getArray(positions, vertexCount * 3) || !reader.getArray(faceOffsets, faceCount + 1) ||
+        !reader.getArray(faceIndices, cornerCount)) {
+        return false;
+    }
+    if (hasFaceNormals && !reader.getArray(faceNormals, faceCount * 3)) return false;
+
+    // Offsets and indices are trusted by every mesh accessor, so they are checked once here
+    if (faceOffsets.front() != 0 || static_cast<uint64_t>(faceOffsets.back()) != cornerCount) return false;
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (faceOffsets[f] > faceOffsets[f + 1]) return false;
+    }
+    for (int vertex : faceIndices) {
+        if (vertex < 0 || static_cast<uint64_t>(vertex) >= vertexCount) return false;
+    }
+    return true;
+}
+
+// A mesh chunk of an opened document; the mapping stays open as long as any mesh needs it
+class MeshChunkGeometry : public DeferredMeshGeometry {
+public:
+    MeshChunkGeometry(std::shared_ptr<const MappedFile> file, const Chunk& entry)
+        : m_file(std::move(file)), m_entry(entry) {}
+
+    bool read(std::vector<float>& positions, std::vector<int>& faceIndices,
+              std::vector<int>& faceOffsets, std::vector<float>& faceNormals) const override {
+        QByteArray payload = readChunk(*m_file, m_entry);
+        if (payload.isEmpty()) return false;
+        return decodeMesh(payload.constData(), static_cast<size_t>(payload.size()),
+                          positions, faceIndices, faceOffsets, faceNormals);
+    }
+
+    const std::shared_ptr<const MappedFile>& file() const { return m_file; }
+    const Chunk& entry() const { return m_entry; }
+
+private:
+    std::shared_ptr<const MappedFile> m_file;
+    Chunk m_entry;
+};
+
+// Orders objects so each comes after everything it is built from
+void collectObjects(const CADObject* object, std::vector<const CADObject*>& order,
+                    std::unordered_map<const CADObject*, int>& recordIndex,
+                    std::unordered_set<const CADObject*>& visiting) {
+    if (!object || recordIndex.count(object) || !visiting.insert(object).second) return;
+
+    for (const CADObject* dependency : object->getDependencies()) {
+        collectObjects(dependency, order, recordIndex, visiting);
+    }
+    visiting.erase(object);
+    recordIndex[object] = static_cast<int>(order.size());
+    order.push_back(object);
+}
+
+int indexOf(const std::unordered_map<const CADObject*, int>& recordIndex, const CADObject* object) {
+    auto it = recordIndex.find(object);
+    return it == recordIndex.end() ? -1 : it->second;
+}
+
+void putMaterial(ByteWriter& writer, const Material& material) {
+    writer.put<quint32>(material.diffuseColor.rgba());
+    writer.put<quint32>(material.specularColor.rgba());
+    writer.putFloat(material.shininess);
+    writer.putFloat(material.transparency);
+    writer.putString(material.name);
+}
+
+Material getMaterial(ByteReader& reader) {
+    Material material;
+    material.diffuseColor = QColor::fromRgba(reader.get<quint32>());
+    material.specularColor = QColor::fromRgba(reader.get<quint32>());
+    material.shininess = reader.getFloat();
+    material.transparency = reader.getFloat();
+    material.name = reader.getString();
+    return material;
+}
+
+// Feature tree chunk: document name, one record per object in dependency order, then the
+// document's own objects and root as record indices. Objects refer to earlier records by index
+// and meshes to their chunk by table index.
+bool encodeFeatureTree(const PartDocument& document, const std::vector<const CADObject*>& order,
+                       const std::unordered_map<const CADObject*, int>& recordIndex,
+                       const std::unordered_map<const CADObject*, int>& meshChunks, std::vector<char>& out) {
+    ByteWriter writer;
+    writer.putString(document.getName());
+    writer.put<quint32>(static_cast<quint32>(order.size()));
+
+    for (const CADObject* object : order) {
+        const ObjectType type = object->getType();
+        writer.put<quint32>(static_cast<quint32>(type));
+        writer.putString(object->getName());
+        writer.put<quint8>(object->isVisible() ? 1 : 0);
+        putMaterial(writer, object->getMaterial());
+
+        switch (type) {
+            case ObjectType::PRIMITIVE_BOX: {
+                const auto* box = static_cast<const Box*>(object);
+                writer.putPoint(box->getMin().x, box->getMin().y, box->getMin().z);
+                writer.putPoint(box->getMax().x, box->getMax().y, box->getMax().z);
+                break;
+            }
+            case ObjectType::PRIMITIVE_CYLINDER: {
+                const auto* cylinder = static_cast<const Cylinder*>(object);
+                writer.putFloat(cylinder->getRadius());
+                writer.putFloat(cylinder->getHeight());
+                writer.put<qint32>(cylinder->getSegments());
+                break;
+            }
+            case ObjectType::PRIMITIVE_SPHERE: {
+                const auto* sphere = static_cast<const Sphere*>(object);
+                writer.putFloat(sphere->getRadius());
+                writer.put<qint32>(sphere->getSegments());
+                writer.putPoint(sphere->getCenter().x, sphere->getCenter().y, sphere->getCenter().z);
+                break;
+            }
+            case ObjectType::PRIMITIVE_CONE: {
+                const auto* cone = static_cast<const Cone*>(object);
+                writer.putFloat(cone->getBottomRadius());
+                writer.putFloat(cone->getTopRadius());
+                writer.putFloat(cone->getHeight());
+                writer.put<qint32>(cone->getSegments());
+                writer.putPoint(cone->getCenter().x, cone->getCenter().y, cone->getCenter().z);
+                break;
+            }
+            case ObjectType::BOOLEAN_UNION:
+            case ObjectType::BOOLEAN_DIFFERENCE:
+            case ObjectType::BOOLEAN_INTERSECTION: {
+                const auto* boolean = static_cast<const BooleanObject*>(object);
+                writer.put<qint32>(indexOf(recordIndex, boolean->getObjectA().get()));
+                writer.put<qint32>(indexOf(recordIndex, boolean->getObjectB().get()));
+                break;
+            }
+            case ObjectType::MESH: {
+                const Point3D min = object->getBoundingBoxMin();
+                const Point3D max = object->getBoundingBoxMax();
+                writer.put<qint32>(indexOf(meshChunks, object));
+                writer.putPoint(min.x, min.y, min.z);
+                writer.putPoint(max.x, max.y, max.z);
+                break;
+            }
+            case ObjectType::ASSEMBLY: {
+                const auto* assembly = static_cast<const Assembly*>(object);
+                writer.put<quint32>(static_cast<quint32>(assembly->getPartInstances().size()));
+                for (const PartInstance& instance : assembly->getPartInstances()) {
+                    float matrix[16];
+                    instance.transform.matrix.copyDataTo(matrix);
+                    writer.put<qint32>(indexOf(recordIndex, instance.part.get()));
+                    writer.putString(instance.instanceName);
+                    for (float value : matrix) writer.putFloat(value);
+                    writer.put<quint8>(instance.color.isValid() ? 1 : 0);
+                    writer.put<quint32>(instance.color.isValid() ? instance.color.rgba() : 0);
+                    writer.put<quint8>(instance.visible ? 1 : 0);
+                    writer.put<quint8>(instance.locked ? 1 : 0);
+                }
+                writer.put<quint32>(static_cast<quint32>(assembly->getConstraints().size()));
+                for (const AssemblyConstraint& constraint : assembly->getConstraints()) {
+                    writer.put<quint32>(static_cast<quint32>(constraint.type));
+                    writer.put<qint32>(indexOf(recordIndex, constraint.partA.get()));
+                    writer.put<qint32>(indexOf(recordIndex, constraint.partB.get()));
+                    writer.putPoint(constraint.pointA.x, constraint.pointA.y, constraint.pointA.z);
+                    writer.putPoint(constraint.pointB.x, constraint.pointB.y, constraint.pointB.z);
+                    writer.putPoint(constraint.directionA.x, constraint.directionA.y, constraint.directionA.z);
+                    writer.putPoint(constraint.directionB.x, constraint.directionB.y, constraint.directionB.z);
+                    writer.putDouble(constraint.value);
+                    writer.put<quint8>(constraint.enabled ? 1 : 0);
+                }
+                break;
+            }
+            default:
+                // Sketch and profile features have no object class yet
+                return false;
+        }
+    }
+
+    writer.put<quint32>(static_cast<quint32>(document.getObjects().size()));
+    for (const CADObjectPtr& object : document.getObjects()) {
+        writer.put<qint32>(indexOf(recordIndex, object.get()));
+    }
+    writer.put<qint32>(indexOf(recordIndex, document.getRootObject().get()));
+
+    out = std::move(writer.data());
+    return true;
+}
+
+// Rebuilds the objects of a feature tree chunk; meshes are bound to their chunks in file
+bool decodeFeatureTree(const char* data, size_t size, const std::shared_ptr<const MappedFile>& file,
+                       const std::vector<Chunk>& toc, PartDocument& document, DocumentStorage& storage) {
+    ByteReader reader(data, size);
+    const std::string documentName = reader.getString();
+    const quint32 recordCount = reader.get<quint32>();
+    if (!reader.ok() || recordCount > size) return false;
+
+    std::vector<CADObjectPtr> objects;
+    std::vector<Material> materials;
+    objects.reserve(recordCount);
+    materials.reserve(recordCount);
+    auto earlier = [&objects](qint32 index) {
+        return index >= 0 && static_cast<size_t>(index) < objects.size() ? objects[index] : nullptr;
+    };
+
+    for (quint32 record = 0; record < recordCount && reader.ok(); ++record) {
+        const quint32 type = reader.get<quint32>();
+        const std::string name = reader.getString();
+        const bool visible = reader.get<quint8>() != 0;
+        materials.push_back(getMaterial(reader));
+
+        CADObjectPtr object;
+        switch (static_cast<ObjectType>(type)) {
+            case ObjectType::PRIMITIVE_BOX: {
+                Point3D min = reader.getPoint();
+                Point3D max = reader.getPoint();
+                object = std::make_shared<Box>(min, max);
+                break;
+            }
+            case ObjectType::PRIMITIVE_CYLINDER: {
+                float radius = reader.getFloat();
+                float height = reader.getFloat();
+                int segments = reader.get<qint32>();
+                object = std::make_shared<Cylinder>(radius, height, segments);
+                break;
+            }
+            case ObjectType::PRIMITIVE_SPHERE: {
+                float radius = reader.getFloat();
+                int segments = reader.get<qint32>();
+                auto sphere = std::make_shared<Sphere>(radius, segments);
+                sphere->setCenter(reader.getPoint());
+                object = sphere;
+                break;
+            }
+            case ObjectType::PRIMITIVE_CONE: {
+                float bottomRadius = reader.getFloat();
+                float topRadius = reader.getFloat();
+                float height = reader.getFloat();
+                int segments = reader.get<qint32>();
+                auto cone = std::make_shared<Cone>(bottomRadius, topRadius, height, segments);
+                cone->setCenter(reader.getPoint());
+                object = cone;
+                break;
+            }
+            case ObjectType::BOOLEAN_UNION:
+            case ObjectType::BOOLEAN_DIFFERENCE:
+            case ObjectType::BOOLEAN_INTERSECTION: {
+                CADObjectPtr objectA = earlier(reader.get<qint32>());
+                CADObjectPtr objectB = earlier(reader.get<qint32>());
+                const ObjectType booleanType = static_cast<ObjectType>(type);
+                BooleanObject::Operation operation =
+                    booleanType == ObjectType::BOOLEAN_UNION ? BooleanObject::UNION :
+                    booleanType == ObjectType::BOOLEAN_DIFFERENCE ? BooleanObject::DIFFERENCE : BooleanObject::INTERSECTION;
+                object = std::make_shared<BooleanObject>(objectA, objectB, operation);
+                break;
+            }
+            case ObjectType::MESH: {
+                const qint32 chunk = reader.get<qint32>();
+                Point3D min = reader.getPoint();
+                Point3D max = reader.getPoint();
+                auto mesh = std::make_shared<MeshObject>();
+                if (chunk >= 0 && static_cast<size_t>(chunk) < toc.size() && toc[chunk].kind == CHUNK_MESH) {
+                    mesh->setDeferredGeometry(std::make_shared<MeshChunkGeometry>(file, toc[chunk]), min, max);
+                    storage.objectChunks[mesh.get()] = { toc[chunk], mesh->getOwnGeometryRevision() };
+                }
+                object = mesh;
+                break;
+            }
+            case ObjectType::ASSEMBLY: {
+                auto assembly = std::make_shared<Assembly>();
+                const quint32 instanceCount = reader.get<quint32>();
+                for (quint32 i = 0; i < instanceCount && reader.ok(); ++i) {
+                    CADObjectPtr part = earlier(reader.get<qint32>());
+                    const std::string instanceName = reader.getString();
+                    float matrix[16];
+                    for (float& value : matrix) value = reader.getFloat();
+                    const bool hasColor = reader.get<quint8>() != 0;
+                    const quint32 color = reader.get<quint32>();
+                    const bool instanceVisible = reader.get<quint8>() != 0;
+                    const bool locked = reader.get<quint8>() != 0;
+                    if (!part) continue;
+
+                    // Instances of one part can share a name, so the new one is filled in directly
+                    PartInstance* instance = assembly->addPart(part, instanceName);
+                    if (!instance) continue;
+                    instance->transform.matrix = QMatrix4x4(matrix);
+                    instance->color = hasColor ? QColor::fromRgba(color) : QColor();
+                    instance->visible = instanceVisible;
+                    instance->locked = locked;
+                }
+                const quint32 constraintCount = reader.get<quint32>();
+                for (quint32 i = 0; i < constraintCount && reader.ok(); ++i) {
+                    AssemblyConstraint constraint(static_cast<ConstraintType>(reader.get<quint32>()));
+                    constraint.partA = earlier(reader.get<qint32>());
+                    constraint.partB = earlier(reader.get<qint32>());
+                    Point3D pointA = reader.getPoint();
+                    Point3D pointB = reader.getPoint();
+                    Point3D directionA = reader.getPoint();
+                    Point3D directionB = reader.getPoint();
+                    constraint.pointA = pointA;
+                    constraint.pointB = pointB;
+                    constraint.directionA = Vector3D(directionA.x, directionA.y, directionA.z);
+                    constraint.directionB = Vector3D(directionB.x, directionB.y, directionB.z);
+                    constraint.value = reader.getDouble();
+                    constraint.enabled = reader.get<quint8>() != 0;
+                    assembly->addConstraint(constraint);
+                }
+                object = assembly;
+                break;
+            }
+            default:
+                return false;
+        }
+
+        object->setName(name);
+        object->setVisible(visible);
+        objects.push_back(object);
+    }
+
+    const quint32 topLevelCount = reader.get<quint32>();
+    std::vector<CADObjectPtr> topLevel;
+    for (quint32 i = 0; i < topLevelCount && reader.ok(); ++i) {
+        if (CADObjectPtr object = earlier(reader.get<qint32>())) topLevel.push_back(object);
+    }
+    CADObjectPtr root = earlier(reader.get<qint32>());
+    if (!reader.ok()) return false;
+
+    // Adding parts to nested assemblies adjusts their materials, so the stored ones go on last
+    for (size_t i = 0; i < objects.size(); ++i) {
+        objects[i]->setMaterial(materials[i]);
+    }
+
+    document.clearObjects();
+    for (const CADObjectPtr& object : topLevel) {
+        document.addObject(object);
+    }
+    document.setRootObject(root);
+    document.setName(documentName);
+    return true;
+}
+
+bool writeZeros(QFileDevice& file, uint64_t count) {
+    static const char zeros[DocumentIO::CHUNK_ALIGNMENT] = {};
+    while (count > 0) {
+        const qint64 bytes = static_cast<qint64>(std::min<uint64_t>(count, sizeof(zeros)));
+        if (file.write(zeros, bytes) != bytes) return false;
+        count -= static_cast<uint64_t>(bytes);
+    }
+    return true;
+}
+
+// Percentages passed on only when they grow, from whichever thread gets there first
+class ProgressReporter {
+public:
+    explicit ProgressReporter(const std::function<void(int)>& callback) : m_callback(callback), m_last(-1) {}
+
+    void report(int percent) {
+        if (!m_callback) return;
+        int last = m_last.load();
+        while (percent > last) {
+            if (m_last.compare_exchange_weak(last, percent)) {
+                m_callback(percent);
+                return;
+            }
+        }
+    }
+
+private:
+    const std::function<void(int)>& m_callback;
+    std::atomic<int> m_last;
+};
+
+// Large chunks are written in slices so progress keeps moving
+constexpr uint64_t WRITE_SLICE_SIZE = 8 << 20;
+
+bool writeChunk(QFileDevice& file, const PendingChunk& chunk, const std::function<void(uint64_t)>& written) {
+    const char* data = chunk.bytes.data();
+    if (chunk.source) {
+        const MappedFile& source = *chunk.source;
+        if (chunk.entry.offset > source.size() || chunk.entry.storedSize > source.size() - chunk.entry.offset) return false;
+        data = source.data() + chunk.entry.offset;
+    }
+    for (uint64_t offset = 0; offset < chunk.entry.storedSize; offset += WRITE_SLICE_SIZE) {
+        const qint64 size = static_cast<qint64>(std::min(WRITE_SLICE_SIZE, chunk.entry.storedSize - offset));
+        if (file.write(data + offset, size) != size) return false;
+        written(static_cast<uint64_t>(size));
+    }
+    return true;
+}
+
+std::vector<char> encodeHeader(uint64_t tocOffset, uint32_t tocCount) {
+    ByteWriter writer;
+    for (char c : MAGIC) writer.put<qint8>(c);
+    writer.put<quint32>(DocumentIO::FORMAT_VERSION);
+    writer.put<quint32>(0);
+    writer.put<quint64>(tocOffset);
+    writer.put<quint32>(tocCount);
+    writer.put<quint32>(0);
+    return std::move(writer.data());
+}
+
+std::vector<char> encodeToc(const std::vector<Chunk>& entries) {
+    ByteWriter writer;
+    for (const Chunk& entry : entries) {
+        writer.put<quint32>(entry.kind);
+        writer.put<quint32>(entry.flags);
+        writer.put<quint64>(entry.offset);
+        writer.put<quint64>(entry.storedSize);
+        writer.put<quint64>(entry.rawSize);
+    }
+    return std::move(writer.data());
+}
+
+bool writeBytes(QFileDevice& file, const std::vector<char>& bytes) {
+    const qint64 size = static_cast<qint64>(bytes.size());
+    return file.write(bytes.data(), size) == size;
+}
+
+// Waits until everything written so far is on the disk, so no later write can land before it
+bool syncToDisk(QFile& file) {
+    if (!file.flush()) return false;
+#ifdef _WIN32
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+bool DocumentIO::load(const std::string& filePath, PartDocument& document) {
+    auto file = std::make_shared<MappedFile>(filePath);
+    if (!file->open() || file->size() < HEADER_SIZE) return false;
+
+    ByteReader header(file->data(), HEADER_SIZE);
+    for (char c : MAGIC) {
+        if (header.get<qint8>() != c) return false;
+    }
+    const quint32 version = header.get<quint32>();
+    header.get<quint32>();
+    const uint64_t tocOffset = header.get<quint64>();
+    const uint64_t tocCount = header.get<quint32>();
+    if (version == 0 || version > FORMAT_VERSION) return false;
+    if (tocOffset > file->size() || tocCount > (file->size() - tocOffset) / TOC_ENTRY_SIZE) return false;
+
+    std::vector<Chunk> toc(tocCount);
+    ByteReader tocReader(file->data() + tocOffset, tocCount * TOC_ENTRY_SIZE);
+    const Chunk* featureTree = nullptr;
+    for (Chunk& entry : toc) {
+        entry.kind = tocReader.get<quint32>();
+        entry.flags = tocReader.get<quint32>();
+        entry.offset = tocReader.get<quint64>();
+        entry.storedSize = tocReader.get<quint64>();
+        entry.rawSize = tocReader.get<quint64>();
+        if (entry.offset > file->size() || entry.storedSize > file->size() - entry.offset) return false;
+        if (entry.kind == CHUNK_FEATURE_TREE) featureTree = &entry;
+    }
+    if (!featureTree) return false;
+
+    auto storage = std::make_shared<DocumentStorage>();
+    storage->filePath = filePath;
+    storage->fileSize = file->size();
+    storage->liveBytes = HEADER_SIZE + tocCount * TOC_ENTRY_SIZE;
+    for (const Chunk& entry : toc) {
+        storage->liveBytes += alignChunk(entry.storedSize);
+    }
+
+    QByteArray tree = readChunk(*file, *featureTree);
+    storage->featureTreeHash = std::hash<std::string_view>()(std::string_view(tree.constData(), static_cast<size_t>(tree.size())));
+    if (tree.isEmpty() ||
+        !decodeFeatureTree(tree.constData(), static_cast<size_t>(tree.size()), file, toc, document, *storage)) {
+        return false;
+    }
+
+    document.setStorage(storage);
+    document.clearHistory();
+    document.setDirty(false);
+    return true;
+}
+
+// Everything a save writes, taken from the document up front so that writing touches no live
+// object. Meshes are referred to only as keys for the resulting storage.
+struct DocumentIO::SaveJob {
+    std::string filePath;
+    SaveOptions options;
+    std::shared_ptr<const DocumentStorage> previous;
+    bool sameFile = false;
+
+    std::vector<const CADObject*> meshes;
+    std::vector<uint64_t> revisions;
+    // Arrays of the meshes to encode, null for the ones already stored somewhere
+    std::vector<std::shared_ptr<const MeshSnapshot>> snapshots;
+    // One per mesh, then the feature tree
+    std::vector<PendingChunk> chunks;
+    std::vector<char> featureTree;
+    uint64_t featureTreeHash = 0;
+
+    std::shared_ptr<DocumentStorage> result;
+};
+
+namespace {
+
+// Objects of a document in record order, with the meshes among them in table order
+struct DocumentLayout {
+    std::vector<const CADObject*> order;
+    std::unordered_map<const CADObject*, int> recordIndex;
+    std::vector<const CADObject*> meshes;
+    std::unordered_map<const CADObject*, int> meshChunks;
+
+    explicit DocumentLayout(const PartDocument& document) {
+        std::unordered_set<const CADObject*> visiting;
+        for (const CADObjectPtr& object : document.getObjects()) {
+            collectObjects(object.get(), order, recordIndex, visiting);
+        }
+        collectObjects(document.getRootObject().get(), order, recordIndex, visiting);
+
+        // Meshes take the first table entries, in record order, and the feature tree the last
+        for (const CADObject* object : order) {
+            if (object->getType() != ObjectType::MESH) continue;
+            meshChunks[object] = static_cast<int>(meshes.size());
+            meshes.push_back(object);
+        }
+    }
+};
+
+bool isCurrentFile(const DocumentStorage* storage, const std::string& filePath) {
+    const QString path = QString::fromStdString(filePath);
+    return storage && storage->filePath == filePath && QFileInfo::exists(path) &&
+           static_cast<uint64_t>(QFileInfo(path).size()) == storage->fileSize;
+}
+
+uint64_t hashFeatureTree(const std::vector<char>& tree) {
+    return std::hash<std::string_view>()(std::string_view(tree.data(), tree.size()));
+}
+
+} // namespace
+
+bool DocumentIO::isSaved(const PartDocument& document, const DocumentStorage& storage) {
+    if (!isCurrentFile(&storage, storage.filePath)) return false;
+
+    DocumentLayout layout(document);
+    for (const CADObject* mesh : layout.meshes) {
+        auto it = storage.objectChunks.find(mesh);
+        if (it == storage.objectChunks.end() || it->second.revision != mesh->getOwnGeometryRevision()) return false;
+    }
+    std::vector<char> tree;
+    return encodeFeatureTree(document, layout.order, layout.recordIndex, layout.meshChunks, tree) &&
+           hashFeatureTree(tree) == storage.featureTreeHash;
+}
+
+std::shared_ptr<DocumentIO::SaveJob> DocumentIO::prepareSave(const std::string& filePath, const PartDocument& document,
+                                                             std::shared_ptr<const DocumentStorage> previous,
+                                                             const SaveOptions& options) {
+    auto job = std::make_shared<SaveJob>();
+    job->filePath = filePath;
+    job->options = options;
+
+    DocumentLayout layout(document);
+    job->meshes = layout.meshes;
+    job->sameFile = isCurrentFile(previous.get(), filePath);
+    job->previous = std::move(previous);
+
+    // Unchanged meshes stay where they are in the same file, and are copied as stored from the
+    // file they were opened from while their arrays have not been read in. Only the rest are
+    // copied here, to be encoded off this thread.
+    const size_t meshCount = job->meshes.size();
+    job->revisions.resize(meshCount);
+    job->snapshots.resize(meshCount);
+    job->chunks.resize(meshCount + 1);
+    for (size_t i = 0; i < meshCount; ++i) {
+        const auto* mesh = static_cast<const MeshObject*>(job->meshes[i]);
+        job->revisions[i] = mesh->getOwnGeometryRevision();
+        if (job->sameFile) {
+            auto it = job->previous->objectChunks.find(mesh);
+            if (it != job->previous->objectChunks.end() && it->second.revision == job->revisions[i]) {
+                job->chunks[i].entry = it->second.chunk;
+                job->chunks[i].inPlace = true;
+                continue;
+            }
+        }
+        auto deferred = std::dynamic_pointer_cast<const MeshChunkGeometry>(mesh->getDeferredGeometry());
+        if (deferred) {
+            job->chunks[i].entry = deferred->entry();
+            job->chunks[i].source = deferred->file();
+            continue;
+        }
+        job->snapshots[i] = mesh->takeSnapshot(nullptr);
+    }
+
+    if (!encodeFeatureTree(document, layout.order, layout.recordIndex, layout.meshChunks, job->featureTree)) return nullptr;
+    job->featureTreeHash = hashFeatureTree(job->featureTree);
+    return job;
+}
+
+bool DocumentIO::writeSave(SaveJob& job, const std::function<void(int)>& progress) {
+    ProgressReporter reporter(progress);
+    std::vector<PendingChunk>& chunks = job.chunks;
+    const std::string& filePath = job.filePath;
+    const QString path = QString::fromStdString(filePath);
+    const DocumentStorage* previous = job.previous.get();
+    if (job.sameFile && static_cast<uint64_t>(QFileInfo(path).size()) != previous->fileSize) return false;
+
+    // Encoding takes the first half of the progress when there is any
+    std::vector<size_t> toEncode;
+    uint64_t encodeTotal = 0;
+    for (size_t i = 0; i < job.snapshots.size(); ++i) {
+        if (!job.snapshots[i]) continue;
+        toEncode.push_back(i);
+        encodeTotal += snapshotBytes(*job.snapshots[i]);
+    }
+    const int encodeShare = toEncode.empty() ? 0 : 50;
+    std::atomic<uint64_t> encoded{0};
+    ThreadPool::instance().parallelFor(0, toEncode.size(), 1, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; ++k) {
+            const size_t i = toEncode[k];
+            const size_t bytes = snapshotBytes(*job.snapshots[i]);
+            chunks[i] = makeChunk(CHUNK_MESH, encodeMesh(*job.snapshots[i]), job.options.compress);
+            job.snapshots[i].reset();
+            reporter.report(static_cast<int>((encoded += bytes) * encodeShare / std::max<uint64_t>(encodeTotal, 1)));
+        }
+    });
+    chunks.back() = makeChunk(CHUNK_FEATURE_TREE, job.featureTree, job.options.compress);
+
+    const uint64_t tocSize = chunks.size() * TOC_ENTRY_SIZE;
+    uint64_t liveBytes = HEADER_SIZE + tocSize;
+    uint64_t appendedBytes = tocSize;
+    for (const PendingChunk& chunk : chunks) {
+        liveBytes += alignChunk(chunk.entry.storedSize);
+        if (!chunk.inPlace) appendedBytes += alignChunk(chunk.entry.storedSize);
+    }
+
+    // Appending leaves the replaced chunks behind; once they would make up more than half the
+    // file it is written out whole instead
+    bool append = job.sameFile && alignChunk(previous->fileSize) + appendedBytes <= 2 * liveBytes;
+    if (job.sameFile && !append) {
+        auto current = std::make_shared<MappedFile>(filePath);
+        if (!current->open()) return false;
+        for (PendingChunk& chunk : chunks) {
+            if (!chunk.inPlace) continue;
+            chunk.inPlace = false;
+            chunk.source = current;
+        }
+    }
+
+    uint64_t writeTotal = 0;
+    for (const PendingChunk& chunk : chunks) {
+        if (!chunk.inPlace) writeTotal += chunk.entry.storedSize;
+    }
+    uint64_t writtenBytes = 0;
+    auto written = [&](uint64_t bytes) {
+        writtenBytes += bytes;
+        reporter.report(encodeShare + static_cast<int>(writtenBytes * (100 - encodeShare) / std::max<uint64_t>(writeTotal, 1)));
+    };
+
+    auto storage = std::make_shared<DocumentStorage>();
+    storage->filePath = filePath;
+    storage->liveBytes = liveBytes;
+    storage->featureTreeHash = job.featureTreeHash;
+
+    std::vector<Chunk> toc;
+    toc.reserve(chunks.size());
+    if (append) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadWrite)) return false;
+
+        uint64_t offset = alignChunk(previous->fileSize);
+        if (!file.seek(static_cast<qint64>(previous->fileSize)) || !writeZeros(file, offset - previous->fileSize)) return false;
+        for (PendingChunk& chunk : chunks) {
+            if (!chunk.inPlace) {
+                // A copied chunk is read from its old offset, so the new one is set after writing
+                if (!writeChunk(file, chunk, written)) return false;
+                chunk.entry.offset = offset;
+                offset += chunk.entry.storedSize;
+                if (!writeZeros(file, alignChunk(offset) - offset)) return false;
+                offset = alignChunk(offset);
+            }
+            toc.push_back(chunk.entry);
+        }
+        // The old header keeps pointing at the old table until everything else is on disk. The
+        // header is a single sector, so a crash leaves either the old table or the new one live.
+        const uint64_t tocOffset = offset;
+        if (!writeBytes(file, encodeToc(toc)) || !syncToDisk(file)) return false;
+        if (!file.seek(0) || !writeBytes(file, encodeHeader(tocOffset, static_cast<uint32_t>(toc.size()))) ||
+            !syncToDisk(file)) {
+            return false;
+        }
+        storage->fileSize = tocOffset + tocSize;
+        file.close();
+    } else {
+        // Written to a temporary file that replaces the old one only once complete
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) return false;
+
+        uint64_t offset = alignChunk(HEADER_SIZE);
+        for (PendingChunk& chunk : chunks) {
+            Chunk entry = chunk.entry;
+            entry.offset = offset;
+            toc.push_back(entry);
+            offset = alignChunk(offset + entry.storedSize);
+        }
+        const uint64_t tocOffset = offset;
+
+        if (!writeBytes(file, encodeHeader(tocOffset, static_cast<uint32_t>(toc.size()))) ||
+            !writeZeros(file, alignChunk(HEADER_SIZE) - HEADER_SIZE)) {
+            return false;
+        }
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (!writeChunk(file, chunks[i], written) ||
+                !writeZeros(file, alignChunk(toc[i].offset + toc[i].storedSize) - (toc[i].offset + toc[i].storedSize))) {
+                return false;
+            }
+        }
+        if (!writeBytes(file, encodeToc(toc)) || !file.commit()) return false;
+        storage->fileSize = tocOffset + tocSize;
+    }
+
+    for (size_t i = 0; i < job.meshes.size(); ++i) {
+        storage->objectChunks[job.meshes[i]] = { toc[i], job.revisions[i] };
+    }
+    job.result = storage;
+    reporter.report(100);
+    return true;
+}
+
+std::shared_ptr<DocumentStorage> DocumentIO::savedStorage(const SaveJob& job) {
+    return job.result;
+}
+
+const std::string& DocumentIO::savePath(const SaveJob& job) {
+    return job.filePath;
+}
+
+bool DocumentIO::save(const std::string& filePath, PartDocument& document, const SaveOptions& options) {
+    std::shared_ptr<SaveJob> job = prepareSave(filePath, document, document.getStorage(), options);
+    if (!job || !writeSave(*job)) return false;
+
+    document.setStorage(job->result);
+    return true;
+}
+
+} // namespace HybridCAD
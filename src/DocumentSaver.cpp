@@ -0,0 +1,214 @@
+#include "DocumentSaver.h"
+#include "PartManager.h"
+#include "ThreadPool.h"
+#include <QDir>
+#include <QFile>
+#include <QMetaObject>
+#include <QStandardPaths>
+#include <QTimer>
+#include <condition_variable>
+#include <mutex>
+
+namespace HybridCAD {
+
+// A save handed to the thread pool; the worker fills in the result and signals done
+struct DocumentSaver::ActiveSave {
+    Request request;
+    std::shared_ptr<DocumentIO::SaveJob> job;
+    bool wasDirty = false;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    bool success = false;
+};
+
+DocumentSaver::DocumentSaver(QObject* parent)
+    : QObject(parent)
+    , m_autosaveTimer(new QTimer(this))
+    , m_autosaveInterval(0)
+{
+    connect(m_autosaveTimer, &QTimer::timeout, this, &DocumentSaver::autosave);
+}
+
+DocumentSaver::~DocumentSaver()
+{
+    // Saves not yet started are dropped; the one being written is seen through
+    m_queue.clear();
+    waitForFinished();
+}
+
+void DocumentSaver::save(std::shared_ptr<PartDocument> document, const QString& filePath)
+{
+    if (!document || filePath.isEmpty()) return;
+
+    for (const Request& queued : m_queue) {
+        if (!queued.autosave && queued.document == document && queued.filePath == filePath) return;
+    }
+    m_queue.push_back({ document, filePath, false });
+    startNext();
+}
+
+void DocumentSaver::waitForFinished()
+{
+    while (m_active) {
+        {
+            std::unique_lock<std::mutex> lock(m_active->mutex);
+            m_active->finished.wait(lock, [this]() { return m_active->done; });
+        }
+        complete();
+    }
+}
+
+void DocumentSaver::setAutosaveInterval(int milliseconds)
+{
+    m_autosaveInterval = std::max(milliseconds, 0);
+    if (m_autosaveInterval > 0) {
+        m_autosaveTimer->start(m_autosaveInterval);
+    } else {
+        m_autosaveTimer->stop();
+    }
+}
+
+void DocumentSaver::setAutosaveDocument(std::shared_ptr<PartDocument> document)
+{
+    if (m_autosaveDocument.lock() == document) return;
+
+    m_autosaveDocument = document;
+    m_autosaveStorage.reset();
+}
+
+QString DocumentSaver::autosavePath(const PartDocument& document)
+{
+    const QString filePath = QString::fromStdString(document.getFilePath());
+    if (!filePath.isEmpty()) {
+        return filePath + ".autosave";
+    }
+
+    // Untitled documents are told apart by address, which is enough within one session
+    const QString folder = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/autosave";
+    QDir().mkpath(folder);
+    const QString key = QString::number(reinterpret_cast<quintptr>(&document), 16);
+    return folder + "/" + QString::fromStdString(document.getName()) + "-" + key + ".cad";
+}
+
+void DocumentSaver::autosave()
+{
+    std::shared_ptr<PartDocument> document = m_autosaveDocument.lock();
+    if (!document) return;
+
+    // A queued autosave will see the latest state anyway
+    for (const Request& queued : m_queue) {
+        if (queued.autosave) return;
+    }
+    m_queue.push_back({ document, QString(), true });
+    startNext();
+}
+
+void DocumentSaver::startNext()
+{
+    while (!m_active && !m_queue.empty()) {
+        Request request = m_queue.front();
+        m_queue.pop_front();
+        std::shared_ptr<PartDocument> document = request.document;
+
+        emit aboutToSave(document.get());
+
+        std::shared_ptr<const DocumentStorage> previous;
+        if (request.autosave) {
+            // Nothing to write while either the document's file or the last autosave is current
+            std::shared_ptr<const DocumentStorage> saved = document->getStorage();
+            if ((saved && DocumentIO::isSaved(*document, *saved)) ||
+                (m_autosaveStorage && DocumentIO::isSaved(*document, *m_autosaveStorage))) {
+                continue;
+            }
+            request.filePath = autosavePath(*document);
+            previous = m_autosaveStorage;
+        } else {
+            previous = document->getStorage();
+        }
+
+        auto active = std::make_shared<ActiveSave>();
+        active->request = request;
+        active->job = DocumentIO::prepareSave(request.filePath.toStdString(), *document, previous, m_options);
+        if (!active->job) {
+            if (request.autosave) {
+                emit autosaveFinished(request.filePath, false);
+            } else {
+                emit saveFinished(request.filePath, false);
+            }
+            continue;
+        }
+
+        // Edits made while the file is written dirty the document again
+        if (!request.autosave) {
+            active->wasDirty = document->isDirty();
+            document->setDirty(false);
+        }
+        m_active = active;
+
+        std::function<void(int)> progress;
+        if (!request.autosave) {
+            const QString filePath = request.filePath;
+            progress = [this, filePath](int percent) {
+                QMetaObject::invokeMethod(this, [this, filePath, percent]() {
+                    emit saveProgress(filePath, percent);
+                }, Qt::QueuedConnection);
+            };
+        }
+
+        ThreadPool::instance().submit([this, active, progress]() {
+            const bool success = DocumentIO::writeSave(*active->job, progress);
+            // Posted before done is set, since the destructor may return as soon as it is
+            QMetaObject::invokeMethod(this, [this, active]() { finish(active); }, Qt::QueuedConnection);
+            {
+                std::lock_guard<std::mutex> lock(active->mutex);
+                active->success = success;
+                active->done = true;
+            }
+            active->finished.notify_all();
+        });
+    }
+}
+
+void DocumentSaver::finish(const std::shared_ptr<ActiveSave>& active)
+{
+    // waitForFinished() may have completed this save already
+    if (m_active != active) return;
+    {
+        std::unique_lock<std::mutex> lock(active->mutex);
+        active->finished.wait(lock, [&active]() { return active->done; });
+    }
+    complete();
+}
+
+void DocumentSaver::complete()
+{
+    std::shared_ptr<ActiveSave> active = std::move(m_active);
+    const Request& request = active->request;
+    std::shared_ptr<PartDocument> document = request.document;
+
+    if (request.autosave) {
+        if (active->success && document == m_autosaveDocument.lock()) {
+            m_autosaveStorage = DocumentIO::savedStorage(*active->job);
+        }
+        emit autosaveFinished(request.filePath, active->success);
+    } else {
+        if (active->success) {
+            document->setStorage(DocumentIO::savedStorage(*active->job));
+            document->setFilePath(request.filePath.toStdString());
+            // Everything the autosave held is now in the document's own file
+            if (document == m_autosaveDocument.lock() && m_autosaveStorage) {
+                QFile::remove(QString::fromStdString(m_autosaveStorage->filePath));
+                m_autosaveStorage.reset();
+            }
+        } else if (active->wasDirty) {
+            document->setDirty(true);
+        }
+        emit saveFinished(request.filePath, active->success);
+    }
+
+    startNext();
+}
+
+} // namespace HybridCAD
@@ -1,9 +1,290 @@
 #include "GeometryManager.h"
+#include "MeshBoolean.h"
 #include <cmath>
+#include <algorithm>
 #include <GL/gl.h>
 
 namespace HybridCAD {
 
+namespace {
+
+// Whether the ray from origin along direction crosses any triangle of mesh
+bool rayHitsMesh(const RenderMesh& mesh, const QVector3D& origin, const QVector3D& direction) {
+    const float epsilon = 1e-7f;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const float* a = &mesh.vertices[mesh.indices[i] * RenderMesh::FLOATS_PER_VERTEX];
+        const float* b = &mesh.vertices[mesh.indices[i + 1] * RenderMesh::FLOATS_PER_VERTEX];
+        const float* c = &mesh.vertices[mesh.indices[i + 2] * RenderMesh::FLOATS_PER_VERTEX];
+        const QVector3D v0(a[0], a[1], a[2]);
+        const QVector3D edge1 = QVector3D(b[0], b[1], b[2]) - v0;
+        const QVector3D edge2 = QVector3D(c[0], c[1], c[2]) - v0;
+
+        const QVector3D p = QVector3D::crossProduct(direction, edge2);
+        const float determinant = QVector3D::dotProduct(edge1, p);
+        if (std::fabs(determinant) < epsilon) continue;
+        const float inverse = 1.0f / determinant;
+        const QVector3D s = origin - v0;
+        const float u = QVector3D::dotProduct(s, p) * inverse;
+        if (u < 0.0f || u > 1.0f) continue;
+        const QVector3D q = QVector3D::crossProduct(s, edge1);
+        const float v = QVector3D::dotProduct(direction, q) * inverse;
+        if (v < 0.0f || u + v > 1.0f) continue;
+        if (QVector3D::dotProduct(edge2, q) * inverse >= 0.0f) return true;
+    }
+    return false;
+}
+
+MeshBoolean::Operation meshOperation(BooleanObject::Operation operation) {
+    switch (operation) {
+        case BooleanObject::UNION: return MeshBoolean::UNION;
+        case BooleanObject::DIFFERENCE: return MeshBoolean::DIFFERENCE;
+        case BooleanObject::INTERSECTION: return MeshBoolean::INTERSECTION;
+    }
+    return MeshBoolean::UNION;
+}
+
+// Closed surface of revolution around the Y axis, shared by cylinders and cones
+void buildRevolvedMesh(RenderMesh& mesh, const QVector3D& center, float bottomRadius, float topRadius,
+                       float height, int segments) {
+    segments = std::max(segments, 3);
+    const float angleStep = 2.0f * M_PI / segments;
+    const float halfHeight = height / 2.0f;
+    
+    // Side wall with smooth normals, tilted for cones
+    unsigned int firstSide = mesh.vertexCount();
+    for (int i = 0; i <= segments; ++i) {
+        float c = cos(i * angleStep);
+        float s = sin(i * angleStep);
+        QVector3D normal = QVector3D(height * c, bottomRadius - topRadius, height * s).normalized();
+        mesh.addVertex(center + QVector3D(bottomRadius * c, -halfHeight, bottomRadius * s), normal);
+        mesh.addVertex(center + QVector3D(topRadius * c, halfHeight, topRadius * s), normal);
+    }
+    for (int i = 0; i < segments; ++i) {
+        unsigned int b0 = firstSide + 2 * i;
+        unsigned int t0 = b0 + 1;
+        unsigned int b1 = b0 + 2;
+        unsigned int t1 = b0 + 3;
+        mesh.addTriangle(b0, t0, t1);
+        mesh.addTriangle(b0, t1, b1);
+    }
+    
+    // Caps
+    if (bottomRadius > 0.0f) {
+        QVector3D normal(0, -1, 0);
+        unsigned int hub = mesh.addVertex(center + QVector3D(0, -halfHeight, 0), normal);
+        for (int i = 0; i <= segments; ++i) {
+            mesh.addVertex(center + QVector3D(bottomRadius * cos(i * angleStep), -halfHeight,
+                                              bottomRadius * sin(i * angleStep)), normal);
+        }
+        for (int i = 0; i < segments; ++i) {
+            mesh.addTriangle(hub, hub + 1 + i, hub + 2 + i);
+        }
+    }
+    if (topRadius > 0.0f) {
+        QVector3D normal(0, 1, 0);
+        unsigned int hub = mesh.addVertex(center + QVector3D(0, halfHeight, 0), normal);
+        for (int i = 0; i <= segments; ++i) {
+            mesh.addVertex(center + QVector3D(topRadius * cos(i * angleStep), halfHeight,
+                                              topRadius * sin(i * angleStep)), normal);
+        }
+        for (int i = 0; i < segments; ++i) {
+            mesh.addTriangle(hub, hub + 2 + i, hub + 1 + i);
+        }
+    }
+}
+
+void buildBoxMesh(RenderMesh& mesh, const QVector3D& lo, const QVector3D& hi) {
+    // Front and back
+    mesh.addQuad(QVector3D(lo.x(), lo.y(), hi.z()), QVector3D(hi.x(), lo.y(), hi.z()),
+                 QVector3D(hi.x(), hi.y(), hi.z()), QVector3D(lo.x(), hi.y(), hi.z()), QVector3D(0, 0, 1));
+    mesh.addQuad(QVector3D(lo.x(), lo.y(), lo.z()), QVector3D(lo.x(), hi.y(), lo.z()),
+                 QVector3D(hi.x(), hi.y(), lo.z()), QVector3D(hi.x(), lo.y(), lo.z()), QVector3D(0, 0, -1));
+    
+    // Top and bottom
+    mesh.addQuad(QVector3D(lo.x(), hi.y(), lo.z()), QVector3D(lo.x(), hi.y(), hi.z()),
+                 QVector3D(hi.x(), hi.y(), hi.z()), QVector3D(hi.x(), hi.y(), lo.z()), QVector3D(0, 1, 0));
+    mesh.addQuad(QVector3D(lo.x(), lo.y(), lo.z()), QVector3D(hi.x(), lo.y(), lo.z()),
+                 QVector3D(hi.x(), lo.y(), hi.z()), QVector3D(lo.x(), lo.y(), hi.z()), QVector3D(0, -1, 0));
+    
+    // Right and left
+    mesh.addQuad(QVector3D(hi.x(), lo.y(), lo.z()), QVector3D(hi.x(), hi.y(), lo.z()),
+                 QVector3D(hi.x(), hi.y(), hi.z()), QVector3D(hi.x(), lo.y(), hi.z()), QVector3D(1, 0, 0));
+    mesh.addQuad(QVector3D(lo.x(), lo.y(), lo.z()), QVector3D(lo.x(), lo.y(), hi.z()),
+                 QVector3D(lo.x(), hi.y(), hi.z()), QVector3D(lo.x(), hi.y(), lo.z()), QVector3D(-1, 0, 0));
+}
+
+void buildSphereMesh(RenderMesh& mesh, const QVector3D& center, float radius, int segments) {
+    const float PI = 3.14159265359f;
+    const int stacks = std::max(segments / 2, 2);
+    const int slices = std::max(segments, 3);
+    
+    unsigned int first = mesh.vertexCount();
+    for (int i = 0; i <= stacks; ++i) {
+        float lat = PI * (-0.5f + (float)i / stacks);
+        float z = sin(lat);
+        float zr = cos(lat);
+        
+        for (int j = 0; j <= slices; ++j) {
+            float lng = 2 * PI * (float)j / slices;
+            QVector3D normal(cos(lng) * zr, sin(lng) * zr, z);
+            mesh.addVertex(center + radius * normal, normal);
+        }
+    }
+    
+    const unsigned int row = slices + 1;
+    for (int i = 0; i < stacks; ++i) {
+        for (int j = 0; j < slices; ++j) {
+            unsigned int a = first + i * row + j;
+            unsigned int b = a + row;
+            mesh.addTriangle(a, a + 1, b + 1);
+            mesh.addTriangle(a, b + 1, b);
+        }
+    }
+}
+
+// Keys compare bitwise, so -0.0 is folded into 0.0
+float canonical(double value) {
+    return static_cast<float>(value) + 0.0f;
+}
+
+} // namespace
+
+// GeometryPrimitive implementation
+void GeometryPrimitive::generateMesh() {
+    if (m_meshGenerated) return;
+    
+    m_vertices.clear();
+    m_triangles.clear();
+    
+    QMatrix4x4 transform;
+    RenderMeshSnapshot mesh = Tessellator::instance().tessellate(describeTessellation(transform));
+    m_vertices.reserve(mesh->vertexCount());
+    for (size_t i = 0; i < mesh->vertices.size(); i += RenderMesh::FLOATS_PER_VERTEX) {
+        const float* v = &mesh->vertices[i];
+        QVector3D position = transform.map(QVector3D(v[0], v[1], v[2]));
+        m_vertices.push_back(Point3D(position.x(), position.y(), position.z()));
+    }
+    
+    m_triangles.reserve(mesh->indices.size() / 3);
+    for (size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+        Triangle triangle;
+        triangle.v0 = m_vertices[mesh->indices[i]];
+        triangle.v1 = m_vertices[mesh->indices[i + 1]];
+        triangle.v2 = m_vertices[mesh->indices[i + 2]];
+        QVector3D normal = QVector3D::normal(triangle.v0.toQVector3D(), triangle.v1.toQVector3D(), triangle.v2.toQVector3D());
+        triangle.normal = Vector3D(normal.x(), normal.y(), normal.z());
+        m_triangles.push_back(triangle);
+    }
+    
+    m_meshGenerated = true;
+}
+
+TessellationKey GeometryPrimitive::tessellationKey() const {
+    QMatrix4x4 transform;
+    return describeTessellation(transform);
+}
+
+QMatrix4x4 GeometryPrimitive::tessellationTransform() const {
+    QMatrix4x4 transform;
+    describeTessellation(transform);
+    return transform;
+}
+
+bool GeometryPrimitive::buildRenderMesh(RenderMesh& mesh) const {
+    // The background build's result when it is current, so no work is repeated
+    QMatrix4x4 transform;
+    const TessellationKey key = describeTessellation(transform);
+    RenderMeshSnapshot source = m_tessellation && m_tessellationKey == key
+        ? m_tessellation : Tessellator::instance().tessellate(key);
+    if (source->isEmpty()) return false;
+    
+    // Unit meshes are placed here; normals go through the inverse transpose like in the shader
+    const QMatrix4x4 normalTransform = transform.inverted().transposed();
+    const unsigned int base = mesh.vertexCount();
+    mesh.vertices.reserve(mesh.vertices.size() + source->vertices.size());
+    for (size_t i = 0; i < source->vertices.size(); i += RenderMesh::FLOATS_PER_VERTEX) {
+        const float* v = &source->vertices[i];
+        mesh.addVertex(transform.map(QVector3D(v[0], v[1], v[2])),
+                       normalTransform.mapVector(QVector3D(v[3], v[4], v[5])).normalized());
+    }
+    if (base == 0) {
+        mesh.indices.insert(mesh.indices.end(), source->indices.begin(), source->indices.end());
+    } else {
+        for (unsigned int index : source->indices) {
+            mesh.indices.push_back(base + index);
+        }
+    }
+    return true;
+}
+
+RenderMeshSnapshot GeometryPrimitive::tessellation(bool& current) const {
+    const TessellationKey key = tessellationKey();
+    if (!m_tessellation || m_tessellationKey != key) {
+        // Re-requesting drops the stale ticket, which cancels its build if it has not started
+        if (!m_tessellationTicket.valid() || m_ticketKey != key) {
+            m_tessellationTicket = Tessellator::instance().request(key);
+            m_ticketKey = key;
+        }
+        if (m_tessellationTicket.ready()) {
+            if (RenderMeshSnapshot result = m_tessellationTicket.get()) {
+                m_tessellation = std::move(result);
+                m_tessellationKey = key;
+            }
+            m_tessellationTicket.reset();
+        }
+    }
+    current = m_tessellation && m_tessellationKey == key;
+    if (current) {
+        m_tessellationPlacement = tessellationTransform();
+        m_tessellationMin = getBoundingBoxMin();
+        m_tessellationMax = getBoundingBoxMax();
+    }
+    return m_tessellation;
+}
+
+QMatrix4x4 GeometryPrimitive::previewTransform() const {
+    const QVector3D oldMin = m_tessellationMin.toQVector3D();
+    const QVector3D oldMax = m_tessellationMax.toQVector3D();
+    const QVector3D newMin = getBoundingBoxMin().toQVector3D();
+    const QVector3D newMax = getBoundingBoxMax().toQVector3D();
+    
+    // Flat axes have nothing to stretch
+    QVector3D scale(1.0f, 1.0f, 1.0f);
+    const QVector3D oldSize = oldMax - oldMin;
+    const QVector3D newSize = newMax - newMin;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (oldSize[axis] > 0.0f && newSize[axis] > 0.0f) {
+            scale[axis] = newSize[axis] / oldSize[axis];
+        }
+    }
+    
+    QMatrix4x4 stretch;
+    stretch.translate((newMin + newMax) / 2.0f);
+    stretch.scale(scale);
+    stretch.translate(-(oldMin + oldMax) / 2.0f);
+    return stretch * m_tessellationPlacement;
+}
+
+void GeometryPrimitive::tessellate(const TessellationKey& key, RenderMesh& mesh) {
+    const auto& v = key.values;
+    switch (key.type) {
+        case ObjectType::PRIMITIVE_BOX:
+            buildBoxMesh(mesh, QVector3D(v[0], v[1], v[2]), QVector3D(v[3], v[4], v[5]));
+            break;
+        case ObjectType::PRIMITIVE_CYLINDER:
+            buildRevolvedMesh(mesh, QVector3D(0, 0, 0), v[0], v[0], v[1], key.segments);
+            break;
+        case ObjectType::PRIMITIVE_SPHERE:
+            buildSphereMesh(mesh, QVector3D(v[1], v[2], v[3]), v[0], key.segments);
+            break;
+        case ObjectType::PRIMITIVE_CONE:
+            buildRevolvedMesh(mesh, QVector3D(v[3], v[4], v[5]), v[0], v[1], v[2], key.segments);
+            break;
+        default:
+            break;
+    }
+}
+
 // Box implementation
 Box::Box(const Point3D& min, const Point3D& max) 
     : GeometryPrimitive("Box"), m_min(min), m_max(max) {
@@ -66,31 +347,27 @@ bool Box::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) con
             rayOrigin.z >= m_min.z && rayOrigin.z <= m_max.z);
 }
 
-void Box::generateMesh() {
-    if (m_meshGenerated) return;
-    
-    m_vertices.clear();
-    m_triangles.clear();
-    
-    // Generate vertices for a box
-    m_vertices = {
-        Point3D(m_min.x, m_min.y, m_min.z), // 0
-        Point3D(m_max.x, m_min.y, m_min.z), // 1
-        Point3D(m_max.x, m_max.y, m_min.z), // 2
-        Point3D(m_min.x, m_max.y, m_min.z), // 3
-        Point3D(m_min.x, m_min.y, m_max.z), // 4
-        Point3D(m_max.x, m_min.y, m_max.z), // 5
-        Point3D(m_max.x, m_max.y, m_max.z), // 6
-        Point3D(m_min.x, m_max.y, m_max.z)  // 7
-    };
-    
-    m_meshGenerated = true;
+TessellationKey Box::describeTessellation(QMatrix4x4& transform) const {
+    TessellationKey key;
+    key.type = ObjectType::PRIMITIVE_BOX;
+    const QVector3D size = (m_max.toQVector3D() - m_min.toQVector3D());
+    if (size.x() > 0.0f && size.y() > 0.0f && size.z() > 0.0f) {
+        // Unit cube around the origin, scaled into place
+        key.values = { -0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.0f };
+        transform.translate((m_min.toQVector3D() + m_max.toQVector3D()) * 0.5f);
+        transform.scale(size);
+        return key;
+    }
+    key.values = { canonical(m_min.x), canonical(m_min.y), canonical(m_min.z),
+                   canonical(m_max.x), canonical(m_max.y), canonical(m_max.z), 0.0f };
+    return key;
 }
 
 void Box::setDimensions(const Point3D& min, const Point3D& max) {
     m_min = min;
     m_max = max;
     m_meshGenerated = false;
+    markGeometryDirty();
 }
 
 // Cylinder implementation
@@ -137,34 +414,25 @@ bool Cylinder::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection
             rayOrigin.y >= -m_height/2 && rayOrigin.y <= m_height/2);
 }
 
-void Cylinder::generateMesh() {
-    if (m_meshGenerated) return;
-    
-    m_vertices.clear();
-    m_triangles.clear();
-    
-    // Generate vertices for cylinder
-    const float angleStep = 2.0f * M_PI / m_segments;
-    
-    for (int i = 0; i <= m_segments; ++i) {
-        float angle = i * angleStep;
-        float x = m_radius * cos(angle);
-        float z = m_radius * sin(angle);
-        
-        m_vertices.push_back(Point3D(x, -m_height/2, z));
-        m_vertices.push_back(Point3D(x, m_height/2, z));
+TessellationKey Cylinder::describeTessellation(QMatrix4x4& transform) const {
+    TessellationKey key;
+    key.type = ObjectType::PRIMITIVE_CYLINDER;
+    key.segments = std::max(m_segments, 3);
+    if (m_radius > 0.0f && m_height > 0.0f) {
+        key.values = { 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        transform.scale(m_radius, m_height, m_radius);
+        return key;
     }
-    
-    m_meshGenerated = true;
+    key.values = { canonical(m_radius), canonical(m_height), 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    return key;
 }
 
-
-
 void Cylinder::setParameters(float radius, float height, int segments) {
     m_radius = radius;
     m_height = height;
     m_segments = segments;
     m_meshGenerated = false;
+    markGeometryDirty();
 }
 
 // Sphere implementation
@@ -216,40 +484,27 @@ bool Sphere::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection)
     return (dx*dx + dy*dy + dz*dz <= m_radius*m_radius);
 }
 
-void Sphere::generateMesh() {
-    if (m_meshGenerated) return;
-    
-    m_vertices.clear();
-    m_triangles.clear();
-    
-    // Generate vertices for sphere
-    const float PI = 3.14159265359f;
-    const int stacks = m_segments / 2;
-    const int slices = m_segments;
-    
-    for (int i = 0; i <= stacks; ++i) {
-        float lat = PI * (-0.5f + (float)i / stacks);
-        float z = sin(lat);
-        float zr = cos(lat);
-        
-        for (int j = 0; j <= slices; ++j) {
-            float lng = 2 * PI * (float)j / slices;
-            float x = cos(lng);
-            float y = sin(lng);
-            
-            m_vertices.push_back(Point3D(m_center.x + m_radius * x * zr, m_center.y + m_radius * y * zr, m_center.z + m_radius * z));
-        }
+TessellationKey Sphere::describeTessellation(QMatrix4x4& transform) const {
+    TessellationKey key;
+    key.type = ObjectType::PRIMITIVE_SPHERE;
+    // Fewer than three segments tessellate like three
+    key.segments = std::max(m_segments, 3);
+    if (m_radius > 0.0f) {
+        key.values = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        transform.translate(m_center.toQVector3D());
+        transform.scale(m_radius);
+        return key;
     }
-    
-    m_meshGenerated = true;
+    key.values = { canonical(m_radius), canonical(m_center.x), canonical(m_center.y), canonical(m_center.z),
+                   0.0f, 0.0f, 0.0f };
+    return key;
 }
 
-
-
 void Sphere::setParameters(float radius, int segments) {
     m_radius = radius;
     m_segments = segments;
     m_meshGenerated = false;
+    markGeometryDirty();
 }
 
 // Cone implementation
@@ -302,37 +557,31 @@ bool Cone::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) co
             rayOrigin.y >= m_center.y -m_height/2 && rayOrigin.y <= m_center.y + m_height/2);
 }
 
-void Cone::generateMesh() {
-    if (m_meshGenerated) return;
-    
-    m_vertices.clear();
-    m_triangles.clear();
-    
-    // Generate vertices for cone
-    const float angleStep = 2.0f * M_PI / m_segments;
-    
-    for (int i = 0; i <= m_segments; ++i) {
-        float angle = i * angleStep;
-        float x_bottom = m_bottomRadius * cos(angle);
-        float z_bottom = m_bottomRadius * sin(angle);
-        float x_top = m_topRadius * cos(angle);
-        float z_top = m_topRadius * sin(angle);
-        
-        m_vertices.push_back(Point3D(x_bottom, -m_height/2, z_bottom));
-        m_vertices.push_back(Point3D(x_top, m_height/2, z_top));
+TessellationKey Cone::describeTessellation(QMatrix4x4& transform) const {
+    TessellationKey key;
+    key.type = ObjectType::PRIMITIVE_CONE;
+    key.segments = std::max(m_segments, 3);
+    // Only the ratio of the radii shapes the mesh
+    const float radius = std::max(m_bottomRadius, m_topRadius);
+    if (radius > 0.0f && m_height > 0.0f && std::min(m_bottomRadius, m_topRadius) >= 0.0f) {
+        key.values = { canonical(m_bottomRadius / radius), canonical(m_topRadius / radius), 1.0f,
+                       0.0f, 0.0f, 0.0f, 0.0f };
+        transform.translate(m_center.toQVector3D());
+        transform.scale(radius, m_height, radius);
+        return key;
     }
-    
-    m_meshGenerated = true;
+    key.values = { canonical(m_bottomRadius), canonical(m_topRadius), canonical(m_height),
+                   canonical(m_center.x), canonical(m_center.y), canonical(m_center.z), 0.0f };
+    return key;
 }
 
-
-
 void Cone::setParameters(float bottomRadius, float topRadius, float height, int segments) {
     m_bottomRadius = bottomRadius;
     m_topRadius = topRadius;
     m_height = height;
     m_segments = segments;
     m_meshGenerated = false;
+    markGeometryDirty();
 }
 
 // BooleanObject implementation
@@ -352,13 +601,115 @@ ObjectType BooleanObject::getType() const {
 void BooleanObject::render() const {
     if (!m_visible) return;
     
-    // For now, just render both objects
-    if (m_objectA) m_objectA->render();
-    if (m_objectB && m_operation != DIFFERENCE) m_objectB->render();
+    const RenderMeshSnapshot result = getResult();
+    if (!result) {
+        // Nothing to combine yet; show the operands as they are
+        if (m_objectA) m_objectA->render();
+        if (m_objectB && m_operation != DIFFERENCE) m_objectB->render();
+        return;
+    }
+    
+    glColor4f(m_material.diffuseColor.redF(), 
+              m_material.diffuseColor.greenF(), 
+              m_material.diffuseColor.blueF(), 
+              1.0f - m_material.transparency);
+    
+    glBegin(GL_TRIANGLES);
+    for (unsigned int index : result->indices) {
+        const float* vertex = &result->vertices[index * RenderMesh::FLOATS_PER_VERTEX];
+        glNormal3f(vertex[3], vertex[4], vertex[5]);
+        glVertex3f(vertex[0], vertex[1], vertex[2]);
+    }
+    glEnd();
+}
+
+bool BooleanObject::buildRenderMesh(RenderMesh& mesh) const {
+    const RenderMeshSnapshot result = getResult();
+    if (result) {
+        if (result->isEmpty()) return false;
+        const unsigned int base = mesh.vertexCount();
+        mesh.vertices.insert(mesh.vertices.end(), result->vertices.begin(), result->vertices.end());
+        for (unsigned int index : result->indices) {
+            mesh.indices.push_back(base + index);
+        }
+        return true;
+    }
+    
+    // Mirrors render() when there is nothing to combine
+    bool built = false;
+    if (m_objectA) built |= m_objectA->buildRenderMesh(mesh);
+    if (m_objectB && m_operation != DIFFERENCE) built |= m_objectB->buildRenderMesh(mesh);
+    return built;
+}
+
+uint64_t BooleanObject::getGeometryRevision() const {
+    // Revisions only grow, so the newest one changes whenever any operand changes
+    uint64_t revision = m_geometryRevision;
+    if (m_objectA) revision = std::max(revision, m_objectA->getGeometryRevision());
+    if (m_objectB) revision = std::max(revision, m_objectB->getGeometryRevision());
+    return revision;
+}
+
+std::vector<const CADObject*> BooleanObject::getDependencies() const {
+    std::vector<const CADObject*> dependencies;
+    if (m_objectA) dependencies.push_back(m_objectA.get());
+    if (m_objectB) dependencies.push_back(m_objectB.get());
+    return dependencies;
+}
+
+Point3D BooleanObject::getBoundingBoxMin() const {
+    if (getResult()) return m_resultMin;
+    if (!m_objectA) return Point3D();
+    return m_objectA->getBoundingBoxMin();
+}
+
+Point3D BooleanObject::getBoundingBoxMax() const {
+    if (getResult()) return m_resultMax;
+    if (!m_objectA) return Point3D();
+    return m_objectA->getBoundingBoxMax();
+}
+
+RenderMeshSnapshot BooleanObject::getResult() const {
+    updateResult();
+    return m_result;
+}
+
+void BooleanObject::updateResult() const {
+    const uint64_t revision = getGeometryRevision();
+    if (m_resultValid && revision == m_resultRevision) return;
+    m_resultValid = true;
+    m_resultRevision = revision;
+    m_result.reset();
+    m_resultMin = Point3D();
+    m_resultMax = Point3D();
+    
+    RenderMesh meshA;
+    RenderMesh meshB;
+    if (!m_objectA || !m_objectB || !m_objectA->buildRenderMesh(meshA) || !m_objectB->buildRenderMesh(meshB)) {
+        return;
+    }
+    
+    auto result = std::make_shared<RenderMesh>();
+    MeshBoolean::compute(meshA, meshB, meshOperation(m_operation), *result);
+    
+    if (!result->vertices.empty()) {
+        QVector3D min(result->vertices[0], result->vertices[1], result->vertices[2]);
+        QVector3D max = min;
+        for (size_t i = 0; i < result->vertices.size(); i += RenderMesh::FLOATS_PER_VERTEX) {
+            const QVector3D position(result->vertices[i], result->vertices[i + 1], result->vertices[i + 2]);
+            min = QVector3D(std::min(min.x(), position.x()), std::min(min.y(), position.y()), std::min(min.z(), position.z()));
+            max = QVector3D(std::max(max.x(), position.x()), std::max(max.y(), position.y()), std::max(max.z(), position.z()));
+        }
+        m_resultMin = Point3D(min.x(), min.y(), min.z());
+        m_resultMax = Point3D(max.x(), max.y(), max.z());
+    }
+    m_result = result;
 }
 
 bool BooleanObject::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const {
-    // Basic intersection test
+    const RenderMeshSnapshot result = getResult();
+    if (result) return rayHitsMesh(*result, rayOrigin.toQVector3D(), rayDirection.toQVector3D());
+    
     bool intersectsA = m_objectA ? m_objectA->intersects(rayOrigin, rayDirection) : false;
     bool intersectsB = m_objectB ? m_objectB->intersects(rayOrigin, rayDirection) : false;
     
@@ -440,6 +791,14 @@ void GeometryManager::generateMeshForObject(CADObjectPtr object) {
     // Placeholder implementation
 }
 
+void GeometryManager::setTessellationCacheBudget(size_t bytes) {
+    Tessellator::instance().setMemoryBudget(bytes);
+}
+
+size_t GeometryManager::getTessellationCacheBudget() const {
+    return Tessellator::instance().memoryBudget();
+}
+
 void GeometryManager::initializeOpenCASCADE() {
     // Initialize OpenCASCADE if available
     m_openCascadeInitialized = false;
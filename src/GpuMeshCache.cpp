@@ -0,0 +1,381 @@
+#include "GpuMeshCache.h"
+#include "GeometryManager.h"
+#include "PartManager.h"
+#include "RenderProfiler.h"
+
+namespace HybridCAD {
+
+namespace {
+
+// mat4 model (16 floats) followed by vec4 color
+constexpr int INSTANCE_FLOATS = 20;
+
+} // namespace
+
+void GpuMesh::destroy() {
+    if (vao) {
+        vao->destroy();
+        vao.reset();
+    }
+    vertexBuffer.destroy();
+    indexBuffer.destroy();
+    indexCount = 0;
+    hasMesh = false;
+    snapshot.reset();
+    pending = false;
+    shared = nullptr;
+}
+
+void GpuInstanceSet::destroy() {
+    instanceBuffer.destroy();
+    ranges.clear();
+}
+
+GpuMeshCache::GpuMeshCache() : m_gl(nullptr), m_profiler(nullptr), m_pendingTessellations(0) {
+}
+
+GpuMeshCache::~GpuMeshCache() {
+    // GL objects must be freed by clear() while the context is still current
+}
+
+void GpuMeshCache::initialize(QOpenGLExtraFunctions* gl) {
+    m_gl = gl;
+}
+
+void GpuMeshCache::setModelAttribute(const QMatrix4x4& model) {
+    m_model = model;
+    applyModelAttribute(model);
+}
+
+void GpuMeshCache::applyModelAttribute(const QMatrix4x4& model) {
+    if (!m_gl) return;
+    // Constant attribute value used when the instance arrays are disabled
+    for (int column = 0; column < 4; ++column) {
+        QVector4D values = model.column(column);
+        m_gl->glVertexAttrib4f(MODEL_LOCATION + column, values.x(), values.y(), values.z(), values.w());
+    }
+}
+
+bool GpuMeshCache::draw(const CADObject* object) {
+    if (!m_gl || !object) return false;
+
+    destroyReleased();
+
+    GpuMesh* mesh = acquire(object);
+    if (!mesh->hasMesh) return mesh->pending;
+
+    if (mesh->shared) {
+        applyModelAttribute(m_model * mesh->transform);
+        drawMesh(*mesh->shared);
+        applyModelAttribute(m_model);
+    } else {
+        drawMesh(*mesh);
+    }
+    return true;
+}
+
+bool GpuMeshCache::drawTransient(const CADObject* object) {
+    if (!m_gl || !object) return false;
+
+    if (!m_transient) {
+        m_transient = std::make_unique<GpuMesh>();
+    }
+
+    upload(*m_transient, object, QOpenGLBuffer::StreamDraw);
+    if (!m_transient->hasMesh) return false;
+
+    drawMesh(*m_transient);
+    return true;
+}
+
+void GpuMeshCache::drawAssembly(const Assembly* assembly, float alphaOverride, const InstanceFallback& fallback) {
+    if (!m_gl || !assembly) return;
+
+    destroyReleased();
+
+    auto& set = m_instanceSets[assembly];
+    if (!set) {
+        set = std::make_unique<GpuInstanceSet>();
+    }
+
+    // Instances carry the placement of shared primitive meshes, so a part that was resized
+    // without retessellating needs them rebuilt as well
+    uint64_t revision = assembly->getGeometryRevision();
+    uint64_t appearanceRevision = assembly->getAppearanceRevision();
+    bool stale = set->revision != revision || set->appearanceRevision != appearanceRevision ||
+                 set->alphaOverride != alphaOverride;
+    for (const auto& range : set->ranges) {
+        if (!stale && acquire(range.part)->transform != range.partTransform) stale = true;
+    }
+    if (stale) {
+        uploadInstances(*set, assembly, alphaOverride);
+        set->revision = revision;
+        set->appearanceRevision = appearanceRevision;
+        set->alphaOverride = alphaOverride;
+    }
+
+    const int stride = INSTANCE_FLOATS * sizeof(float);
+    std::vector<InstanceBatch> fallbackBatches;
+
+    for (const auto& range : set->ranges) {
+        GpuMesh* mesh = acquire(range.part);
+        if (!mesh->hasMesh) {
+            if (!mesh->pending && fallback && fallbackBatches.empty()) {
+                fallbackBatches = assembly->buildInstanceBatches();
+            }
+            continue;
+        }
+
+        const GpuMesh& buffers = mesh->shared ? *mesh->shared : *mesh;
+        buffers.vao->bind();
+        set->instanceBuffer.bind();
+
+        // Instance attributes are enabled only for this draw so regular draws keep using the
+        // constant model/color values set by the viewer
+        const size_t base = static_cast<size_t>(range.firstInstance) * stride;
+        for (int column = 0; column < 4; ++column) {
+            m_gl->glEnableVertexAttribArray(MODEL_LOCATION + column);
+            m_gl->glVertexAttribPointer(MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, stride,
+                                        reinterpret_cast<const void*>(base + column * 4 * sizeof(float)));
+            m_gl->glVertexAttribDivisor(MODEL_LOCATION + column, 1);
+        }
+        m_gl->glEnableVertexAttribArray(COLOR_LOCATION);
+        m_gl->glVertexAttribPointer(COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, stride,
+                                    reinterpret_cast<const void*>(base + 16 * sizeof(float)));
+        m_gl->glVertexAttribDivisor(COLOR_LOCATION, 1);
+
+        m_gl->glDrawElementsInstanced(GL_TRIANGLES, buffers.indexCount, GL_UNSIGNED_INT, nullptr,
+                                      range.instanceCount);
+        if (m_profiler) m_profiler->countDraw(buffers.indexCount / 3, range.instanceCount);
+
+        for (int location = MODEL_LOCATION; location <= COLOR_LOCATION; ++location) {
+            m_gl->glVertexAttribDivisor(location, 0);
+            m_gl->glDisableVertexAttribArray(location);
+        }
+        set->instanceBuffer.release();
+        buffers.vao->release();
+    }
+
+    // Parts that can only draw themselves through render()
+    for (const auto& batch : fallbackBatches) {
+        GpuMesh* mesh = acquire(batch.part.get());
+        if (mesh->hasMesh || mesh->pending) continue;
+
+        for (size_t i = 0; i < batch.transforms.size(); ++i) {
+            QColor color = batch.colors[i];
+            if (alphaOverride >= 0.0f) color.setAlphaF(alphaOverride);
+            fallback(*batch.part, batch.transforms[i], color);
+        }
+    }
+}
+
+void GpuMeshCache::uploadInstances(GpuInstanceSet& set, const Assembly* assembly, float alphaOverride) {
+    std::vector<InstanceBatch> batches = assembly->buildInstanceBatches();
+
+    std::vector<float> data;
+    set.ranges.clear();
+    for (const auto& batch : batches) {
+        const QMatrix4x4 partTransform = acquire(batch.part.get())->transform;
+        GpuInstanceSet::Range range{batch.part.get(), static_cast<int>(data.size() / INSTANCE_FLOATS),
+                                    static_cast<int>(batch.transforms.size()), partTransform};
+        set.ranges.push_back(range);
+
+        for (size_t i = 0; i < batch.transforms.size(); ++i) {
+            const QMatrix4x4 transform = batch.transforms[i] * partTransform;
+            const float* matrix = transform.constData();
+            data.insert(data.end(), matrix, matrix + 16);
+
+            const QColor& color = batch.colors[i];
+            data.push_back(color.redF());
+            data.push_back(color.greenF());
+            data.push_back(color.blueF());
+            data.push_back(alphaOverride >= 0.0f ? alphaOverride : color.alphaF());
+        }
+    }
+
+    if (!set.instanceBuffer.isCreated()) {
+        set.instanceBuffer.create();
+        set.instanceBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+    set.instanceBuffer.bind();
+    set.instanceBuffer.allocate(data.data(), static_cast<int>(data.size() * sizeof(float)));
+    set.instanceBuffer.release();
+}
+
+void GpuMeshCache::release(const CADObject* object) {
+    auto it = m_meshes.find(object);
+    if (it != m_meshes.end()) {
+        releaseShared(*it->second);
+        m_released.push_back(std::move(it->second));
+        m_meshes.erase(it);
+    }
+
+    auto setIt = m_instanceSets.find(object);
+    if (setIt != m_instanceSets.end()) {
+        m_releasedInstanceSets.push_back(std::move(setIt->second));
+        m_instanceSets.erase(setIt);
+    }
+}
+
+void GpuMeshCache::releaseAll() {
+    for (auto& entry : m_meshes) {
+        releaseShared(*entry.second);
+        m_released.push_back(std::move(entry.second));
+    }
+    m_meshes.clear();
+
+    for (auto& entry : m_instanceSets) {
+        m_releasedInstanceSets.push_back(std::move(entry.second));
+    }
+    m_instanceSets.clear();
+}
+
+void GpuMeshCache::clear() {
+    releaseAll();
+    destroyReleased();
+
+    if (m_transient) {
+        m_transient->destroy();
+        m_transient.reset();
+    }
+}
+
+GpuMesh* GpuMeshCache::acquire(const CADObject* object) {
+    auto& entry = m_meshes[object];
+    if (!entry) {
+        entry = std::make_unique<GpuMesh>();
+    }
+
+    uint64_t revision = object->getGeometryRevision();
+    if (entry->revision == revision) return entry.get();
+
+    const auto* primitive = dynamic_cast<const GeometryPrimitive*>(object);
+    if (!primitive) {
+        upload(*entry, object, QOpenGLBuffer::StaticDraw);
+        entry->revision = revision;
+        return entry.get();
+    }
+
+    // Swap buffers only once the background tessellation lands; until then the last upload stays,
+    // stretched to the present bounds
+    bool current = false;
+    RenderMeshSnapshot snapshot = primitive->tessellation(current);
+    if (snapshot && snapshot != entry->snapshot) {
+        releaseShared(*entry);
+        entry->shared = acquireShared(snapshot);
+        entry->snapshot = std::move(snapshot);
+    }
+    entry->hasMesh = entry->shared && entry->shared->hasMesh;
+    entry->pending = !current && !entry->snapshot;
+    if (current) {
+        entry->transform = primitive->tessellationTransform();
+        entry->revision = revision;
+    } else {
+        if (entry->snapshot) {
+            entry->transform = primitive->previewTransform();
+        }
+        ++m_pendingTessellations;
+    }
+    return entry.get();
+}
+
+GpuMesh* GpuMeshCache::acquireShared(const RenderMeshSnapshot& snapshot) {
+    SharedMesh& shared = m_sharedMeshes[snapshot.get()];
+    if (!shared.mesh) {
+        shared.mesh = std::make_unique<GpuMesh>();
+        uploadMesh(*shared.mesh, *snapshot, QOpenGLBuffer::StaticDraw);
+        // Keeps the address used as the key from being reused while the buffers exist
+        shared.mesh->snapshot = snapshot;
+    }
+    ++shared.users;
+    return shared.mesh.get();
+}
+
+void GpuMeshCache::releaseShared(GpuMesh& entry) {
+    if (!entry.shared) return;
+
+    auto it = m_sharedMeshes.find(entry.shared->snapshot.get());
+    entry.shared = nullptr;
+    entry.hasMesh = false;
+    if (it == m_sharedMeshes.end() || --it->second.users > 0) return;
+
+    m_released.push_back(std::move(it->second.mesh));
+    m_sharedMeshes.erase(it);
+}
+
+int GpuMeshCache::takePendingTessellations() {
+    int pending = m_pendingTessellations;
+    m_pendingTessellations = 0;
+    return pending;
+}
+
+void GpuMeshCache::upload(GpuMesh& mesh, const CADObject* object, QOpenGLBuffer::UsagePattern usage) {
+    m_scratch.clear();
+    if (!object->buildRenderMesh(m_scratch) || m_scratch.isEmpty()) {
+        mesh.hasMesh = false;
+        mesh.indexCount = 0;
+        return;
+    }
+    uploadMesh(mesh, m_scratch, usage);
+}
+
+void GpuMeshCache::uploadMesh(GpuMesh& mesh, const RenderMesh& source, QOpenGLBuffer::UsagePattern usage) {
+    mesh.hasMesh = !source.isEmpty();
+    mesh.indexCount = static_cast<int>(source.indices.size());
+    if (!mesh.hasMesh) return;
+
+    if (!mesh.vao) {
+        mesh.vao = std::make_unique<QOpenGLVertexArrayObject>();
+        mesh.vao->create();
+        mesh.vertexBuffer.create();
+        mesh.indexBuffer.create();
+        mesh.vertexBuffer.setUsagePattern(usage);
+        mesh.indexBuffer.setUsagePattern(usage);
+
+        // Attribute layout and element binding are captured by the VAO once
+        mesh.vao->bind();
+        mesh.vertexBuffer.bind();
+        mesh.indexBuffer.bind();
+
+        const int stride = RenderMesh::FLOATS_PER_VERTEX * sizeof(float);
+        m_gl->glEnableVertexAttribArray(POSITION_LOCATION);
+        m_gl->glVertexAttribPointer(POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+        m_gl->glEnableVertexAttribArray(NORMAL_LOCATION);
+        m_gl->glVertexAttribPointer(NORMAL_LOCATION, 3, GL_FLOAT, GL_FALSE, stride,
+                                    reinterpret_cast<const void*>(3 * sizeof(float)));
+        mesh.vao->release();
+    }
+
+    mesh.vertexBuffer.bind();
+    mesh.vertexBuffer.allocate(source.vertices.data(),
+                               static_cast<int>(source.vertices.size() * sizeof(float)));
+    mesh.vertexBuffer.release();
+
+    // Binding the IBO outside the VAO would not change the VAO's element binding
+    mesh.vao->bind();
+    mesh.indexBuffer.bind();
+    mesh.indexBuffer.allocate(source.indices.data(),
+                              static_cast<int>(source.indices.size() * sizeof(unsigned int)));
+    mesh.vao->release();
+}
+
+void GpuMeshCache::drawMesh(const GpuMesh& mesh) {
+    mesh.vao->bind();
+    m_gl->glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+    if (m_profiler) m_profiler->countDraw(mesh.indexCount / 3);
+    mesh.vao->release();
+}
+
+void GpuMeshCache::destroyReleased() {
+    for (auto& mesh : m_released) {
+        mesh->destroy();
+    }
+    m_released.clear();
+
+    for (auto& set : m_releasedInstanceSets) {
+        set->destroy();
+    }
+    m_releasedInstanceSets.clear();
+}
+
+} // namespace HybridCAD
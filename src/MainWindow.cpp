@@ -1,10 +1,14 @@
 #include "MainWindow.h"
 #include "CADViewer.h"
 #include "PropertyPanel.h"
+#include "PropertyEditBatch.h"
 #include "TreeView.h"
 #include "ToolManager.h"
 #include "KeyBindingDialog.h"
 #include "PreferencesDialog.h"
+#include "MeshManager.h"
+#include "PartManager.h"
+#include "DocumentSaver.h"
 
 #include <QApplication>
 #include <QMessageBox>
@@ -24,6 +28,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_propertyPanel(nullptr)
     , m_treeView(nullptr)
     , m_toolManager(nullptr)
+    , m_documentSaver(nullptr)
 {
     setWindowTitle("HybridCAD - Advanced CAD & Mesh Editor");
     setMinimumSize(1200, 800);
@@ -42,6 +47,16 @@ MainWindow::MainWindow(QWidget *parent)
     restoreGeometry(settings.value("geometry").toByteArray());
     restoreState(settings.value("windowState").toByteArray());
     
+    // Document saving and autosave
+    m_documentSaver = new DocumentSaver(this);
+    connect(m_documentSaver, &DocumentSaver::aboutToSave, this, &MainWindow::syncDocument);
+    connect(m_documentSaver, &DocumentSaver::saveProgress, this, [this](const QString& filePath, int percent) {
+        m_statusLabel->setText(tr("Saving %1... %2%").arg(strippedName(filePath)).arg(percent));
+    });
+    connect(m_documentSaver, &DocumentSaver::saveFinished, this, &MainWindow::documentSaved);
+    setDocument(std::make_shared<PartDocument>("Untitled"));
+    m_documentSaver->setAutosaveInterval(settings.value("autosaveInterval", 5 * 60 * 1000).toInt());
+    
     // Update recent files menu
     updateRecentFileActions();
     
@@ -62,6 +77,7 @@ MainWindow::~MainWindow()
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     // TODO: Check for unsaved changes
+    m_documentSaver->waitForFinished();
     event->accept();
 }
 
@@ -177,6 +193,16 @@ void MainWindow::createActions()
     m_axesAct->setCheckable(true);
     connect(m_axesAct, &QAction::triggered, this, &MainWindow::toggleAxes);
     
+    m_renderStatsAct = new QAction(tr("Render &Statistics"), this);
+    m_renderStatsAct->setCheckable(true);
+    m_renderStatsAct->setShortcut(QKeySequence(Qt::Key_F3));
+    m_renderStatsAct->setStatusTip(tr("Show per-pass frame timings and draw counters"));
+    connect(m_renderStatsAct, &QAction::triggered, this, &MainWindow::toggleRenderStatistics);
+    
+    m_exportRenderProfileAct = new QAction(tr("Export Render &Profile..."), this);
+    m_exportRenderProfileAct->setStatusTip(tr("Save recorded frame timings as CSV or Chrome trace"));
+    connect(m_exportRenderProfileAct, &QAction::triggered, this, &MainWindow::exportRenderProfile);
+    
     // Create actions
     m_createBoxAct = new QAction(QIcon(":/icons/box.png"), tr("&Box"), this);
     m_createBoxAct->setStatusTip(tr("Create a box primitive"));
@@ -348,6 +374,9 @@ void MainWindow::createMenus()
     m_viewMenu->addAction(m_wireframeAct);
     m_viewMenu->addAction(m_gridAct);
     m_viewMenu->addAction(m_axesAct);
+    m_viewMenu->addSeparator();
+    m_viewMenu->addAction(m_renderStatsAct);
+    m_viewMenu->addAction(m_exportRenderProfileAct);
     
     // Create menu
     m_createMenu = menuBar()->addMenu(tr("&Create"));
@@ -500,8 +529,22 @@ void MainWindow::createDockWindows()
 void MainWindow::setupLayoutAndConnections()
 {
     // Connect CAD viewer signals
-    connect(m_cadViewer, &CADViewer::objectSelected, m_propertyPanel, &PropertyPanel::setSelectedObject);
-    connect(m_cadViewer, &CADViewer::objectSelected, m_treeView, &TreeView::selectObject);
+    // The outline and the property panel follow the scene and its selection as a whole, not object by object
+    connect(m_cadViewer, &CADViewer::selectionChanged, this, [this]() {
+        m_treeView->setSelectedObjects(m_cadViewer->getSelectedObjects());
+        m_propertyPanel->setSelectedObjects(m_cadViewer->getSelectedObjects());
+    });
+    connect(m_cadViewer, &CADViewer::objectAdded, m_treeView, &TreeView::addObject);
+    connect(m_cadViewer, &CADViewer::objectAdded, this, [this](CADObjectPtr object) {
+        // Instances moved inside an assembly are recorded like any other edit
+        if (auto assembly = std::dynamic_pointer_cast<Assembly>(object)) {
+            assembly->setUndoRecorder([this](UndoCommandPtr command) {
+                m_document->addUndoCommand(std::move(command));
+            });
+        }
+    });
+    connect(m_cadViewer, &CADViewer::objectRemoved, m_treeView, &TreeView::removeObject);
+    connect(m_cadViewer, &CADViewer::objectsCleared, m_treeView, &TreeView::clearObjects);
     connect(m_cadViewer, &CADViewer::coordinatesChanged, this, [this](const QVector3D& pos) {
         m_coordinateLabel->setText(QString("X: %1  Y: %2  Z: %3")
                                   .arg(pos.x(), 0, 'f', 2)
@@ -549,8 +592,27 @@ void MainWindow::setupLayoutAndConnections()
     });
     
     // Connect tree view signals
-    connect(m_treeView, &TreeView::objectSelected, m_cadViewer, &CADViewer::selectObject);
-    connect(m_treeView, &TreeView::objectSelected, m_propertyPanel, &PropertyPanel::setSelectedObject);
+    connect(m_treeView, &TreeView::selectionChanged, m_cadViewer, &CADViewer::setSelectedObjects);
+    
+    // Property edits arrive at most once a frame; only names and visibility show in the outline
+    connect(m_propertyPanel, &PropertyPanel::objectsChanged, this, [this](const std::vector<CADObjectPtr>& objects, int changes) {
+        m_cadViewer->refreshObjects(objects);
+        if (changes & (PROPERTY_NAME | PROPERTY_VISIBILITY)) {
+            m_treeView->refreshObjects(objects);
+        }
+    });
+    // Renaming or hiding in the outline reaches the other views the same way
+    connect(m_treeView, &TreeView::objectVisibilityChanged, this, [this](CADObjectPtr object) {
+        m_cadViewer->refreshObjects({ object });
+        m_propertyPanel->refreshObjects({ object });
+    });
+    connect(m_treeView, &TreeView::objectRenamed, this, [this](CADObjectPtr object) {
+        m_propertyPanel->refreshObjects({ object });
+    });
+    // Each finished edit gesture is one step of the document's history
+    m_propertyPanel->getEditBatch()->setRecorder([this](UndoCommandPtr command) {
+        m_document->addUndoCommand(std::move(command));
+    });
     
     // Connect dock widget visibility to actions
     connect(m_propertyDock, &QDockWidget::visibilityChanged, m_propertyPanelAct, &QAction::setChecked);
@@ -565,6 +627,7 @@ void MainWindow::newFile()
     m_cadViewer->clearObjects();
     m_treeView->clearObjects();
     m_propertyPanel->clearSelection();
+    setDocument(std::make_shared<PartDocument>("Untitled"));
     setCurrentFile("");
     m_statusLabel->setText(tr("New file created"));
 }
@@ -573,10 +636,26 @@ void MainWindow::openFile()
 {
     QString fileName = QFileDialog::getOpenFileName(this,
         tr("Open CAD File"), "",
-        tr("CAD Files (*.cad *.step *.stp *.iges *.igs);;All Files (*)"));
+        tr("CAD Files (*.cad);;All Files (*)"));
     
     if (!fileName.isEmpty()) {
-        // TODO: Implement file loading
+        const std::string path = fileName.toStdString();
+        auto document = std::make_shared<PartDocument>(QFileInfo(fileName).completeBaseName().toStdString());
+        document->setFilePath(path);
+        if (!DocumentIO::load(path, *document)) {
+            QMessageBox::warning(this, tr("Open"), tr("Could not open %1.").arg(fileName));
+            return;
+        }
+        
+        // The viewer takes the document's objects, so the next save finds them unchanged and
+        // only appends what is edited from here on
+        m_cadViewer->clearObjects();
+        m_treeView->clearObjects();
+        m_propertyPanel->clearSelection();
+        setDocument(document);
+        for (const auto& object : document->getObjects()) {
+            m_cadViewer->addObject(object);
+        }
         setCurrentFile(fileName);
         m_statusLabel->setText(tr("File opened: %1").arg(fileName));
     }
@@ -587,11 +666,31 @@ void MainWindow::saveFile()
     if (m_currentFile.isEmpty()) {
         saveAsFile();
     } else {
-        // TODO: Implement file saving
-        m_statusLabel->setText(tr("File saved: %1").arg(m_currentFile));
+        // Written in the background; documentSaved() reports the outcome
+        m_statusLabel->setText(tr("Saving %1...").arg(strippedName(m_currentFile)));
+        m_documentSaver->save(m_document, m_currentFile);
     }
 }
 
+void MainWindow::documentSaved(const QString& filePath, bool success)
+{
+    if (success) {
+        m_statusLabel->setText(tr("File saved: %1").arg(filePath));
+    } else {
+        m_statusLabel->setText(tr("Save failed"));
+        QMessageBox::warning(this, tr("Save"), tr("Could not save %1.").arg(filePath));
+    }
+}
+
+void MainWindow::syncDocument(PartDocument* document)
+{
+    // The viewer owns the scene; the document only needs its object list for saving, and
+    // mirroring it is not an edit, so the undo history is left alone
+    if (document != m_document.get() || m_document->getObjects() == m_cadViewer->getObjects()) return;
+    
+    m_document->setObjects(m_cadViewer->getObjects());
+}
+
 void MainWindow::saveAsFile()
 {
     QString fileName = QFileDialog::getSaveFileName(this,
@@ -611,7 +710,28 @@ void MainWindow::exportFile()
         tr("STEP Files (*.step *.stp);;IGES Files (*.iges *.igs);;STL Files (*.stl);;OBJ Files (*.obj)"));
     
     if (!fileName.isEmpty()) {
-        // TODO: Implement export
+        QString suffix = QFileInfo(fileName).suffix().toLower();
+        if (suffix == "stl" || suffix == "obj") {
+            const auto& selected = m_cadViewer->getSelectedObjects();
+            if (selected.empty()) {
+                QMessageBox::warning(this, tr("Export"), tr("Select an object to export."));
+                return;
+            }
+            
+            MeshManager meshManager;
+            auto mesh = std::dynamic_pointer_cast<MeshObject>(selected.front());
+            if (!mesh) {
+                mesh = meshManager.convertToMesh(selected.front());
+            }
+            
+            std::string path = fileName.toStdString();
+            bool exported = suffix == "stl" ? meshManager.exportSTL(path, mesh) : meshManager.exportOBJ(path, mesh);
+            if (!exported) {
+                QMessageBox::warning(this, tr("Export"), tr("Could not export %1").arg(fileName));
+                return;
+            }
+        }
+        // TODO: STEP/IGES export
         m_statusLabel->setText(tr("File exported: %1").arg(fileName));
     }
 }
@@ -623,14 +743,78 @@ void MainWindow::importFile()
         tr("STEP Files (*.step *.stp);;IGES Files (*.iges *.igs);;STL Files (*.stl);;OBJ Files (*.obj);;All Files (*)"));
     
     if (!fileName.isEmpty()) {
-        // TODO: Implement import
+        QFileInfo info(fileName);
+        QString suffix = info.suffix().toLower();
+        if (suffix == "stl" || suffix == "obj") {
+            MeshManager meshManager;
+            auto mesh = meshManager.createMesh(info.completeBaseName().toStdString());
+            
+            std::string path = fileName.toStdString();
+            bool imported = suffix == "stl" ? meshManager.importSTL(path, mesh) : meshManager.importOBJ(path, mesh);
+            if (!imported) {
+                QMessageBox::warning(this, tr("Import"), tr("Could not import %1").arg(fileName));
+                return;
+            }
+            m_cadViewer->addObject(mesh);
+        }
+        // TODO: STEP/IGES import
         m_statusLabel->setText(tr("File imported: %1").arg(fileName));
     }
 }
 
 // Edit menu implementations
-void MainWindow::undo() { m_statusLabel->setText(tr("Undo")); }
-void MainWindow::redo() { m_statusLabel->setText(tr("Redo")); }
+void MainWindow::undo()
+{
+    // An edit still open in the property panel becomes the step undone
+    m_propertyPanel->getEditBatch()->commit();
+    if (!m_document->canUndo()) return;
+    
+    const QString description = QString::fromStdString(m_document->getHistory().undoDescription());
+    m_document->undo();
+    refreshScene();
+    m_statusLabel->setText(tr("Undo %1").arg(description));
+}
+
+void MainWindow::redo()
+{
+    m_propertyPanel->getEditBatch()->commit();
+    if (!m_document->canRedo()) return;
+    
+    const QString description = QString::fromStdString(m_document->getHistory().redoDescription());
+    m_document->redo();
+    refreshScene();
+    m_statusLabel->setText(tr("Redo %1").arg(description));
+}
+
+void MainWindow::setDocument(std::shared_ptr<PartDocument> document)
+{
+    if (m_document) {
+        m_document->getHistory().setChangedCallback(nullptr);
+    }
+    m_document = std::move(document);
+    m_document->getHistory().setChangedCallback([this]() { updateUndoActions(); });
+    m_documentSaver->setAutosaveDocument(m_document);
+    m_propertyPanel->setDocument(m_document.get());
+    updateUndoActions();
+}
+
+void MainWindow::updateUndoActions()
+{
+    const UndoHistory& history = m_document->getHistory();
+    m_undoAct->setEnabled(history.canUndo());
+    m_redoAct->setEnabled(history.canRedo());
+    m_undoAct->setText(history.canUndo() ? tr("&Undo %1").arg(QString::fromStdString(history.undoDescription())) : tr("&Undo"));
+    m_redoAct->setText(history.canRedo() ? tr("&Redo %1").arg(QString::fromStdString(history.redoDescription())) : tr("&Redo"));
+}
+
+void MainWindow::refreshScene()
+{
+    // Commands do not report what they touched, so every view looks at the whole scene again
+    const CADObjectList& objects = m_cadViewer->getObjects();
+    m_cadViewer->refreshObjects(objects);
+    m_treeView->refreshObjects(objects);
+    m_propertyPanel->refreshObjects(objects);
+}
 void MainWindow::cut() { m_statusLabel->setText(tr("Cut")); }
 void MainWindow::copy() { m_statusLabel->setText(tr("Copy")); }
 void MainWindow::paste() { m_statusLabel->setText(tr("Paste")); }
@@ -659,6 +843,32 @@ void MainWindow::toggleAxes() {
     if (m_cadViewer) m_cadViewer->setAxesVisible(m_axesAct->isChecked()); 
 }
 
+void MainWindow::toggleRenderStatistics() {
+    if (m_cadViewer) m_cadViewer->setProfilerOverlayVisible(m_renderStatsAct->isChecked());
+}
+
+void MainWindow::exportRenderProfile()
+{
+    if (!m_cadViewer) return;
+    if (!m_cadViewer->isProfilerOverlayVisible()) {
+        QMessageBox::information(this, tr("Export Render Profile"),
+            tr("Enable View > Render Statistics to record frames first."));
+        return;
+    }
+    
+    QString fileName = QFileDialog::getSaveFileName(this,
+        tr("Export Render Profile"), "",
+        tr("Chrome Trace (*.json);;CSV Files (*.csv)"));
+    
+    if (!fileName.isEmpty()) {
+        if (!m_cadViewer->exportRenderProfile(fileName)) {
+            QMessageBox::warning(this, tr("Export Render Profile"), tr("Could not write %1").arg(fileName));
+            return;
+        }
+        m_statusLabel->setText(tr("Render profile exported: %1").arg(fileName));
+    }
+}
+
 // Create menu implementations
 void MainWindow::createBox() { 
     if (m_cadViewer) {
@@ -721,9 +931,60 @@ void MainWindow::createSketch() { m_statusLabel->setText(tr("Create sketch")); }
 // Mesh menu implementations
 void MainWindow::enterMeshEditMode() { m_statusLabel->setText(tr("Enter mesh edit mode")); }
 void MainWindow::exitMeshEditMode() { m_statusLabel->setText(tr("Exit mesh edit mode")); }
-void MainWindow::subdivideMesh() { m_statusLabel->setText(tr("Subdivide mesh")); }
-void MainWindow::smoothMesh() { m_statusLabel->setText(tr("Smooth mesh")); }
-void MainWindow::decimateMesh() { m_statusLabel->setText(tr("Decimate mesh")); }
+void MainWindow::subdivideMesh() {
+    if (!m_cadViewer) return;
+    
+    MeshManager meshManager;
+    meshManager.setUndoHistory(&m_document->getHistory());
+    int subdivided = 0;
+    m_document->beginUndoGroup("Subdivide");
+    for (const auto& object : m_cadViewer->getSelectedObjects()) {
+        auto mesh = std::dynamic_pointer_cast<MeshObject>(object);
+        if (mesh && meshManager.applySubdivisionSurface(mesh, 1)) {
+            m_cadViewer->updateObject(mesh);
+            ++subdivided;
+        }
+    }
+    m_document->endUndoGroup();
+    m_statusLabel->setText(subdivided > 0 ? tr("Subdivided %1 mesh(es)").arg(subdivided) : tr("Select a mesh to subdivide"));
+}
+
+void MainWindow::smoothMesh() {
+    if (!m_cadViewer) return;
+    
+    MeshManager meshManager;
+    meshManager.setUndoHistory(&m_document->getHistory());
+    int smoothed = 0;
+    m_document->beginUndoGroup("Smooth");
+    for (const auto& object : m_cadViewer->getSelectedObjects()) {
+        auto mesh = std::dynamic_pointer_cast<MeshObject>(object);
+        if (mesh && meshManager.smoothMesh(mesh)) {
+            m_cadViewer->updateObject(mesh);
+            ++smoothed;
+        }
+    }
+    m_document->endUndoGroup();
+    m_statusLabel->setText(smoothed > 0 ? tr("Smoothed %1 mesh(es)").arg(smoothed) : tr("Select a mesh to smooth"));
+}
+void MainWindow::decimateMesh() {
+    if (!m_cadViewer) return;
+    
+    // Halves the triangle count of each selected mesh
+    MeshManager meshManager;
+    meshManager.setUndoHistory(&m_document->getHistory());
+    int decimated = 0;
+    m_document->beginUndoGroup("Decimate");
+    for (const auto& object : m_cadViewer->getSelectedObjects()) {
+        auto mesh = std::dynamic_pointer_cast<MeshObject>(object);
+        if (mesh && meshManager.decimateMesh(mesh, 0.5f)) {
+            m_cadViewer->updateObject(mesh);
+            ++decimated;
+        }
+    }
+    m_document->endUndoGroup();
+    m_statusLabel->setText(decimated > 0 ? tr("Decimated %1 mesh(es)").arg(decimated) : tr("Select a mesh to decimate"));
+}
+
 
 // Boolean operations
 void MainWindow::booleanUnion() { m_statusLabel->setText(tr("Boolean union")); }
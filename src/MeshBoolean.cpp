@@ -0,0 +1,1256 @@
+#include "MeshBoolean.h"
+#include "SpatialIndex.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace HybridCAD {
+
+namespace {
+
+constexpr int64_t GRID_SIZE = int64_t(1) << MeshBoolean::GRID_BITS;
+// Distance in grid steps within which a constructed point counts as on a plane
+constexpr double PLANE_EPSILON = 1e-6;
+// Twice the signed area, in barycentric units, below which three points count as collinear
+constexpr double AREA_EPSILON = 1e-12;
+// Barycentric margin of a ray hit counted as grazing an edge
+constexpr double RAY_EDGE_EPSILON = 1e-9;
+// Ray distance in grid steps below which the start point counts as on the surface
+constexpr double RAY_START_EPSILON = 1e-6;
+// Distance in grid steps within which seam points the two operands constructed are the same point
+constexpr double SEAM_EPSILON = 1e-4;
+// Output points closer than this many grid steps are welded; nearly parallel planes can put
+// more rounding into a constructed point than SEAM_EPSILON allows for, but far less than a step
+constexpr double WELD_STEPS = 0.05;
+
+constexpr size_t PAIR_GRAIN = 256;
+constexpr size_t SPLIT_GRAIN = 8;
+constexpr size_t CLASSIFY_GRAIN = 16;
+
+struct Vec3 {
+    double x = 0.0, y = 0.0, z = 0.0;
+
+    Vec3() = default;
+    Vec3(double x, double y, double z) : x(x), y(y), z(z) {}
+
+    Vec3 operator+(const Vec3& other) const { return Vec3(x + other.x, y + other.y, z + other.z); }
+    Vec3 operator-(const Vec3& other) const { return Vec3(x - other.x, y - other.y, z - other.z); }
+    Vec3 operator*(double factor) const { return Vec3(x * factor, y * factor, z * factor); }
+    double operator[](int axis) const { return axis == 0 ? x : (axis == 1 ? y : z); }
+};
+
+inline double dot(const Vec3& a, const Vec3& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline double length(const Vec3& a) {
+    return std::sqrt(dot(a, a));
+}
+
+struct GridPoint {
+    int64_t v[3];
+
+    bool operator==(const GridPoint& other) const {
+        return v[0] == other.v[0] && v[1] == other.v[1] && v[2] == other.v[2];
+    }
+};
+
+struct GridPointHash {
+    size_t operator()(const GridPoint& point) const {
+        uint64_t hash = static_cast<uint64_t>(point.v[0]);
+        hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(point.v[1]);
+        hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(point.v[2]);
+        return static_cast<size_t>(hash);
+    }
+};
+
+inline Vec3 toVec3(const GridPoint& point) {
+    return Vec3(static_cast<double>(point.v[0]), static_cast<double>(point.v[1]), static_cast<double>(point.v[2]));
+}
+
+inline int sign(int64_t value) {
+    return (value > 0) - (value < 0);
+}
+
+// Six times the signed volume of abcd, positive when d lies on the side ab x ac points to.
+// Exact: coordinate differences stay below 2^20, so the determinant stays below 2^60.
+int64_t orient3d(const GridPoint& a, const GridPoint& b, const GridPoint& c, const GridPoint& d) {
+    const int64_t bx = b.v[0] - a.v[0], by = b.v[1] - a.v[1], bz = b.v[2] - a.v[2];
+    const int64_t cx = c.v[0] - a.v[0], cy = c.v[1] - a.v[1], cz = c.v[2] - a.v[2];
+    const int64_t dx = d.v[0] - a.v[0], dy = d.v[1] - a.v[1], dz = d.v[2] - a.v[2];
+    return bx * (cy * dz - cz * dy) + by * (cz * dx - cx * dz) + bz * (cx * dy - cy * dx);
+}
+
+// Twice the signed area of abc projected along axis; equals that component of ab x ac
+int64_t orient2d(const GridPoint& a, const GridPoint& b, const GridPoint& c, int axis) {
+    const int i = (axis + 1) % 3;
+    const int j = (axis + 2) % 3;
+    return (b.v[i] - a.v[i]) * (c.v[j] - a.v[j]) - (b.v[j] - a.v[j]) * (c.v[i] - a.v[i]);
+}
+
+inline uint64_t edgeKey(int a, int b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+}
+
+// Depth-first walk over a StaticBVH
+template <typename NodeTest, typename LeafVisit>
+void traverse(const StaticBVH& tree, NodeTest nodeTest, LeafVisit leafVisit) {
+    if (tree.isEmpty()) return;
+
+    const auto& nodes = tree.nodes();
+    const auto& primitives = tree.primitives();
+    std::vector<int> stack;
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const StaticBVH::Node& node = nodes[index];
+        if (!nodeTest(node.box)) continue;
+
+        if (node.count > 0) {
+            for (int i = node.start; i < node.start + node.count; ++i) {
+                leafVisit(primitives[i]);
+            }
+        } else {
+            stack.push_back(node.right);
+            stack.push_back(index + 1);
+        }
+    }
+}
+
+// Maps world coordinates onto the shared integer grid
+struct Grid {
+    Vec3 origin;
+    double step = 0.0;
+
+    GridPoint snap(const float* position) const {
+        GridPoint point;
+        for (int axis = 0; axis < 3; ++axis) {
+            const long long steps = std::llround((position[axis] - origin[axis]) / step);
+            point.v[axis] = std::min<int64_t>(std::max<int64_t>(steps, 0), GRID_SIZE);
+        }
+        return point;
+    }
+
+    QVector3D toWorld(const Vec3& point) const {
+        return QVector3D(static_cast<float>(origin.x + point.x * step), static_cast<float>(origin.y + point.y * step),
+                         static_cast<float>(origin.z + point.z * step));
+    }
+};
+
+enum class Classification { OUTSIDE, INSIDE, ON_SAME, ON_OPPOSITE };
+
+struct Hit {
+    int triangle;
+    bool coplanar;
+};
+
+// Point on an original edge, t measured from the edge's lower-numbered welded vertex
+struct EdgeCut {
+    double t;
+    Vec3 position;
+
+    bool operator<(const EdgeCut& other) const { return t < other.t; }
+};
+
+// One operand welded on the grid. Degenerate triangles are dropped.
+struct Operand {
+    std::vector<GridPoint> points;
+    std::vector<std::array<int, 3>> triangles;
+    // Source normals per corner, interpolated onto split points
+    std::vector<std::array<QVector3D, 3>> normals;
+    std::vector<std::array<int64_t, 3>> faceNormals;
+    std::vector<int> dominantAxes;
+    StaticBVH tree;
+    std::vector<AABB> bounds;
+
+    // Triangles of the other operand each triangle touches
+    std::vector<std::vector<Hit>> hits;
+    // Sorted cuts per welded edge
+    std::unordered_map<uint64_t, std::vector<EdgeCut>> edgeCuts;
+
+    const GridPoint& corner(int triangle, int index) const { return points[triangles[triangle][index]]; }
+    Vec3 faceNormal(int triangle) const {
+        const auto& n = faceNormals[triangle];
+        return Vec3(static_cast<double>(n[0]), static_cast<double>(n[1]), static_cast<double>(n[2]));
+    }
+};
+
+void buildOperand(const RenderMesh& mesh, const Grid& grid, Operand& operand) {
+    const unsigned int vertexCount = mesh.vertexCount();
+    std::unordered_map<GridPoint, int, GridPointHash> welded;
+    welded.reserve(vertexCount);
+    std::vector<int> remap(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        auto result = welded.emplace(grid.snap(&mesh.vertices[i * RenderMesh::FLOATS_PER_VERTEX]),
+                                     static_cast<int>(operand.points.size()));
+        if (result.second) operand.points.push_back(result.first->first);
+        remap[i] = result.first->second;
+    }
+
+    const size_t triangleCount = mesh.indices.size() / 3;
+    operand.triangles.reserve(triangleCount);
+    operand.normals.reserve(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const unsigned int* source = &mesh.indices[t * 3];
+        std::array<int, 3> triangle = { remap[source[0]], remap[source[1]], remap[source[2]] };
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) continue;
+
+        // Snapping can flatten a sliver completely; components stay below 2^41
+        const GridPoint& a = operand.points[triangle[0]];
+        const GridPoint& b = operand.points[triangle[1]];
+        const GridPoint& c = operand.points[triangle[2]];
+        std::array<int64_t, 3> normal = { orient2d(a, b, c, 0), orient2d(a, b, c, 1), orient2d(a, b, c, 2) };
+        if (normal[0] == 0 && normal[1] == 0 && normal[2] == 0) continue;
+
+        int axis = 0;
+        if (std::llabs(normal[1]) > std::llabs(normal[axis])) axis = 1;
+        if (std::llabs(normal[2]) > std::llabs(normal[axis])) axis = 2;
+
+        std::array<QVector3D, 3> normals;
+        for (int k = 0; k < 3; ++k) {
+            const float* v = &mesh.vertices[source[k] * RenderMesh::FLOATS_PER_VERTEX];
+            normals[k] = QVector3D(v[3], v[4], v[5]);
+        }
+
+        operand.triangles.push_back(triangle);
+        operand.normals.push_back(normals);
+        operand.faceNormals.push_back(normal);
+        operand.dominantAxes.push_back(axis);
+
+        AABB box;
+        for (const GridPoint* p : { &a, &b, &c }) {
+            // Grid coordinates are below 2^24, so floats hold them exactly
+            box.expand(QVector3D(static_cast<float>(p->v[0]), static_cast<float>(p->v[1]), static_cast<float>(p->v[2])));
+        }
+        operand.bounds.push_back(box);
+    }
+
+    operand.tree.build(operand.bounds);
+    operand.hits.resize(operand.triangles.size());
+}
+
+// Intersection tests, all exact
+
+inline bool separated(const int64_t* sides) {
+    return (sides[0] > 0 && sides[1] > 0 && sides[2] > 0) || (sides[0] < 0 && sides[1] < 0 && sides[2] < 0);
+}
+
+// Segment pq, with its orientations sp and sq against the plane of t, touches triangle t.
+// Segments lying in the plane are left to the other edges of the pair.
+bool segmentTouchesTriangle(const GridPoint& p, const GridPoint& q, int64_t sp, int64_t sq, const GridPoint* const* t) {
+    if ((sp > 0 && sq > 0) || (sp < 0 && sq < 0) || (sp == 0 && sq == 0)) return false;
+    const int o1 = sign(orient3d(p, q, *t[0], *t[1]));
+    const int o2 = sign(orient3d(p, q, *t[1], *t[2]));
+    const int o3 = sign(orient3d(p, q, *t[2], *t[0]));
+    return (o1 >= 0 && o2 >= 0 && o3 >= 0) || (o1 <= 0 && o2 <= 0 && o3 <= 0);
+}
+
+bool segmentsTouch2d(const GridPoint& a, const GridPoint& b, const GridPoint& c, const GridPoint& d, int axis) {
+    const int o1 = sign(orient2d(a, b, c, axis));
+    const int o2 = sign(orient2d(a, b, d, axis));
+    const int o3 = sign(orient2d(c, d, a, axis));
+    const int o4 = sign(orient2d(c, d, b, axis));
+    if (o1 * o2 > 0 || o3 * o4 > 0) return false;
+    if (o1 != 0 || o2 != 0 || o3 != 0 || o4 != 0) return true;
+
+    // Collinear: the projections onto either remaining axis must overlap
+    for (int i = 1; i <= 2; ++i) {
+        const int k = (axis + i) % 3;
+        if (std::max(a.v[k], b.v[k]) < std::min(c.v[k], d.v[k]) ||
+            std::max(c.v[k], d.v[k]) < std::min(a.v[k], b.v[k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool pointInTriangle2d(const GridPoint& p, const GridPoint* const* t, int axis) {
+    const int o1 = sign(orient2d(*t[0], *t[1], p, axis));
+    const int o2 = sign(orient2d(*t[1], *t[2], p, axis));
+    const int o3 = sign(orient2d(*t[2], *t[0], p, axis));
+    return (o1 >= 0 && o2 >= 0 && o3 >= 0) || (o1 <= 0 && o2 <= 0 && o3 <= 0);
+}
+
+bool coplanarTrianglesTouch(const GridPoint* const* p, const GridPoint* const* q, int axis) {
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (segmentsTouch2d(*p[i], *p[(i + 1) % 3], *q[j], *q[(j + 1) % 3], axis)) return true;
+        }
+    }
+    return pointInTriangle2d(*p[0], q, axis) || pointInTriangle2d(*q[0], p, axis);
+}
+
+bool trianglesTouch(const Operand& a, int ta, const Operand& b, int tb, bool& coplanar) {
+    const GridPoint* p[3] = { &a.corner(ta, 0), &a.corner(ta, 1), &a.corner(ta, 2) };
+    const GridPoint* q[3] = { &b.corner(tb, 0), &b.corner(tb, 1), &b.corner(tb, 2) };
+
+    const int64_t sq[3] = { orient3d(*p[0], *p[1], *p[2], *q[0]), orient3d(*p[0], *p[1], *p[2], *q[1]),
+                            orient3d(*p[0], *p[1], *p[2], *q[2]) };
+    if (separated(sq)) return false;
+    const int64_t sp[3] = { orient3d(*q[0], *q[1], *q[2], *p[0]), orient3d(*q[0], *q[1], *q[2], *p[1]),
+                            orient3d(*q[0], *q[1], *q[2], *p[2]) };
+    if (separated(sp)) return false;
+
+    coplanar = sq[0] == 0 && sq[1] == 0 && sq[2] == 0;
+    if (coplanar) return coplanarTrianglesTouch(p, q, a.dominantAxes[ta]);
+
+    // Where non-coplanar triangles meet, some edge of one passes through the other
+    for (int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        if (segmentTouchesTriangle(*p[i], *p[j], sp[i], sp[j], q)) return true;
+        if (segmentTouchesTriangle(*q[i], *q[j], sq[i], sq[j], p)) return true;
+    }
+    return false;
+}
+
+// Splitting
+
+// Plane a triangle is cut along: the plane of a crossing triangle, or the plane through an edge of
+// a coplanar one perpendicular to it
+struct SplitPlane {
+    Vec3 normal;
+    Vec3 origin;
+    double normalLength = 0.0;
+    GridPoint a, b, c;
+    int axis = -1;  // Projection axis of a coplanar triangle; -1 for triangle planes
+    int axisSign = 0;
+
+    // Exact and proportional to value() at grid points; edge planes are only ever evaluated at
+    // points in the coplanar triangle's plane
+    int64_t exact(const GridPoint& p) const {
+        if (axis < 0) return orient3d(a, b, c, p);
+        return -orient2d(a, b, p, axis) * axisSign;
+    }
+    double value(const Vec3& p) const { return dot(normal, p - origin); }
+
+    static SplitPlane throughTriangle(const GridPoint& a, const GridPoint& b, const GridPoint& c) {
+        SplitPlane plane;
+        plane.a = a;
+        plane.b = b;
+        plane.c = c;
+        plane.origin = toVec3(a);
+        plane.normal = cross(toVec3(b) - plane.origin, toVec3(c) - plane.origin);
+        plane.normalLength = length(plane.normal);
+        return plane;
+    }
+
+    static SplitPlane alongEdge(const GridPoint& e0, const GridPoint& e1, const Vec3& faceNormal, int axis) {
+        SplitPlane plane;
+        plane.a = e0;
+        plane.b = e1;
+        plane.axis = axis;
+        plane.axisSign = faceNormal[axis] > 0.0 ? 1 : -1;
+        plane.origin = toVec3(e0);
+        plane.normal = cross(toVec3(e1) - plane.origin, faceNormal);
+        plane.normalLength = length(plane.normal);
+        return plane;
+    }
+};
+
+// Vertex of a split triangle
+struct PoolVertex {
+    Vec3 position;  // Grid space
+    std::array<double, 3> barycentric{};
+    int corner = -1;  // Triangle corner this vertex is, if any
+    int edge = -1;    // Triangle edge a constructed vertex lies on, if any; edge k runs from corner k to k + 1
+    double t = 0.0;   // Parameter along that edge from its lower-numbered welded vertex
+
+    // Triangle edges the vertex lies on, one bit each
+    int edgeMask() const {
+        if (corner >= 0) return (1 << corner) | (1 << ((corner + 2) % 3));
+        return edge >= 0 ? 1 << edge : 0;
+    }
+};
+
+// Convex pieces of one triangle. Pieces share their vertices, and every piece along a cut edge
+// carries the cut's vertices, so they form a conforming subdivision.
+struct TriangleSplit {
+    std::vector<PoolVertex> pool;
+    std::vector<std::vector<int>> pieces;
+    std::vector<Classification> classifications;
+    std::vector<std::pair<uint64_t, EdgeCut>> edgeCuts;
+    // Pool vertices the splitting itself produced; seam points copied from the other operand follow
+    size_t seamVertices = 0;
+};
+
+class TriangleSplitter {
+public:
+    TriangleSplitter(const Operand& mesh, int triangle, TriangleSplit& split)
+        : m_mesh(mesh), m_triangle(triangle), m_split(split) {}
+
+    void begin() {
+        m_split.pool.clear();
+        for (int k = 0; k < 3; ++k) {
+            PoolVertex vertex;
+            vertex.position = toVec3(m_mesh.corner(m_triangle, k));
+            vertex.barycentric[k] = 1.0;
+            vertex.corner = k;
+            m_split.pool.push_back(vertex);
+        }
+        m_split.pieces.assign(1, { 0, 1, 2 });
+    }
+
+    void split(const SplitPlane& plane) {
+        // Pieces lie inside the triangle, so a plane that leaves every corner on one side cuts nothing
+        int positive = 0;
+        int negative = 0;
+        for (int k = 0; k < 3; ++k) {
+            const int side = sign(plane.exact(m_mesh.corner(m_triangle, k)));
+            positive += side > 0;
+            negative += side < 0;
+        }
+        if (positive == 0 || negative == 0) return;
+
+        m_cuts.clear();
+        m_next.clear();
+        for (auto& piece : m_split.pieces) {
+            m_sides.resize(piece.size());
+            bool hasPositive = false;
+            bool hasNegative = false;
+            for (size_t i = 0; i < piece.size(); ++i) {
+                m_sides[i] = side(plane, m_split.pool[piece[i]]);
+                hasPositive |= m_sides[i] > 0;
+                hasNegative |= m_sides[i] < 0;
+            }
+            if (!hasPositive || !hasNegative) {
+                m_next.push_back(std::move(piece));
+                continue;
+            }
+
+            std::vector<int> front;
+            std::vector<int> back;
+            for (size_t i = 0; i < piece.size(); ++i) {
+                const size_t j = (i + 1) % piece.size();
+                if (m_sides[i] >= 0) front.push_back(piece[i]);
+                if (m_sides[i] <= 0) back.push_back(piece[i]);
+                if (m_sides[i] * m_sides[j] < 0) {
+                    const int cut = cutEdge(plane, piece[i], piece[j]);
+                    front.push_back(cut);
+                    back.push_back(cut);
+                }
+            }
+            if (front.size() >= 3) m_next.push_back(std::move(front));
+            if (back.size() >= 3) m_next.push_back(std::move(back));
+        }
+        m_split.pieces.swap(m_next);
+    }
+
+private:
+    int side(const SplitPlane& plane, const PoolVertex& vertex) const {
+        if (vertex.corner >= 0) return sign(plane.exact(m_mesh.corner(m_triangle, vertex.corner)));
+        const double value = plane.value(vertex.position);
+        const double tolerance = PLANE_EPSILON * plane.normalLength;
+        return value > tolerance ? 1 : (value < -tolerance ? -1 : 0);
+    }
+
+    double edgeParameter(const PoolVertex& vertex, int lower) const {
+        if (vertex.corner >= 0) return vertex.corner == lower ? 0.0 : 1.0;
+        return vertex.t;
+    }
+
+    int cutEdge(const SplitPlane& plane, int u, int v) {
+        const uint64_t key = edgeKey(u, v);
+        for (const auto& cut : m_cuts) {
+            if (cut.first == key) return cut.second;
+        }
+
+        const PoolVertex pu = m_split.pool[u];
+        const PoolVertex pv = m_split.pool[v];
+        const int shared = pu.edgeMask() & pv.edgeMask();
+
+        PoolVertex vertex;
+        if (shared != 0) {
+            // On a triangle edge the cut comes from the edge's own endpoints, so the triangle on
+            // the other side computes the identical point
+            const int edge = shared & 1 ? 0 : (shared & 2 ? 1 : 2);
+            const auto& triangle = m_mesh.triangles[m_triangle];
+            const int lower = triangle[edge] < triangle[(edge + 1) % 3] ? edge : (edge + 1) % 3;
+            const int upper = lower == edge ? (edge + 1) % 3 : edge;
+            const double sLower = static_cast<double>(plane.exact(m_mesh.corner(m_triangle, lower)));
+            const double sUpper = static_cast<double>(plane.exact(m_mesh.corner(m_triangle, upper)));
+            double t = sLower / (sLower - sUpper);
+            const double tu = edgeParameter(pu, lower);
+            const double tv = edgeParameter(pv, lower);
+            t = std::min(std::max(t, std::min(tu, tv)), std::max(tu, tv));
+
+            vertex = edgeVertex(m_mesh, m_triangle, edge, t);
+            m_split.edgeCuts.emplace_back(edgeKey(triangle[edge], triangle[(edge + 1) % 3]), EdgeCut{ t, vertex.position });
+        } else {
+            const double du = plane.value(pu.position);
+            const double dv = plane.value(pv.position);
+            const double t = du != dv ? std::min(std::max(du / (du - dv), 0.0), 1.0) : 0.5;
+            vertex.position = pu.position + (pv.position - pu.position) * t;
+            for (int k = 0; k < 3; ++k) {
+                vertex.barycentric[k] = pu.barycentric[k] + (pv.barycentric[k] - pu.barycentric[k]) * t;
+            }
+        }
+
+        const int index = static_cast<int>(m_split.pool.size());
+        m_split.pool.push_back(vertex);
+        m_cuts.emplace_back(key, index);
+        return index;
+    }
+
+public:
+    static PoolVertex edgeVertex(const Operand& mesh, int triangle, int edge, double t) {
+        const auto& corners = mesh.triangles[triangle];
+        const int lower = corners[edge] < corners[(edge + 1) % 3] ? edge : (edge + 1) % 3;
+        const int upper = lower == edge ? (edge + 1) % 3 : edge;
+        const Vec3 from = toVec3(mesh.corner(triangle, lower));
+        const Vec3 to = toVec3(mesh.corner(triangle, upper));
+
+        PoolVertex vertex;
+        vertex.position = from + (to - from) * t;
+        vertex.barycentric[lower] = 1.0 - t;
+        vertex.barycentric[upper] = t;
+        vertex.edge = edge;
+        vertex.t = t;
+        return vertex;
+    }
+
+private:
+    const Operand& m_mesh;
+    int m_triangle;
+    TriangleSplit& m_split;
+    // Cuts made by the current plane, keyed by the pool edge they split
+    std::vector<std::pair<uint64_t, int>> m_cuts;
+    std::vector<std::vector<int>> m_next;
+    std::vector<int> m_sides;
+};
+
+// Classification
+
+// Irregular directions, so rays rarely run exactly along mesh features
+const Vec3 RAY_DIRECTIONS[] = {
+    Vec3(0.5428987, 0.6058130, 0.5815413),
+    Vec3(-0.3561058, 0.8330133, 0.4233864),
+    Vec3(0.7926740, -0.2494306, 0.5563648),
+    Vec3(-0.6344463, -0.5352917, 0.5576044),
+    Vec3(0.1559076, 0.3170645, -0.9354996),
+};
+
+bool rayHitsBox(const Vec3& origin, const Vec3& inverse, const AABB& box) {
+    double entry = 0.0;
+    double exit = std::numeric_limits<double>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        // Boxes hold integer grid coordinates; half a step covers the float conversion
+        double t1 = (box.min[axis] - 0.5 - origin[axis]) * inverse[axis];
+        double t2 = (box.max[axis] + 0.5 - origin[axis]) * inverse[axis];
+        if (t1 > t2) std::swap(t1, t2);
+        entry = std::max(entry, t1);
+        exit = std::min(exit, t2);
+        if (entry > exit) return false;
+    }
+    return true;
+}
+
+// Crossings of the mesh along a ray; ambiguous when the ray grazes an edge or starts on the surface
+int countCrossings(const Operand& mesh, const Vec3& origin, const Vec3& direction, bool& ambiguous) {
+    const Vec3 inverse(1.0 / direction.x, 1.0 / direction.y, 1.0 / direction.z);
+    int crossings = 0;
+    traverse(mesh.tree,
+        [&](const AABB& box) { return !ambiguous && rayHitsBox(origin, inverse, box); },
+        [&](int triangle) {
+            if (ambiguous) return;
+            const Vec3 p0 = toVec3(mesh.corner(triangle, 0));
+            const Vec3 edge1 = toVec3(mesh.corner(triangle, 1)) - p0;
+            const Vec3 edge2 = toVec3(mesh.corner(triangle, 2)) - p0;
+            const Vec3 h = cross(direction, edge2);
+            const double determinant = dot(edge1, h);
+            if (std::fabs(determinant) <= 1e-12 * length(edge1) * length(edge2)) return;
+
+            const double inverseDeterminant = 1.0 / determinant;
+            const Vec3 s = origin - p0;
+            const double u = dot(s, h) * inverseDeterminant;
+            if (u < -RAY_EDGE_EPSILON || u > 1.0 + RAY_EDGE_EPSILON) return;
+            const Vec3 q = cross(s, edge1);
+            const double v = dot(direction, q) * inverseDeterminant;
+            if (v < -RAY_EDGE_EPSILON || u + v > 1.0 + RAY_EDGE_EPSILON) return;
+            const double t = dot(edge2, q) * inverseDeterminant;
+            if (t < -RAY_START_EPSILON) return;
+
+            if (t <= RAY_START_EPSILON || u < RAY_EDGE_EPSILON || v < RAY_EDGE_EPSILON ||
+                u + v > 1.0 - RAY_EDGE_EPSILON) {
+                ambiguous = true;
+                return;
+            }
+            ++crossings;
+        });
+    return crossings;
+}
+
+bool pointInside(const Operand& mesh, const Vec3& point) {
+    int crossings = 0;
+    for (const Vec3& direction : RAY_DIRECTIONS) {
+        bool ambiguous = false;
+        crossings = countCrossings(mesh, point, direction, ambiguous);
+        if (!ambiguous) break;
+    }
+    return crossings % 2 == 1;
+}
+
+// Point in a coplanar triangle, in the triangle's projection
+bool pointInTriangleProjected(const Operand& mesh, int triangle, const Vec3& point) {
+    const int axis = mesh.dominantAxes[triangle];
+    const int i = (axis + 1) % 3;
+    const int j = (axis + 2) % 3;
+    const double orientation = static_cast<double>(mesh.faceNormals[triangle][axis]) > 0.0 ? 1.0 : -1.0;
+    for (int k = 0; k < 3; ++k) {
+        const Vec3 a = toVec3(mesh.corner(triangle, k));
+        const Vec3 b = toVec3(mesh.corner(triangle, (k + 1) % 3));
+        const double area = (b[i] - a[i]) * (point[j] - a[j]) - (b[j] - a[j]) * (point[i] - a[i]);
+        if (area * orientation < 0.0) return false;
+    }
+    return true;
+}
+
+Classification classifyPiece(const Operand& mesh, int triangle, const Operand& other, const Vec3& centroid) {
+    // Pieces were cut along the edges of coplanar triangles, so each lies fully inside or outside them
+    for (const Hit& hit : mesh.hits[triangle]) {
+        if (!hit.coplanar || !pointInTriangleProjected(other, hit.triangle, centroid)) continue;
+        const double facing = dot(mesh.faceNormal(triangle), other.faceNormal(hit.triangle));
+        return facing > 0.0 ? Classification::ON_SAME : Classification::ON_OPPOSITE;
+    }
+    return pointInside(other, centroid) ? Classification::INSIDE : Classification::OUTSIDE;
+}
+
+bool keepPiece(MeshBoolean::Operation operation, bool fromA, Classification classification, bool& flip) {
+    flip = false;
+    switch (operation) {
+        case MeshBoolean::UNION:
+            return classification == Classification::OUTSIDE || (fromA && classification == Classification::ON_SAME);
+        case MeshBoolean::INTERSECTION:
+            return classification == Classification::INSIDE || (fromA && classification == Classification::ON_SAME);
+        case MeshBoolean::DIFFERENCE:
+            if (fromA) return classification == Classification::OUTSIDE || classification == Classification::ON_OPPOSITE;
+            flip = true;
+            return classification == Classification::INSIDE;
+    }
+    return false;
+}
+
+// Output
+
+// Output vertices written for split triangles and their cut neighbours
+struct SeamVertices {
+    std::vector<unsigned int> corners;
+    std::vector<unsigned int> constructed;
+};
+
+class PolygonWriter {
+public:
+    PolygonWriter(const Operand& mesh, const Grid& grid, RenderMesh& output, SeamVertices& seams)
+        : m_mesh(mesh), m_grid(grid), m_output(output), m_seams(seams) {}
+
+    // Adds cut points the neighbouring triangles made on this triangle's edges, then triangulates
+    void write(int triangle, std::vector<PoolVertex>& pool, const std::vector<int>& polygon, bool flip) {
+        m_ring.clear();
+        const auto& corners = m_mesh.triangles[triangle];
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            // Copies, as inserting points grows the pool
+            const PoolVertex u = pool[polygon[i]];
+            const PoolVertex v = pool[polygon[(i + 1) % polygon.size()]];
+            m_ring.push_back(polygon[i]);
+
+            const int shared = u.edgeMask() & v.edgeMask();
+            if (shared == 0) continue;
+            const int edge = shared & 1 ? 0 : (shared & 2 ? 1 : 2);
+            auto cuts = m_mesh.edgeCuts.find(edgeKey(corners[edge], corners[(edge + 1) % 3]));
+            if (cuts == m_mesh.edgeCuts.end()) continue;
+
+            const int lower = corners[edge] < corners[(edge + 1) % 3] ? edge : (edge + 1) % 3;
+            const double tu = u.corner >= 0 ? (u.corner == lower ? 0.0 : 1.0) : u.t;
+            const double tv = v.corner >= 0 ? (v.corner == lower ? 0.0 : 1.0) : v.t;
+            const auto& parameters = cuts->second;
+            if (tu < tv) {
+                for (auto it = std::upper_bound(parameters.begin(), parameters.end(), EdgeCut{ tu, Vec3() });
+                     it != parameters.end() && it->t < tv; ++it) {
+                    m_ring.push_back(addEdgeVertex(pool, triangle, edge, *it));
+                }
+            } else {
+                auto it = std::lower_bound(parameters.begin(), parameters.end(), EdgeCut{ tu, Vec3() });
+                while (it != parameters.begin() && (it - 1)->t > tv) {
+                    --it;
+                    m_ring.push_back(addEdgeVertex(pool, triangle, edge, *it));
+                }
+            }
+        }
+        triangulate(triangle, pool, flip);
+    }
+
+    // Unsplit triangle with no cuts on its edges
+    void writeTriangle(int triangle, bool flip) {
+        const unsigned int base = m_output.vertexCount();
+        for (int k = 0; k < 3; ++k) {
+            QVector3D normal = m_mesh.normals[triangle][k];
+            if (normal.lengthSquared() == 0.0f) normal = faceNormal(triangle);
+            m_output.addVertex(m_grid.toWorld(toVec3(m_mesh.corner(triangle, k))), flip ? -normal : normal);
+        }
+        if (flip) {
+            m_output.addTriangle(base, base + 2, base + 1);
+        } else {
+            m_output.addTriangle(base, base + 1, base + 2);
+        }
+    }
+
+private:
+    int addEdgeVertex(std::vector<PoolVertex>& pool, int triangle, int edge, const EdgeCut& cut) {
+        pool.push_back(TriangleSplitter::edgeVertex(m_mesh, triangle, edge, cut.t));
+        pool.back().position = cut.position;
+        return static_cast<int>(pool.size()) - 1;
+    }
+
+    QVector3D faceNormal(int triangle) const {
+        const Vec3 n = m_mesh.faceNormal(triangle);
+        return QVector3D(static_cast<float>(n.x), static_cast<float>(n.y), static_cast<float>(n.z)).normalized();
+    }
+
+    // Twice the signed area in barycentric coordinates; positive for the triangle's own winding
+    static double area(const PoolVertex& a, const PoolVertex& b, const PoolVertex& c) {
+        return (b.barycentric[1] - a.barycentric[1]) * (c.barycentric[2] - a.barycentric[2]) -
+               (b.barycentric[2] - a.barycentric[2]) * (c.barycentric[1] - a.barycentric[1]);
+    }
+
+    unsigned int writeVertex(int triangle, const PoolVertex& vertex, bool flip) {
+        const auto& normals = m_mesh.normals[triangle];
+        QVector3D normal = normals[0] * static_cast<float>(vertex.barycentric[0]) +
+                           normals[1] * static_cast<float>(vertex.barycentric[1]) +
+                           normals[2] * static_cast<float>(vertex.barycentric[2]);
+        normal = normal.lengthSquared() > 0.0f ? normal.normalized() : faceNormal(triangle);
+        const unsigned int index = m_output.addVertex(m_grid.toWorld(vertex.position), flip ? -normal : normal);
+        (vertex.corner >= 0 ? m_seams.corners : m_seams.constructed).push_back(index);
+        return index;
+    }
+
+    void addTriangle(unsigned int a, unsigned int b, unsigned int c, bool flip) {
+        if (flip) {
+            m_output.addTriangle(a, c, b);
+        } else {
+            m_output.addTriangle(a, b, c);
+        }
+    }
+
+    void triangulate(int triangle, const std::vector<PoolVertex>& pool, bool flip) {
+        const size_t count = m_ring.size();
+        if (count < 3) return;
+
+        bool straight = false;
+        double total = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            const PoolVertex& a = pool[m_ring[(i + count - 1) % count]];
+            const PoolVertex& b = pool[m_ring[i]];
+            const PoolVertex& c = pool[m_ring[(i + 1) % count]];
+            straight |= area(a, b, c) <= AREA_EPSILON;
+            total += area(pool[m_ring[0]], b, c);
+        }
+        // Slivers are kept however thin; dropping one would open the edges it shares with its neighbours
+        if (total <= 0.0) return;
+
+        m_indices.clear();
+        for (int index : m_ring) {
+            m_indices.push_back(writeVertex(triangle, pool[index], flip));
+        }
+
+        if (!straight) {
+            for (size_t i = 1; i + 1 < count; ++i) {
+                addTriangle(m_indices[0], m_indices[i], m_indices[i + 1], flip);
+            }
+            return;
+        }
+
+        // Points along a straight side would give a plain fan zero-area triangles and drop them
+        // from the side; a fan around the centroid keeps every boundary point
+        PoolVertex center;
+        for (int index : m_ring) {
+            center.position = center.position + pool[index].position;
+            for (int k = 0; k < 3; ++k) center.barycentric[k] += pool[index].barycentric[k];
+        }
+        center.position = center.position * (1.0 / count);
+        for (int k = 0; k < 3; ++k) center.barycentric[k] /= count;
+        const unsigned int middle = writeVertex(triangle, center, flip);
+        for (size_t i = 0; i < count; ++i) {
+            addTriangle(middle, m_indices[i], m_indices[(i + 1) % count], flip);
+        }
+    }
+
+    const Operand& m_mesh;
+    const Grid& m_grid;
+    RenderMesh& m_output;
+    SeamVertices& m_seams;
+    std::vector<int> m_ring;
+    std::vector<unsigned int> m_indices;
+};
+
+int findRoot(std::vector<int>& parent, int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+void appendMesh(RenderMesh& output, const RenderMesh& source) {
+    const unsigned int base = output.vertexCount();
+    output.vertices.insert(output.vertices.end(), source.vertices.begin(), source.vertices.end());
+    for (unsigned int index : source.indices) {
+        output.indices.push_back(base + index);
+    }
+}
+
+// Splits the triangles of mesh that touch other, classifies every piece and writes the kept ones
+class OperandPass {
+public:
+    OperandPass(const Operand& mesh, const Operand& other, bool fromA)
+        : m_mesh(mesh), m_other(other), m_fromA(fromA) {}
+
+    size_t splitCount() const { return m_splitTriangles.size(); }
+
+    void split() {
+        m_splitIndex.assign(m_mesh.triangles.size(), -1);
+        for (size_t t = 0; t < m_mesh.triangles.size(); ++t) {
+            if (m_mesh.hits[t].empty()) continue;
+            m_splitIndex[t] = static_cast<int>(m_splitTriangles.size());
+            m_splitTriangles.push_back(static_cast<int>(t));
+        }
+        m_splits.resize(m_splitTriangles.size());
+
+        ThreadPool::instance().parallelFor(0, m_splitTriangles.size(), SPLIT_GRAIN, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const int triangle = m_splitTriangles[i];
+                TriangleSplit& split = m_splits[i];
+                TriangleSplitter splitter(m_mesh, triangle, split);
+                splitter.begin();
+                for (const Hit& hit : m_mesh.hits[triangle]) {
+                    const GridPoint& q0 = m_other.corner(hit.triangle, 0);
+                    const GridPoint& q1 = m_other.corner(hit.triangle, 1);
+                    const GridPoint& q2 = m_other.corner(hit.triangle, 2);
+                    if (!hit.coplanar) {
+                        splitter.split(SplitPlane::throughTriangle(q0, q1, q2));
+                        continue;
+                    }
+                    const Vec3 normal = m_other.faceNormal(hit.triangle);
+                    const int axis = m_other.dominantAxes[hit.triangle];
+                    splitter.split(SplitPlane::alongEdge(q0, q1, normal, axis));
+                    splitter.split(SplitPlane::alongEdge(q1, q2, normal, axis));
+                    splitter.split(SplitPlane::alongEdge(q2, q0, normal, axis));
+                }
+            }
+        });
+    }
+
+    // Both operands construct the intersection curve on their own, so the same seam point comes
+    // out of each side with different rounding. Points on an original edge are computed the same
+    // way by both of its triangles and win; otherwise A's copy does.
+    static void mergeSeams(OperandPass& a, OperandPass& b) {
+        const double limit = SEAM_EPSILON * SEAM_EPSILON;
+        for (size_t i = 0; i < a.m_splitTriangles.size(); ++i) {
+            std::vector<PoolVertex>& poolA = a.m_splits[i].pool;
+            for (const Hit& hit : a.m_mesh.hits[a.m_splitTriangles[i]]) {
+                std::vector<PoolVertex>& poolB = b.m_splits[b.m_splitIndex[hit.triangle]].pool;
+                for (PoolVertex& u : poolA) {
+                    for (PoolVertex& v : poolB) {
+                        const Vec3 offset = u.position - v.position;
+                        if (dot(offset, offset) > limit) continue;
+                        const bool fixedU = u.corner >= 0 || u.edge >= 0;
+                        const bool fixedV = v.corner >= 0 || v.edge >= 0;
+                        if (fixedV && !fixedU) {
+                            u.position = v.position;
+                        } else if (!fixedV) {
+                            v.position = u.position;
+                        }
+                    }
+                }
+            }
+        }
+        for (TriangleSplit& split : a.m_splits) split.seamVertices = split.pool.size();
+        for (TriangleSplit& split : b.m_splits) split.seamVertices = split.pool.size();
+    }
+
+    // A seam edge can pass points only the other operand cut at, such as where one of its far
+    // planes crosses the curve. Threading them into this side's pieces closes the result along it.
+    void insertSeamVertices(const OperandPass& other) {
+        ThreadPool::instance().parallelFor(0, m_splitTriangles.size(), SPLIT_GRAIN, [&](size_t first, size_t last) {
+            std::vector<std::pair<double, int>> points;
+            std::vector<int> ring;
+            for (size_t i = first; i < last; ++i) {
+                const int triangle = m_splitTriangles[i];
+                TriangleSplit& split = m_splits[i];
+                for (auto& piece : split.pieces) {
+                    ring.clear();
+                    for (size_t k = 0; k < piece.size(); ++k) {
+                        const int u = piece[k];
+                        const int v = piece[(k + 1) % piece.size()];
+                        ring.push_back(u);
+                        const int shared = split.pool[u].edgeMask() & split.pool[v].edgeMask();
+
+                        points.clear();
+                        for (const Hit& hit : m_mesh.hits[triangle]) {
+                            const TriangleSplit& seam = other.m_splits[other.m_splitIndex[hit.triangle]];
+                            for (size_t w = 0; w < seam.seamVertices; ++w) {
+                                const Vec3& point = seam.pool[w].position;
+                                double s = 0.0;
+                                if (!onSegment(split.pool[u].position, split.pool[v].position, point, s)) continue;
+                                if (shared != 0) {
+                                    // Original edges get the point as a cut, so the neighbour across gets it too
+                                    addSeamCut(triangle, split, shared, point);
+                                    continue;
+                                }
+                                points.emplace_back(s, seamVertex(split, u, v, s, point));
+                            }
+                        }
+                        std::sort(points.begin(), points.end());
+                        for (const auto& point : points) {
+                            if (ring.back() != point.second) ring.push_back(point.second);
+                        }
+                    }
+                    piece = ring;
+                }
+            }
+        });
+    }
+
+    // Cut parameters are shared with the neighbours of the split triangles
+    void collectEdgeCuts(Operand& mesh) {
+        for (const TriangleSplit& split : m_splits) {
+            for (const auto& cut : split.edgeCuts) {
+                mesh.edgeCuts[cut.first].push_back(cut.second);
+            }
+        }
+        for (auto& entry : mesh.edgeCuts) {
+            auto& parameters = entry.second;
+            std::sort(parameters.begin(), parameters.end());
+            parameters.erase(std::unique(parameters.begin(), parameters.end(),
+                                         [](const EdgeCut& a, const EdgeCut& b) { return a.t == b.t; }),
+                             parameters.end());
+        }
+    }
+
+    void classify() {
+        // Triangles that touch nothing inherit one classification across shared edges
+        const size_t triangleCount = m_mesh.triangles.size();
+        m_component.resize(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t) m_component[t] = static_cast<int>(t);
+
+        std::unordered_map<uint64_t, int> edgeOwner;
+        edgeOwner.reserve(triangleCount * 2);
+        for (size_t t = 0; t < triangleCount; ++t) {
+            if (m_splitIndex[t] >= 0) continue;
+            const auto& corners = m_mesh.triangles[t];
+            for (int k = 0; k < 3; ++k) {
+                auto result = edgeOwner.emplace(edgeKey(corners[k], corners[(k + 1) % 3]), static_cast<int>(t));
+                if (!result.second) {
+                    int a = findRoot(m_component, result.first->second);
+                    int b = findRoot(m_component, static_cast<int>(t));
+                    if (a != b) m_component[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+
+        std::vector<int> roots;
+        for (size_t t = 0; t < triangleCount; ++t) {
+            if (m_splitIndex[t] >= 0) continue;
+            if (findRoot(m_component, static_cast<int>(t)) == static_cast<int>(t)) roots.push_back(static_cast<int>(t));
+        }
+        m_componentClass.assign(triangleCount, Classification::OUTSIDE);
+
+        ThreadPool& pool = ThreadPool::instance();
+        pool.parallelFor(0, roots.size(), CLASSIFY_GRAIN, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const int triangle = roots[i];
+                const Vec3 centroid = (toVec3(m_mesh.corner(triangle, 0)) + toVec3(m_mesh.corner(triangle, 1)) +
+                                       toVec3(m_mesh.corner(triangle, 2))) * (1.0 / 3.0);
+                m_componentClass[triangle] = pointInside(m_other, centroid) ? Classification::INSIDE
+                                                                             : Classification::OUTSIDE;
+            }
+        });
+
+        pool.parallelFor(0, m_splitTriangles.size(), CLASSIFY_GRAIN, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                TriangleSplit& split = m_splits[i];
+                split.classifications.resize(split.pieces.size());
+                for (size_t p = 0; p < split.pieces.size(); ++p) {
+                    Vec3 centroid;
+                    for (int index : split.pieces[p]) centroid = centroid + split.pool[index].position;
+                    centroid = centroid * (1.0 / split.pieces[p].size());
+                    split.classifications[p] = classifyPiece(m_mesh, m_splitTriangles[i], m_other, centroid);
+                }
+            }
+        });
+    }
+
+    void write(MeshBoolean::Operation operation, const Grid& grid, RenderMesh& output, SeamVertices& seams) {
+        PolygonWriter writer(m_mesh, grid, output, seams);
+        std::vector<PoolVertex> pool;
+        const std::vector<int> corners = { 0, 1, 2 };
+        bool flip = false;
+
+        for (size_t t = 0; t < m_mesh.triangles.size(); ++t) {
+            const int triangle = static_cast<int>(t);
+            const int splitIndex = m_splitIndex[t];
+            if (splitIndex >= 0) {
+                TriangleSplit& split = m_splits[splitIndex];
+                for (size_t p = 0; p < split.pieces.size(); ++p) {
+                    if (keepPiece(operation, m_fromA, split.classifications[p], flip)) {
+                        writer.write(triangle, split.pool, split.pieces[p], flip);
+                    }
+                }
+                continue;
+            }
+
+            const Classification classification = m_componentClass[findRoot(m_component, triangle)];
+            if (!keepPiece(operation, m_fromA, classification, flip)) continue;
+
+            if (!hasEdgeCuts(triangle)) {
+                writer.writeTriangle(triangle, flip);
+                continue;
+            }
+            pool.clear();
+            for (int k = 0; k < 3; ++k) {
+                PoolVertex vertex;
+                vertex.position = toVec3(m_mesh.corner(triangle, k));
+                vertex.barycentric[k] = 1.0;
+                vertex.corner = k;
+                pool.push_back(vertex);
+            }
+            writer.write(triangle, pool, corners, flip);
+        }
+    }
+
+private:
+    // Whether point lies strictly inside segment uv, away from both ends; s is its parameter
+    static bool onSegment(const Vec3& u, const Vec3& v, const Vec3& point, double& s) {
+        const double limit = SEAM_EPSILON * SEAM_EPSILON;
+        const Vec3 direction = v - u;
+        const double lengthSquared = dot(direction, direction);
+        if (lengthSquared <= limit) return false;
+        s = dot(point - u, direction) / lengthSquared;
+        if (s <= 0.0 || s >= 1.0) return false;
+
+        const Vec3 offset = point - u - direction * s;
+        const Vec3 fromU = point - u;
+        const Vec3 fromV = point - v;
+        return dot(offset, offset) <= limit && dot(fromU, fromU) > limit && dot(fromV, fromV) > limit;
+    }
+
+    // Pool index for a seam point on edge uv; pieces on both sides of the edge get the same vertex
+    static int seamVertex(TriangleSplit& split, int u, int v, double s, const Vec3& position) {
+        const double limit = SEAM_EPSILON * SEAM_EPSILON;
+        for (size_t i = split.seamVertices; i < split.pool.size(); ++i) {
+            const Vec3 offset = split.pool[i].position - position;
+            if (dot(offset, offset) <= limit) return static_cast<int>(i);
+        }
+        PoolVertex vertex;
+        vertex.position = position;
+        for (int k = 0; k < 3; ++k) {
+            vertex.barycentric[k] = split.pool[u].barycentric[k] * (1.0 - s) + split.pool[v].barycentric[k] * s;
+        }
+        split.pool.push_back(vertex);
+        return static_cast<int>(split.pool.size()) - 1;
+    }
+
+    void addSeamCut(int triangle, TriangleSplit& split, int shared, const Vec3& position) const {
+        const int edge = shared & 1 ? 0 : (shared & 2 ? 1 : 2);
+        const auto& corners = m_mesh.triangles[triangle];
+        const int lower = corners[edge] < corners[(edge + 1) % 3] ? edge : (edge + 1) % 3;
+        const int upper = lower == edge ? (edge + 1) % 3 : edge;
+        const Vec3 from = toVec3(m_mesh.corner(triangle, lower));
+        const Vec3 direction = toVec3(m_mesh.corner(triangle, upper)) - from;
+        const double t = dot(position - from, direction) / dot(direction, direction);
+        split.edgeCuts.emplace_back(edgeKey(corners[edge], corners[(edge + 1) % 3]), EdgeCut{ t, position });
+    }
+
+    bool hasEdgeCuts(int triangle) const {
+        if (m_mesh.edgeCuts.empty()) return false;
+        const auto& corners = m_mesh.triangles[triangle];
+        for (int k = 0; k < 3; ++k) {
+            if (m_mesh.edgeCuts.count(edgeKey(corners[k], corners[(k + 1) % 3]))) return true;
+        }
+        return false;
+    }
+
+    const Operand& m_mesh;
+    const Operand& m_other;
+    bool m_fromA;
+    std::vector<int> m_splitTriangles;
+    std::vector<int> m_splitIndex;
+    std::vector<TriangleSplit> m_splits;
+    std::vector<int> m_component;
+    std::vector<Classification> m_componentClass;
+};
+
+// Constructed points within tolerance of a corner or an earlier point take its position, and the
+// triangles that collapse are dropped. Corners never move, as unsplit neighbours share them.
+void weldSeams(RenderMesh& mesh, const SeamVertices& seams, float tolerance) {
+    auto position = [&mesh](unsigned int vertex) { return &mesh.vertices[vertex * RenderMesh::FLOATS_PER_VERTEX]; };
+    auto cellKey = [](int64_t x, int64_t y, int64_t z) {
+        uint64_t hash = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ull;
+        hash = (hash ^ static_cast<uint64_t>(y)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ static_cast<uint64_t>(z)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    };
+    auto cellOf = [tolerance](const float* point, int64_t* cell) {
+        for (int axis = 0; axis < 3; ++axis) cell[axis] = static_cast<int64_t>(std::floor(point[axis] / tolerance));
+    };
+
+    std::unordered_map<uint64_t, std::vector<unsigned int>> cells;
+    cells.reserve(seams.corners.size() + seams.constructed.size());
+    int64_t cell[3];
+    for (unsigned int vertex : seams.corners) {
+        cellOf(position(vertex), cell);
+        cells[cellKey(cell[0], cell[1], cell[2])].push_back(vertex);
+    }
+
+    const float limit = tolerance * tolerance;
+    for (unsigned int vertex : seams.constructed) {
+        float* point = position(vertex);
+        cellOf(point, cell);
+        int nearest = -1;
+        float nearestDistance = limit;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    auto it = cells.find(cellKey(cell[0] + dx, cell[1] + dy, cell[2] + dz));
+                    if (it == cells.end()) continue;
+                    for (unsigned int other : it->second) {
+                        const float* q = position(other);
+                        const float distance = (q[0] - point[0]) * (q[0] - point[0]) +
+                                               (q[1] - point[1]) * (q[1] - point[1]) +
+                                               (q[2] - point[2]) * (q[2] - point[2]);
+                        if (distance <= nearestDistance) {
+                            nearest = static_cast<int>(other);
+                            nearestDistance = distance;
+                        }
+                    }
+                }
+            }
+        }
+        if (nearest >= 0) {
+            std::copy_n(position(static_cast<unsigned int>(nearest)), 3, point);
+        } else {
+            cells[cellKey(cell[0], cell[1], cell[2])].push_back(vertex);
+        }
+    }
+
+    auto same = [&](unsigned int a, unsigned int b) { return std::equal(position(a), position(a) + 3, position(b)); };
+    size_t write = 0;
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        const unsigned int a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+        if (same(a, b) || same(b, c) || same(c, a)) continue;
+        mesh.indices[write++] = a;
+        mesh.indices[write++] = b;
+        mesh.indices[write++] = c;
+    }
+    mesh.indices.resize(write);
+}
+
+bool meshBounds(const RenderMesh& mesh, Vec3& min, Vec3& max) {
+    if (mesh.isEmpty()) return false;
+    for (size_t i = 0; i < mesh.vertices.size(); i += RenderMesh::FLOATS_PER_VERTEX) {
+        const Vec3 p(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+        min = Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+        max = Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+    }
+    return true;
+}
+
+} // namespace
+
+bool MeshBoolean::compute(const RenderMesh& a, const RenderMesh& b, Operation operation, RenderMesh& result,
+                          Stats* stats) {
+    result.clear();
+    if (stats) *stats = Stats();
+
+    const double infinity = std::numeric_limits<double>::max();
+    Vec3 minA(infinity, infinity, infinity), maxA(-infinity, -infinity, -infinity);
+    Vec3 minB = minA, maxB = maxA;
+    const bool hasA = meshBounds(a, minA, maxA);
+    const bool hasB = meshBounds(b, minB, maxB);
+
+    // Operands whose bounds do not meet combine trivially
+    const bool disjoint = !hasA || !hasB ||
+        maxA.x < minB.x || maxB.x < minA.x || maxA.y < minB.y || maxB.y < minA.y || maxA.z < minB.z || maxB.z < minA.z;
+    if (disjoint) {
+        if (operation != INTERSECTION && hasA) appendMesh(result, a);
+        if (operation == UNION && hasB) appendMesh(result, b);
+        if (stats) stats->outputTriangles = result.indices.size() / 3;
+        return !result.isEmpty();
+    }
+
+    Grid grid;
+    grid.origin = Vec3(std::min(minA.x, minB.x), std::min(minA.y, minB.y), std::min(minA.z, minB.z));
+    const Vec3 extent = Vec3(std::max(maxA.x, maxB.x), std::max(maxA.y, maxB.y), std::max(maxA.z, maxB.z)) - grid.origin;
+    const double largest = std::max(extent.x, std::max(extent.y, extent.z));
+    if (largest <= 0.0) return false;
+    grid.step = largest / static_cast<double>(GRID_SIZE);
+
+    Operand operandA;
+    Operand operandB;
+    buildOperand(a, grid, operandA);
+    buildOperand(b, grid, operandB);
+
+    // Broad phase against B's tree, then the exact test, one A triangle per task item
+    std::vector<size_t> candidates(operandA.triangles.size(), 0);
+    ThreadPool::instance().parallelFor(0, operandA.triangles.size(), PAIR_GRAIN, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const int triangle = static_cast<int>(i);
+            const AABB& box = operandA.bounds[i];
+            traverse(operandB.tree,
+                [&](const AABB& node) { return node.overlaps(box); },
+                [&](int other) {
+                    if (!operandB.bounds[other].overlaps(box)) return;
+                    ++candidates[i];
+                    bool coplanar = false;
+                    if (trianglesTouch(operandA, triangle, operandB, other, coplanar)) {
+                        operandA.hits[i].push_back({ other, coplanar });
+                    }
+                });
+        }
+    });
+
+    size_t intersectingPairs = 0;
+    for (size_t t = 0; t < operandA.triangles.size(); ++t) {
+        for (const Hit& hit : operandA.hits[t]) {
+            operandB.hits[hit.triangle].push_back({ static_cast<int>(t), hit.coplanar });
+        }
+        intersectingPairs += operandA.hits[t].size();
+    }
+
+    OperandPass passA(operandA, operandB, true);
+    OperandPass passB(operandB, operandA, false);
+    passA.split();
+    passB.split();
+    OperandPass::mergeSeams(passA, passB);
+    passA.insertSeamVertices(passB);
+    passB.insertSeamVertices(passA);
+    passA.collectEdgeCuts(operandA);
+    passB.collectEdgeCuts(operandB);
+    passA.classify();
+    passB.classify();
+    SeamVertices seams;
+    passA.write(operation, grid, result, seams);
+    passB.write(operation, grid, result, seams);
+    weldSeams(result, seams, static_cast<float>(WELD_STEPS * grid.step));
+
+    if (stats) {
+        for (size_t count : candidates) stats->candidatePairs += count;
+        stats->intersectingPairs = intersectingPairs;
+        stats->splitTriangles = passA.splitCount() + passB.splitCount();
+        stats->outputTriangles = result.indices.size() / 3;
+    }
+    return !result.isEmpty();
+}
+
+} // namespace HybridCAD
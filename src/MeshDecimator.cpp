@@ -0,0 +1,417 @@
+#include "MeshDecimator.h"
+#include "MeshManager.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace HybridCAD {
+
+namespace {
+
+// Boundary edges get a perpendicular constraint plane so open borders do not shrink
+constexpr double BOUNDARY_WEIGHT = 1000.0;
+
+inline void subtract(const float* a, const float* b, double* out) {
+    out[0] = static_cast<double>(a[0]) - b[0];
+    out[1] = static_cast<double>(a[1]) - b[1];
+    out[2] = static_cast<double>(a[2]) - b[2];
+}
+
+inline void cross(const double* a, const double* b, double* out) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline double dot(const double* a, const double* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+} // namespace
+
+void MeshDecimator::Quadric::addPlane(double a, double b, double c, double d, double weight) {
+    a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+    b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+    c2 += weight * c * c; cd += weight * c * d;
+    d2 += weight * d * d;
+}
+
+void MeshDecimator::Quadric::add(const Quadric& other) {
+    a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+    b2 += other.b2; bc += other.bc; bd += other.bd;
+    c2 += other.c2; cd += other.cd;
+    d2 += other.d2;
+}
+
+bool MeshDecimator::heapOrder(const Collapse& a, const Collapse& b) {
+    // std heap functions keep the largest element on top; inverting gives a min-heap on cost
+    return a.cost > b.cost;
+}
+
+double MeshDecimator::Quadric::evaluate(double x, double y, double z) const {
+    return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+         + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+         + c2 * z * z + 2 * cd * z
+         + d2;
+}
+
+MeshDecimator::MeshDecimator(const MeshObject& mesh)
+    : m_positions(mesh.getPositionData()), m_inputTriangles(0), m_liveTriangles(0) {
+    const size_t vertexCount = mesh.vertexCount();
+    const auto& faceIndices = mesh.getFaceIndexData();
+    const auto& faceOffsets = mesh.getFaceOffsetData();
+
+    // Polygons are fan-triangulated; triangles that repeat a vertex are dropped
+    m_triangles.reserve(faceIndices.size());
+    for (size_t f = 0; f + 1 < faceOffsets.size(); ++f) {
+        const int begin = faceOffsets[f];
+        const int end = faceOffsets[f + 1];
+        for (int c = begin + 1; c + 1 < end; ++c) {
+            int a = faceIndices[begin], b = faceIndices[c], d = faceIndices[c + 1];
+            if (a == b || b == d || d == a) continue;
+            m_triangles.insert(m_triangles.end(), { a, b, d });
+        }
+    }
+
+    m_inputTriangles = m_liveTriangles = m_triangles.size() / 3;
+    m_triangleAlive.assign(m_inputTriangles, 1);
+    m_vertexTriangles.resize(vertexCount);
+    for (size_t t = 0; t < m_inputTriangles; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            m_vertexTriangles[m_triangles[t * 3 + k]].push_back(static_cast<int>(t));
+        }
+    }
+
+    m_quadrics.resize(vertexCount);
+    m_stamps.assign(vertexCount, 0);
+    m_vertexAlive.assign(vertexCount, 1);
+    m_boundary.assign(vertexCount, 0);
+    computeQuadrics();
+}
+
+void MeshDecimator::computeQuadrics() {
+    // Area-weighted face planes
+    for (size_t t = 0; t < m_inputTriangles; ++t) {
+        const int* corners = &m_triangles[t * 3];
+        const float* p0 = &m_positions[corners[0] * 3];
+        double e1[3], e2[3], normal[3];
+        subtract(&m_positions[corners[1] * 3], p0, e1);
+        subtract(&m_positions[corners[2] * 3], p0, e2);
+        cross(e1, e2, normal);
+
+        const double length = std::sqrt(dot(normal, normal));
+        if (length <= 0.0) continue;
+        for (double& component : normal) component /= length;
+
+        const double d = -(normal[0] * p0[0] + normal[1] * p0[1] + normal[2] * p0[2]);
+        for (int k = 0; k < 3; ++k) {
+            m_quadrics[corners[k]].addPlane(normal[0], normal[1], normal[2], d, length * 0.5);
+        }
+    }
+
+    // Sorting edge keys groups the half-edges of each edge; single ones lie on the boundary
+    std::vector<std::pair<uint64_t, int>> halfEdges;
+    halfEdges.reserve(m_triangles.size());
+    for (size_t t = 0; t < m_inputTriangles; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            int a = m_triangles[t * 3 + k];
+            int b = m_triangles[t * 3 + (k + 1) % 3];
+            halfEdges.emplace_back(MeshObject::edgeKey(a, b), static_cast<int>(t * 3 + k));
+        }
+    }
+    std::sort(halfEdges.begin(), halfEdges.end());
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(halfEdges.size() / 2 + 1);
+    for (size_t i = 0; i < halfEdges.size();) {
+        size_t j = i + 1;
+        while (j < halfEdges.size() && halfEdges[j].first == halfEdges[i].first) ++j;
+
+        const int corner = halfEdges[i].second;
+        const int t = corner / 3;
+        const int a = m_triangles[corner];
+        const int b = m_triangles[t * 3 + (corner % 3 + 1) % 3];
+
+        if (j - i == 1) {
+            m_boundary[a] = m_boundary[b] = 1;
+
+            double edge[3], e2[3], normal[3], side[3];
+            subtract(&m_positions[b * 3], &m_positions[a * 3], edge);
+            subtract(&m_positions[m_triangles[t * 3 + (corner % 3 + 2) % 3] * 3], &m_positions[a * 3], e2);
+            cross(edge, e2, normal);
+            cross(edge, normal, side);
+
+            const double length = std::sqrt(dot(side, side));
+            if (length > 0.0) {
+                for (double& component : side) component /= length;
+                const float* p = &m_positions[a * 3];
+                const double d = -(side[0] * p[0] + side[1] * p[1] + side[2] * p[2]);
+                const double weight = BOUNDARY_WEIGHT * dot(edge, edge);
+                m_quadrics[a].addPlane(side[0], side[1], side[2], d, weight);
+                m_quadrics[b].addPlane(side[0], side[1], side[2], d, weight);
+            }
+        }
+
+        edges.emplace_back(a, b);
+        i = j;
+    }
+
+    // Costs need the complete quadrics, boundary planes included
+    m_heap.reserve(edges.size() * 2);
+    for (const auto& edge : edges) {
+        pushCollapse(edge.first, edge.second);
+    }
+}
+
+void MeshDecimator::pushCollapse(int keep, int remove) {
+    // The boundary vertex survives so the boundary flag stays exact
+    if (m_boundary[remove] && !m_boundary[keep]) std::swap(keep, remove);
+
+    Quadric q = m_quadrics[keep];
+    q.add(m_quadrics[remove]);
+
+    const float* p1 = &m_positions[keep * 3];
+    const float* p2 = &m_positions[remove * 3];
+    double midpoint[3] = { (p1[0] + p2[0]) * 0.5, (p1[1] + p2[1]) * 0.5, (p1[2] + p2[2]) * 0.5 };
+    double edge[3];
+    subtract(p2, p1, edge);
+    const double edgeLengthSquared = dot(edge, edge);
+
+    Collapse collapse;
+    collapse.keep = keep;
+    collapse.remove = remove;
+    collapse.keepStamp = m_stamps[keep];
+    collapse.removeStamp = m_stamps[remove];
+
+    // Optimal position solves the 3x3 system of the quadric; near-singular systems (flat or
+    // straight regions) fall back to the best of the endpoints and the midpoint
+    const double det = q.a2 * (q.b2 * q.c2 - q.bc * q.bc)
+                     - q.ab * (q.ab * q.c2 - q.bc * q.ac)
+                     + q.ac * (q.ab * q.bc - q.b2 * q.ac);
+    const double trace = q.a2 + q.b2 + q.c2;
+    bool solved = false;
+    if (std::abs(det) > 1e-9 * trace * trace * trace && trace > 0.0) {
+        const double x = (-q.ad * (q.b2 * q.c2 - q.bc * q.bc) - q.ab * (-q.bd * q.c2 + q.bc * q.cd)
+                          + q.ac * (-q.bd * q.bc + q.b2 * q.cd)) / det;
+        const double y = (q.a2 * (-q.bd * q.c2 + q.cd * q.bc) + q.ad * (q.ab * q.c2 - q.bc * q.ac)
+                          + q.ac * (-q.ab * q.cd + q.bd * q.ac)) / det;
+        const double z = (q.a2 * (-q.b2 * q.cd + q.bd * q.bc) - q.ab * (-q.ab * q.cd + q.bd * q.ac)
+                          - q.ad * (q.ab * q.bc - q.b2 * q.ac)) / det;
+
+        // Solutions far from the edge come from badly conditioned quadrics
+        double offset[3] = { x - midpoint[0], y - midpoint[1], z - midpoint[2] };
+        if (dot(offset, offset) <= edgeLengthSquared) {
+            collapse.target[0] = static_cast<float>(x);
+            collapse.target[1] = static_cast<float>(y);
+            collapse.target[2] = static_cast<float>(z);
+            collapse.cost = q.evaluate(x, y, z);
+            solved = true;
+        }
+    }
+
+    if (!solved) {
+        const double candidates[3][3] = {
+            { p1[0], p1[1], p1[2] },
+            { p2[0], p2[1], p2[2] },
+            { midpoint[0], midpoint[1], midpoint[2] }
+        };
+        collapse.cost = std::numeric_limits<double>::max();
+        for (const auto& candidate : candidates) {
+            double cost = q.evaluate(candidate[0], candidate[1], candidate[2]);
+            if (cost < collapse.cost) {
+                collapse.cost = cost;
+                collapse.target[0] = static_cast<float>(candidate[0]);
+                collapse.target[1] = static_cast<float>(candidate[1]);
+                collapse.target[2] = static_cast<float>(candidate[2]);
+            }
+        }
+    }
+
+    collapse.cost = std::max(collapse.cost, 0.0);
+    m_heap.push_back(collapse);
+    std::push_heap(m_heap.begin(), m_heap.end(), heapOrder);
+}
+
+bool MeshDecimator::isStale(const Collapse& collapse) const {
+    return !m_vertexAlive[collapse.keep] || !m_vertexAlive[collapse.remove] ||
+           m_stamps[collapse.keep] != collapse.keepStamp || m_stamps[collapse.remove] != collapse.removeStamp;
+}
+
+void MeshDecimator::gatherNeighbours(int vertex, std::vector<int>& neighbours) const {
+    neighbours.clear();
+    for (int t : m_vertexTriangles[vertex]) {
+        if (!m_triangleAlive[t]) continue;
+        for (int k = 0; k < 3; ++k) {
+            int other = m_triangles[t * 3 + k];
+            if (other != vertex) neighbours.push_back(other);
+        }
+    }
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+}
+
+bool MeshDecimator::canCollapse(const Collapse& collapse) {
+    const int keep = collapse.keep;
+    const int remove = collapse.remove;
+
+    gatherNeighbours(keep, m_neighbours1);
+    gatherNeighbours(remove, m_neighbours2);
+    if (!std::binary_search(m_neighbours1.begin(), m_neighbours1.end(), remove)) return false;
+
+    int edgeTriangles = 0;
+    for (int t : m_vertexTriangles[keep]) {
+        if (!m_triangleAlive[t]) continue;
+        const int* corners = &m_triangles[t * 3];
+        edgeTriangles += corners[0] == remove || corners[1] == remove || corners[2] == remove;
+    }
+
+    // Link condition: the only vertices adjacent to both ends are the apexes of the edge's triangles
+    size_t shared = 0;
+    auto first = m_neighbours1.begin();
+    auto second = m_neighbours2.begin();
+    while (first != m_neighbours1.end() && second != m_neighbours2.end()) {
+        if (*first < *second) {
+            ++first;
+        } else if (*second < *first) {
+            ++second;
+        } else {
+            ++shared;
+            ++first;
+            ++second;
+        }
+    }
+    if (shared != static_cast<size_t>(edgeTriangles)) return false;
+
+    // An interior edge between two boundary vertices would pinch the surface
+    if (m_boundary[keep] && m_boundary[remove] && edgeTriangles != 1) return false;
+
+    // Collapsing a tetrahedron-like fan leaves a degenerate double-sided patch
+    if (m_neighbours1.size() + m_neighbours2.size() - shared - 2 < 3) return false;
+
+    // Reject collapses that flip or degenerate any remaining triangle
+    for (int vertex : { keep, remove }) {
+        for (int t : m_vertexTriangles[vertex]) {
+            if (!m_triangleAlive[t]) continue;
+            const int* corners = &m_triangles[t * 3];
+            if ((corners[0] == keep || corners[1] == keep || corners[2] == keep) &&
+                (corners[0] == remove || corners[1] == remove || corners[2] == remove)) {
+                continue;
+            }
+
+            const float* points[3];
+            for (int k = 0; k < 3; ++k) {
+                points[k] = &m_positions[corners[k] * 3];
+            }
+            double e1[3], e2[3], before[3];
+            subtract(points[1], points[0], e1);
+            subtract(points[2], points[0], e2);
+            cross(e1, e2, before);
+
+            for (int k = 0; k < 3; ++k) {
+                if (corners[k] == vertex) points[k] = collapse.target;
+            }
+            double after[3];
+            subtract(points[1], points[0], e1);
+            subtract(points[2], points[0], e2);
+            cross(e1, e2, after);
+
+            const double afterLengthSquared = dot(after, after);
+            if (afterLengthSquared <= 1e-12 * dot(before, before) || dot(before, after) <= 0.0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void MeshDecimator::applyCollapse(const Collapse& collapse) {
+    const int keep = collapse.keep;
+    const int remove = collapse.remove;
+
+    std::copy_n(collapse.target, 3, &m_positions[keep * 3]);
+    m_quadrics[keep].add(m_quadrics[remove]);
+    m_boundary[keep] = m_boundary[keep] || m_boundary[remove];
+
+    for (int t : m_vertexTriangles[remove]) {
+        if (!m_triangleAlive[t]) continue;
+        int* corners = &m_triangles[t * 3];
+        if (corners[0] == keep || corners[1] == keep || corners[2] == keep) {
+            m_triangleAlive[t] = 0;
+            --m_liveTriangles;
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            if (corners[k] == remove) corners[k] = keep;
+        }
+        m_vertexTriangles[keep].push_back(t);
+    }
+
+    auto& triangles = m_vertexTriangles[keep];
+    triangles.erase(std::remove_if(triangles.begin(), triangles.end(),
+                                   [this](int t) { return !m_triangleAlive[t]; }),
+                    triangles.end());
+    m_vertexTriangles[remove].clear();
+    m_vertexTriangles[remove].shrink_to_fit();
+
+    m_vertexAlive[remove] = 0;
+    ++m_stamps[keep];
+    ++m_stamps[remove];
+
+    // Only edges around the survivor change cost; the older entries are now stale
+    gatherNeighbours(keep, m_neighbours1);
+    for (int neighbour : m_neighbours1) {
+        pushCollapse(keep, neighbour);
+    }
+}
+
+size_t MeshDecimator::decimateTo(size_t targetTriangles) {
+    while (m_liveTriangles > targetTriangles && !m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), heapOrder);
+        Collapse collapse = m_heap.back();
+        m_heap.pop_back();
+
+        if (isStale(collapse) || !canCollapse(collapse)) continue;
+        applyCollapse(collapse);
+    }
+    return m_liveTriangles;
+}
+
+void MeshDecimator::extract(MeshObject& mesh) const {
+    std::vector<int> newIndex(m_vertexAlive.size(), -1);
+    std::vector<float> positions;
+    std::vector<int> indices;
+    indices.reserve(m_liveTriangles * 3);
+
+    for (size_t t = 0; t < m_triangleAlive.size(); ++t) {
+        if (!m_triangleAlive[t]) continue;
+        for (int k = 0; k < 3; ++k) {
+            int vertex = m_triangles[t * 3 + k];
+            if (newIndex[vertex] < 0) {
+                newIndex[vertex] = static_cast<int>(positions.size() / 3);
+                positions.insert(positions.end(), &m_positions[vertex * 3], &m_positions[vertex * 3] + 3);
+            }
+            indices.push_back(newIndex[vertex]);
+        }
+    }
+
+    std::vector<int> offsets(indices.size() / 3 + 1);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        offsets[i] = static_cast<int>(i * 3);
+    }
+    mesh.setGeometry(std::move(positions), std::move(indices), std::move(offsets));
+}
+
+std::vector<std::shared_ptr<MeshObject>> MeshDecimator::buildLodChain(const std::vector<float>& ratios, const std::string& name) {
+    std::vector<std::shared_ptr<MeshObject>> levels;
+    levels.reserve(ratios.size());
+    for (size_t i = 0; i < ratios.size(); ++i) {
+        decimateTo(static_cast<size_t>(std::max(ratios[i], 0.0f) * m_inputTriangles));
+
+        auto level = std::make_shared<MeshObject>(name + "_lod" + std::to_string(i + 1));
+        extract(*level);
+        levels.push_back(level);
+    }
+    return levels;
+}
+
+} // namespace HybridCAD
@@ -0,0 +1,578 @@
+#include "MeshIO.h"
+#include "MappedFile.h"
+#include "MeshManager.h"
+#include "ThreadPool.h"
+#include <QFile>
+#include <QString>
+#include <QtEndian>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace HybridCAD {
+
+namespace {
+
+constexpr size_t STL_HEADER_SIZE = 80;
+constexpr size_t STL_RECORD_SIZE = 50;
+
+// Below this size an OBJ file is parsed on the calling thread only
+constexpr size_t OBJ_PARALLEL_CHUNK_SIZE = 4 << 20;
+
+// Buffered writer; output reaches the file only when the buffer fills or on finish()
+class BufferedWriter {
+public:
+    explicit BufferedWriter(const std::string& filename)
+        : m_file(QString::fromStdString(filename)), m_ok(false) {
+        m_buffer.reserve(MeshIO::WRITE_BUFFER_SIZE);
+    }
+
+    bool open() {
+        m_ok = m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        return m_ok;
+    }
+
+    void write(const char* data, size_t size) {
+        if (m_buffer.size() + size > MeshIO::WRITE_BUFFER_SIZE) {
+            flushBuffer();
+        }
+        m_buffer.insert(m_buffer.end(), data, data + size);
+    }
+
+    void writeText(const char* text) { write(text, std::strlen(text)); }
+
+    void writeFloat(float value) {
+        char text[32];
+        // Locale independent and round-trips exactly
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        write(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    void writeInt(long long value) {
+        char text[24];
+        auto result = std::to_chars(text, text + sizeof(text), value);
+        write(text, static_cast<size_t>(result.ptr - text));
+    }
+
+    template <typename T>
+    void writeLittleEndian(T value) {
+        char bytes[sizeof(T)];
+        qToLittleEndian(value, bytes);
+        write(bytes, sizeof(T));
+    }
+
+    bool finish() {
+        flushBuffer();
+        m_file.close();
+        return m_ok;
+    }
+
+private:
+    void flushBuffer() {
+        if (m_buffer.empty()) return;
+        qint64 size = static_cast<qint64>(m_buffer.size());
+        if (m_file.write(m_buffer.data(), size) != size) {
+            m_ok = false;
+        }
+        m_buffer.clear();
+    }
+
+    QFile m_file;
+    std::vector<char> m_buffer;
+    bool m_ok;
+};
+
+// Allocation-free tokenizer over a character range
+struct TextCursor {
+    const char* p;
+    const char* end;
+
+    bool atEnd() const { return p >= end; }
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // Stays on the current line
+    void skipSpaces() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    }
+
+    void skipWhitespace() {
+        while (p < end && isSpace(*p)) ++p;
+    }
+
+    void skipLine() {
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+
+    void skipToken() {
+        while (p < end && !isSpace(*p)) ++p;
+    }
+
+    bool atLineEnd() const { return p >= end || *p == '\n' || *p == '#'; }
+
+    // Consumes word when it is followed by whitespace or the end of input
+    bool matchWord(const char* word) {
+        size_t length = std::strlen(word);
+        if (static_cast<size_t>(end - p) < length || std::memcmp(p, word, length) != 0) return false;
+        if (p + length < end && !isSpace(p[length])) return false;
+        p += length;
+        return true;
+    }
+
+    bool parseInt(long long& value) {
+        skipSpaces();
+        const char* start = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        if (p >= end || !isDigit(*p)) {
+            p = start;
+            return false;
+        }
+        long long result = 0;
+        while (p < end && isDigit(*p)) {
+            result = result * 10 + (*p - '0');
+            ++p;
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    bool parseFloat(float& value) {
+        static const double powersOfTen[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        skipSpaces();
+        const char* start = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+
+        double mantissa = 0.0;
+        int exponent = 0;
+        bool digits = false;
+        while (p < end && isDigit(*p)) {
+            mantissa = mantissa * 10.0 + (*p - '0');
+            digits = true;
+            ++p;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            while (p < end && isDigit(*p)) {
+                mantissa = mantissa * 10.0 + (*p - '0');
+                --exponent;
+                digits = true;
+                ++p;
+            }
+        }
+        if (!digits) {
+            p = start;
+            return false;
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* exponentStart = p++;
+            bool exponentNegative = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                exponentNegative = *p == '-';
+                ++p;
+            }
+            if (p < end && isDigit(*p)) {
+                int exponentValue = 0;
+                while (p < end && isDigit(*p)) {
+                    exponentValue = std::min(exponentValue * 10 + (*p - '0'), 10000);
+                    ++p;
+                }
+                exponent += exponentNegative ? -exponentValue : exponentValue;
+            } else {
+                p = exponentStart;
+            }
+        }
+
+        double result = mantissa;
+        if (exponent < 0) {
+            result = -exponent <= 22 ? result / powersOfTen[-exponent] : result * std::pow(10.0, exponent);
+        } else if (exponent > 0) {
+            result = exponent <= 22 ? result * powersOfTen[exponent] : result * std::pow(10.0, exponent);
+        }
+        value = static_cast<float>(negative ? -result : result);
+        return true;
+    }
+};
+
+// Streaming vertex weld: an open-addressing hash on the exact position bits, so identical
+// facet corners (as STL stores them) collapse to one vertex without a second pass
+class PositionWelder {
+public:
+    PositionWelder(std::vector<float>& positions, size_t expectedVertices)
+        : m_positions(positions), m_size(0) {
+        size_t capacity = 16;
+        while (capacity < expectedVertices * 2) capacity <<= 1;
+        m_slots.assign(capacity, Slot());
+    }
+
+    int insert(const float* xyz) {
+        Slot key;
+        // Adding 0.0f turns -0.0f into 0.0f so both weld together
+        float normalized[3] = { xyz[0] + 0.0f, xyz[1] + 0.0f, xyz[2] + 0.0f };
+        std::memcpy(key.bits, normalized, sizeof(normalized));
+
+        size_t mask = m_slots.size() - 1;
+        size_t slot = hash(key) & mask;
+        while (m_slots[slot].index >= 0) {
+            const Slot& existing = m_slots[slot];
+            if (existing.bits[0] == key.bits[0] && existing.bits[1] == key.bits[1] && existing.bits[2] == key.bits[2]) {
+                return existing.index;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        key.index = static_cast<int>(m_positions.size() / 3);
+        m_slots[slot] = key;
+        m_positions.insert(m_positions.end(), { normalized[0], normalized[1], normalized[2] });
+
+        if (++m_size * 2 > m_slots.size()) {
+            grow();
+        }
+        return key.index;
+    }
+
+private:
+    struct Slot {
+        uint32_t bits[3] = { 0, 0, 0 };
+        int index = -1;
+    };
+
+    static size_t hash(const Slot& slot) {
+        uint64_t h = slot.bits[0] * 0x9E3779B97F4A7C15ull;
+        h ^= (h >> 29) ^ (slot.bits[1] * 0xBF58476D1CE4E5B9ull);
+        h ^= (h >> 32) ^ (slot.bits[2] * 0x94D049BB133111EBull);
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.assign(old.size() * 2, Slot());
+
+        size_t mask = m_slots.size() - 1;
+        for (const auto& entry : old) {
+            if (entry.index < 0) continue;
+            size_t slot = hash(entry) & mask;
+            while (m_slots[slot].index >= 0) {
+                slot = (slot + 1) & mask;
+            }
+            m_slots[slot] = entry;
+        }
+    }
+
+    std::vector<float>& m_positions;
+    std::vector<Slot> m_slots;
+    size_t m_size;
+};
+
+std::vector<int> triangleOffsets(size_t triangleCount) {
+    std::vector<int> offsets(triangleCount + 1);
+    for (size_t i = 0; i <= triangleCount; ++i) {
+        offsets[i] = static_cast<int>(i * 3);
+    }
+    return offsets;
+}
+
+void addWeldedTriangle(PositionWelder& welder, const float* corners, std::vector<int>& indices) {
+    int a = welder.insert(corners);
+    int b = welder.insert(corners + 3);
+    int c = welder.insert(corners + 6);
+    // Facets that collapse to a line or point add nothing to the surface
+    if (a == b || b == c || c == a) return;
+    indices.insert(indices.end(), { a, b, c });
+}
+
+bool readBinarySTL(const char* data, size_t size, std::vector<float>& positions, std::vector<int>& indices) {
+    uint32_t triangleCount = qFromLittleEndian<quint32>(data + STL_HEADER_SIZE);
+    if (size < STL_HEADER_SIZE + 4 + static_cast<size_t>(triangleCount) * STL_RECORD_SIZE) return false;
+
+    // Closed meshes have about half as many vertices as facets
+    positions.reserve(static_cast<size_t>(triangleCount) * 3 / 2);
+    indices.reserve(static_cast<size_t>(triangleCount) * 3);
+    PositionWelder welder(positions, triangleCount / 2 + 1);
+
+    const char* record = data + STL_HEADER_SIZE + 4;
+    float corners[9];
+    for (uint32_t i = 0; i < triangleCount; ++i, record += STL_RECORD_SIZE) {
+        // Record layout: normal, three corners, attribute byte count; the stored normal is ignored
+        for (int k = 0; k < 9; ++k) {
+            quint32 bits = qFromLittleEndian<quint32>(record + 12 + k * 4);
+            std::memcpy(&corners[k], &bits, sizeof(float));
+        }
+        addWeldedTriangle(welder, corners, indices);
+    }
+    return true;
+}
+
+bool readAsciiSTL(const char* data, size_t size, std::vector<float>& positions, std::vector<int>& indices) {
+    PositionWelder welder(positions, size / 256);
+    TextCursor cursor{data, data + size};
+
+    float corners[9];
+    int cornerCount = 0;
+    while (!cursor.atEnd()) {
+        cursor.skipWhitespace();
+        if (cursor.matchWord("vertex")) {
+            float* corner = &corners[cornerCount * 3];
+            if (!cursor.parseFloat(corner[0]) || !cursor.parseFloat(corner[1]) || !cursor.parseFloat(corner[2])) {
+                return false;
+            }
+            if (++cornerCount == 3) {
+                addWeldedTriangle(welder, corners, indices);
+                cornerCount = 0;
+            }
+        } else if (cursor.matchWord("endloop")) {
+            cornerCount = 0;
+        } else {
+            cursor.skipToken();
+        }
+    }
+    return true;
+}
+
+// Parsed content of one line range of an OBJ file
+struct ObjChunk {
+    std::vector<float> positions;
+    std::vector<int> corners;        // Absolute zero-based, or chunk-local for relative references
+    std::vector<int> faceSizes;
+    std::vector<size_t> relativeCorners;
+    bool ok = true;
+};
+
+void parseObjChunk(const char* begin, const char* end, ObjChunk& chunk) {
+    TextCursor cursor{begin, end};
+    while (!cursor.atEnd()) {
+        cursor.skipSpaces();
+        if (cursor.atEnd()) break;
+
+        if (cursor.matchWord("v")) {
+            float xyz[3];
+            if (!cursor.parseFloat(xyz[0]) || !cursor.parseFloat(xyz[1]) || !cursor.parseFloat(xyz[2])) {
+                chunk.ok = false;
+                return;
+            }
+            chunk.positions.insert(chunk.positions.end(), { xyz[0], xyz[1], xyz[2] });
+        } else if (cursor.matchWord("f")) {
+            size_t firstCorner = chunk.corners.size();
+            size_t firstRelative = chunk.relativeCorners.size();
+            int localVertexCount = static_cast<int>(chunk.positions.size() / 3);
+
+            for (;;) {
+                cursor.skipSpaces();
+                if (cursor.atLineEnd()) break;
+
+                long long index;
+                if (!cursor.parseInt(index) || index == 0) {
+                    chunk.ok = false;
+                    return;
+                }
+                // Texture and normal references ("v/vt/vn") are not used
+                cursor.skipToken();
+
+                if (index > 0) {
+                    chunk.corners.push_back(static_cast<int>(index - 1));
+                } else {
+                    // Negative indices count back from the latest vertex; resolved once chunk bases are known
+                    chunk.relativeCorners.push_back(chunk.corners.size());
+                    chunk.corners.push_back(localVertexCount + static_cast<int>(index));
+                }
+            }
+
+            int cornerCount = static_cast<int>(chunk.corners.size() - firstCorner);
+            if (cornerCount >= 3) {
+                chunk.faceSizes.push_back(cornerCount);
+            } else {
+                chunk.corners.resize(firstCorner);
+                chunk.relativeCorners.resize(firstRelative);
+            }
+        }
+        cursor.skipLine();
+    }
+}
+
+} // namespace
+
+bool MeshIO::importSTL(const std::string& filename, MeshObject& mesh) {
+    MappedFile file(filename);
+    if (!file.open() || file.size() < STL_HEADER_SIZE + 4) return false;
+
+    const char* data = file.data();
+    const size_t size = file.size();
+
+    // Binary files can also start with "solid", so the size check decides first
+    uint32_t triangleCount = qFromLittleEndian<quint32>(data + STL_HEADER_SIZE);
+    bool binary = size == STL_HEADER_SIZE + 4 + static_cast<size_t>(triangleCount) * STL_RECORD_SIZE;
+    if (!binary) {
+        binary = std::strncmp(data, "solid", 5) != 0;
+    }
+
+    std::vector<float> positions;
+    std::vector<int> indices;
+    bool ok = binary ? readBinarySTL(data, size, positions, indices) : readAsciiSTL(data, size, positions, indices);
+    if (!ok) return false;
+
+    size_t faceCount = indices.size() / 3;
+    mesh.setGeometry(std::move(positions), std::move(indices), triangleOffsets(faceCount));
+    return true;
+}
+
+bool MeshIO::exportSTL(const std::string& filename, const MeshObject& mesh) {
+    BufferedWriter writer(filename);
+    if (!writer.open()) return false;
+
+    uint32_t triangleCount = 0;
+    for (size_t f = 0; f < mesh.faceCount(); ++f) {
+        size_t corners = mesh.getFaceVertices(static_cast<int>(f)).size();
+        if (corners >= 3) triangleCount += static_cast<uint32_t>(corners - 2);
+    }
+
+    char header[STL_HEADER_SIZE] = {};
+    std::strncpy(header, "HybridCAD binary STL", sizeof(header));
+    writer.write(header, sizeof(header));
+    writer.writeLittleEndian<quint32>(triangleCount);
+
+    const std::vector<float>& positions = mesh.getPositionData();
+    auto writeVector = [&writer](const float* xyz) {
+        for (int k = 0; k < 3; ++k) {
+            quint32 bits;
+            std::memcpy(&bits, &xyz[k], sizeof(float));
+            writer.writeLittleEndian<quint32>(bits);
+        }
+    };
+
+    for (size_t f = 0; f < mesh.faceCount(); ++f) {
+        AdjacencyRange corners = mesh.getFaceVertices(static_cast<int>(f));
+        if (corners.size() < 3) continue;
+
+        const float* normal = &mesh.getFaceNormalData()[f * 3];
+        for (size_t i = 1; i + 1 < corners.size(); ++i) {
+            writeVector(normal);
+            writeVector(&positions[corners[0] * 3]);
+            writeVector(&positions[corners[i] * 3]);
+            writeVector(&positions[corners[i + 1] * 3]);
+            writer.writeLittleEndian<quint16>(0);
+        }
+    }
+    return writer.finish();
+}
+
+bool MeshIO::importOBJ(const std::string& filename, MeshObject& mesh) {
+    MappedFile file(filename);
+    if (!file.open()) return false;
+
+    const char* data = file.data();
+    const char* end = data + file.size();
+
+    // Split at line starts so every chunk parses independently
+    ThreadPool& pool = ThreadPool::instance();
+    size_t chunkCount = std::max<size_t>(1, std::min(pool.threadCount() * 2, file.size() / OBJ_PARALLEL_CHUNK_SIZE));
+    std::vector<const char*> bounds(chunkCount + 1, end);
+    bounds[0] = data;
+    for (size_t i = 1; i < chunkCount; ++i) {
+        const char* split = std::max(bounds[i - 1], data + file.size() * i / chunkCount);
+        while (split < end && *split != '\n') ++split;
+        bounds[i] = split < end ? split + 1 : end;
+    }
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    pool.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            parseObjChunk(bounds[i], bounds[i + 1], chunks[i]);
+        }
+    });
+
+    // Prefix sums give each chunk its place in the merged arrays
+    std::vector<size_t> vertexBase(chunkCount + 1, 0), cornerBase(chunkCount + 1, 0), faceBase(chunkCount + 1, 0);
+    for (size_t i = 0; i < chunkCount; ++i) {
+        if (!chunks[i].ok) return false;
+        vertexBase[i + 1] = vertexBase[i] + chunks[i].positions.size() / 3;
+        cornerBase[i + 1] = cornerBase[i] + chunks[i].corners.size();
+        faceBase[i + 1] = faceBase[i] + chunks[i].faceSizes.size();
+    }
+
+    const size_t vertexCount = vertexBase[chunkCount];
+    std::vector<float> positions(vertexCount * 3);
+    std::vector<int> corners(cornerBase[chunkCount]);
+    std::vector<int> offsets(faceBase[chunkCount] + 1);
+    offsets.back() = static_cast<int>(corners.size());
+
+    std::atomic<bool> valid{true};
+    pool.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            ObjChunk& chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + vertexBase[i] * 3);
+
+            for (size_t corner : chunk.relativeCorners) {
+                chunk.corners[corner] += static_cast<int>(vertexBase[i]);
+            }
+            for (size_t c = 0; c < chunk.corners.size(); ++c) {
+                int index = chunk.corners[c];
+                if (index < 0 || static_cast<size_t>(index) >= vertexCount) {
+                    valid = false;
+                }
+                corners[cornerBase[i] + c] = index;
+            }
+
+            int offset = static_cast<int>(cornerBase[i]);
+            for (size_t f = 0; f < chunk.faceSizes.size(); ++f) {
+                offsets[faceBase[i] + f] = offset;
+                offset += chunk.faceSizes[f];
+            }
+
+            // Chunk storage is released as soon as it has been merged
+            chunk = ObjChunk();
+        }
+    });
+    if (!valid) return false;
+
+    mesh.setGeometry(std::move(positions), std::move(corners), std::move(offsets));
+    return true;
+}
+
+bool MeshIO::exportOBJ(const std::string& filename, const MeshObject& mesh) {
+    BufferedWriter writer(filename);
+    if (!writer.open()) return false;
+
+    writer.writeText("# HybridCAD OBJ export\n");
+
+    const std::vector<float>& positions = mesh.getPositionData();
+    for (size_t i = 0; i < positions.size(); i += 3) {
+        writer.writeText("v ");
+        writer.writeFloat(positions[i]);
+        writer.writeText(" ");
+        writer.writeFloat(positions[i + 1]);
+        writer.writeText(" ");
+        writer.writeFloat(positions[i + 2]);
+        writer.writeText("\n");
+    }
+
+    for (size_t f = 0; f < mesh.faceCount(); ++f) {
+        AdjacencyRange corners = mesh.getFaceVertices(static_cast<int>(f));
+        if (corners.empty()) continue;
+
+        writer.writeText("f");
+        for (int vertex : corners) {
+            writer.writeText(" ");
+            writer.writeInt(vertex + 1);
+        }
+        writer.writeText("\n");
+    }
+    return writer.finish();
+}
+
+} // namespace HybridCAD
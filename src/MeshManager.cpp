@@ -1,36 +1,179 @@
 #include "MeshManager.h"
+#include "MeshBoolean.h"
+#include "MeshDecimator.h"
+#include "MeshIO.h"
+#include "ThreadPool.h"
+#include "UndoHistory.h"
 #include <GL/gl.h>
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace HybridCAD {
 
+namespace {
+
+constexpr size_t NORMAL_GRAIN = 4096;
+
+// Records the edit made during its lifetime as one MeshSnapshotCommand, if the mesh changed
+class MeshEditRecord {
+public:
+    MeshEditRecord(UndoHistory* history, const std::shared_ptr<MeshObject>& mesh, const char* description)
+        : m_history(history && mesh && !history->isReplaying() ? history : nullptr)
+        , m_mesh(mesh)
+        , m_description(description)
+        , m_revision(0)
+    {
+        if (m_history) {
+            m_revision = mesh->getGeometryRevision();
+            m_before = m_history->snapshotMesh(*mesh);
+        }
+    }
+    
+    ~MeshEditRecord() {
+        if (!m_history || m_mesh->getGeometryRevision() == m_revision) return;
+        m_history->push(std::make_unique<MeshSnapshotCommand>(m_description, m_mesh, std::move(m_before),
+                                                              m_history->snapshotMesh(*m_mesh)));
+    }
+    
+    MeshEditRecord(const MeshEditRecord&) = delete;
+    MeshEditRecord& operator=(const MeshEditRecord&) = delete;
+
+private:
+    UndoHistory* m_history;
+    std::shared_ptr<MeshObject> m_mesh;
+    const char* m_description;
+    uint64_t m_revision;
+    std::shared_ptr<const MeshSnapshot> m_before;
+};
+
+} // namespace
+
+// SelectionBits implementation
+void SelectionBits::resize(size_t count) {
+    m_count = count;
+    m_words.resize((count + 63) / 64, 0);
+    maskTail();
+}
+
+void SelectionBits::set(size_t index, bool value) {
+    if (index >= m_count) return;
+    uint64_t mask = uint64_t(1) << (index % 64);
+    if (value) {
+        m_words[index / 64] |= mask;
+    } else {
+        m_words[index / 64] &= ~mask;
+    }
+}
+
+void SelectionBits::setAll() {
+    std::fill(m_words.begin(), m_words.end(), ~uint64_t(0));
+    maskTail();
+}
+
+void SelectionBits::flip() {
+    for (auto& word : m_words) {
+        word = ~word;
+    }
+    maskTail();
+}
+
+size_t SelectionBits::count() const {
+    size_t total = 0;
+    for (uint64_t word : m_words) {
+        while (word) {
+            word &= word - 1;
+            ++total;
+        }
+    }
+    return total;
+}
+
+bool SelectionBits::any() const {
+    return std::any_of(m_words.begin(), m_words.end(), [](uint64_t word) { return word != 0; });
+}
+
+std::vector<int> SelectionBits::indices() const {
+    std::vector<int> result;
+    for (size_t w = 0; w < m_words.size(); ++w) {
+        uint64_t word = m_words[w];
+        while (word) {
+            int bit = 0;
+            while (!((word >> bit) & 1u)) ++bit;
+            result.push_back(static_cast<int>(w * 64 + bit));
+            word &= word - 1;
+        }
+    }
+    return result;
+}
+
+void SelectionBits::maskTail() {
+    // Bits past the element count must stay clear so count() and indices() are exact
+    if (m_count % 64 && !m_words.empty()) {
+        m_words.back() &= (uint64_t(1) << (m_count % 64)) - 1;
+    }
+}
+
 // MeshObject implementation
 MeshObject::MeshObject(const std::string& name) 
-    : CADObject(name), m_nextVertexId(0), m_nextEdgeId(0), m_nextFaceId(0) {
+    : CADObject(name), m_faceOffsets(1, 0) {
 }
 
 void MeshObject::render() const {
     if (!m_visible) return;
     
     glBegin(GL_TRIANGLES);
-    for (const auto& face : m_faces) {
-        if (face.vertices.size() >= 3) {
-            for (size_t i = 1; i < face.vertices.size() - 1; ++i) {
-                const auto& v0 = m_vertices[face.vertices[0]];
-                const auto& v1 = m_vertices[face.vertices[i]];
-                const auto& v2 = m_vertices[face.vertices[i + 1]];
-                
-                glNormal3f(face.normal.x, face.normal.y, face.normal.z);
-                glVertex3f(v0.position.x, v0.position.y, v0.position.z);
-                glVertex3f(v1.position.x, v1.position.y, v1.position.z);
-                glVertex3f(v2.position.x, v2.position.y, v2.position.z);
-            }
+    for (size_t f = 0; f < faceCount(); ++f) {
+        AdjacencyRange corners = getFaceVertices(static_cast<int>(f));
+        if (corners.size() < 3) continue;
+        
+        const float* normal = &m_faceNormals[f * 3];
+        const float* v0 = &m_positions[corners[0] * 3];
+        for (size_t i = 1; i + 1 < corners.size(); ++i) {
+            const float* v1 = &m_positions[corners[i] * 3];
+            const float* v2 = &m_positions[corners[i + 1] * 3];
+            
+            glNormal3fv(normal);
+            glVertex3fv(v0);
+            glVertex3fv(v1);
+            glVertex3fv(v2);
         }
     }
     glEnd();
 }
 
+bool MeshObject::buildRenderMesh(RenderMesh& mesh) const {
+    ensureLoaded();
+    // Flat shaded like render(): each face gets its own vertices carrying the face normal
+    mesh.vertices.reserve(mesh.vertices.size() + m_faceIndices.size() * RenderMesh::FLOATS_PER_VERTEX);
+    for (size_t f = 0; f < faceCount(); ++f) {
+        AdjacencyRange corners = getFaceVertices(static_cast<int>(f));
+        if (corners.size() < 3) continue;
+        
+        QVector3D normal = getFaceNormal(static_cast<int>(f));
+        unsigned int first = mesh.vertexCount();
+        for (int vertexIndex : corners) {
+            mesh.addVertex(getVertexPosition(vertexIndex), normal);
+        }
+        for (unsigned int i = 1; i + 1 < corners.size(); ++i) {
+            mesh.addTriangle(first, first + i, first + i + 1);
+        }
+    }
+    return !mesh.isEmpty();
+}
+
+int MeshObject::faceForRenderTriangle(int triangle) const {
+    if (triangle < 0) return -1;
+    // Mirrors buildRenderMesh(): faces fan into corners - 2 triangles, degenerate faces into none
+    for (size_t f = 0; f < faceCount(); ++f) {
+        const int triangles = m_faceOffsets[f + 1] - m_faceOffsets[f] - 2;
+        if (triangles <= 0) continue;
+        if (triangle < triangles) return static_cast<int>(f);
+        triangle -= triangles;
+    }
+    return -1;
+}
+
 bool MeshObject::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const {
     // Basic mesh intersection test - check against bounding box
     Point3D min = getBoundingBoxMin();
@@ -41,112 +184,261 @@ bool MeshObject::intersects(const Point3D& rayOrigin, const Vector3D& rayDirecti
             rayOrigin.z >= min.z && rayOrigin.z <= max.z);
 }
 
+void MeshObject::setVertexPosition(int vertexIndex, const QVector3D& position) {
+    float* p = &m_positions[vertexIndex * 3];
+    p[0] = position.x();
+    p[1] = position.y();
+    p[2] = position.z();
+}
+
+int MeshObject::addVertex(const QVector3D& position) {
+    ensureLoaded();
+    int index = static_cast<int>(vertexCount());
+    m_positions.insert(m_positions.end(), { position.x(), position.y(), position.z() });
+    m_normals.insert(m_normals.end(), { 0.0f, 0.0f, 0.0f });
+    m_vertexSelection.resize(vertexCount());
+    return index;
+}
+
+int MeshObject::addFace(const int* vertexIndices, int cornerCount, const QVector3D& normal) {
+    ensureLoaded();
+    int index = static_cast<int>(faceCount());
+    m_faceIndices.insert(m_faceIndices.end(), vertexIndices, vertexIndices + cornerCount);
+    m_faceOffsets.push_back(static_cast<int>(m_faceIndices.size()));
+    m_faceNormals.insert(m_faceNormals.end(), { normal.x(), normal.y(), normal.z() });
+    m_faceSelection.resize(faceCount());
+    return index;
+}
+
+void MeshObject::reserve(size_t vertices, size_t faces, size_t corners) {
+    ensureLoaded();
+    m_positions.reserve(vertices * 3);
+    m_normals.reserve(vertices * 3);
+    m_faceIndices.reserve(corners);
+    m_faceOffsets.reserve(faces + 1);
+    m_faceNormals.reserve(faces * 3);
+}
+
+void MeshObject::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_deferredMutex);
+        m_deferred.reset();
+        m_deferredPending.store(false, std::memory_order_release);
+    }
+    m_positions.clear();
+    m_normals.clear();
+    m_faceIndices.clear();
+    m_faceOffsets.assign(1, 0);
+    m_faceNormals.clear();
+    m_edgeVertices.clear();
+    m_edgeLookup.clear();
+    m_cornerEdges.clear();
+    m_vertexSelection.resize(0);
+    m_edgeSelection.resize(0);
+    m_faceSelection.resize(0);
+}
+
 void MeshObject::createFromTriangles(const std::vector<Triangle>& triangles) {
-    m_vertices.clear();
-    m_edges.clear();
-    m_faces.clear();
-    
-    int vertexId = 0;
-    int faceId = 0;
+    clear();
+    reserve(triangles.size() * 3, triangles.size(), triangles.size() * 3);
     
     for (const auto& triangle : triangles) {
-        std::vector<int> faceVertices;
-        
-        // Add vertices
-        m_vertices.emplace_back(triangle.v0, vertexId++);
-        faceVertices.push_back(vertexId - 1);
-        
-        m_vertices.emplace_back(triangle.v1, vertexId++);
-        faceVertices.push_back(vertexId - 1);
-        
-        m_vertices.emplace_back(triangle.v2, vertexId++);
-        faceVertices.push_back(vertexId - 1);
-        
-        // Add face
-        MeshFace face(faceVertices, faceId++);
-        face.normal = triangle.normal;
-        m_faces.push_back(face);
+        int corners[3] = {
+            addVertex(triangle.v0.toQVector3D()),
+            addVertex(triangle.v1.toQVector3D()),
+            addVertex(triangle.v2.toQVector3D())
+        };
+        addFace(corners, 3, triangle.normal.toQVector3D());
     }
     
-    buildTopology();
+    // Every triangle brings its own corners; welding shares them and rebuilds the topology
+    if (removeDuplicateVertices() == 0) {
+        buildTopology();
+    }
+    markGeometryDirty();
 }
 
 void MeshObject::createFromGeometry(const std::vector<Point3D>& vertices, const std::vector<Face>& faces) {
-    m_vertices.clear();
-    m_edges.clear();
-    m_faces.clear();
+    clear();
     
-    int vertexId = 0;
-    for (const auto& vertex : vertices) {
-        m_vertices.emplace_back(vertex, vertexId++);
+    size_t cornerCount = 0;
+    for (const auto& face : faces) {
+        cornerCount += face.vertexIndices.size();
     }
+    reserve(vertices.size(), faces.size(), cornerCount);
     
-    int faceId = 0;
+    for (const auto& vertex : vertices) {
+        addVertex(vertex.toQVector3D());
+    }
     for (const auto& face : faces) {
-        MeshFace meshFace(face.vertexIndices, faceId++);
-        meshFace.normal = face.normal;
-        m_faces.push_back(meshFace);
+        addFace(face.vertexIndices.data(), static_cast<int>(face.vertexIndices.size()), face.normal.toQVector3D());
+    }
+    
+    buildTopology();
+    markGeometryDirty();
+}
+
+void MeshObject::setGeometry(std::vector<float> positions, std::vector<int> faceIndices, std::vector<int> faceOffsets) {
+    clear();
+    m_positions = std::move(positions);
+    m_faceIndices = std::move(faceIndices);
+    m_faceOffsets = std::move(faceOffsets);
+    if (m_faceOffsets.empty()) {
+        m_faceOffsets.assign(1, 0);
     }
     
+    m_normals.assign(m_positions.size(), 0.0f);
+    m_faceNormals.assign(faceCount() * 3, 0.0f);
+    m_vertexSelection.resize(vertexCount());
+    m_faceSelection.resize(faceCount());
+    
+    buildTopology();
+    recalculateNormals();
+}
+
+namespace {
+
+template <typename T>
+std::shared_ptr<const std::vector<T>> shareArray(const std::vector<T>& data, const std::shared_ptr<const std::vector<T>>* base) {
+    if (base && *base && **base == data) return *base;
+    return std::make_shared<const std::vector<T>>(data);
+}
+
+template <typename T>
+size_t arrayBytes(const std::shared_ptr<const std::vector<T>>& data, std::unordered_set<const void*>& counted) {
+    if (!data || !counted.insert(data.get()).second) return 0;
+    return sizeof(std::vector<T>) + data->capacity() * sizeof(T);
+}
+
+} // namespace
+
+size_t MeshSnapshot::memoryUsage(std::unordered_set<const void*>& counted) const {
+    return arrayBytes(positions, counted) + arrayBytes(faceIndices, counted) +
+           arrayBytes(faceOffsets, counted) + arrayBytes(faceNormals, counted);
+}
+
+std::shared_ptr<const MeshSnapshot> MeshObject::takeSnapshot(const MeshSnapshot* base) const {
+    ensureLoaded();
+    auto snapshot = std::make_shared<MeshSnapshot>();
+    snapshot->positions = shareArray(m_positions, base ? &base->positions : nullptr);
+    snapshot->faceIndices = shareArray(m_faceIndices, base ? &base->faceIndices : nullptr);
+    snapshot->faceOffsets = shareArray(m_faceOffsets, base ? &base->faceOffsets : nullptr);
+    snapshot->faceNormals = shareArray(m_faceNormals, base ? &base->faceNormals : nullptr);
+    return snapshot;
+}
+
+void MeshObject::restoreSnapshot(const MeshSnapshot& snapshot) {
+    clear();
+    m_positions = *snapshot.positions;
+    m_faceIndices = *snapshot.faceIndices;
+    m_faceOffsets = *snapshot.faceOffsets;
+    m_faceNormals = *snapshot.faceNormals;
+    
+    m_vertexSelection.resize(vertexCount());
+    m_faceSelection.resize(faceCount());
     buildTopology();
+    updateNormals();
+    markGeometryDirty();
+}
+
+void MeshObject::setDeferredGeometry(std::shared_ptr<const DeferredMeshGeometry> geometry,
+                                     const Point3D& min, const Point3D& max) {
+    clear();
+    std::lock_guard<std::mutex> lock(m_deferredMutex);
+    m_deferred = std::move(geometry);
+    m_deferredMin = min;
+    m_deferredMax = max;
+    m_deferredPending.store(m_deferred != nullptr, std::memory_order_release);
+    markGeometryDirty();
+}
+
+std::shared_ptr<const DeferredMeshGeometry> MeshObject::getDeferredGeometry() const {
+    std::lock_guard<std::mutex> lock(m_deferredMutex);
+    return m_deferredPending.load(std::memory_order_relaxed) ? m_deferred : nullptr;
+}
+
+void MeshObject::loadDeferredGeometry() const {
+    std::lock_guard<std::mutex> lock(m_deferredMutex);
+    if (!m_deferredPending.load(std::memory_order_relaxed)) return;
+    
+    // Assembled in a scratch mesh, whose accessors cannot come back here
+    MeshObject loaded;
+    if (m_deferred->read(loaded.m_positions, loaded.m_faceIndices, loaded.m_faceOffsets, loaded.m_faceNormals)) {
+        if (loaded.m_faceOffsets.empty()) {
+            loaded.m_faceOffsets.assign(1, 0);
+        }
+        loaded.m_vertexSelection.resize(loaded.vertexCount());
+        loaded.m_faceSelection.resize(loaded.faceCount());
+        loaded.buildTopology();
+        if (loaded.m_faceNormals.size() == loaded.faceCount() * 3) {
+            loaded.updateNormals();
+        } else {
+            loaded.m_faceNormals.assign(loaded.faceCount() * 3, 0.0f);
+            loaded.recalculateNormals();
+        }
+    } else {
+        // An unreadable payload leaves the mesh empty rather than failing on every access
+        loaded.clear();
+    }
+    
+    // Loading is logically const: the mesh reads as if its arrays had been there all along
+    MeshObject& self = const_cast<MeshObject&>(*this);
+    self.m_positions = std::move(loaded.m_positions);
+    self.m_normals = std::move(loaded.m_normals);
+    self.m_faceIndices = std::move(loaded.m_faceIndices);
+    self.m_faceOffsets = std::move(loaded.m_faceOffsets);
+    self.m_faceNormals = std::move(loaded.m_faceNormals);
+    self.m_edgeVertices = std::move(loaded.m_edgeVertices);
+    self.m_vertexSelection = std::move(loaded.m_vertexSelection);
+    self.m_edgeSelection = std::move(loaded.m_edgeSelection);
+    self.m_faceSelection = std::move(loaded.m_faceSelection);
+    self.m_cornerEdges = std::move(loaded.m_cornerEdges);
+    self.m_edgeFaceOffsets = std::move(loaded.m_edgeFaceOffsets);
+    self.m_edgeFaces = std::move(loaded.m_edgeFaces);
+    self.m_vertexFaceOffsets = std::move(loaded.m_vertexFaceOffsets);
+    self.m_vertexFaces = std::move(loaded.m_vertexFaces);
+    self.m_vertexEdgeOffsets = std::move(loaded.m_vertexEdgeOffsets);
+    self.m_vertexEdges = std::move(loaded.m_vertexEdges);
+    self.m_edgeLookup = std::move(loaded.m_edgeLookup);
+    
+    m_deferred.reset();
+    m_deferredPending.store(false, std::memory_order_release);
 }
 
 void MeshObject::selectVertex(int vertexId, bool addToSelection) {
     if (!addToSelection) {
         deselectAll();
     }
-    
-    m_selectedVertices.insert(vertexId);
-    if (vertexId < m_vertices.size()) {
-        m_vertices[vertexId].selected = true;
-    }
+    m_vertexSelection.set(vertexId);
 }
 
 void MeshObject::selectEdge(int edgeId, bool addToSelection) {
     if (!addToSelection) {
         deselectAll();
     }
-    
-    m_selectedEdges.insert(edgeId);
-    if (edgeId < m_edges.size()) {
-        m_edges[edgeId].selected = true;
-    }
+    m_edgeSelection.set(edgeId);
 }
 
 void MeshObject::selectFace(int faceId, bool addToSelection) {
     if (!addToSelection) {
         deselectAll();
     }
-    
-    m_selectedFaces.insert(faceId);
-    if (faceId < m_faces.size()) {
-        m_faces[faceId].selected = true;
-    }
+    m_faceSelection.set(faceId);
 }
 
 void MeshObject::deselectAll() {
-    m_selectedVertices.clear();
-    m_selectedEdges.clear();
-    m_selectedFaces.clear();
-    
-    for (auto& vertex : m_vertices) {
-        vertex.selected = false;
-    }
-    for (auto& edge : m_edges) {
-        edge.selected = false;
-    }
-    for (auto& face : m_faces) {
-        face.selected = false;
-    }
+    m_vertexSelection.clear();
+    m_edgeSelection.clear();
+    m_faceSelection.clear();
 }
 
 bool MeshObject::isValid() const {
+    ensureLoaded();
     // Basic validation - check that all face vertices exist
-    for (const auto& face : m_faces) {
-        for (int vertexId : face.vertices) {
-            if (vertexId < 0 || vertexId >= m_vertices.size()) {
-                return false;
-            }
+    const int count = static_cast<int>(vertexCount());
+    for (int vertexIndex : m_faceIndices) {
+        if (vertexIndex < 0 || vertexIndex >= count) {
+            return false;
         }
     }
     return true;
@@ -154,139 +446,473 @@ bool MeshObject::isValid() const {
 
 void MeshObject::recalculateNormals() {
     // Calculate face normals
-    for (auto& face : m_faces) {
-        if (face.vertices.size() >= 3) {
-            const auto& v0 = m_vertices[face.vertices[0]].position;
-            const auto& v1 = m_vertices[face.vertices[1]].position;
-            const auto& v2 = m_vertices[face.vertices[2]].position;
+    ThreadPool::instance().parallelFor(0, faceCount(), NORMAL_GRAIN, [this](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            AdjacencyRange corners = getFaceVertices(static_cast<int>(f));
+            if (corners.size() < 3) continue;
             
-            Vector3D edge1(v1.x - v0.x, v1.y - v0.y, v1.z - v0.z);
-            Vector3D edge2(v2.x - v0.x, v2.y - v0.y, v2.z - v0.z);
+            QVector3D v0 = getVertexPosition(corners[0]);
+            QVector3D v1 = getVertexPosition(corners[1]);
+            QVector3D v2 = getVertexPosition(corners[2]);
+            QVector3D normal = QVector3D::crossProduct(v1 - v0, v2 - v0).normalized();
             
-            // Cross product
-            face.normal.x = edge1.y * edge2.z - edge1.z * edge2.y;
-            face.normal.y = edge1.z * edge2.x - edge1.x * edge2.z;
-            face.normal.z = edge1.x * edge2.y - edge1.y * edge2.x;
-            
-            // Normalize
-            float length = sqrt(face.normal.x * face.normal.x + 
-                              face.normal.y * face.normal.y + 
-                              face.normal.z * face.normal.z);
-            if (length > 0.0f) {
-                face.normal.x /= length;
-                face.normal.y /= length;
-                face.normal.z /= length;
-            }
+            float* n = &m_faceNormals[f * 3];
+            n[0] = normal.x();
+            n[1] = normal.y();
+            n[2] = normal.z();
         }
-    }
+    });
     
     updateNormals();
+    markGeometryDirty();
 }
 
-void MeshObject::removeDuplicateVertices(float tolerance) {
-    // Placeholder implementation
+namespace {
+
+inline uint64_t cellHash(int64_t x, int64_t y, int64_t z) {
+    uint64_t h = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ static_cast<uint64_t>(y)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ static_cast<uint64_t>(z)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
 }
 
-void MeshObject::removeUnusedVertices() {
-    // Placeholder implementation
+} // namespace
+
+size_t MeshObject::removeDuplicateVertices(float tolerance) {
+    ensureLoaded();
+    const size_t count = vertexCount();
+    if (count < 2) return 0;
+    
+    tolerance = std::max(tolerance, 0.0f);
+    float extent = 0.0f;
+    for (float coordinate : m_positions) {
+        extent = std::max(extent, std::abs(coordinate));
+    }
+    
+    // Cells at least as wide as the tolerance keep every match within the 27 surrounding cells;
+    // the floor relative to the extent keeps cell coordinates bounded for tiny tolerances
+    const double cellSize = std::max({ static_cast<double>(tolerance), extent * 1e-6,
+                                       static_cast<double>(std::numeric_limits<float>::min()) });
+    
+    ThreadPool& pool = ThreadPool::instance();
+    std::vector<int64_t> cells(count * 3);
+    pool.parallelFor(0, count * 3, 8192, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            cells[i] = static_cast<int64_t>(std::floor(m_positions[i] / cellSize));
+        }
+    });
+    
+    // Counting sort into hash buckets; vertices stay in ascending order inside each bucket
+    size_t bucketCount = 1;
+    while (bucketCount < count) bucketCount <<= 1;
+    const uint64_t mask = bucketCount - 1;
+    
+    std::vector<int> bucketOffsets(bucketCount + 1, 0);
+    std::vector<uint32_t> vertexBuckets(count);
+    for (size_t v = 0; v < count; ++v) {
+        const int64_t* cell = &cells[v * 3];
+        vertexBuckets[v] = static_cast<uint32_t>(cellHash(cell[0], cell[1], cell[2]) & mask);
+        bucketOffsets[vertexBuckets[v] + 1]++;
+    }
+    for (size_t b = 0; b < bucketCount; ++b) {
+        bucketOffsets[b + 1] += bucketOffsets[b];
+    }
+    // Cell coordinates and positions are copied into bucket order so neighbour scans stay contiguous
+    std::vector<int> bucketVertices(count);
+    std::vector<int64_t> bucketCells(count * 3);
+    std::vector<float> bucketPositions(count * 3);
+    std::vector<int> cursor(bucketOffsets.begin(), bucketOffsets.end() - 1);
+    for (size_t v = 0; v < count; ++v) {
+        const int slot = cursor[vertexBuckets[v]]++;
+        bucketVertices[slot] = static_cast<int>(v);
+        std::copy_n(&cells[v * 3], 3, &bucketCells[slot * 3]);
+        std::copy_n(&m_positions[v * 3], 3, &bucketPositions[slot * 3]);
+    }
+    
+    // Each vertex points at the lowest-index vertex within tolerance. Buckets only read shared
+    // data and write their own vertices, so they are processed in parallel.
+    const double toleranceSquared = static_cast<double>(tolerance) * tolerance;
+    std::vector<int> remap(count);
+    pool.parallelFor(0, bucketCount, 1024, [&](size_t first, size_t last) {
+        for (size_t b = first; b < last; ++b) {
+            for (int i = bucketOffsets[b]; i < bucketOffsets[b + 1]; ++i) {
+                const int v = bucketVertices[i];
+                const int64_t* cell = &bucketCells[i * 3];
+                const float* p = &bucketPositions[i * 3];
+                int best = v;
+                
+                // Only neighbours that the tolerance sphere actually reaches into are visited
+                int64_t low[3], high[3];
+                for (int k = 0; k < 3; ++k) {
+                    low[k] = static_cast<int64_t>(std::floor((static_cast<double>(p[k]) - tolerance) / cellSize)) - cell[k];
+                    high[k] = static_cast<int64_t>(std::floor((static_cast<double>(p[k]) + tolerance) / cellSize)) - cell[k];
+                }
+                
+                for (int64_t dx = low[0]; dx <= high[0]; ++dx) {
+                    for (int64_t dy = low[1]; dy <= high[1]; ++dy) {
+                        for (int64_t dz = low[2]; dz <= high[2]; ++dz) {
+                            const int64_t x = cell[0] + dx, y = cell[1] + dy, z = cell[2] + dz;
+                            const uint64_t neighbor = cellHash(x, y, z) & mask;
+                            for (int j = bucketOffsets[neighbor]; j < bucketOffsets[neighbor + 1]; ++j) {
+                                const int u = bucketVertices[j];
+                                if (u >= best) break;
+                                
+                                const int64_t* other = &bucketCells[j * 3];
+                                if (other[0] != x || other[1] != y || other[2] != z) continue;
+                                
+                                const float* q = &bucketPositions[j * 3];
+                                double ex = q[0] - p[0], ey = q[1] - p[1], ez = q[2] - p[2];
+                                if (ex * ex + ey * ey + ez * ez <= toleranceSquared) {
+                                    best = u;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+                remap[v] = best;
+            }
+        }
+    });
+    
+    // Targets always have lower indices, so one ascending pass resolves chains to their root
+    for (size_t v = 0; v < count; ++v) {
+        remap[v] = remap[remap[v]];
+    }
+    return remapVertices(remap);
+}
+
+size_t MeshObject::remapVertices(const std::vector<int>& remap) {
+    ensureLoaded();
+    const size_t count = vertexCount();
+    if (remap.size() != count) return 0;
+    
+    size_t merged = 0;
+    for (size_t v = 0; v < count; ++v) {
+        if (remap[v] != static_cast<int>(v)) {
+            ++merged;
+            if (m_vertexSelection.test(v)) m_vertexSelection.set(remap[v]);
+        }
+    }
+    if (merged == 0) return 0;
+    
+    // Remap corners in place, dropping repeated corners and faces that collapse below a triangle
+    const size_t oldFaceCount = faceCount();
+    SelectionBits faceSelection;
+    faceSelection.resize(oldFaceCount);
+    
+    size_t write = 0;
+    size_t faceWrite = 0;
+    int begin = m_faceOffsets[0];
+    for (size_t f = 0; f < oldFaceCount; ++f) {
+        const int end = m_faceOffsets[f + 1];
+        const size_t start = write;
+        for (int c = begin; c < end; ++c) {
+            int vertex = m_faceIndices[c];
+            if (vertex >= 0 && vertex < static_cast<int>(count)) {
+                vertex = remap[vertex];
+            }
+            if (write > start && m_faceIndices[write - 1] == vertex) continue;
+            m_faceIndices[write++] = vertex;
+        }
+        while (write - start > 1 && m_faceIndices[write - 1] == m_faceIndices[start]) {
+            --write;
+        }
+        begin = end;
+        
+        if (write - start < 3) {
+            write = start;
+            continue;
+        }
+        if (m_faceSelection.test(f)) faceSelection.set(faceWrite);
+        m_faceOffsets[++faceWrite] = static_cast<int>(write);
+    }
+    
+    m_faceIndices.resize(write);
+    m_faceOffsets.resize(faceWrite + 1);
+    m_faceNormals.assign(faceWrite * 3, 0.0f);
+    faceSelection.resize(faceWrite);
+    m_faceSelection = faceSelection;
+    
+    return removeUnusedVertices();
+}
+
+size_t MeshObject::removeUnusedVertices() {
+    ensureLoaded();
+    const int count = static_cast<int>(vertexCount());
+    std::vector<int> newIndex(count, -1);
+    for (int vertex : m_faceIndices) {
+        if (vertex >= 0 && vertex < count) newIndex[vertex] = 0;
+    }
+    
+    int kept = 0;
+    for (int v = 0; v < count; ++v) {
+        if (newIndex[v] == 0) newIndex[v] = kept++;
+    }
+    if (kept == count) return 0;
+    
+    // Kept vertices only move towards the front, so compaction works in place
+    SelectionBits vertexSelection;
+    vertexSelection.resize(kept);
+    for (int v = 0; v < count; ++v) {
+        const int target = newIndex[v];
+        if (target < 0) continue;
+        std::copy_n(&m_positions[v * 3], 3, &m_positions[target * 3]);
+        if (m_vertexSelection.test(v)) vertexSelection.set(target);
+    }
+    m_positions.resize(kept * 3);
+    m_normals.assign(m_positions.size(), 0.0f);
+    m_vertexSelection = vertexSelection;
+    
+    for (int& vertex : m_faceIndices) {
+        // Out-of-range corners stay invalid rather than aliasing a compacted vertex
+        vertex = vertex >= 0 && vertex < count ? newIndex[vertex] : -1;
+    }
+    
+    buildTopology();
+    recalculateNormals();
+    return static_cast<size_t>(count - kept);
 }
 
 Point3D MeshObject::getBoundingBoxMin() const {
-    if (m_vertices.empty()) {
+    if (!isGeometryLoaded()) {
+        return m_deferredMin;
+    }
+    if (m_positions.empty()) {
         return Point3D(0, 0, 0);
     }
     
-    Point3D min = m_vertices[0].position;
-    for (const auto& vertex : m_vertices) {
-        min.x = std::min(min.x, vertex.position.x);
-        min.y = std::min(min.y, vertex.position.y);
-        min.z = std::min(min.z, vertex.position.z);
+    float min[3] = { m_positions[0], m_positions[1], m_positions[2] };
+    for (size_t i = 0; i < m_positions.size(); i += 3) {
+        min[0] = std::min(min[0], m_positions[i]);
+        min[1] = std::min(min[1], m_positions[i + 1]);
+        min[2] = std::min(min[2], m_positions[i + 2]);
     }
-    return min;
+    return Point3D(min[0], min[1], min[2]);
 }
 
 Point3D MeshObject::getBoundingBoxMax() const {
-    if (m_vertices.empty()) {
+    if (!isGeometryLoaded()) {
+        return m_deferredMax;
+    }
+    if (m_positions.empty()) {
         return Point3D(0, 0, 0);
     }
     
-    Point3D max = m_vertices[0].position;
-    for (const auto& vertex : m_vertices) {
-        max.x = std::max(max.x, vertex.position.x);
-        max.y = std::max(max.y, vertex.position.y);
-        max.z = std::max(max.z, vertex.position.z);
+    float max[3] = { m_positions[0], m_positions[1], m_positions[2] };
+    for (size_t i = 0; i < m_positions.size(); i += 3) {
+        max[0] = std::max(max[0], m_positions[i]);
+        max[1] = std::max(max[1], m_positions[i + 1]);
+        max[2] = std::max(max[2], m_positions[i + 2]);
     }
-    return max;
+    return Point3D(max[0], max[1], max[2]);
 }
 
 void MeshObject::buildTopology() {
-    m_edges.clear();
-    
-    // Build edges from faces
-    int edgeId = 0;
-    for (const auto& face : m_faces) {
-        for (size_t i = 0; i < face.vertices.size(); ++i) {
-            int v1 = face.vertices[i];
-            int v2 = face.vertices[(i + 1) % face.vertices.size()];
+    ensureLoaded();
+    m_edgeVertices.clear();
+    m_edgeLookup.clear();
+    
+    const int vertexCountValue = static_cast<int>(vertexCount());
+    const int faceCountValue = static_cast<int>(faceCount());
+    auto validFace = [&](int faceIndex) {
+        for (int vertex : getFaceVertices(faceIndex)) {
+            if (vertex < 0 || vertex >= vertexCountValue) return false;
+        }
+        return true;
+    };
+    
+    std::vector<char> faceValid(faceCountValue);
+    for (int f = 0; f < faceCountValue; ++f) {
+        faceValid[f] = validFace(f);
+    }
+    
+    // Vertex-to-face adjacency: count, prefix sum, fill
+    m_vertexFaceOffsets.assign(vertexCountValue + 1, 0);
+    for (int f = 0; f < faceCountValue; ++f) {
+        if (!faceValid[f]) continue;
+        for (int vertex : getFaceVertices(f)) {
+            m_vertexFaceOffsets[vertex + 1]++;
+        }
+    }
+    for (int i = 0; i < vertexCountValue; ++i) {
+        m_vertexFaceOffsets[i + 1] += m_vertexFaceOffsets[i];
+    }
+    
+    m_vertexFaces.resize(m_vertexFaceOffsets[vertexCountValue]);
+    std::vector<int> cursor(m_vertexFaceOffsets.begin(), m_vertexFaceOffsets.end() - 1);
+    for (int f = 0; f < faceCountValue; ++f) {
+        if (!faceValid[f]) continue;
+        for (int vertex : getFaceVertices(f)) {
+            m_vertexFaces[cursor[vertex]++] = f;
+        }
+    }
+    
+    // Half-edges are bucketed by their lower vertex, so matching half-edges always meet in one short
+    // bucket. Each corner records the edge it starts so edge-to-face adjacency can be filled afterwards.
+    std::vector<int> lowOffsets(vertexCountValue + 1, 0);
+    for (int f = 0; f < faceCountValue; ++f) {
+        if (!faceValid[f]) continue;
+        
+        int begin = m_faceOffsets[f];
+        int size = m_faceOffsets[f + 1] - begin;
+        for (int i = 0; i < size; ++i) {
+            int v1 = m_faceIndices[begin + i];
+            int v2 = m_faceIndices[begin + (i + 1) % size];
+            if (v1 != v2) lowOffsets[std::min(v1, v2) + 1]++;
+        }
+    }
+    for (int i = 0; i < vertexCountValue; ++i) {
+        lowOffsets[i + 1] += lowOffsets[i];
+    }
+    
+    // Higher vertex first, then corner
+    std::vector<std::pair<int, int>> lowHalfEdges(lowOffsets[vertexCountValue]);
+    cursor.assign(lowOffsets.begin(), lowOffsets.end() - 1);
+    for (int f = 0; f < faceCountValue; ++f) {
+        if (!faceValid[f]) continue;
+        
+        int begin = m_faceOffsets[f];
+        int size = m_faceOffsets[f + 1] - begin;
+        for (int i = 0; i < size; ++i) {
+            int v1 = m_faceIndices[begin + i];
+            int v2 = m_faceIndices[begin + (i + 1) % size];
+            if (v1 == v2) continue;
             
-            // Check if edge already exists
-            bool exists = false;
-            for (auto& edge : m_edges) {
-                if ((edge.vertex1 == v1 && edge.vertex2 == v2) ||
-                    (edge.vertex1 == v2 && edge.vertex2 == v1)) {
-                    edge.adjacentFaces.push_back(face.id);
-                    exists = true;
-                    break;
-                }
+            lowHalfEdges[cursor[std::min(v1, v2)]++] = { std::max(v1, v2), begin + i };
+        }
+    }
+    
+    // Sorting a bucket puts the half-edges of one edge next to each other, so deduplication is a
+    // single pass however high the valence
+    m_cornerEdges.assign(m_faceIndices.size(), -1);
+    m_edgeVertices.reserve(lowHalfEdges.size() + 2);
+    m_edgeLookup.reserve(lowHalfEdges.size() / 2 + 1);
+    for (int v = 0; v < vertexCountValue; ++v) {
+        auto bucketBegin = lowHalfEdges.begin() + lowOffsets[v];
+        auto bucketEnd = lowHalfEdges.begin() + lowOffsets[v + 1];
+        std::sort(bucketBegin, bucketEnd);
+        
+        int edge = -1;
+        int previous = -1;
+        for (auto it = bucketBegin; it != bucketEnd; ++it) {
+            const int other = it->first;
+            const int corner = it->second;
+            if (other != previous) {
+                edge = static_cast<int>(edgeCount());
+                // Edge direction follows the first corner that uses it
+                const bool forward = m_faceIndices[corner] == v;
+                m_edgeVertices.push_back(forward ? v : other);
+                m_edgeVertices.push_back(forward ? other : v);
+                m_edgeLookup.emplace(edgeKey(v, other), edge);
+                previous = other;
             }
-            
-            if (!exists) {
-                Edge edge(v1, v2, edgeId++);
-                edge.adjacentFaces.push_back(face.id);
-                m_edges.push_back(edge);
+            m_cornerEdges[corner] = edge;
+        }
+    }
+    
+    const int edgeCountValue = static_cast<int>(edgeCount());
+    m_edgeFaceOffsets.assign(edgeCountValue + 1, 0);
+    for (int edge : m_cornerEdges) {
+        if (edge >= 0) m_edgeFaceOffsets[edge + 1]++;
+    }
+    for (int i = 0; i < edgeCountValue; ++i) {
+        m_edgeFaceOffsets[i + 1] += m_edgeFaceOffsets[i];
+    }
+    
+    m_edgeFaces.resize(m_edgeFaceOffsets[edgeCountValue]);
+    cursor.assign(m_edgeFaceOffsets.begin(), m_edgeFaceOffsets.end() - 1);
+    for (int f = 0; f < faceCountValue; ++f) {
+        for (int c = m_faceOffsets[f]; c < m_faceOffsets[f + 1]; ++c) {
+            if (m_cornerEdges[c] >= 0) {
+                m_edgeFaces[cursor[m_cornerEdges[c]]++] = f;
             }
         }
     }
+    
+    // Vertex-to-edge adjacency
+    m_vertexEdgeOffsets.assign(vertexCountValue + 1, 0);
+    for (int vertex : m_edgeVertices) {
+        m_vertexEdgeOffsets[vertex + 1]++;
+    }
+    for (int i = 0; i < vertexCountValue; ++i) {
+        m_vertexEdgeOffsets[i + 1] += m_vertexEdgeOffsets[i];
+    }
+    
+    m_vertexEdges.resize(m_vertexEdgeOffsets[vertexCountValue]);
+    cursor.assign(m_vertexEdgeOffsets.begin(), m_vertexEdgeOffsets.end() - 1);
+    for (int e = 0; e < edgeCountValue; ++e) {
+        m_vertexEdges[cursor[m_edgeVertices[e * 2]]++] = e;
+        m_vertexEdges[cursor[m_edgeVertices[e * 2 + 1]]++] = e;
+    }
+    
+    // Edge indices change with the topology, so an old edge selection is meaningless
+    m_edgeSelection.resize(0);
+    m_edgeSelection.resize(edgeCountValue);
+}
+
+uint64_t MeshObject::edgeKey(int vertex1, int vertex2) {
+    // Order-independent, so both half-edges of an edge map to the same key
+    uint32_t low = static_cast<uint32_t>(std::min(vertex1, vertex2));
+    uint32_t high = static_cast<uint32_t>(std::max(vertex1, vertex2));
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+int MeshObject::findEdge(int vertex1, int vertex2) const {
+    auto it = m_edgeLookup.find(edgeKey(vertex1, vertex2));
+    return it != m_edgeLookup.end() ? it->second : -1;
+}
+
+AdjacencyRange MeshObject::getVertexFaces(int vertexIndex) const {
+    if (vertexIndex < 0 || vertexIndex + 1 >= static_cast<int>(m_vertexFaceOffsets.size())) {
+        return AdjacencyRange();
+    }
+    const int* data = m_vertexFaces.data();
+    return AdjacencyRange{data + m_vertexFaceOffsets[vertexIndex], data + m_vertexFaceOffsets[vertexIndex + 1]};
+}
+
+AdjacencyRange MeshObject::getVertexEdges(int vertexIndex) const {
+    if (vertexIndex < 0 || vertexIndex + 1 >= static_cast<int>(m_vertexEdgeOffsets.size())) {
+        return AdjacencyRange();
+    }
+    const int* data = m_vertexEdges.data();
+    return AdjacencyRange{data + m_vertexEdgeOffsets[vertexIndex], data + m_vertexEdgeOffsets[vertexIndex + 1]};
 }
 
 void MeshObject::updateNormals() {
-    // Calculate vertex normals from adjacent face normals
-    for (auto& vertex : m_vertices) {
-        vertex.normal = Vector3D(0, 0, 0);
-        int faceCount = 0;
-        
-        for (const auto& face : m_faces) {
-            for (int vertexId : face.vertices) {
-                if (vertexId == vertex.id) {
-                    vertex.normal.x += face.normal.x;
-                    vertex.normal.y += face.normal.y;
-                    vertex.normal.z += face.normal.z;
-                    faceCount++;
-                    break;
-                }
+    // Calculate vertex normals from adjacent face normals; each vertex only writes its own
+    m_normals.assign(m_positions.size(), 0.0f);
+    ThreadPool::instance().parallelFor(0, vertexCount(), NORMAL_GRAIN, [this](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            const int vertexIndex = static_cast<int>(v);
+            float sum[3] = { 0.0f, 0.0f, 0.0f };
+            
+            int lastFace = -1;
+            for (int faceIndex : getVertexFaces(vertexIndex)) {
+                // A vertex repeated within one face is only counted once
+                if (faceIndex == lastFace) continue;
+                lastFace = faceIndex;
+                
+                const float* n = &m_faceNormals[faceIndex * 3];
+                sum[0] += n[0];
+                sum[1] += n[1];
+                sum[2] += n[2];
             }
-        }
-        
-        if (faceCount > 0) {
-            vertex.normal.x /= faceCount;
-            vertex.normal.y /= faceCount;
-            vertex.normal.z /= faceCount;
             
-            // Normalize
-            float length = sqrt(vertex.normal.x * vertex.normal.x + 
-                              vertex.normal.y * vertex.normal.y + 
-                              vertex.normal.z * vertex.normal.z);
+            // Averaging is unnecessary before normalizing
+            float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
             if (length > 0.0f) {
-                vertex.normal.x /= length;
-                vertex.normal.y /= length;
-                vertex.normal.z /= length;
+                float* normal = &m_normals[vertexIndex * 3];
+                normal[0] = sum[0] / length;
+                normal[1] = sum[1] / length;
+                normal[2] = sum[2] / length;
             }
         }
-    }
+    });
 }
 
 // MeshManager implementation
-MeshManager::MeshManager() : m_selectionMode(SelectionMode::VERTEX), m_activeTool(MeshTool::SELECT) {
+MeshManager::MeshManager() : m_selectionMode(SelectionMode::VERTEX), m_activeTool(MeshTool::SELECT), m_undoHistory(nullptr) {
 }
 
 MeshManager::~MeshManager() {
@@ -328,36 +954,393 @@ std::shared_ptr<MeshObject> MeshManager::createPrimitiveMesh(ObjectType type, co
 std::shared_ptr<MeshObject> MeshManager::convertToMesh(CADObjectPtr cadObject) {
     if (!cadObject) return nullptr;
     
+    RenderMesh renderMesh;
+    if (!cadObject->buildRenderMesh(renderMesh)) return nullptr;
+    
     auto mesh = std::make_shared<MeshObject>(cadObject->getName() + "_mesh");
-    // Conversion logic would go here
+    
+    // Render vertices are split at hard edges, so corners stay unshared until welded
+    const size_t vertexCount = renderMesh.vertexCount();
+    std::vector<float> positions(vertexCount * 3);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const float* vertex = &renderMesh.vertices[i * RenderMesh::FLOATS_PER_VERTEX];
+        std::copy(vertex, vertex + 3, &positions[i * 3]);
+    }
+    
+    std::vector<int> faceIndices(renderMesh.indices.begin(), renderMesh.indices.end());
+    std::vector<int> faceOffsets(faceIndices.size() / 3 + 1);
+    for (size_t i = 0; i < faceOffsets.size(); ++i) {
+        faceOffsets[i] = static_cast<int>(i * 3);
+    }
+    
+    mesh->setGeometry(std::move(positions), std::move(faceIndices), std::move(faceOffsets));
     return mesh;
 }
 
-bool MeshManager::extrudeFaces(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& faceIds, 
-                             const Vector3D& direction, float distance) {
-    // Placeholder implementation
-    return false;
-}
+namespace {
 
-bool MeshManager::insetFaces(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& faceIds, 
-                           float insetAmount) {
-    // Placeholder implementation
-    return false;
+constexpr size_t EDIT_GRAIN = 4096;
+// Taubin pass-band frequency; sets the inflating step that follows each shrinking one
+constexpr float TAUBIN_PASSBAND = 0.1f;
+
+inline void addPoint(float* sum, const float* p, float weight = 1.0f) {
+    sum[0] += p[0] * weight;
+    sum[1] += p[1] * weight;
+    sum[2] += p[2] * weight;
 }
 
-bool MeshManager::subdivideEdges(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds) {
-    // Placeholder implementation
-    return false;
+// Turns per-element counts, with one spare entry at the end, into CSR offsets and returns the
+// total. Chunks are scanned in parallel and then shifted by the totals of the chunks before them.
+int exclusiveScan(std::vector<int>& values) {
+    ThreadPool& pool = ThreadPool::instance();
+    const size_t count = values.size();
+    const size_t chunkCount = std::max<size_t>(1, std::min(pool.threadCount() * 4, (count + EDIT_GRAIN - 1) / EDIT_GRAIN));
+    const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    
+    std::vector<int> chunkStarts(chunkCount + 1, 0);
+    pool.parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            const size_t end = std::min(count, (chunk + 1) * chunkSize);
+            int sum = 0;
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                const int value = values[i];
+                values[i] = sum;
+                sum += value;
+            }
+            chunkStarts[chunk + 1] = sum;
+        }
+    });
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        chunkStarts[chunk + 1] += chunkStarts[chunk];
+    }
+    pool.parallelFor(1, chunkCount, 1, [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            const size_t end = std::min(count, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                values[i] += chunkStarts[chunk];
+            }
+        }
+    });
+    return count > 0 ? values.back() : 0;
 }
 
-bool MeshManager::subdivideSelected(std::shared_ptr<MeshObject> mesh) {
-    // Placeholder implementation
-    return false;
+std::vector<char> faceMask(const MeshObject& mesh, const std::unordered_set<int>& faceIds, bool& any) {
+    std::vector<char> mask(mesh.faceCount(), 0);
+    any = false;
+    for (int face : faceIds) {
+        if (face >= 0 && face < static_cast<int>(mask.size())) {
+            mask[face] = 1;
+            any = true;
+        }
+    }
+    return mask;
 }
 
-bool MeshManager::mergeVertices(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& vertexIds) {
-    // Placeholder implementation
-    return false;
+// Direction scaled to the distance; false when the direction has no length
+bool scaledOffset(const Vector3D& direction, float distance, float* offset) {
+    const double length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+    if (length <= 0.0) return false;
+    offset[0] = static_cast<float>(direction.x / length * distance);
+    offset[1] = static_cast<float>(direction.y / length * distance);
+    offset[2] = static_cast<float>(direction.z / length * distance);
+    return true;
+}
+
+// Newell's method: area-weighted and fine for non-planar faces, and does not rely on stored normals
+void newellNormal(const std::vector<float>& positions, const int* corners, int size, float* out) {
+    out[0] = out[1] = out[2] = 0.0f;
+    for (int i = 0; i < size; ++i) {
+        const float* p = &positions[corners[i] * 3];
+        const float* q = &positions[corners[(i + 1) % size] * 3];
+        out[0] += (p[1] - q[1]) * (p[2] + q[2]);
+        out[1] += (p[2] - q[2]) * (p[0] + q[0]);
+        out[2] += (p[0] - q[0]) * (p[1] + q[1]);
+    }
+}
+
+// Corner of face where it runs along edge
+int cornerOnEdge(const MeshObject& mesh, int face, int edge) {
+    const auto& cornerEdges = mesh.getCornerEdgeData();
+    const auto& faceOffsets = mesh.getFaceOffsetData();
+    for (int c = faceOffsets[face]; c < faceOffsets[face + 1]; ++c) {
+        if (cornerEdges[c] == edge) return c;
+    }
+    return -1;
+}
+
+} // namespace
+
+bool MeshManager::extrudeFaces(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& faceIds, 
+                             const Vector3D& direction, float distance) {
+    if (!mesh || faceIds.empty() || !mesh->isValid()) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Extrude faces");
+    
+    bool any = false;
+    const std::vector<char> selected = faceMask(*mesh, faceIds, any);
+    if (!any) return false;
+    
+    const auto& positions = mesh->getPositionData();
+    const auto& faceIndices = mesh->getFaceIndexData();
+    const auto& faceOffsets = mesh->getFaceOffsetData();
+    const size_t vertexCount = mesh->vertexCount();
+    const size_t edgeCount = mesh->edgeCount();
+    const size_t faceCount = mesh->faceCount();
+    const size_t cornerCount = faceIndices.size();
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Walls rise along the region's rim: edges with exactly one selected face
+    std::vector<int> wallOffsets(edgeCount + 1, 0);
+    pool.parallelFor(0, edgeCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t e = first; e < last; ++e) {
+            int count = 0;
+            for (int face : mesh->getEdgeFaces(static_cast<int>(e))) {
+                count += selected[face];
+            }
+            wallOffsets[e] = count == 1;
+        }
+    });
+    const int wallCount = exclusiveScan(wallOffsets);
+    
+    // Vertices of the region move. Those still used by a wall or an unselected face are copied;
+    // the rest move in place.
+    std::vector<char> moved(vertexCount, 0);
+    std::vector<int> copyOffsets(vertexCount + 1, 0);
+    pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            bool inRegion = false;
+            bool shared = false;
+            for (int face : mesh->getVertexFaces(static_cast<int>(v))) {
+                (selected[face] ? inRegion : shared) = true;
+            }
+            for (int edge : mesh->getVertexEdges(static_cast<int>(v))) {
+                shared = shared || wallOffsets[edge + 1] != wallOffsets[edge];
+            }
+            moved[v] = inRegion;
+            copyOffsets[v] = inRegion && shared;
+        }
+    });
+    const int copyCount = exclusiveScan(copyOffsets);
+    auto movedVertex = [&](int vertex) {
+        return copyOffsets[vertex + 1] != copyOffsets[vertex] ? static_cast<int>(vertexCount) + copyOffsets[vertex] : vertex;
+    };
+    
+    // Without a direction each vertex follows the mean normal of its selected faces
+    float offset[3] = { 0.0f, 0.0f, 0.0f };
+    const bool alongNormals = !scaledOffset(direction, distance, offset);
+    std::vector<float> regionNormals;
+    if (alongNormals) {
+        regionNormals.assign(faceCount * 3, 0.0f);
+        pool.parallelFor(0, faceCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+            for (size_t f = first; f < last; ++f) {
+                if (!selected[f]) continue;
+                newellNormal(positions, &faceIndices[faceOffsets[f]], faceOffsets[f + 1] - faceOffsets[f], &regionNormals[f * 3]);
+                const float* n = &regionNormals[f * 3];
+                const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                if (length > 0.0f) {
+                    for (int k = 0; k < 3; ++k) regionNormals[f * 3 + k] /= length;
+                }
+            }
+        });
+    }
+    
+    std::vector<float> newPositions((vertexCount + copyCount) * 3);
+    pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            const float* p = &positions[v * 3];
+            std::copy_n(p, 3, &newPositions[v * 3]);
+            if (!moved[v]) continue;
+            
+            float shift[3] = { offset[0], offset[1], offset[2] };
+            if (alongNormals) {
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                int lastFace = -1;
+                for (int face : mesh->getVertexFaces(static_cast<int>(v))) {
+                    if (face == lastFace || !selected[face]) continue;
+                    lastFace = face;
+                    addPoint(sum, &regionNormals[face * 3]);
+                }
+                const float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                const float scale = length > 0.0f ? distance / length : 0.0f;
+                for (int k = 0; k < 3; ++k) shift[k] = sum[k] * scale;
+            }
+            
+            float* out = &newPositions[movedVertex(static_cast<int>(v)) * 3];
+            for (int k = 0; k < 3; ++k) out[k] = p[k] + shift[k];
+        }
+    });
+    
+    // Existing faces keep their slots, selected ones now on the moved vertices; walls follow
+    std::vector<int> newIndices(cornerCount + static_cast<size_t>(wallCount) * 4);
+    std::vector<int> newOffsets(faceCount + wallCount + 1);
+    pool.parallelFor(0, faceCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            newOffsets[f] = faceOffsets[f];
+            for (int c = faceOffsets[f]; c < faceOffsets[f + 1]; ++c) {
+                newIndices[c] = selected[f] ? movedVertex(faceIndices[c]) : faceIndices[c];
+            }
+        }
+    });
+    
+    // Each wall runs against its selected face along the rim edge: a, b, moved b, moved a
+    pool.parallelFor(0, edgeCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t e = first; e < last; ++e) {
+            const int wall = wallOffsets[e];
+            if (wallOffsets[e + 1] == wall) continue;
+            
+            int face = -1;
+            for (int candidate : mesh->getEdgeFaces(static_cast<int>(e))) {
+                if (selected[candidate]) {
+                    face = candidate;
+                    break;
+                }
+            }
+            const int corner = cornerOnEdge(*mesh, face, static_cast<int>(e));
+            const int next = corner + 1 < faceOffsets[face + 1] ? corner + 1 : faceOffsets[face];
+            const int a = faceIndices[corner];
+            const int b = faceIndices[next];
+            
+            const size_t base = cornerCount + static_cast<size_t>(wall) * 4;
+            newIndices[base] = a;
+            newIndices[base + 1] = b;
+            newIndices[base + 2] = movedVertex(b);
+            newIndices[base + 3] = movedVertex(a);
+            newOffsets[faceCount + wall] = static_cast<int>(base);
+        }
+    });
+    newOffsets.back() = static_cast<int>(newIndices.size());
+    
+    mesh->setGeometry(std::move(newPositions), std::move(newIndices), std::move(newOffsets));
+    // The extruded faces keep their indices and stay selected
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (selected[f]) mesh->selectFace(static_cast<int>(f), true);
+    }
+    return true;
+}
+
+bool MeshManager::insetFaces(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& faceIds, 
+                           float insetAmount) {
+    if (!mesh || faceIds.empty() || insetAmount <= 0.0f || !mesh->isValid()) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Inset faces");
+    
+    bool any = false;
+    const std::vector<char> selected = faceMask(*mesh, faceIds, any);
+    if (!any) return false;
+    
+    const auto& positions = mesh->getPositionData();
+    const auto& faceIndices = mesh->getFaceIndexData();
+    const auto& faceOffsets = mesh->getFaceOffsetData();
+    const size_t vertexCount = mesh->vertexCount();
+    const size_t faceCount = mesh->faceCount();
+    const size_t cornerCount = faceIndices.size();
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Every selected face gets a ring of its own: one inner vertex and one quad per corner
+    std::vector<int> ringOffsets(faceCount + 1, 0);
+    pool.parallelFor(0, faceCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            ringOffsets[f] = selected[f] ? faceOffsets[f + 1] - faceOffsets[f] : 0;
+        }
+    });
+    const int ringCount = exclusiveScan(ringOffsets);
+    
+    std::vector<float> newPositions((vertexCount + ringCount) * 3);
+    std::copy(positions.begin(), positions.end(), newPositions.begin());
+    std::vector<int> newIndices(cornerCount + static_cast<size_t>(ringCount) * 4);
+    std::vector<int> newOffsets(faceCount + ringCount + 1);
+    
+    pool.parallelFor(0, faceCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            const int begin = faceOffsets[f];
+            const int size = faceOffsets[f + 1] - begin;
+            newOffsets[f] = begin;
+            if (!selected[f]) {
+                std::copy_n(&faceIndices[begin], size, &newIndices[begin]);
+                continue;
+            }
+            
+            float centroid[3] = { 0.0f, 0.0f, 0.0f };
+            for (int c = begin; c < begin + size; ++c) {
+                addPoint(centroid, &positions[faceIndices[c] * 3]);
+            }
+            for (int k = 0; k < 3; ++k) centroid[k] /= size;
+            
+            // Corners move towards the centroid by the inset amount but never past it
+            const int ring = ringOffsets[f];
+            for (int i = 0; i < size; ++i) {
+                const float* p = &positions[faceIndices[begin + i] * 3];
+                const float toCentroid[3] = { centroid[0] - p[0], centroid[1] - p[1], centroid[2] - p[2] };
+                const float length = std::sqrt(toCentroid[0] * toCentroid[0] + toCentroid[1] * toCentroid[1] +
+                                               toCentroid[2] * toCentroid[2]);
+                const float t = length > 0.0f ? std::min(insetAmount / length, 1.0f) : 0.0f;
+                float* inner = &newPositions[(vertexCount + ring + i) * 3];
+                for (int k = 0; k < 3; ++k) inner[k] = p[k] + toCentroid[k] * t;
+            }
+            
+            // The face shrinks onto the ring; each quad runs a, b, inner b, inner a
+            for (int i = 0; i < size; ++i) {
+                const int j = (i + 1) % size;
+                const size_t base = cornerCount + static_cast<size_t>(ring + i) * 4;
+                newIndices[base] = faceIndices[begin + i];
+                newIndices[base + 1] = faceIndices[begin + j];
+                newIndices[base + 2] = static_cast<int>(vertexCount) + ring + j;
+                newIndices[base + 3] = static_cast<int>(vertexCount) + ring + i;
+                newOffsets[faceCount + ring + i] = static_cast<int>(base);
+                newIndices[begin + i] = static_cast<int>(vertexCount) + ring + i;
+            }
+        }
+    });
+    newOffsets.back() = static_cast<int>(newIndices.size());
+    
+    mesh->setGeometry(std::move(newPositions), std::move(newIndices), std::move(newOffsets));
+    // The inner faces keep the original indices and stay selected
+    for (size_t f = 0; f < faceCount; ++f) {
+        if (selected[f]) mesh->selectFace(static_cast<int>(f), true);
+    }
+    return true;
+}
+
+bool MeshManager::subdivideEdges(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds) {
+    // Placeholder implementation
+    return false;
+}
+
+bool MeshManager::subdivideSelected(std::shared_ptr<MeshObject> mesh) {
+    // Placeholder implementation
+    return false;
+}
+
+bool MeshManager::mergeVertices(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& vertexIds) {
+    if (!mesh) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Merge vertices");
+    
+    const int vertexCount = static_cast<int>(mesh->vertexCount());
+    std::vector<int> vertices;
+    vertices.reserve(vertexIds.size());
+    for (int vertex : vertexIds) {
+        if (vertex >= 0 && vertex < vertexCount) vertices.push_back(vertex);
+    }
+    if (vertices.size() < 2) return false;
+    std::sort(vertices.begin(), vertices.end());
+    
+    // All of them collapse onto the lowest index, placed at their centroid
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    float* positions = mesh->getPositionBuffer();
+    for (int vertex : vertices) {
+        for (int k = 0; k < 3; ++k) sum[k] += positions[vertex * 3 + k];
+    }
+    const int target = vertices.front();
+    for (int k = 0; k < 3; ++k) {
+        positions[target * 3 + k] = static_cast<float>(sum[k] / vertices.size());
+    }
+    
+    std::vector<int> remap(vertexCount);
+    for (int v = 0; v < vertexCount; ++v) remap[v] = v;
+    for (int vertex : vertices) remap[vertex] = target;
+    // A remap that merged nothing leaves the moved target with its old normals and revision
+    if (mesh->remapVertices(remap) == 0) {
+        mesh->recalculateNormals();
+    }
+    return true;
 }
 
 bool MeshManager::dissolveVertices(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& vertexIds) {
@@ -367,8 +1350,92 @@ bool MeshManager::dissolveVertices(std::shared_ptr<MeshObject> mesh, const std::
 
 bool MeshManager::extrudeEdges(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds, 
                              const Vector3D& direction, float distance) {
-    // Placeholder implementation
-    return false;
+    float offset[3];
+    if (!mesh || edgeIds.empty() || !scaledOffset(direction, distance, offset) || !mesh->isValid()) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Extrude edges");
+    
+    const size_t vertexCount = mesh->vertexCount();
+    const size_t edgeCount = mesh->edgeCount();
+    std::vector<char> selected(edgeCount, 0);
+    std::vector<int> edges;
+    edges.reserve(edgeIds.size());
+    for (int edge : edgeIds) {
+        if (edge >= 0 && edge < static_cast<int>(edgeCount)) {
+            selected[edge] = 1;
+            edges.push_back(edge);
+        }
+    }
+    if (edges.empty()) return false;
+    std::sort(edges.begin(), edges.end());
+    
+    const auto& positions = mesh->getPositionData();
+    const auto& faceIndices = mesh->getFaceIndexData();
+    const auto& faceOffsets = mesh->getFaceOffsetData();
+    const auto& edgeVertices = mesh->getEdgeVertexData();
+    const size_t faceCount = mesh->faceCount();
+    const size_t cornerCount = faceIndices.size();
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Endpoints are copied once each, however many selected edges share them
+    std::vector<int> copyOffsets(vertexCount + 1, 0);
+    pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            for (int edge : mesh->getVertexEdges(static_cast<int>(v))) {
+                if (selected[edge]) {
+                    copyOffsets[v] = 1;
+                    break;
+                }
+            }
+        }
+    });
+    const int copyCount = exclusiveScan(copyOffsets);
+    
+    std::vector<float> newPositions((vertexCount + copyCount) * 3);
+    std::copy(positions.begin(), positions.end(), newPositions.begin());
+    pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            if (copyOffsets[v + 1] == copyOffsets[v]) continue;
+            float* out = &newPositions[(vertexCount + copyOffsets[v]) * 3];
+            for (int k = 0; k < 3; ++k) out[k] = positions[v * 3 + k] + offset[k];
+        }
+    });
+    
+    std::vector<int> newIndices(cornerCount + edges.size() * 4);
+    std::vector<int> newOffsets(faceCount + edges.size() + 1);
+    std::copy(faceIndices.begin(), faceIndices.end(), newIndices.begin());
+    std::copy(faceOffsets.begin(), faceOffsets.end() - 1, newOffsets.begin());
+    
+    pool.parallelFor(0, edges.size(), EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const int edge = edges[i];
+            int a = edgeVertices[edge * 2];
+            int b = edgeVertices[edge * 2 + 1];
+            
+            // On a boundary the quad runs against the edge's one face so the surface continues
+            AdjacencyRange faces = mesh->getEdgeFaces(edge);
+            if (faces.size() == 1) {
+                const int corner = cornerOnEdge(*mesh, faces[0], edge);
+                if (corner >= 0 && faceIndices[corner] == a) std::swap(a, b);
+            }
+            
+            const size_t base = cornerCount + i * 4;
+            newIndices[base] = a;
+            newIndices[base + 1] = b;
+            newIndices[base + 2] = static_cast<int>(vertexCount) + copyOffsets[b];
+            newIndices[base + 3] = static_cast<int>(vertexCount) + copyOffsets[a];
+            newOffsets[faceCount + i] = static_cast<int>(base);
+        }
+    });
+    newOffsets.back() = static_cast<int>(newIndices.size());
+    
+    mesh->setGeometry(std::move(newPositions), std::move(newIndices), std::move(newOffsets));
+    // Select the far edges, ready to be extruded again
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const int* quad = &mesh->getFaceIndexData()[cornerCount + i * 4];
+        const int edge = mesh->findEdge(quad[2], quad[3]);
+        if (edge >= 0) mesh->selectEdge(edge, true);
+    }
+    return true;
 }
 
 bool MeshManager::bridgeEdgeLoops(std::shared_ptr<MeshObject> mesh, const std::unordered_set<int>& edgeIds1,
@@ -383,42 +1450,286 @@ bool MeshManager::knifeProject(std::shared_ptr<MeshObject> mesh, const Point3D&
 }
 
 bool MeshManager::smoothMesh(std::shared_ptr<MeshObject> mesh, int iterations, float factor) {
-    // Placeholder implementation
-    return false;
+    if (!mesh || iterations < 1 || factor <= 0.0f || factor > 1.0f || mesh->vertexCount() == 0) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Smooth");
+    
+    const size_t vertexCount = mesh->vertexCount();
+    const auto& edgeVertices = mesh->getEdgeVertexData();
+    const SelectionBits& selection = mesh->getSelectedVertices();
+    const bool selectedOnly = selection.any();
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Neighbours of each vertex in CSR form. Vertices on a boundary or crease keep the outline and
+    // have none, as do unselected vertices while any are selected; those stay put.
+    auto neighbours = [&](int vertex, int* out) {
+        if (selectedOnly && !selection.test(vertex)) return 0;
+        
+        AdjacencyRange edges = mesh->getVertexEdges(vertex);
+        for (int edge : edges) {
+            if (mesh->getEdgeFaces(edge).size() != 2) return 0;
+        }
+        if (out) {
+            for (size_t i = 0; i < edges.size(); ++i) {
+                const int edge = edges[i];
+                out[i] = edgeVertices[edge * 2] == vertex ? edgeVertices[edge * 2 + 1] : edgeVertices[edge * 2];
+            }
+        }
+        return static_cast<int>(edges.size());
+    };
+    
+    std::vector<int> neighbourOffsets(vertexCount + 1, 0);
+    pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            neighbourOffsets[v] = neighbours(static_cast<int>(v), nullptr);
+        }
+    });
+    std::vector<int> neighbourList(exclusiveScan(neighbourOffsets));
+    
+    // One weight per coordinate lane so the blend below runs over flat float arrays. Fixed
+    // vertices gather themselves with weight one and so do not move.
+    std::vector<float> weights(vertexCount * 3);
+    pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            neighbours(static_cast<int>(v), neighbourList.data() + neighbourOffsets[v]);
+            const int count = neighbourOffsets[v + 1] - neighbourOffsets[v];
+            std::fill_n(&weights[v * 3], 3, 1.0f / std::max(count, 1));
+        }
+    });
+    
+    // Double-buffered: each step reads one array and writes the other
+    std::vector<float> current(mesh->getPositionData());
+    std::vector<float> next(current.size());
+    
+    // Taubin smoothing: every iteration shrinks by factor, then inflates by a slightly larger
+    // negative step, so repeated passes do not shrink the mesh
+    const float inflate = factor / (TAUBIN_PASSBAND * factor - 1.0f);
+    for (int step = 0; step < iterations * 2; ++step) {
+        const float lambda = step % 2 == 0 ? factor : inflate;
+        pool.parallelFor(0, vertexCount, EDIT_GRAIN, [&](size_t first, size_t last) {
+            const float* in = current.data();
+            float* out = next.data();
+            const float* weight = weights.data();
+            
+            for (size_t v = first; v < last; ++v) {
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                const int begin = neighbourOffsets[v];
+                const int end = neighbourOffsets[v + 1];
+                if (begin == end) {
+                    addPoint(sum, &in[v * 3]);
+                }
+                for (int i = begin; i < end; ++i) {
+                    addPoint(sum, &in[neighbourList[i] * 3]);
+                }
+                std::copy_n(sum, 3, &out[v * 3]);
+            }
+            // Contiguous and branch-free, so the compiler vectorizes it
+            for (size_t i = first * 3; i < last * 3; ++i) {
+                out[i] = in[i] + lambda * (out[i] * weight[i] - in[i]);
+            }
+        });
+        std::swap(current, next);
+    }
+    
+    std::copy(current.begin(), current.end(), mesh->getPositionBuffer());
+    mesh->recalculateNormals();
+    return true;
 }
 
 bool MeshManager::decimateMesh(std::shared_ptr<MeshObject> mesh, float ratio) {
-    // Placeholder implementation
-    return false;
+    if (!mesh || ratio <= 0.0f || ratio >= 1.0f || mesh->faceCount() == 0) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Decimate");
+    
+    MeshDecimator decimator(*mesh);
+    decimator.decimateTo(static_cast<size_t>(ratio * decimator.inputTriangleCount()));
+    decimator.extract(*mesh);
+    return true;
+}
+
+std::vector<std::shared_ptr<MeshObject>> MeshManager::buildLevelsOfDetail(std::shared_ptr<MeshObject> mesh,
+                                                                        const std::vector<float>& ratios) {
+    if (!mesh || mesh->faceCount() == 0) return {};
+    
+    MeshDecimator decimator(*mesh);
+    return decimator.buildLodChain(ratios, mesh->getName());
 }
 
 bool MeshManager::applySubdivisionSurface(std::shared_ptr<MeshObject> mesh, int levels) {
-    // Placeholder implementation
-    return false;
+    if (!mesh || levels < 1 || mesh->faceCount() == 0 || !mesh->isValid()) return false;
+    MeshEditRecord record(m_undoHistory, mesh, "Subdivide");
+    
+    for (int level = 0; level < levels; ++level) {
+        // Pure triangle meshes use Loop; anything with quads or n-gons uses Catmull-Clark
+        const auto& offsets = mesh->getFaceOffsetData();
+        bool triangles = true;
+        for (size_t f = 0; f + 1 < offsets.size() && triangles; ++f) {
+            triangles = offsets[f + 1] - offsets[f] == 3;
+        }
+        
+        bool subdivided = triangles ? loopSubdivision(mesh.get()) : catmullClarkSubdivision(mesh.get());
+        if (!subdivided) return false;
+    }
+    return true;
 }
 
+namespace {
+
+std::shared_ptr<MeshObject> combineMeshes(const std::shared_ptr<MeshObject>& meshA, const std::shared_ptr<MeshObject>& meshB,
+                                          MeshBoolean::Operation operation, const std::string& name) {
+    if (!meshA || !meshB) return nullptr;
+    
+    RenderMesh renderA;
+    RenderMesh renderB;
+    if (!meshA->buildRenderMesh(renderA) || !meshB->buildRenderMesh(renderB)) return nullptr;
+    
+    RenderMesh result;
+    if (!MeshBoolean::compute(renderA, renderB, operation, result)) return nullptr;
+    
+    const size_t vertexCount = result.vertexCount();
+    std::vector<float> positions(vertexCount * 3);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const float* vertex = &result.vertices[i * RenderMesh::FLOATS_PER_VERTEX];
+        std::copy(vertex, vertex + 3, &positions[i * 3]);
+    }
+    std::vector<int> faceIndices(result.indices.begin(), result.indices.end());
+    std::vector<int> faceOffsets(faceIndices.size() / 3 + 1);
+    for (size_t i = 0; i < faceOffsets.size(); ++i) {
+        faceOffsets[i] = static_cast<int>(i * 3);
+    }
+    
+    auto mesh = std::make_shared<MeshObject>(meshA->getName() + name);
+    mesh->setGeometry(std::move(positions), std::move(faceIndices), std::move(faceOffsets));
+    // Pieces are written per source triangle; welding shares the seams and rebuilds the topology
+    if (mesh->removeDuplicateVertices() == 0) {
+        mesh->buildTopology();
+        mesh->recalculateNormals();
+    }
+    return mesh;
+}
+
+} // namespace
+
 std::shared_ptr<MeshObject> MeshManager::booleanUnion(std::shared_ptr<MeshObject> meshA, 
                                                     std::shared_ptr<MeshObject> meshB) {
-    // Placeholder implementation
-    return nullptr;
+    return combineMeshes(meshA, meshB, MeshBoolean::UNION, "_union");
 }
 
 std::shared_ptr<MeshObject> MeshManager::booleanDifference(std::shared_ptr<MeshObject> meshA, 
                                                          std::shared_ptr<MeshObject> meshB) {
-    // Placeholder implementation
-    return nullptr;
+    return combineMeshes(meshA, meshB, MeshBoolean::DIFFERENCE, "_difference");
 }
 
 std::shared_ptr<MeshObject> MeshManager::booleanIntersection(std::shared_ptr<MeshObject> meshA, 
                                                            std::shared_ptr<MeshObject> meshB) {
-    // Placeholder implementation
-    return nullptr;
+    return combineMeshes(meshA, meshB, MeshBoolean::INTERSECTION, "_intersection");
 }
 
 bool MeshManager::selectByRay(std::shared_ptr<MeshObject> mesh, const Point3D& rayOrigin, 
                             const Vector3D& rayDirection) {
-    // Placeholder implementation
-    return false;
+    if (!mesh) return false;
+    
+    // Nearest face along the ray over the same fan triangulation the viewport draws
+    const QVector3D origin = rayOrigin.toQVector3D();
+    const QVector3D direction = rayDirection.toQVector3D();
+    float nearest = std::numeric_limits<float>::max();
+    int hitFace = -1;
+    for (size_t f = 0; f < mesh->faceCount(); ++f) {
+        AdjacencyRange corners = mesh->getFaceVertices(static_cast<int>(f));
+        if (corners.size() < 3) continue;
+        
+        const QVector3D v0 = mesh->getVertexPosition(corners[0]);
+        for (size_t i = 1; i + 1 < corners.size(); ++i) {
+            // Moller-Trumbore
+            const QVector3D edge1 = mesh->getVertexPosition(corners[i]) - v0;
+            const QVector3D edge2 = mesh->getVertexPosition(corners[i + 1]) - v0;
+            const QVector3D p = QVector3D::crossProduct(direction, edge2);
+            const float det = QVector3D::dotProduct(edge1, p);
+            if (std::abs(det) < 1e-12f) continue;
+            
+            const float inverse = 1.0f / det;
+            const QVector3D s = origin - v0;
+            const float u = QVector3D::dotProduct(s, p) * inverse;
+            if (u < 0.0f || u > 1.0f) continue;
+            const QVector3D q = QVector3D::crossProduct(s, edge1);
+            const float v = QVector3D::dotProduct(direction, q) * inverse;
+            if (v < 0.0f || u + v > 1.0f) continue;
+            
+            const float t = QVector3D::dotProduct(edge2, q) * inverse;
+            if (t > 0.0f && t < nearest) {
+                nearest = t;
+                hitFace = static_cast<int>(f);
+            }
+        }
+    }
+    return hitFace >= 0 && selectOnFace(mesh, hitFace, rayOrigin, rayDirection);
+}
+
+bool MeshManager::selectOnFace(std::shared_ptr<MeshObject> mesh, int faceId, const Point3D& rayOrigin,
+                               const Vector3D& rayDirection, bool addToSelection) {
+    if (!mesh || faceId < 0 || faceId >= static_cast<int>(mesh->faceCount())) return false;
+    
+    AdjacencyRange corners = mesh->getFaceVertices(faceId);
+    if (corners.empty()) return false;
+    
+    if (m_selectionMode == SelectionMode::FACE) {
+        mesh->selectFace(faceId, addToSelection);
+        return true;
+    }
+    if (m_selectionMode == SelectionMode::OBJECT) {
+        selectAll(mesh);
+        return true;
+    }
+    
+    // Hit point on the face plane; the centroid stands in when the ray grazes the plane
+    QVector3D centroid;
+    for (int vertexIndex : corners) {
+        centroid += mesh->getVertexPosition(vertexIndex);
+    }
+    centroid /= static_cast<float>(corners.size());
+    
+    const QVector3D origin = rayOrigin.toQVector3D();
+    const QVector3D direction = rayDirection.toQVector3D();
+    const QVector3D normal = mesh->getFaceNormal(faceId);
+    const float denominator = QVector3D::dotProduct(direction, normal);
+    QVector3D hit = centroid;
+    if (std::abs(denominator) > 1e-6f) {
+        hit = origin + direction * (QVector3D::dotProduct(centroid - origin, normal) / denominator);
+    }
+    
+    if (m_selectionMode == SelectionMode::VERTEX) {
+        int nearestVertex = corners[0];
+        float nearestDistance = std::numeric_limits<float>::max();
+        for (int vertexIndex : corners) {
+            const float distance = (mesh->getVertexPosition(vertexIndex) - hit).lengthSquared();
+            if (distance < nearestDistance) {
+                nearestDistance = distance;
+                nearestVertex = vertexIndex;
+            }
+        }
+        mesh->selectVertex(nearestVertex, addToSelection);
+        return true;
+    }
+    
+    // Edge mode: corner i's edge runs to corner i + 1
+    const std::vector<int>& cornerEdges = mesh->getCornerEdgeData();
+    const int firstCorner = mesh->getFaceOffsetData()[faceId];
+    if (cornerEdges.size() < mesh->getFaceIndexData().size()) return false;
+    
+    int nearestEdge = -1;
+    float nearestDistance = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < corners.size(); ++i) {
+        const QVector3D start = mesh->getVertexPosition(corners[i]);
+        const QVector3D segment = mesh->getVertexPosition(corners[(i + 1) % corners.size()]) - start;
+        const float length = segment.lengthSquared();
+        const float t = length > 0.0f ? std::clamp(QVector3D::dotProduct(hit - start, segment) / length, 0.0f, 1.0f) : 0.0f;
+        const float distance = (start + segment * t - hit).lengthSquared();
+        if (distance < nearestDistance && cornerEdges[firstCorner + i] >= 0) {
+            nearestDistance = distance;
+            nearestEdge = cornerEdges[firstCorner + i];
+        }
+    }
+    if (nearestEdge < 0) return false;
+    mesh->selectEdge(nearestEdge, addToSelection);
+    return true;
 }
 
 void MeshManager::clearSelection(std::shared_ptr<MeshObject> mesh) {
@@ -436,19 +1747,13 @@ void MeshManager::selectAll(std::shared_ptr<MeshObject> mesh) {
     
     switch (m_selectionMode) {
         case SelectionMode::VERTEX:
-            for (int i = 0; i < mesh->getVertices().size(); ++i) {
-                mesh->selectVertex(i, true);
-            }
+            mesh->getSelectedVertices().setAll();
             break;
         case SelectionMode::EDGE:
-            for (int i = 0; i < mesh->getEdges().size(); ++i) {
-                mesh->selectEdge(i, true);
-            }
+            mesh->getSelectedEdges().setAll();
             break;
         case SelectionMode::FACE:
-            for (int i = 0; i < mesh->getFaces().size(); ++i) {
-                mesh->selectFace(i, true);
-            }
+            mesh->getSelectedFaces().setAll();
             break;
         default:
             break;
@@ -456,23 +1761,19 @@ void MeshManager::selectAll(std::shared_ptr<MeshObject> mesh) {
 }
 
 bool MeshManager::importOBJ(const std::string& filename, std::shared_ptr<MeshObject> mesh) {
-    // Placeholder implementation
-    return false;
+    return mesh && MeshIO::importOBJ(filename, *mesh);
 }
 
 bool MeshManager::exportOBJ(const std::string& filename, std::shared_ptr<MeshObject> mesh) {
-    // Placeholder implementation
-    return false;
+    return mesh && MeshIO::exportOBJ(filename, *mesh);
 }
 
 bool MeshManager::importSTL(const std::string& filename, std::shared_ptr<MeshObject> mesh) {
-    // Placeholder implementation
-    return false;
+    return mesh && MeshIO::importSTL(filename, *mesh);
 }
 
 bool MeshManager::exportSTL(const std::string& filename, std::shared_ptr<MeshObject> mesh) {
-    // Placeholder implementation
-    return false;
+    return mesh && MeshIO::exportSTL(filename, *mesh);
 }
 
 void MeshManager::calculateFaceNormal(MeshObject* mesh, int faceId) {
@@ -484,39 +1785,325 @@ void MeshManager::calculateVertexNormal(MeshObject* mesh, int vertexId) {
 }
 
 std::vector<int> MeshManager::getAdjacentVertices(const MeshObject* mesh, int vertexId) {
-    // Placeholder implementation
-    return {};
+    std::vector<int> adjacent;
+    if (!mesh) return adjacent;
+    
+    const auto& edgeVertices = mesh->getEdgeVertexData();
+    for (int edgeIndex : mesh->getVertexEdges(vertexId)) {
+        int v1 = edgeVertices[edgeIndex * 2];
+        int v2 = edgeVertices[edgeIndex * 2 + 1];
+        adjacent.push_back(v1 == vertexId ? v2 : v1);
+    }
+    return adjacent;
 }
 
 std::vector<int> MeshManager::getAdjacentFaces(const MeshObject* mesh, int vertexId) {
-    // Placeholder implementation
-    return {};
+    if (!mesh) return {};
+    
+    AdjacencyRange faces = mesh->getVertexFaces(vertexId);
+    std::vector<int> adjacent(faces.begin(), faces.end());
+    adjacent.erase(std::unique(adjacent.begin(), adjacent.end()), adjacent.end());
+    return adjacent;
 }
 
 bool MeshManager::isEdgeManifold(const MeshObject* mesh, int edgeId) {
-    // Placeholder implementation
-    return false;
+    if (!mesh || edgeId < 0 || edgeId >= static_cast<int>(mesh->edgeCount())) return false;
+    
+    // Boundary edges (one face) count as manifold
+    size_t faceCount = mesh->getEdgeFaces(edgeId).size();
+    return faceCount == 1 || faceCount == 2;
 }
 
-void MeshManager::catmullClarkSubdivision(MeshObject* mesh) {
-    // Placeholder implementation
+namespace {
+
+constexpr size_t SUBDIVISION_GRAIN = 2048;
+
+// Edges with other than two faces are treated as creases
+inline bool isSharpEdge(const MeshObject* mesh, int edge) {
+    return mesh->getEdgeFaces(edge).size() != 2;
 }
 
-void MeshManager::loopSubdivision(MeshObject* mesh) {
-    // Placeholder implementation
+// Boundary rule shared by both schemes: 3/4 of the vertex plus 1/8 of each boundary neighbour.
+// Returns false when the vertex is a corner (other than two sharp edges), which stays fixed.
+bool boundaryVertexPoint(const MeshObject* mesh, int vertex, int sharpEdges, float* out) {
+    const auto& positions = mesh->getPositionData();
+    const auto& edgeVertices = mesh->getEdgeVertexData();
+    const float* p = &positions[vertex * 3];
+    if (sharpEdges != 2) {
+        std::copy_n(p, 3, out);
+        return false;
+    }
+    
+    out[0] = out[1] = out[2] = 0.0f;
+    addPoint(out, p, 0.75f);
+    for (int edge : mesh->getVertexEdges(vertex)) {
+        if (!isSharpEdge(mesh, edge)) continue;
+        int other = edgeVertices[edge * 2] == vertex ? edgeVertices[edge * 2 + 1] : edgeVertices[edge * 2];
+        addPoint(out, &positions[other * 3], 0.125f);
+    }
+    return true;
+}
+
+} // namespace
+
+bool MeshManager::catmullClarkSubdivision(MeshObject* mesh) {
+    const auto& positions = mesh->getPositionData();
+    const auto& faceIndices = mesh->getFaceIndexData();
+    const auto& faceOffsets = mesh->getFaceOffsetData();
+    const auto& edgeVertices = mesh->getEdgeVertexData();
+    const auto& cornerEdges = mesh->getCornerEdgeData();
+    if (std::find(cornerEdges.begin(), cornerEdges.end(), -1) != cornerEdges.end()) return false;
+    
+    const size_t vertexCount = mesh->vertexCount();
+    const size_t edgeCount = mesh->edgeCount();
+    const size_t faceCount = mesh->faceCount();
+    const size_t cornerCount = faceIndices.size();
+    
+    // Output layout: original vertices, then edge points, then face points; one quad per corner
+    const size_t edgeBase = vertexCount;
+    const size_t faceBase = vertexCount + edgeCount;
+    std::vector<float> newPositions((faceBase + faceCount) * 3, 0.0f);
+    std::vector<int> newIndices(cornerCount * 4);
+    std::vector<int> newOffsets(cornerCount + 1);
+    
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Face points: corner centroid
+    pool.parallelFor(0, faceCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            float* out = &newPositions[(faceBase + f) * 3];
+            const int begin = faceOffsets[f], end = faceOffsets[f + 1];
+            for (int c = begin; c < end; ++c) {
+                addPoint(out, &positions[faceIndices[c] * 3]);
+            }
+            const float inverse = 1.0f / (end - begin);
+            out[0] *= inverse;
+            out[1] *= inverse;
+            out[2] *= inverse;
+        }
+    });
+    
+    // Edge points: average of the endpoints and both face points, or the midpoint on creases
+    pool.parallelFor(0, edgeCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t e = first; e < last; ++e) {
+            float* out = &newPositions[(edgeBase + e) * 3];
+            addPoint(out, &positions[edgeVertices[e * 2] * 3]);
+            addPoint(out, &positions[edgeVertices[e * 2 + 1] * 3]);
+            
+            AdjacencyRange faces = mesh->getEdgeFaces(static_cast<int>(e));
+            float weight = 0.5f;
+            if (faces.size() == 2) {
+                addPoint(out, &newPositions[(faceBase + faces[0]) * 3]);
+                addPoint(out, &newPositions[(faceBase + faces[1]) * 3]);
+                weight = 0.25f;
+            }
+            out[0] *= weight;
+            out[1] *= weight;
+            out[2] *= weight;
+        }
+    });
+    
+    // Vertex points: (F + 2R + (n - 3)P) / n with F the face point average and R the edge midpoint average
+    pool.parallelFor(0, vertexCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            const int vertex = static_cast<int>(v);
+            const float* p = &positions[v * 3];
+            float* out = &newPositions[v * 3];
+            AdjacencyRange edges = mesh->getVertexEdges(vertex);
+            
+            int sharpEdges = 0;
+            for (int edge : edges) {
+                sharpEdges += isSharpEdge(mesh, edge);
+            }
+            if (sharpEdges > 0 || edges.size() < 3) {
+                boundaryVertexPoint(mesh, vertex, edges.size() < 3 ? 0 : sharpEdges, out);
+                continue;
+            }
+            
+            float faceSum[3] = { 0.0f, 0.0f, 0.0f };
+            int faceTotal = 0;
+            int lastFace = -1;
+            for (int face : mesh->getVertexFaces(vertex)) {
+                if (face == lastFace) continue;
+                lastFace = face;
+                addPoint(faceSum, &newPositions[(faceBase + face) * 3]);
+                ++faceTotal;
+            }
+            
+            const int n = static_cast<int>(edges.size());
+            if (faceTotal != n) {
+                std::copy_n(p, 3, out);
+                continue;
+            }
+            
+            // Sum of edge midpoints is (n * P + sum of neighbours) / 2
+            float neighbourSum[3] = { 0.0f, 0.0f, 0.0f };
+            for (int edge : edges) {
+                int other = edgeVertices[edge * 2] == vertex ? edgeVertices[edge * 2 + 1] : edgeVertices[edge * 2];
+                addPoint(neighbourSum, &positions[other * 3]);
+            }
+            
+            const float inverse = 1.0f / n;
+            for (int k = 0; k < 3; ++k) {
+                float faceAverage = faceSum[k] * inverse;
+                float midpointAverage = (n * p[k] + neighbourSum[k]) * 0.5f * inverse;
+                out[k] = (faceAverage + 2.0f * midpointAverage + (n - 3) * p[k]) * inverse;
+            }
+        }
+    });
+    
+    // One quad per corner: corner vertex, its outgoing edge point, face point, incoming edge point
+    pool.parallelFor(0, faceCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            const int begin = faceOffsets[f];
+            const int size = faceOffsets[f + 1] - begin;
+            for (int i = 0; i < size; ++i) {
+                const int corner = begin + i;
+                const int previous = begin + (i + size - 1) % size;
+                int* quad = &newIndices[corner * 4];
+                quad[0] = faceIndices[corner];
+                quad[1] = static_cast<int>(edgeBase) + cornerEdges[corner];
+                quad[2] = static_cast<int>(faceBase + f);
+                quad[3] = static_cast<int>(edgeBase) + cornerEdges[previous];
+                newOffsets[corner] = corner * 4;
+            }
+        }
+    });
+    newOffsets[cornerCount] = static_cast<int>(cornerCount * 4);
+    
+    mesh->setGeometry(std::move(newPositions), std::move(newIndices), std::move(newOffsets));
+    return true;
+}
+
+bool MeshManager::loopSubdivision(MeshObject* mesh) {
+    const auto& positions = mesh->getPositionData();
+    const auto& faceIndices = mesh->getFaceIndexData();
+    const auto& edgeVertices = mesh->getEdgeVertexData();
+    const auto& cornerEdges = mesh->getCornerEdgeData();
+    if (std::find(cornerEdges.begin(), cornerEdges.end(), -1) != cornerEdges.end()) return false;
+    
+    const size_t vertexCount = mesh->vertexCount();
+    const size_t edgeCount = mesh->edgeCount();
+    const size_t faceCount = mesh->faceCount();
+    
+    // Output layout: original vertices, then edge points; four triangles per triangle
+    const size_t edgeBase = vertexCount;
+    std::vector<float> newPositions((vertexCount + edgeCount) * 3, 0.0f);
+    std::vector<int> newIndices(faceCount * 12);
+    std::vector<int> newOffsets(faceCount * 4 + 1);
+    
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Edge points: 3/8 of the endpoints plus 1/8 of both opposite vertices, or the midpoint on creases
+    pool.parallelFor(0, edgeCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t e = first; e < last; ++e) {
+            const int a = edgeVertices[e * 2];
+            const int b = edgeVertices[e * 2 + 1];
+            float* out = &newPositions[(edgeBase + e) * 3];
+            
+            AdjacencyRange faces = mesh->getEdgeFaces(static_cast<int>(e));
+            if (faces.size() != 2) {
+                addPoint(out, &positions[a * 3], 0.5f);
+                addPoint(out, &positions[b * 3], 0.5f);
+                continue;
+            }
+            
+            addPoint(out, &positions[a * 3], 0.375f);
+            addPoint(out, &positions[b * 3], 0.375f);
+            for (int face : faces) {
+                for (int c = face * 3; c < face * 3 + 3; ++c) {
+                    const int vertex = faceIndices[c];
+                    if (vertex != a && vertex != b) {
+                        addPoint(out, &positions[vertex * 3], 0.125f);
+                        break;
+                    }
+                }
+            }
+        }
+    });
+    
+    // Vertex points: (1 - n * beta) P + beta * sum of neighbours, with Warren's beta
+    pool.parallelFor(0, vertexCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v) {
+            const int vertex = static_cast<int>(v);
+            float* out = &newPositions[v * 3];
+            AdjacencyRange edges = mesh->getVertexEdges(vertex);
+            
+            int sharpEdges = 0;
+            for (int edge : edges) {
+                sharpEdges += isSharpEdge(mesh, edge);
+            }
+            if (sharpEdges > 0 || edges.size() < 3) {
+                boundaryVertexPoint(mesh, vertex, edges.size() < 3 ? 0 : sharpEdges, out);
+                continue;
+            }
+            
+            const int n = static_cast<int>(edges.size());
+            const float beta = n == 3 ? 3.0f / 16.0f : 3.0f / (8.0f * n);
+            addPoint(out, &positions[v * 3], 1.0f - n * beta);
+            for (int edge : edges) {
+                int other = edgeVertices[edge * 2] == vertex ? edgeVertices[edge * 2 + 1] : edgeVertices[edge * 2];
+                addPoint(out, &positions[other * 3], beta);
+            }
+        }
+    });
+    
+    // Corner triangles keep the original winding; the centre triangle joins the three edge points
+    pool.parallelFor(0, faceCount, SUBDIVISION_GRAIN, [&](size_t first, size_t last) {
+        for (size_t f = first; f < last; ++f) {
+            const int* corners = &faceIndices[f * 3];
+            const int* edges = &cornerEdges[f * 3];
+            const int e0 = static_cast<int>(edgeBase) + edges[0];
+            const int e1 = static_cast<int>(edgeBase) + edges[1];
+            const int e2 = static_cast<int>(edgeBase) + edges[2];
+            
+            const int triangles[12] = {
+                corners[0], e0, e2,
+                corners[1], e1, e0,
+                corners[2], e2, e1,
+                e0, e1, e2
+            };
+            std::copy_n(triangles, 12, &newIndices[f * 12]);
+            for (int k = 0; k < 4; ++k) {
+                newOffsets[f * 4 + k] = static_cast<int>((f * 4 + k) * 3);
+            }
+        }
+    });
+    newOffsets[faceCount * 4] = static_cast<int>(faceCount * 12);
+    
+    mesh->setGeometry(std::move(newPositions), std::move(newIndices), std::move(newOffsets));
+    return true;
 }
 
 bool MeshManager::isMeshManifold(const MeshObject* mesh) {
-    // Placeholder implementation
-    return false;
+    if (!mesh) return false;
+    
+    for (const auto& edge : mesh->getEdges()) {
+        if (edge.adjacentFaces().size() > 2) return false;
+    }
+    return true;
 }
 
 void MeshManager::findBoundaryEdges(const MeshObject* mesh, std::vector<int>& boundaryEdges) {
-    // Placeholder implementation
+    boundaryEdges.clear();
+    if (!mesh) return;
+    
+    for (const auto& edge : mesh->getEdges()) {
+        if (edge.adjacentFaces().size() == 1) {
+            boundaryEdges.push_back(edge.id());
+        }
+    }
 }
 
 void MeshManager::findNonManifoldEdges(const MeshObject* mesh, std::vector<int>& nonManifoldEdges) {
-    // Placeholder implementation
+    nonManifoldEdges.clear();
+    if (!mesh) return;
+    
+    for (const auto& edge : mesh->getEdges()) {
+        if (edge.adjacentFaces().size() > 2) {
+            nonManifoldEdges.push_back(edge.id());
+        }
+    }
 }
 
 } // namespace HybridCAD 
\ No newline at end of file
@@ -0,0 +1,329 @@
+#include "PartLibrary.h"
+#include "PartManager.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string_view>
+
+namespace HybridCAD {
+
+namespace {
+
+constexpr char CATALOG_HEADER[] = "HybridCAD part library 1";
+constexpr char CATALOG_FILE[] = "library.catalog";
+constexpr char PARTS_FOLDER[] = "parts";
+constexpr int CATALOG_FIELDS = 6;
+constexpr uint64_t DEFAULT_MEMORY_BUDGET = 256ull * 1024 * 1024;
+
+// Catalog lines are tab-separated fields
+void appendEscaped(std::string& out, const std::string& field) {
+    for (char c : field) {
+        switch (c) {
+        case '\\': out += "\\\\"; break;
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        default: out += c; break;
+        }
+    }
+}
+
+std::string unescape(std::string_view field) {
+    std::string out;
+    out.reserve(field.size());
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] != '\\' || i + 1 == field.size()) {
+            out += field[i];
+            continue;
+        }
+        switch (field[++i]) {
+        case 't': out += '\t'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        default: out += field[i]; break;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+PartLibrary::PartLibrary()
+    : m_catalogDirty(false)
+    , m_memoryBudget(DEFAULT_MEMORY_BUDGET)
+    , m_residentBytes(0) {
+}
+
+PartLibrary::~PartLibrary() {
+    flush();
+}
+
+bool PartLibrary::open(const std::string& directory) {
+    flush();
+    m_slots.clear();
+    m_categories.clear();
+    m_fileNames.clear();
+    m_recent.clear();
+    m_residentBytes = 0;
+    m_catalogDirty = false;
+    m_directory = directory;
+
+    QDir().mkpath(QString::fromStdString(filePath(PARTS_FOLDER)));
+
+    QFile file(QString::fromStdString(filePath(CATALOG_FILE)));
+    if (!file.exists()) return true;
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QByteArray data = file.readAll();
+    std::string_view text(data.constData(), static_cast<size_t>(data.size()));
+    bool header = true;
+    while (!text.empty()) {
+        const size_t end = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(std::min(end + 1, text.size()));
+
+        if (header) {
+            if (line != CATALOG_HEADER) return false;
+            header = false;
+            continue;
+        }
+        if (line.empty()) continue;
+
+        std::string_view fields[CATALOG_FIELDS];
+        int count = 0;
+        while (count < CATALOG_FIELDS - 1) {
+            const size_t tab = line.find('\t');
+            if (tab == std::string_view::npos) break;
+            fields[count++] = line.substr(0, tab);
+            line.remove_prefix(tab + 1);
+        }
+        fields[count++] = line;
+        if (count != CATALOG_FIELDS) continue;
+
+        Entry entry;
+        entry.name = unescape(fields[0]);
+        entry.category = unescape(fields[1]);
+        entry.fileName = unescape(fields[2]);
+        entry.fileSize = std::strtoull(std::string(fields[3]).c_str(), nullptr, 10);
+        entry.thumbnailPath = unescape(fields[4]);
+        entry.description = unescape(fields[5]);
+        if (entry.fileName.empty() || m_slots.count(entry.name)) continue;
+
+        m_categories[entry.category].push_back(entry.name);
+        m_fileNames.insert(entry.fileName);
+        m_slots[entry.name].entry = std::move(entry);
+    }
+    return !header;
+}
+
+bool PartLibrary::flush() {
+    if (!m_catalogDirty || m_directory.empty()) return true;
+
+    // Sorted categories keep the file stable between writes
+    std::string text = std::string(CATALOG_HEADER) + "\n";
+    for (const std::string& category : getCategories()) {
+        for (const std::string& name : getParts(category)) {
+            const Entry& entry = m_slots.at(name).entry;
+            if (entry.fileName.empty()) continue;
+            appendEscaped(text, entry.name);
+            text += '\t';
+            appendEscaped(text, entry.category);
+            text += '\t';
+            appendEscaped(text, entry.fileName);
+            text += '\t';
+            text += std::to_string(entry.fileSize);
+            text += '\t';
+            appendEscaped(text, entry.thumbnailPath);
+            text += '\t';
+            appendEscaped(text, entry.description);
+            text += '\n';
+        }
+    }
+
+    QSaveFile file(QString::fromStdString(filePath(CATALOG_FILE)));
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    if (file.write(text.data(), static_cast<qint64>(text.size())) != static_cast<qint64>(text.size()) || !file.commit()) {
+        return false;
+    }
+    m_catalogDirty = false;
+    return true;
+}
+
+bool PartLibrary::add(CADObjectPtr part, const std::string& name, const std::string& category,
+                      const std::string& description) {
+    if (!part || name.empty()) return false;
+
+    Entry entry;
+    entry.name = name;
+    entry.category = category;
+    entry.description = description;
+
+    if (!m_directory.empty()) {
+        // A document of its own per part, under a new file so a replaced part's file stays intact
+        // until the new one is written
+        PartDocument document(name);
+        document.addObject(part);
+        entry.fileName = partFileName(name);
+        const std::string path = filePath(entry.fileName);
+        if (!DocumentIO::save(path, document, m_saveOptions)) {
+            m_fileNames.erase(entry.fileName);
+            return false;
+        }
+        entry.fileSize = static_cast<uint64_t>(QFileInfo(QString::fromStdString(path)).size());
+    }
+
+    remove(name);
+    m_categories[category].push_back(name);
+    Slot& slot = m_slots[name];
+    slot.entry = std::move(entry);
+    slot.part = std::move(part);
+    if (!slot.entry.fileName.empty()) {
+        touch(slot);
+        trim();
+    }
+    m_catalogDirty = true;
+    return true;
+}
+
+bool PartLibrary::remove(const std::string& name) {
+    auto it = m_slots.find(name);
+    if (it == m_slots.end()) return false;
+
+    Slot& slot = it->second;
+    forget(slot);
+    if (!slot.entry.fileName.empty()) {
+        QFile::remove(QString::fromStdString(filePath(slot.entry.fileName)));
+        m_fileNames.erase(slot.entry.fileName);
+    }
+
+    auto category = m_categories.find(slot.entry.category);
+    if (category != m_categories.end()) {
+        std::vector<std::string>& names = category->second;
+        auto listed = std::find(names.begin(), names.end(), name);
+        if (listed != names.end()) names.erase(listed);
+        if (names.empty()) m_categories.erase(category);
+    }
+
+    m_slots.erase(it);
+    m_catalogDirty = true;
+    return true;
+}
+
+const PartLibrary::Entry* PartLibrary::findEntry(const std::string& name) const {
+    auto it = m_slots.find(name);
+    return it != m_slots.end() ? &it->second.entry : nullptr;
+}
+
+void PartLibrary::setThumbnailPath(const std::string& name, const std::string& thumbnailPath) {
+    auto it = m_slots.find(name);
+    if (it == m_slots.end() || it->second.entry.thumbnailPath == thumbnailPath) return;
+
+    it->second.entry.thumbnailPath = thumbnailPath;
+    m_catalogDirty = true;
+}
+
+CADObjectPtr PartLibrary::get(const std::string& name) {
+    auto it = m_slots.find(name);
+    if (it == m_slots.end()) return nullptr;
+
+    Slot& slot = it->second;
+    if (!slot.part) {
+        // Meshes stay on disk until they are drawn or edited, so a part reads little more than its parameters
+        PartDocument document(name);
+        if (!DocumentIO::load(filePath(slot.entry.fileName), document) || document.getObjects().empty()) {
+            return nullptr;
+        }
+        slot.part = document.getObjects().front();
+    }
+    if (!slot.entry.fileName.empty()) {
+        touch(slot);
+        trim();
+    }
+    return slot.part;
+}
+
+bool PartLibrary::isResident(const std::string& name) const {
+    auto it = m_slots.find(name);
+    return it != m_slots.end() && it->second.part;
+}
+
+std::vector<std::string> PartLibrary::getCategories() const {
+    std::vector<std::string> categories;
+    categories.reserve(m_categories.size());
+    for (const auto& pair : m_categories) {
+        categories.push_back(pair.first);
+    }
+    std::sort(categories.begin(), categories.end());
+    return categories;
+}
+
+const std::vector<std::string>& PartLibrary::getParts(const std::string& category) const {
+    static const std::vector<std::string> none;
+    auto it = m_categories.find(category);
+    return it != m_categories.end() ? it->second : none;
+}
+
+void PartLibrary::setMemoryBudget(uint64_t bytes) {
+    m_memoryBudget = bytes;
+    trim();
+}
+
+void PartLibrary::touch(Slot& slot) {
+    if (slot.isRecent) {
+        m_recent.splice(m_recent.begin(), m_recent, slot.recent);
+        return;
+    }
+    m_recent.push_front(slot.entry.name);
+    slot.recent = m_recent.begin();
+    slot.isRecent = true;
+    m_residentBytes += slot.entry.fileSize;
+}
+
+void PartLibrary::forget(Slot& slot) {
+    if (!slot.isRecent) return;
+
+    // Callers still holding the part keep it alive; the library reads it afresh next time
+    m_recent.erase(slot.recent);
+    slot.isRecent = false;
+    slot.part.reset();
+    m_residentBytes -= slot.entry.fileSize;
+}
+
+void PartLibrary::trim() {
+    // The part just used always stays
+    while (m_residentBytes > m_memoryBudget && m_recent.size() > 1) {
+        forget(m_slots.at(m_recent.back()));
+    }
+}
+
+std::string PartLibrary::partFileName(const std::string& name) {
+    // Readable prefix plus a hash of the full name, so names differing only in dropped
+    // characters rarely collide
+    std::string base;
+    for (char c : name) {
+        if (base.size() == 40) break;
+        const bool plain = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+        base += plain ? c : '_';
+    }
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(std::hash<std::string>()(name)));
+    base = std::string(PARTS_FOLDER) + "/" + base + "-" + hash;
+
+    std::string fileName = base + ".cad";
+    for (int counter = 1; m_fileNames.count(fileName); ++counter) {
+        fileName = base + "-" + std::to_string(counter) + ".cad";
+    }
+    m_fileNames.insert(fileName);
+    return fileName;
+}
+
+std::string PartLibrary::filePath(const std::string& fileName) const {
+    return m_directory + "/" + fileName;
+}
+
+} // namespace HybridCAD
@@ -1,4 +1,10 @@
 #include "PartManager.h"
+#include "GeometryManager.h"
+#include "MeshManager.h"
+#include "ThumbnailRenderer.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
 #include <algorithm>
 #include <GL/gl.h>
 
@@ -33,11 +39,90 @@ void Assembly::render() const {
     }
 }
 
+uint64_t Assembly::getGeometryRevision() const {
+    // Revisions only grow, so the newest one reflects changes to any part or nested assembly
+    uint64_t revision = m_geometryRevision;
+    for (const auto& instance : m_partInstances) {
+        if (instance.part) {
+            revision = std::max(revision, instance.part->getGeometryRevision());
+        }
+    }
+    return revision;
+}
+
+uint64_t Assembly::getAppearanceRevision() const {
+    uint64_t revision = m_appearanceRevision;
+    for (const auto& instance : m_partInstances) {
+        if (instance.part) {
+            revision = std::max(revision, instance.part->getAppearanceRevision());
+        }
+    }
+    return revision;
+}
+
+std::vector<const CADObject*> Assembly::getDependencies() const {
+    std::vector<const CADObject*> parts;
+    for (const auto& instance : m_partInstances) {
+        if (instance.part && std::find(parts.begin(), parts.end(), instance.part.get()) == parts.end()) {
+            parts.push_back(instance.part.get());
+        }
+    }
+    return parts;
+}
+
+std::vector<InstanceBatch> Assembly::buildInstanceBatches() const {
+    std::vector<InstanceBatch> batches;
+    std::unordered_map<const CADObject*, size_t> batchIndex;
+    
+    QMatrix4x4 identity;
+    collectInstances(identity, batches, batchIndex);
+    return batches;
+}
+
+void Assembly::collectInstances(const QMatrix4x4& parentTransform, std::vector<InstanceBatch>& batches,
+                                std::unordered_map<const CADObject*, size_t>& batchIndex) const {
+    for (const auto& instance : m_partInstances) {
+        if (!instance.visible || !instance.part || !instance.part->isVisible()) continue;
+        
+        QMatrix4x4 transform = parentTransform * instance.transform.matrix;
+        
+        // Nested assemblies are flattened so their parts batch with the top level
+        if (instance.part->getType() == ObjectType::ASSEMBLY) {
+            static_cast<const Assembly*>(instance.part.get())->collectInstances(transform, batches, batchIndex);
+            continue;
+        }
+        
+        auto it = batchIndex.find(instance.part.get());
+        if (it == batchIndex.end()) {
+            it = batchIndex.emplace(instance.part.get(), batches.size()).first;
+            batches.push_back(InstanceBatch{instance.part, {}, {}});
+        }
+        
+        QColor color = instance.color;
+        if (!color.isValid()) {
+            const Material& material = instance.part->getMaterial();
+            color = material.diffuseColor;
+            color.setAlphaF(1.0f - material.transparency);
+        }
+        
+        InstanceBatch& batch = batches[it->second];
+        batch.transforms.push_back(transform);
+        batch.colors.push_back(color);
+    }
+}
+
 bool Assembly::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection) const {
     for (const auto& instance : m_partInstances) {
         if (instance.visible && instance.part) {
-            // For simplicity, check intersection without transform
-            if (instance.part->intersects(rayOrigin, rayDirection)) {
+            // Test the ray in the part's own frame
+            bool invertible = false;
+            const QMatrix4x4 toPart = instance.transform.matrix.inverted(&invertible);
+            if (!invertible) continue;
+            
+            const QVector3D origin = toPart.map(rayOrigin.toQVector3D());
+            const QVector3D direction = toPart.mapVector(rayDirection.toQVector3D());
+            if (instance.part->intersects(Point3D(origin.x(), origin.y(), origin.z()),
+                                          Vector3D(direction.x(), direction.y(), direction.z()))) {
                 return true;
             }
         }
@@ -45,13 +130,15 @@ bool Assembly::intersects(const Point3D& rayOrigin, const Vector3D& rayDirection
     return false;
 }
 
-void Assembly::addPart(CADObjectPtr part, const std::string& instanceName) {
-    if (!part) return;
+PartInstance* Assembly::addPart(CADObjectPtr part, const std::string& instanceName) {
+    if (!part) return nullptr;
     
     std::string name = instanceName.empty() ? part->getName() : instanceName;
     
     PartInstance instance(part, name);
     m_partInstances.push_back(instance);
+    m_constraintsDirty = true;
+    markGeometryDirty();
     
     // Set the parent of the added part
     part->setParent(this);
@@ -66,6 +153,7 @@ void Assembly::addPart(CADObjectPtr part, const std::string& instanceName) {
         partMaterial.transparency = 0.0f; // Opaque
         part->setMaterial(partMaterial);
     }
+    return &m_partInstances.back();
 }
 
 void Assembly::removePart(CADObjectPtr part) {
@@ -75,6 +163,8 @@ void Assembly::removePart(CADObjectPtr part) {
                           return instance.part == part; 
                       }),
         m_partInstances.end());
+    m_constraintsDirty = true;
+    markGeometryDirty();
 }
 
 void Assembly::removePartInstance(const std::string& instanceName) {
@@ -84,11 +174,26 @@ void Assembly::removePartInstance(const std::string& instanceName) {
                           return instance.instanceName == instanceName; 
                       }),
         m_partInstances.end());
+    m_constraintsDirty = true;
+    markGeometryDirty();
+}
+
+const PartInstance* Assembly::getPartInstance(const std::string& instanceName) const {
+    for (const auto& instance : m_partInstances) {
+        if (instance.instanceName == instanceName) {
+            return &instance;
+        }
+    }
+    return nullptr;
 }
 
-PartInstance* Assembly::getPartInstance(const std::string& instanceName) {
+PartInstance* Assembly::editPartInstance(const std::string& instanceName) {
     for (auto& instance : m_partInstances) {
         if (instance.instanceName == instanceName) {
+            // The caller may edit the instance in place, so cached instance data is invalidated
+            // and the solver set up again in case the instance was locked or unlocked
+            m_constraintsDirty = true;
+            markGeometryDirty();
             return &instance;
         }
     }
@@ -96,10 +201,34 @@ PartInstance* Assembly::getPartInstance(const std::string& instanceName) {
 }
 
 void Assembly::setPartTransform(const std::string& instanceName, const Transform& transform) {
-    PartInstance* instance = getPartInstance(instanceName);
-    if (instance) {
-        instance->transform = transform;
-        m_constraintsDirty = true;
+    for (size_t i = 0; i < m_partInstances.size(); ++i) {
+        if (m_partInstances[i].instanceName == instanceName) {
+            const Transform before = m_partInstances[i].transform;
+            m_partInstances[i].transform = transform;
+            // Assemblies not owned by a shared_ptr have nothing a command could hold on to
+            if (m_undoRecorder) {
+                if (auto self = weak_from_this().lock()) {
+                    m_undoRecorder(std::make_unique<TransformCommand>("Move " + instanceName, self, instanceName,
+                                                                      before, transform));
+                }
+            }
+            // Only the constraints reaching this instance need solving again
+            m_solver.markBodyDirty(static_cast<int>(i));
+            markGeometryDirty();
+            return;
+        }
+    }
+}
+
+void Assembly::setPartColor(const std::string& instanceName, const QColor& color) {
+    for (auto& instance : m_partInstances) {
+        if (instance.instanceName == instanceName) {
+            if (instance.color == color) return;
+            // Instance buffers follow the revision; the solver never sees colors
+            instance.color = color;
+            markGeometryDirty();
+            return;
+        }
     }
 }
 
@@ -131,152 +260,446 @@ void Assembly::updateConstraint(size_t index, const AssemblyConstraint& constrai
     }
 }
 
+int Assembly::findInstanceIndex(const CADObject* part) const {
+    for (size_t i = 0; i < m_partInstances.size(); ++i) {
+        if (m_partInstances[i].part.get() == part) return static_cast<int>(i);
+    }
+    return -1;
+}
+
 bool Assembly::solveConstraints() {
-    // Placeholder constraint solver
-    m_constraintsDirty = false;
-    return true;
+    if (m_constraintsDirty) {
+        std::vector<char> grounded(m_partInstances.size());
+        for (size_t i = 0; i < m_partInstances.size(); ++i) {
+            grounded[i] = m_partInstances[i].locked || !m_partInstances[i].part;
+        }
+        
+        std::vector<AssemblySolver::Constraint> constraints;
+        for (const auto& constraint : m_constraints) {
+            if (!constraint.enabled) continue;
+            
+            AssemblySolver::Constraint solverConstraint;
+            solverConstraint.type = constraint.type;
+            solverConstraint.bodyA = constraint.partA ? findInstanceIndex(constraint.partA.get()) : -1;
+            solverConstraint.bodyB = constraint.partB ? findInstanceIndex(constraint.partB.get()) : -1;
+            // Constraints on parts that are not in the assembly are ignored
+            if ((constraint.partA && solverConstraint.bodyA < 0) || (constraint.partB && solverConstraint.bodyB < 0)) continue;
+            
+            solverConstraint.pointA = constraint.pointA.toQVector3D();
+            solverConstraint.pointB = constraint.pointB.toQVector3D();
+            solverConstraint.directionA = constraint.directionA.toQVector3D();
+            solverConstraint.directionB = constraint.directionB.toQVector3D();
+            solverConstraint.value = constraint.value;
+            constraints.push_back(solverConstraint);
+        }
+        
+        m_solver.rebuild(grounded, constraints);
+        m_constraintsDirty = false;
+    }
+    if (!m_solver.hasDirtyComponents()) return true;
+    
+    // The current placements are the starting guess, so small drags converge in a few steps
+    std::vector<QMatrix4x4> transforms(m_partInstances.size());
+    for (size_t i = 0; i < m_partInstances.size(); ++i) {
+        transforms[i] = m_partInstances[i].transform.matrix;
+    }
+    const bool solved = m_solver.solve(transforms);
+    
+    bool moved = false;
+    for (size_t i = 0; i < m_partInstances.size(); ++i) {
+        if (m_partInstances[i].transform.matrix != transforms[i]) {
+            m_partInstances[i].transform.matrix = transforms[i];
+            moved = true;
+        }
+    }
+    if (moved) markGeometryDirty();
+    return solved;
 }
 
 void Assembly::updateAssembly() {
-    if (m_constraintsDirty) {
+    if (m_constraintsDirty || m_solver.hasDirtyComponents()) {
         solveConstraints();
     }
 }
 
-Point3D Assembly::getBoundingBoxMin() const {
-    if (m_partInstances.empty()) {
-        return Point3D(0, 0, 0);
-    }
-    
-    Point3D min(std::numeric_limits<double>::max(), 
-                std::numeric_limits<double>::max(), 
-                std::numeric_limits<double>::max());
+void Assembly::getPlacedBounds(Point3D& min, Point3D& max) const {
+    min = Point3D(std::numeric_limits<double>::max(), 
+                  std::numeric_limits<double>::max(), 
+                  std::numeric_limits<double>::max());
+    max = Point3D(std::numeric_limits<double>::lowest(), 
+                  std::numeric_limits<double>::lowest(), 
+                  std::numeric_limits<double>::lowest());
     
     for (const auto& instance : m_partInstances) {
-        if (instance.visible && instance.part) {
-            // For simplicity, use basic bounding box calculation
-            Point3D partMin(-1, -1, -1);
-            Point3D partMax(1, 1, 1);
+        if (!instance.visible || !instance.part) continue;
+        
+        // Corners of the part's box in assembly space
+        const Point3D partMin = instance.part->getBoundingBoxMin();
+        const Point3D partMax = instance.part->getBoundingBoxMax();
+        for (int corner = 0; corner < 8; ++corner) {
+            QVector3D point((corner & 1) ? partMax.x : partMin.x,
+                            (corner & 2) ? partMax.y : partMin.y,
+                            (corner & 4) ? partMax.z : partMin.z);
+            point = instance.transform.matrix.map(point);
             
-            min.x = std::min(min.x, partMin.x);
-            min.y = std::min(min.y, partMin.y);
-            min.z = std::min(min.z, partMin.z);
+            min.x = std::min(min.x, static_cast<double>(point.x()));
+            min.y = std::min(min.y, static_cast<double>(point.y()));
+            min.z = std::min(min.z, static_cast<double>(point.z()));
+            max.x = std::max(max.x, static_cast<double>(point.x()));
+            max.y = std::max(max.y, static_cast<double>(point.y()));
+            max.z = std::max(max.z, static_cast<double>(point.z()));
         }
     }
     
+    if (min.x > max.x) {
+        min = Point3D(0, 0, 0);
+        max = Point3D(0, 0, 0);
+    }
+}
+
+Point3D Assembly::getBoundingBoxMin() const {
+    Point3D min, max;
+    getPlacedBounds(min, max);
     return min;
 }
 
 Point3D Assembly::getBoundingBoxMax() const {
-    if (m_partInstances.empty()) {
-        return Point3D(0, 0, 0);
-    }
-    
-    Point3D max(std::numeric_limits<double>::lowest(), 
-                std::numeric_limits<double>::lowest(), 
-                std::numeric_limits<double>::lowest());
-    
-    for (const auto& instance : m_partInstances) {
-        if (instance.visible && instance.part) {
-            // For simplicity, use basic bounding box calculation
-            Point3D partMin(-1, -1, -1);
-            Point3D partMax(1, 1, 1);
-            
-            max.x = std::max(max.x, partMax.x);
-            max.y = std::max(max.y, partMax.y);
-            max.z = std::max(max.z, partMax.z);
-        }
-    }
-    
+    Point3D min, max;
+    getPlacedBounds(min, max);
     return max;
 }
 
-bool Assembly::hasCollisions() const {
-    // Placeholder collision detection
-    return false;
+void Assembly::updateCollisions() const {
+    std::vector<CollisionDetector::Body> bodies(m_partInstances.size());
+    for (size_t i = 0; i < m_partInstances.size(); ++i) {
+        const PartInstance& instance = m_partInstances[i];
+        bodies[i].part = instance.part.get();
+        bodies[i].transform = instance.transform.matrix;
+        bodies[i].enabled = instance.visible && instance.part && instance.part->isVisible();
+    }
+    m_collisionDetector.update(bodies);
 }
 
-std::vector<std::pair<std::string, std::string>> Assembly::getCollisions() const {
-    // Placeholder collision detection
-    return {};
+bool Assembly::hasCollisions() const {
+    updateCollisions();
+    return !m_collisionDetector.collisions().empty();
 }
 
-void Assembly::applyConstraint(const AssemblyConstraint& constraint) {
-    // Placeholder constraint application
+std::vector<std::pair<std::string, std::string>> Assembly::getCollisions() const {
+    updateCollisions();
+    
+    std::vector<std::pair<std::string, std::string>> collisions;
+    for (const auto& [a, b] : m_collisionDetector.collisions()) {
+        collisions.emplace_back(m_partInstances[a].instanceName, m_partInstances[b].instanceName);
+    }
+    return collisions;
 }
 
 bool Assembly::checkCollision(const PartInstance& instanceA, const PartInstance& instanceB) const {
-    // Placeholder collision check
-    return false;
+    CollisionDetector::Body a;
+    a.part = instanceA.part.get();
+    a.transform = instanceA.transform.matrix;
+    CollisionDetector::Body b;
+    b.part = instanceB.part.get();
+    b.transform = instanceB.transform.matrix;
+    return m_collisionDetector.test(a, b);
 }
 
 // PartDocument implementation
+namespace {
+
+// Objects added to or removed from a document, with the positions they had in its list
+class ObjectListCommand : public UndoCommand {
+public:
+    ObjectListCommand(const std::string& description, PartDocument& document, bool added)
+        : UndoCommand(description), m_document(document), m_added(added) {}
+    
+    // Entries are expected in ascending index order
+    void addEntry(size_t index, CADObjectPtr object) { m_entries.emplace_back(index, std::move(object)); }
+    
+    void undo() override { m_added ? remove() : insert(); }
+    void redo() override { m_added ? insert() : remove(); }
+    
+    size_t memoryUsage(std::unordered_set<const void*>& counted) const override {
+        // The objects themselves are shared with the document, not owned by the history
+        return UndoCommand::memoryUsage(counted) + m_entries.capacity() * sizeof(m_entries[0]);
+    }
+
+private:
+    void insert() {
+        for (const auto& [index, object] : m_entries) m_document.insertObject(index, object);
+    }
+    
+    void remove() {
+        for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) m_document.removeObject(it->second);
+    }
+    
+    PartDocument& m_document;
+    std::vector<std::pair<size_t, CADObjectPtr>> m_entries;
+    bool m_added;
+};
+
+} // namespace
+
 PartDocument::PartDocument(const std::string& name) 
-    : m_name(name), m_dirty(false), m_maxUndoLevels(50) {
+    : m_name(name), m_dirty(false) {
 }
 
-void PartDocument::addObject(CADObjectPtr object) {
-    if (object) {
-        m_objects.push_back(object);
-        setDirty(true);
+PartDocument::~PartDocument() {
+    for (const auto& object : m_objects) {
+        object->removeNameObserver(this);
     }
 }
 
+void PartDocument::addObject(CADObjectPtr object) {
+    insertObject(m_objects.size(), object);
+}
+
+void PartDocument::insertObject(size_t index, CADObjectPtr object) {
+    if (!object) return;
+    
+    index = std::min(index, m_objects.size());
+    m_objects.insert(m_objects.begin() + index, object);
+    indexObject(object);
+    setDirty(true);
+    
+    auto command = std::make_unique<ObjectListCommand>("Add " + object->getName(), *this, true);
+    command->addEntry(index, object);
+    m_history.push(std::move(command));
+}
+
 void PartDocument::removeObject(CADObjectPtr object) {
-    m_objects.erase(
-        std::remove(m_objects.begin(), m_objects.end(), object),
-        m_objects.end());
+    auto it = std::find(m_objects.begin(), m_objects.end(), object);
+    if (it == m_objects.end()) return;
+    
+    auto command = std::make_unique<ObjectListCommand>("Delete " + object->getName(), *this, false);
+    command->addEntry(static_cast<size_t>(it - m_objects.begin()), object);
+    m_objects.erase(it);
+    unindexObject(object);
     setDirty(true);
+    m_history.push(std::move(command));
 }
 
 void PartDocument::clearObjects() {
+    if (m_objects.empty()) return;
+    
+    auto command = std::make_unique<ObjectListCommand>("Delete All", *this, false);
+    for (size_t i = 0; i < m_objects.size(); ++i) {
+        command->addEntry(i, m_objects[i]);
+        m_objects[i]->removeNameObserver(this);
+    }
+    m_objects.clear();
+    m_nameIndex.clear();
+    setDirty(true);
+    m_history.push(std::move(command));
+}
+
+void PartDocument::setObjects(const CADObjectList& objects) {
+    for (const auto& object : m_objects) {
+        object->removeNameObserver(this);
+    }
     m_objects.clear();
+    m_nameIndex.clear();
+    
+    m_objects.reserve(objects.size());
+    for (const auto& object : objects) {
+        if (!object) continue;
+        m_objects.push_back(object);
+        indexObject(object);
+    }
     setDirty(true);
 }
 
 CADObjectPtr PartDocument::findObject(const std::string& name) const {
+    auto range = m_nameIndex.equal_range(name);
+    if (range.first == range.second) return nullptr;
+    if (std::next(range.first) == range.second) return range.first->second;
+    
+    // Shared names are rare; the list decides which comes first
     for (const auto& object : m_objects) {
-        if (object && object->getName() == name) {
+        if (object->getName() == name) {
             return object;
         }
     }
     return nullptr;
 }
 
+std::string PartDocument::generateUniqueName(const std::string& baseName) {
+    if (!findObject(baseName)) return baseName;
+    
+    int& counter = m_nameCounters[baseName];
+    std::string name;
+    do {
+        name = baseName + "_" + std::to_string(++counter);
+    } while (findObject(name));
+    return name;
+}
+
+void PartDocument::indexObject(const CADObjectPtr& object) {
+    m_nameIndex.emplace(object->getName(), object);
+    object->addNameObserver(this);
+}
+
+void PartDocument::unindexObject(const CADObjectPtr& object) {
+    auto range = m_nameIndex.equal_range(object->getName());
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        if (entry->second == object) {
+            m_nameIndex.erase(entry);
+            break;
+        }
+    }
+    object->removeNameObserver(this);
+}
+
+void PartDocument::objectRenamed(CADObject* object, const std::string& oldName) {
+    auto range = m_nameIndex.equal_range(oldName);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        if (entry->second.get() == object) {
+            CADObjectPtr indexed = std::move(entry->second);
+            m_nameIndex.erase(entry);
+            m_nameIndex.emplace(object->getName(), std::move(indexed));
+            return;
+        }
+    }
+}
+
 void PartDocument::beginUndoGroup(const std::string& description) {
-    // Placeholder undo system
+    m_history.beginGroup(description);
 }
 
 void PartDocument::endUndoGroup() {
-    // Placeholder undo system
+    m_history.endGroup();
 }
 
-void PartDocument::addUndoCommand(const std::string& description) {
-    // Placeholder undo system
+void PartDocument::addUndoCommand(UndoCommandPtr command) {
+    m_history.push(std::move(command));
 }
 
 bool PartDocument::canUndo() const {
-    return !m_undoStack.empty();
+    return m_history.canUndo();
 }
 
 bool PartDocument::canRedo() const {
-    return !m_redoStack.empty();
+    return m_history.canRedo();
 }
 
 void PartDocument::undo() {
-    // Placeholder undo implementation
+    if (m_history.undo()) {
+        setDirty(true);
+    }
 }
 
 void PartDocument::redo() {
-    // Placeholder redo implementation
+    if (m_history.redo()) {
+        setDirty(true);
+    }
 }
 
 void PartDocument::clearHistory() {
-    m_undoStack.clear();
-    m_redoStack.clear();
+    m_history.clear();
 }
 
 // PartManager implementation
+namespace {
+
+// Deep copy sharing nothing editable with the original; operands and parts used more than once
+// are copied once. Unloaded meshes share their deferred arrays, which are never written.
+CADObjectPtr copyObject(const CADObjectPtr& object, std::unordered_map<const CADObject*, CADObjectPtr>& copies,
+                        std::vector<std::pair<CADObjectPtr, Material>>& materials) {
+    if (!object) return nullptr;
+    auto it = copies.find(object.get());
+    if (it != copies.end()) return it->second;
+    
+    CADObjectPtr copy;
+    switch (object->getType()) {
+        case ObjectType::PRIMITIVE_BOX: {
+            const auto* box = static_cast<const Box*>(object.get());
+            copy = std::make_shared<Box>(box->getMin(), box->getMax());
+            break;
+        }
+        case ObjectType::PRIMITIVE_CYLINDER: {
+            const auto* cylinder = static_cast<const Cylinder*>(object.get());
+            copy = std::make_shared<Cylinder>(cylinder->getRadius(), cylinder->getHeight(), cylinder->getSegments());
+            break;
+        }
+        case ObjectType::PRIMITIVE_SPHERE: {
+            const auto* sphere = static_cast<const Sphere*>(object.get());
+            auto sphereCopy = std::make_shared<Sphere>(sphere->getRadius(), sphere->getSegments());
+            sphereCopy->setCenter(sphere->getCenter());
+            copy = sphereCopy;
+            break;
+        }
+        case ObjectType::PRIMITIVE_CONE: {
+            const auto* cone = static_cast<const Cone*>(object.get());
+            auto coneCopy = std::make_shared<Cone>(cone->getBottomRadius(), cone->getTopRadius(), cone->getHeight(), cone->getSegments());
+            coneCopy->setCenter(cone->getCenter());
+            copy = coneCopy;
+            break;
+        }
+        case ObjectType::BOOLEAN_UNION:
+        case ObjectType::BOOLEAN_DIFFERENCE:
+        case ObjectType::BOOLEAN_INTERSECTION: {
+            const auto* boolean = static_cast<const BooleanObject*>(object.get());
+            copy = std::make_shared<BooleanObject>(copyObject(boolean->getObjectA(), copies, materials),
+                                                   copyObject(boolean->getObjectB(), copies, materials),
+                                                   boolean->getOperation());
+            break;
+        }
+        case ObjectType::MESH: {
+            const auto* mesh = static_cast<const MeshObject*>(object.get());
+            auto meshCopy = std::make_shared<MeshObject>();
+            if (auto deferred = mesh->getDeferredGeometry()) {
+                meshCopy->setDeferredGeometry(std::move(deferred), mesh->getBoundingBoxMin(), mesh->getBoundingBoxMax());
+            } else {
+                meshCopy->restoreSnapshot(*mesh->takeSnapshot());
+            }
+            copy = meshCopy;
+            break;
+        }
+        case ObjectType::ASSEMBLY: {
+            const auto* assembly = static_cast<const Assembly*>(object.get());
+            auto assemblyCopy = std::make_shared<Assembly>();
+            for (const PartInstance& instance : assembly->getPartInstances()) {
+                CADObjectPtr part = copyObject(instance.part, copies, materials);
+                if (!part) continue;
+                // Names can repeat, so the whole instance goes into the slot just added
+                if (PartInstance* instanceCopy = assemblyCopy->addPart(part, instance.instanceName)) {
+                    *instanceCopy = instance;
+                    instanceCopy->part = part;
+                }
+            }
+            for (AssemblyConstraint constraint : assembly->getConstraints()) {
+                constraint.partA = copyObject(constraint.partA, copies, materials);
+                constraint.partB = copyObject(constraint.partB, copies, materials);
+                assemblyCopy->addConstraint(constraint);
+            }
+            copy = assemblyCopy;
+            break;
+        }
+        default:
+            return nullptr;
+    }
+    
+    copy->setName(object->getName());
+    copy->setVisible(object->isVisible());
+    materials.emplace_back(copy, object->getMaterial());
+    copies.emplace(object.get(), copy);
+    return copy;
+}
+
+CADObjectPtr copyObject(const CADObjectPtr& object) {
+    std::unordered_map<const CADObject*, CADObjectPtr> copies;
+    std::vector<std::pair<CADObjectPtr, Material>> materials;
+    CADObjectPtr copy = copyObject(object, copies, materials);
+    // Adding parts to nested assemblies adjusts their materials, so the originals go on last
+    for (const auto& [target, material] : materials) {
+        target->setMaterial(material);
+    }
+    return copy;
+}
+
+} // namespace
+
 PartManager::PartManager() {
 }
 
@@ -312,7 +735,12 @@ bool PartManager::saveDocument(std::shared_ptr<PartDocument> document) {
         return false;
     }
     
-    return saveToFile(document->getFilePath(), document);
+    if (!saveToFile(document->getFilePath(), document)) {
+        return false;
+    }
+    
+    document->setDirty(false);
+    return true;
 }
 
 bool PartManager::saveDocumentAs(std::shared_ptr<PartDocument> document, const std::string& filePath) {
@@ -349,74 +777,87 @@ std::shared_ptr<Assembly> PartManager::createAssembly(const std::string& name) {
     return std::make_shared<Assembly>(name);
 }
 
+bool PartManager::openLibrary(const std::string& directory) {
+    m_library.setSaveOptions(m_saveOptions);
+    return m_library.open(directory);
+}
+
 void PartManager::addToLibrary(CADObjectPtr part, const std::string& category) {
-    if (!part) return;
+    if (!part || !m_library.add(part, part->getName(), category)) return;
     
-    LibraryEntry entry;
-    entry.part = part;
-    entry.name = part->getName();
-    entry.category = category;
-    entry.description = "";
-    entry.thumbnailPath = "";
-    
-    m_libraryParts.push_back(entry);
-    m_libraryCategories[category].push_back(entry.name);
+    // Rendered ahead of browsing; a no-op when the part is already in the cache
+    getThumbnailRenderer()->request(part);
 }
 
 void PartManager::removeFromLibrary(const std::string& name) {
-    m_libraryParts.erase(
-        std::remove_if(m_libraryParts.begin(), m_libraryParts.end(),
-                      [&name](const LibraryEntry& entry) { 
-                          return entry.name == name; 
-                      }),
-        m_libraryParts.end());
+    m_library.remove(name);
 }
 
-CADObjectPtr PartManager::getFromLibrary(const std::string& name) const {
-    for (const auto& entry : m_libraryParts) {
-        if (entry.name == name) {
-            return entry.part;
-        }
-    }
-    return nullptr;
+CADObjectPtr PartManager::getFromLibrary(const std::string& name) {
+    return m_library.get(name);
 }
 
 std::vector<std::string> PartManager::getLibraryCategories() const {
-    std::vector<std::string> categories;
-    for (const auto& pair : m_libraryCategories) {
-        categories.push_back(pair.first);
-    }
-    return categories;
+    return m_library.getCategories();
 }
 
 std::vector<std::string> PartManager::getLibraryParts(const std::string& category) const {
-    auto it = m_libraryCategories.find(category);
-    if (it != m_libraryCategories.end()) {
-        return it->second;
-    }
-    return {};
+    return m_library.getParts(category);
 }
 
-void PartManager::saveAsTemplate(CADObjectPtr object, const std::string& name, const std::string& category) {
-    if (!object) return;
+std::string PartManager::getLibraryThumbnail(const std::string& name) {
+    const PartLibrary::Entry* entry = m_library.findEntry(name);
+    if (!entry) return "";
     
-    LibraryEntry entry;
-    entry.part = object;
-    entry.name = name;
-    entry.category = category;
-    entry.description = "";
-    entry.thumbnailPath = "";
+    // A part not in memory is exactly what its file holds, so its last thumbnail still stands
+    if (!m_library.isResident(name) && !entry->thumbnailPath.empty() &&
+        QFileInfo::exists(QString::fromStdString(entry->thumbnailPath))) {
+        return entry->thumbnailPath;
+    }
     
-    m_templates.push_back(entry);
+    // Parts edited since their last thumbnail get a new one queued and none meanwhile
+    const std::string thumbnailPath = getThumbnailRenderer()->request(m_library.get(name)).toStdString();
+    if (!thumbnailPath.empty()) {
+        m_library.setThumbnailPath(name, thumbnailPath);
+    }
+    return thumbnailPath;
 }
 
-CADObjectPtr PartManager::createFromTemplate(const std::string& name) const {
-    for (const auto& entry : m_templates) {
-        if (entry.name == name) {
-            return entry.part; // In a real implementation, this would create a copy
+void PartManager::requestLibraryThumbnails(const std::string& category) {
+    std::vector<CADObjectPtr> parts;
+    for (const std::string& name : m_library.getParts(category)) {
+        const PartLibrary::Entry* entry = m_library.findEntry(name);
+        if (!m_library.isResident(name) && !entry->thumbnailPath.empty() &&
+            QFileInfo::exists(QString::fromStdString(entry->thumbnailPath))) {
+            continue;
+        }
+        if (CADObjectPtr part = m_library.get(name)) {
+            parts.push_back(std::move(part));
         }
     }
-    return nullptr;
+    getThumbnailRenderer()->requestBatch(parts);
+}
+
+ThumbnailRenderer* PartManager::getThumbnailRenderer() {
+    if (!m_thumbnailRenderer) {
+        const QString cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+        m_thumbnailRenderer = std::make_unique<ThumbnailRenderer>(cacheDirectory);
+    }
+    return m_thumbnailRenderer.get();
+}
+
+void PartManager::saveAsTemplate(CADObjectPtr object, const std::string& name, const std::string& category) {
+    if (!object) return;
+    
+    // Later edits to the object do not reach the template
+    if (CADObjectPtr copy = copyObject(object)) {
+        m_templates.add(copy, name, category);
+    }
+}
+
+CADObjectPtr PartManager::createFromTemplate(const std::string& name) {
+    // Each use gets an object of its own to edit
+    return copyObject(m_templates.get(name));
 }
 
 bool PartManager::importSTEP(const std::string& filePath, std::shared_ptr<PartDocument> document) {
@@ -439,8 +880,13 @@ bool PartManager::exportIGES(const std::string& filePath, std::shared_ptr<PartDo
     return false;
 }
 
-void PartManager::generateThumbnail(CADObjectPtr object, const std::string& imagePath) {
-    // Placeholder thumbnail generation
+bool PartManager::generateThumbnail(CADObjectPtr object, const std::string& imagePath) {
+    const QString cached = getThumbnailRenderer()->render(object);
+    if (cached.isEmpty()) return false;
+    
+    const QString target = QString::fromStdString(imagePath);
+    QFile::remove(target);
+    return QFile::copy(cached, target);
 }
 
 void PartManager::optimizeForPerformance(CADObjectPtr object) {
@@ -462,26 +908,15 @@ void PartManager::validateGeometry(CADObjectPtr object, std::vector<std::string>
 }
 
 bool PartManager::loadFromFile(const std::string& filePath, std::shared_ptr<PartDocument> document) {
-    // Placeholder file loading
-    return false;
+    return document && DocumentIO::load(filePath, *document);
 }
 
 bool PartManager::saveToFile(const std::string& filePath, std::shared_ptr<PartDocument> document) {
-    // Placeholder file saving
-    return false;
+    return document && DocumentIO::save(filePath, *document, m_saveOptions);
 }
 
 std::string PartManager::generateUniqueObjectName(const std::string& baseName, std::shared_ptr<PartDocument> document) {
-    if (!document) return baseName;
-    
-    std::string name = baseName;
-    int counter = 1;
-    
-    while (document->findObject(name)) {
-        name = baseName + "_" + std::to_string(counter++);
-    }
-    
-    return name;
+    return document ? document->generateUniqueName(baseName) : baseName;
 }
 
 } // namespace HybridCAD 
\ No newline at end of file
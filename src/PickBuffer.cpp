@@ -0,0 +1,114 @@
+#include "PickBuffer.h"
+#include <algorithm>
+
+namespace HybridCAD {
+
+PickBuffer::PickBuffer()
+    : m_gl(nullptr)
+    , m_current(false) {
+}
+
+PickBuffer::~PickBuffer() = default;
+
+void PickBuffer::initialize(QOpenGLExtraFunctions* gl) {
+    m_gl = gl;
+    m_packBuffer.create();
+    m_packBuffer.setUsagePattern(QOpenGLBuffer::StreamRead);
+}
+
+void PickBuffer::destroy() {
+    m_fbo.reset();
+    m_packBuffer.destroy();
+    m_current = false;
+}
+
+bool PickBuffer::resize(const QSize& size) {
+    if (!m_gl || size.width() <= 0 || size.height() <= 0) return false;
+    if (m_fbo && m_fbo->width() == size.width() && m_fbo->height() == size.height()) {
+        return m_fbo->isValid();
+    }
+
+    m_current = false;
+    m_fbo = std::make_unique<QOpenGLFramebufferObject>(size.width(), size.height(),
+                                                       QOpenGLFramebufferObject::Depth, GL_TEXTURE_2D, GL_RGBA8);
+    if (!m_fbo->isValid() || !m_fbo->addColorAttachment(size, GL_RGBA8)) {
+        m_fbo.reset();
+        return false;
+    }
+    return true;
+}
+
+bool PickBuffer::isValid() const {
+    return m_fbo && m_fbo->isValid();
+}
+
+QSize PickBuffer::size() const {
+    return m_fbo ? m_fbo->size() : QSize();
+}
+
+void PickBuffer::bind() {
+    if (!isValid()) return;
+    m_fbo->bind();
+    static const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    m_gl->glDrawBuffers(2, drawBuffers);
+    m_gl->glViewport(0, 0, m_fbo->width(), m_fbo->height());
+}
+
+void PickBuffer::clear() {
+    m_gl->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    m_gl->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void PickBuffer::release(GLuint framebuffer) {
+    if (!m_gl) return;
+    m_gl->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+bool PickBuffer::readIds(int attachment, const QRect& rect, std::vector<uint32_t>& ids) {
+    ids.clear();
+    if (!isValid()) return false;
+
+    const int targetWidth = m_fbo->width();
+    const int targetHeight = m_fbo->height();
+    const int left = std::max(rect.x(), 0);
+    const int top = std::max(rect.y(), 0);
+    const int right = std::min(rect.x() + rect.width(), targetWidth);
+    const int bottom = std::min(rect.y() + rect.height(), targetHeight);
+    if (left >= right || top >= bottom) return false;
+
+    const int width = right - left;
+    const int height = bottom - top;
+    const int bytes = width * height * 4;
+
+    m_packBuffer.bind();
+    if (m_packBuffer.size() < bytes) {
+        m_packBuffer.allocate(bytes);
+    }
+
+    // GL rows run bottom-up
+    m_gl->glReadBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+    m_gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    m_gl->glReadPixels(left, targetHeight - bottom, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    const auto* pixels = static_cast<const unsigned char*>(
+        m_gl->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT));
+    if (pixels) {
+        ids.resize(static_cast<size_t>(width) * height);
+        for (int row = 0; row < height; ++row) {
+            const unsigned char* source = pixels + static_cast<size_t>(height - 1 - row) * width * 4;
+            uint32_t* destination = &ids[static_cast<size_t>(row) * width];
+            for (int column = 0; column < width; ++column) {
+                destination[column] = decodeId(source + column * 4);
+            }
+        }
+        m_gl->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    m_packBuffer.release();
+    return pixels != nullptr;
+}
+
+QVector4D PickBuffer::encodeId(uint32_t id) {
+    return QVector4D((id & 0xFF) / 255.0f, ((id >> 8) & 0xFF) / 255.0f, ((id >> 16) & 0xFF) / 255.0f, 1.0f);
+}
+
+} // namespace HybridCAD
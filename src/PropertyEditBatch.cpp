@@ -0,0 +1,87 @@
+#include "PropertyEditBatch.h"
+#include <unordered_set>
+
+namespace HybridCAD {
+
+PropertyEditBatch::PropertyEditBatch(QObject* parent)
+    : QObject(parent)
+    , m_frameTimer(new QTimer(this))
+    , m_idleTimer(new QTimer(this))
+{
+    // Started by the first edit of a frame and not restarted, so a drag still applies every frame
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setInterval(FRAME_INTERVAL_MS);
+    connect(m_frameTimer, &QTimer::timeout, this, &PropertyEditBatch::flush);
+
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(COMMIT_IDLE_MS);
+    connect(m_idleTimer, &QTimer::timeout, this, &PropertyEditBatch::commit);
+}
+
+void PropertyEditBatch::stageEdit(const EditKey& key, Edit edit) {
+    auto it = m_pendingIndex.find(key);
+    if (it != m_pendingIndex.end()) {
+        m_pending[it->second] = std::move(edit);
+    } else {
+        m_pendingIndex.emplace(key, m_pending.size());
+        m_pending.push_back(std::move(edit));
+    }
+
+    if (!m_frameTimer->isActive()) {
+        m_frameTimer->start();
+    }
+    m_idleTimer->start();
+}
+
+void PropertyEditBatch::flush() {
+    m_frameTimer->stop();
+    if (m_pending.empty()) return;
+
+    // Taken first: listeners may stage more edits from objectsChanged()
+    std::vector<Edit> edits;
+    edits.swap(m_pending);
+    m_pendingIndex.clear();
+
+    std::vector<CADObjectPtr> objects;
+    std::unordered_set<const CADObject*> seen;
+    int changes = 0;
+    for (Edit& edit : edits) {
+        edit.apply();
+        changes |= edit.change;
+        if (seen.insert(edit.object.get()).second) {
+            objects.push_back(std::move(edit.object));
+        }
+    }
+
+    emit objectsChanged(objects, changes);
+}
+
+void PropertyEditBatch::commit() {
+    flush();
+    m_idleTimer->stop();
+    if (m_gesture.empty()) return;
+
+    std::vector<UndoCommandPtr> commands;
+    commands.reserve(m_gestureOrder.size());
+    for (const EditKey& key : m_gestureOrder) {
+        if (UndoCommandPtr command = m_gesture[key]()) {
+            commands.push_back(std::move(command));
+        }
+    }
+    m_gesture.clear();
+    m_gestureOrder.clear();
+
+    if (!m_recorder || commands.empty()) return;
+    if (commands.size() == 1) {
+        m_recorder(std::move(commands.front()));
+        return;
+    }
+
+    auto group = std::make_unique<UndoGroup>("Edit properties");
+    for (auto& command : commands) {
+        group->add(std::move(command));
+    }
+    m_recorder(std::move(group));
+}
+
+} // namespace HybridCAD
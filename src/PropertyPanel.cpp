@@ -1,35 +1,139 @@
 #include "PropertyPanel.h"
+#include "GeometryManager.h"
+#include "PartManager.h"
+#include "PropertyEditBatch.h"
+#include <algorithm>
 
 namespace HybridCAD {
 
+namespace {
+
+// Edits staged for the same object and key within a frame replace each other
+enum PropertyKey {
+    KEY_NAME,
+    KEY_VISIBILITY,
+    KEY_MATERIAL_NAME,
+    KEY_SHININESS,
+    KEY_TRANSPARENCY,
+    KEY_DIFFUSE_COLOR,
+    KEY_SPECULAR_COLOR,
+    KEY_POSITION,
+    KEY_BOX_MIN,
+    KEY_BOX_MAX,
+    KEY_RADIUS,
+    KEY_TOP_RADIUS,
+    KEY_HEIGHT,
+    KEY_SEGMENTS
+};
+
+// point moved by the step from one position to another
+Point3D offsetBy(const Point3D& point, const Point3D& from, const Point3D& to) {
+    return Point3D(point.x + to.x - from.x, point.y + to.y - from.y, point.z + to.z - from.z);
+}
+
+// Placement of the primitives that have one; cylinders are always built around the origin
+bool objectCenter(const CADObject& object, Point3D& center) {
+    if (auto box = dynamic_cast<const Box*>(&object)) {
+        const Point3D min = box->getMin();
+        const Point3D max = box->getMax();
+        center = Point3D((min.x + max.x) / 2, (min.y + max.y) / 2, (min.z + max.z) / 2);
+        return true;
+    }
+    if (auto sphere = dynamic_cast<const Sphere*>(&object)) {
+        center = sphere->getCenter();
+        return true;
+    }
+    if (auto cone = dynamic_cast<const Cone*>(&object)) {
+        center = cone->getCenter();
+        return true;
+    }
+    return false;
+}
+
+Point3D centerOf(const CADObject& object) {
+    Point3D center;
+    objectCenter(object, center);
+    return center;
+}
+
+void moveCenter(CADObject& object, const Point3D& center) {
+    if (auto box = dynamic_cast<Box*>(&object)) {
+        const Point3D current = centerOf(*box);
+        box->setDimensions(offsetBy(box->getMin(), current, center), offsetBy(box->getMax(), current, center));
+    } else if (auto sphere = dynamic_cast<Sphere*>(&object)) {
+        sphere->setCenter(center);
+    } else if (auto cone = dynamic_cast<Cone*>(&object)) {
+        cone->setCenter(center);
+    }
+}
+
+template <typename T>
+void stageMaterial(PropertyEditBatch& batch, const CADObjectPtr& object, int key, const std::string& description,
+                   T Material::*field, const T& value) {
+    batch.stage<CADObject, T>(object, key, PROPERTY_MATERIAL, description,
+        [field](const CADObject& target) { return target.getMaterial().*field; },
+        [field](CADObject& target, const T& newValue) {
+            Material material = target.getMaterial();
+            material.*field = newValue;
+            target.setMaterial(material);
+        },
+        value);
+}
+
+// The same value for one parameter of each object
+template <typename Object, typename T>
+void stageParameter(PropertyEditBatch& batch, const std::vector<std::shared_ptr<Object>>& objects, int key,
+                    const std::string& description, T (Object::*getter)() const,
+                    std::function<void(Object&, const T&)> setter, const T& value) {
+    for (const auto& object : objects) {
+        batch.stage<Object, T>(object, key, PROPERTY_GEOMETRY, description,
+                               [getter](const Object& target) { return (target.*getter)(); }, setter, value);
+    }
+}
+
+} // namespace
+
 PropertyPanel::PropertyPanel(QWidget *parent)
     : QWidget(parent)
     , m_currentObject(nullptr)
+    , m_editBatch(new PropertyEditBatch(this))
+    , m_document(nullptr)
     , m_updating(false)
 {
     setupUI();
+    connect(m_editBatch, &PropertyEditBatch::objectsChanged, this, &PropertyPanel::onEditsApplied);
 }
 
 PropertyPanel::~PropertyPanel() {
 }
 
 void PropertyPanel::setSelectedObject(CADObjectPtr object) {
-    if (m_currentObject == object) return;
+    setSelectedObjects(object ? std::vector<CADObjectPtr>{ object } : std::vector<CADObjectPtr>());
+}
+
+void PropertyPanel::setSelectedObjects(const std::vector<CADObjectPtr>& objects) {
+    // An open gesture is recorded against the objects it was made on
+    m_editBatch->commit();
     
     disconnectSignals();
-    m_currentObject = object;
+    m_objects = objects;
+    m_currentObject = objects.empty() ? nullptr : objects.front();
     updateProperties();
     connectSignals();
 }
 
 void PropertyPanel::clearSelection() {
+    m_editBatch->commit();
     disconnectSignals();
+    m_objects.clear();
     m_currentObject = nullptr;
     
     // Clear all controls
+    m_updating = true;
     m_nameEdit->clear();
     m_visibilityCheck->setChecked(false);
     m_typeCombo->setCurrentIndex(0);
+    m_updating = false;
     
     clearGeometryProperties();
 }
@@ -50,47 +154,170 @@ void PropertyPanel::updateProperties() {
     m_updating = false;
 }
 
+void PropertyPanel::refreshObjects(const std::vector<CADObjectPtr>& objects) {
+    // Values being edited here are already shown, and re-setting them would fight the drag
+    if (!m_currentObject || m_editBatch->inGesture()) return;
+    
+    if (std::find(objects.begin(), objects.end(), m_currentObject) != objects.end()) {
+        updateProperties();
+    }
+}
+
 void PropertyPanel::onNameChanged() {
     if (m_updating || !m_currentObject) return;
     
-    m_currentObject->setName(m_nameEdit->text().toStdString());
-    emit propertyChanged();
+    std::string name = m_nameEdit->text().toStdString();
+    if (name == m_currentObject->getName()) return;
+    if (name.empty()) {
+        m_nameEdit->setText(QString::fromStdString(m_currentObject->getName()));
+        return;
+    }
+    
+    // Names are unique, so only the shown object is renamed; a taken name gets a number
+    if (m_document) {
+        name = m_document->generateUniqueName(name);
+        m_nameEdit->setText(QString::fromStdString(name));
+    }
+    m_editBatch->stage<CADObject, std::string>(m_currentObject, KEY_NAME, PROPERTY_NAME, "Rename",
+        [](const CADObject& object) { return object.getName(); },
+        [](CADObject& object, const std::string& value) { object.setName(value); },
+        name);
 }
 
 void PropertyPanel::onVisibilityChanged(bool visible) {
     if (m_updating || !m_currentObject) return;
     
-    m_currentObject->setVisible(visible);
-    emit propertyChanged();
+    for (const auto& object : m_objects) {
+        m_editBatch->stage<CADObject, bool>(object, KEY_VISIBILITY, PROPERTY_VISIBILITY, visible ? "Show" : "Hide",
+            [](const CADObject& target) { return target.isVisible(); },
+            [](CADObject& target, const bool& value) { target.setVisible(value); },
+            visible);
+    }
+    m_editBatch->commit();
 }
 
 void PropertyPanel::onMaterialChanged() {
     if (m_updating || !m_currentObject) return;
     
-    // Update material properties based on UI controls
-    Material material = m_currentObject->getMaterial();
-    
-    material.name = m_materialNameEdit->text().toStdString();
-    material.shininess = m_shininessSlider->value();
-    material.transparency = m_transparencySlider->value() / 100.0f;
-
-    m_currentObject->setMaterial(material);
-    
-    emit propertyChanged();
+    // Only the control that moved is applied, so the objects keep their other material settings
+    QObject* source = sender();
+    for (const auto& object : m_objects) {
+        if (source == m_materialNameEdit) {
+            stageMaterial(*m_editBatch, object, KEY_MATERIAL_NAME, "Material name", &Material::name,
+                          m_materialNameEdit->text().toStdString());
+        } else if (source == m_shininessSlider) {
+            stageMaterial(*m_editBatch, object, KEY_SHININESS, "Shininess", &Material::shininess,
+                          static_cast<float>(m_shininessSlider->value()));
+        } else if (source == m_transparencySlider) {
+            stageMaterial(*m_editBatch, object, KEY_TRANSPARENCY, "Transparency", &Material::transparency,
+                          m_transparencySlider->value() / 100.0f);
+        }
+    }
 }
 
 void PropertyPanel::onTransformChanged() {
     if (m_updating || !m_currentObject) return;
     
-    // Transform changes would be handled here
-    emit propertyChanged();
+    // Rotation and scale have no counterpart on the objects yet; only positions are applied
+    Point3D shown;
+    if (!objectCenter(*m_currentObject, shown)) return;
+    
+    // The others move along, keeping their offsets from the shown object. Neither center has
+    // had this frame's earlier edits applied yet, so the offset is the same for every tick.
+    const Point3D target(m_posXSpin->value(), m_posYSpin->value(), m_posZSpin->value());
+    for (const auto& object : m_objects) {
+        Point3D center;
+        if (!objectCenter(*object, center)) continue;
+        m_editBatch->stage<CADObject, Point3D>(object, KEY_POSITION, PROPERTY_GEOMETRY, "Move",
+            [](const CADObject& moved) { return centerOf(moved); },
+            [](CADObject& moved, const Point3D& position) { moveCenter(moved, position); },
+            offsetBy(center, shown, target));
+    }
 }
 
 void PropertyPanel::onGeometryParameterChanged() {
     if (m_updating || !m_currentObject) return;
     
-    // Update geometry-specific parameters
-    emit propertyChanged();
+    QObject* source = sender();
+    switch (m_currentObject->getType()) {
+        case ObjectType::PRIMITIVE_BOX: {
+            auto shown = std::dynamic_pointer_cast<Box>(m_currentObject);
+            if (!shown) break;
+            
+            // Corners move by the same step on every box, keeping their sizes and offsets apart
+            const bool minCorner = source == m_boxMinXSpin || source == m_boxMinYSpin || source == m_boxMinZSpin;
+            const Point3D from = minCorner ? shown->getMin() : shown->getMax();
+            const Point3D to = minCorner ? Point3D(m_boxMinXSpin->value(), m_boxMinYSpin->value(), m_boxMinZSpin->value())
+                                         : Point3D(m_boxMaxXSpin->value(), m_boxMaxYSpin->value(), m_boxMaxZSpin->value());
+            for (const auto& box : selectedLikeCurrent<Box>()) {
+                if (minCorner) {
+                    m_editBatch->stage<Box, Point3D>(box, KEY_BOX_MIN, PROPERTY_GEOMETRY, "Box minimum",
+                        [](const Box& target) { return target.getMin(); },
+                        [](Box& target, const Point3D& min) { target.setDimensions(min, target.getMax()); },
+                        offsetBy(box->getMin(), from, to));
+                } else {
+                    m_editBatch->stage<Box, Point3D>(box, KEY_BOX_MAX, PROPERTY_GEOMETRY, "Box maximum",
+                        [](const Box& target) { return target.getMax(); },
+                        [](Box& target, const Point3D& max) { target.setDimensions(target.getMin(), max); },
+                        offsetBy(box->getMax(), from, to));
+                }
+            }
+            break;
+        }
+        case ObjectType::PRIMITIVE_CYLINDER: {
+            const auto cylinders = selectedLikeCurrent<Cylinder>();
+            if (source == m_cylinderRadiusSpin) {
+                stageParameter<Cylinder, float>(*m_editBatch, cylinders, KEY_RADIUS, "Radius", &Cylinder::getRadius,
+                    [](Cylinder& c, const float& radius) { c.setParameters(radius, c.getHeight(), c.getSegments()); },
+                    static_cast<float>(m_cylinderRadiusSpin->value()));
+            } else if (source == m_cylinderHeightSpin) {
+                stageParameter<Cylinder, float>(*m_editBatch, cylinders, KEY_HEIGHT, "Height", &Cylinder::getHeight,
+                    [](Cylinder& c, const float& height) { c.setParameters(c.getRadius(), height, c.getSegments()); },
+                    static_cast<float>(m_cylinderHeightSpin->value()));
+            } else if (source == m_cylinderSegmentsSpin) {
+                stageParameter<Cylinder, int>(*m_editBatch, cylinders, KEY_SEGMENTS, "Segments", &Cylinder::getSegments,
+                    [](Cylinder& c, const int& segments) { c.setParameters(c.getRadius(), c.getHeight(), segments); },
+                    m_cylinderSegmentsSpin->value());
+            }
+            break;
+        }
+        case ObjectType::PRIMITIVE_SPHERE: {
+            const auto spheres = selectedLikeCurrent<Sphere>();
+            if (source == m_sphereRadiusSpin) {
+                stageParameter<Sphere, float>(*m_editBatch, spheres, KEY_RADIUS, "Radius", &Sphere::getRadius,
+                    [](Sphere& s, const float& radius) { s.setParameters(radius, s.getSegments()); },
+                    static_cast<float>(m_sphereRadiusSpin->value()));
+            } else if (source == m_sphereSegmentsSpin) {
+                stageParameter<Sphere, int>(*m_editBatch, spheres, KEY_SEGMENTS, "Segments", &Sphere::getSegments,
+                    [](Sphere& s, const int& segments) { s.setParameters(s.getRadius(), segments); },
+                    m_sphereSegmentsSpin->value());
+            }
+            break;
+        }
+        case ObjectType::PRIMITIVE_CONE: {
+            const auto cones = selectedLikeCurrent<Cone>();
+            if (source == m_coneBottomRadiusSpin) {
+                stageParameter<Cone, float>(*m_editBatch, cones, KEY_RADIUS, "Bottom radius", &Cone::getBottomRadius,
+                    [](Cone& c, const float& radius) { c.setParameters(radius, c.getTopRadius(), c.getHeight(), c.getSegments()); },
+                    static_cast<float>(m_coneBottomRadiusSpin->value()));
+            } else if (source == m_coneTopRadiusSpin) {
+                stageParameter<Cone, float>(*m_editBatch, cones, KEY_TOP_RADIUS, "Top radius", &Cone::getTopRadius,
+                    [](Cone& c, const float& radius) { c.setParameters(c.getBottomRadius(), radius, c.getHeight(), c.getSegments()); },
+                    static_cast<float>(m_coneTopRadiusSpin->value()));
+            } else if (source == m_coneHeightSpin) {
+                stageParameter<Cone, float>(*m_editBatch, cones, KEY_HEIGHT, "Height", &Cone::getHeight,
+                    [](Cone& c, const float& height) { c.setParameters(c.getBottomRadius(), c.getTopRadius(), height, c.getSegments()); },
+                    static_cast<float>(m_coneHeightSpin->value()));
+            } else if (source == m_coneSegmentsSpin) {
+                stageParameter<Cone, int>(*m_editBatch, cones, KEY_SEGMENTS, "Segments", &Cone::getSegments,
+                    [](Cone& c, const int& segments) { c.setParameters(c.getBottomRadius(), c.getTopRadius(), c.getHeight(), segments); },
+                    m_coneSegmentsSpin->value());
+            }
+            break;
+        }
+        default:
+            break;
+    }
 }
 
 void PropertyPanel::onColorChanged() {
@@ -101,35 +328,58 @@ void PropertyPanel::onColorChanged() {
     
     QColor color = QColorDialog::getColor(Qt::white, this);
     if (color.isValid()) {
-        Material material = m_currentObject->getMaterial();
-        
-        if (button == m_diffuseColorButton) {
-            material.diffuseColor = color;
-        } else if (button == m_specularColorButton) {
-            material.specularColor = color;
+        for (const auto& object : m_objects) {
+            if (button == m_diffuseColorButton) {
+                stageMaterial(*m_editBatch, object, KEY_DIFFUSE_COLOR, "Diffuse color", &Material::diffuseColor, color);
+            } else if (button == m_specularColorButton) {
+                stageMaterial(*m_editBatch, object, KEY_SPECULAR_COLOR, "Specular color", &Material::specularColor, color);
+            }
         }
-        
-        m_currentObject->setMaterial(material);
+        m_editBatch->commit();
         
         // Update button color
         QPalette palette = button->palette();
         palette.setColor(QPalette::Button, color);
         button->setPalette(palette);
-        
-        emit propertyChanged();
     }
 }
 
 void PropertyPanel::onApplyChanges() {
+    m_editBatch->commit();
     if (m_currentObject) {
         emit objectModified(m_currentObject);
     }
 }
 
 void PropertyPanel::onResetChanges() {
+    m_editBatch->commit();
     updateProperties();
 }
 
+void PropertyPanel::onEditFinished() {
+    m_editBatch->commit();
+}
+
+void PropertyPanel::onEditsApplied(const std::vector<CADObjectPtr>& objects, int changes) {
+    emit objectsChanged(objects, changes);
+    emit propertyChanged();
+}
+
+template <typename Object>
+std::vector<std::shared_ptr<Object>> PropertyPanel::selectedLikeCurrent() const {
+    std::vector<std::shared_ptr<Object>> objects;
+    if (!m_currentObject) return objects;
+    
+    const ObjectType type = m_currentObject->getType();
+    for (const auto& object : m_objects) {
+        if (object->getType() != type) continue;
+        if (auto typed = std::dynamic_pointer_cast<Object>(object)) {
+            objects.push_back(std::move(typed));
+        }
+    }
+    return objects;
+}
+
 void PropertyPanel::setupUI() {
     m_scrollArea = new QScrollArea(this);
     m_contentWidget = new QWidget();
@@ -305,8 +555,8 @@ void PropertyPanel::createGeometryProperties() {
     m_geometryLayout->addWidget(m_geometryWidget);
     
     // Box properties
-    QWidget* boxWidget = new QWidget();
-    QVBoxLayout* boxLayout = new QVBoxLayout(boxWidget);
+    m_boxWidget = new QWidget();
+    QVBoxLayout* boxLayout = new QVBoxLayout(m_boxWidget);
     
     QWidget* minWidget = createSpinBoxRow("Min:", m_boxMinXSpin);
     boxLayout->addWidget(minWidget);
@@ -323,8 +573,8 @@ void PropertyPanel::createGeometryProperties() {
     boxLayout->addWidget(maxZWidget);
     
     // Cylinder properties
-    QWidget* cylinderWidget = new QWidget();
-    QVBoxLayout* cylinderLayout = new QVBoxLayout(cylinderWidget);
+    m_cylinderWidget = new QWidget();
+    QVBoxLayout* cylinderLayout = new QVBoxLayout(m_cylinderWidget);
     
     QWidget* radiusWidget = createSpinBoxRow("Radius:", m_cylinderRadiusSpin, 0.01, 1000.0);
     cylinderLayout->addWidget(radiusWidget);
@@ -333,12 +583,29 @@ void PropertyPanel::createGeometryProperties() {
     QWidget* segmentsWidget = createIntSpinBoxRow("Segments:", m_cylinderSegmentsSpin, 3, 128);
     cylinderLayout->addWidget(segmentsWidget);
     
-    // Initially hide all geometry widgets
-    boxWidget->hide();
-    cylinderWidget->hide();
+    // Sphere properties
+    m_sphereWidget = new QWidget();
+    QVBoxLayout* sphereLayout = new QVBoxLayout(m_sphereWidget);
+    
+    sphereLayout->addWidget(createSpinBoxRow("Radius:", m_sphereRadiusSpin, 0.01, 1000.0));
+    sphereLayout->addWidget(createIntSpinBoxRow("Segments:", m_sphereSegmentsSpin, 3, 128));
+    
+    // Cone properties
+    m_coneWidget = new QWidget();
+    QVBoxLayout* coneLayout = new QVBoxLayout(m_coneWidget);
+    
+    coneLayout->addWidget(createSpinBoxRow("Bottom Radius:", m_coneBottomRadiusSpin, 0.0, 1000.0));
+    coneLayout->addWidget(createSpinBoxRow("Top Radius:", m_coneTopRadiusSpin, 0.0, 1000.0));
+    coneLayout->addWidget(createSpinBoxRow("Height:", m_coneHeightSpin, 0.01, 1000.0));
+    coneLayout->addWidget(createIntSpinBoxRow("Segments:", m_coneSegmentsSpin, 3, 128));
     
-    m_geometryLayout->addWidget(boxWidget);
-    m_geometryLayout->addWidget(cylinderWidget);
+    m_geometryLayout->addWidget(m_boxWidget);
+    m_geometryLayout->addWidget(m_cylinderWidget);
+    m_geometryLayout->addWidget(m_sphereWidget);
+    m_geometryLayout->addWidget(m_coneWidget);
+    
+    // Initially hide all geometry widgets
+    clearGeometryProperties();
     
     m_mainLayout->addWidget(m_geometryGroup);
 }
@@ -366,10 +633,15 @@ void PropertyPanel::updateGeneralProperties() {
 void PropertyPanel::updateTransformProperties() {
     if (!m_currentObject) return;
     
-    // For now, set default transform values
-    setSpinBoxValue(m_posXSpin, 0.0);
-    setSpinBoxValue(m_posYSpin, 0.0);
-    setSpinBoxValue(m_posZSpin, 0.0);
+    // Position is the primitive's center; objects without one cannot be moved from here
+    Point3D center;
+    const bool movable = objectCenter(*m_currentObject, center);
+    setSpinBoxValue(m_posXSpin, center.x);
+    setSpinBoxValue(m_posYSpin, center.y);
+    setSpinBoxValue(m_posZSpin, center.z);
+    m_posXSpin->setEnabled(movable);
+    m_posYSpin->setEnabled(movable);
+    m_posZSpin->setEnabled(movable);
     
     setSpinBoxValue(m_rotXSpin, 0.0);
     setSpinBoxValue(m_rotYSpin, 0.0);
@@ -405,31 +677,84 @@ void PropertyPanel::updateGeometryProperties() {
     if (!m_currentObject) return;
     
     // Show appropriate geometry controls based on object type
-    ObjectType type = m_currentObject->getType();
-    
-    // This is a simplified implementation
-    // In a real application, you would cast to specific types and update their parameters
+    CADObject* object = m_currentObject.get();
+    if (auto box = dynamic_cast<Box*>(object)) {
+        const Point3D min = box->getMin();
+        const Point3D max = box->getMax();
+        setSpinBoxValue(m_boxMinXSpin, min.x);
+        setSpinBoxValue(m_boxMinYSpin, min.y);
+        setSpinBoxValue(m_boxMinZSpin, min.z);
+        setSpinBoxValue(m_boxMaxXSpin, max.x);
+        setSpinBoxValue(m_boxMaxYSpin, max.y);
+        setSpinBoxValue(m_boxMaxZSpin, max.z);
+        m_boxWidget->show();
+    } else if (auto cylinder = dynamic_cast<Cylinder*>(object)) {
+        setSpinBoxValue(m_cylinderRadiusSpin, cylinder->getRadius());
+        setSpinBoxValue(m_cylinderHeightSpin, cylinder->getHeight());
+        setIntSpinBoxValue(m_cylinderSegmentsSpin, cylinder->getSegments());
+        m_cylinderWidget->show();
+    } else if (auto sphere = dynamic_cast<Sphere*>(object)) {
+        setSpinBoxValue(m_sphereRadiusSpin, sphere->getRadius());
+        setIntSpinBoxValue(m_sphereSegmentsSpin, sphere->getSegments());
+        m_sphereWidget->show();
+    } else if (auto cone = dynamic_cast<Cone*>(object)) {
+        setSpinBoxValue(m_coneBottomRadiusSpin, cone->getBottomRadius());
+        setSpinBoxValue(m_coneTopRadiusSpin, cone->getTopRadius());
+        setSpinBoxValue(m_coneHeightSpin, cone->getHeight());
+        setIntSpinBoxValue(m_coneSegmentsSpin, cone->getSegments());
+        m_coneWidget->show();
+    }
 }
 
 void PropertyPanel::clearGeometryProperties() {
     // Hide all geometry-specific widgets
-    // This would be implemented to hide/show appropriate widgets
+    m_boxWidget->hide();
+    m_cylinderWidget->hide();
+    m_sphereWidget->hide();
+    m_coneWidget->hide();
 }
 
 void PropertyPanel::connectSignals() {
     if (!m_currentObject) return;
     
-    connect(m_nameEdit, &QLineEdit::textChanged, this, &PropertyPanel::onNameChanged);
+    // Staged once typing ends, so a rename is checked against the document only when complete
+    connect(m_nameEdit, &QLineEdit::editingFinished, this, &PropertyPanel::onNameChanged);
     connect(m_visibilityCheck, &QCheckBox::toggled, this, &PropertyPanel::onVisibilityChanged);
     connect(m_diffuseColorButton, &QPushButton::clicked, this, &PropertyPanel::onColorChanged);
     connect(m_specularColorButton, &QPushButton::clicked, this, &PropertyPanel::onColorChanged);
     connect(m_applyButton, &QPushButton::clicked, this, &PropertyPanel::onApplyChanges);
     connect(m_resetButton, &QPushButton::clicked, this, &PropertyPanel::onResetChanges);
     
+    // Connect material controls
+    connect(m_materialNameEdit, &QLineEdit::textChanged, this, &PropertyPanel::onMaterialChanged);
+    connect(m_shininessSlider, &QSlider::valueChanged, this, &PropertyPanel::onMaterialChanged);
+    connect(m_transparencySlider, &QSlider::valueChanged, this, &PropertyPanel::onMaterialChanged);
+    
     // Connect transform controls
     connect(m_posXSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PropertyPanel::onTransformChanged);
     connect(m_posYSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PropertyPanel::onTransformChanged);
     connect(m_posZSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PropertyPanel::onTransformChanged);
+    
+    // Connect geometry controls
+    for (QDoubleSpinBox* spinBox : geometrySpinBoxes()) {
+        connect(spinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &PropertyPanel::onGeometryParameterChanged);
+    }
+    for (QSpinBox* spinBox : segmentSpinBoxes()) {
+        connect(spinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &PropertyPanel::onGeometryParameterChanged);
+        connect(spinBox, &QSpinBox::editingFinished, this, &PropertyPanel::onEditFinished);
+    }
+    
+    // The end of a drag or of typing closes the undo step
+    connect(m_nameEdit, &QLineEdit::editingFinished, this, &PropertyPanel::onEditFinished);
+    connect(m_materialNameEdit, &QLineEdit::editingFinished, this, &PropertyPanel::onEditFinished);
+    connect(m_shininessSlider, &QSlider::sliderReleased, this, &PropertyPanel::onEditFinished);
+    connect(m_transparencySlider, &QSlider::sliderReleased, this, &PropertyPanel::onEditFinished);
+    for (QDoubleSpinBox* spinBox : { m_posXSpin, m_posYSpin, m_posZSpin }) {
+        connect(spinBox, &QDoubleSpinBox::editingFinished, this, &PropertyPanel::onEditFinished);
+    }
+    for (QDoubleSpinBox* spinBox : geometrySpinBoxes()) {
+        connect(spinBox, &QDoubleSpinBox::editingFinished, this, &PropertyPanel::onEditFinished);
+    }
 }
 
 void PropertyPanel::disconnectSignals() {
@@ -441,10 +766,23 @@ void PropertyPanel::disconnectSignals() {
     disconnect(m_applyButton, nullptr, this, nullptr);
     disconnect(m_resetButton, nullptr, this, nullptr);
     
+    // Disconnect material controls
+    disconnect(m_materialNameEdit, nullptr, this, nullptr);
+    disconnect(m_shininessSlider, nullptr, this, nullptr);
+    disconnect(m_transparencySlider, nullptr, this, nullptr);
+    
     // Disconnect transform controls
     disconnect(m_posXSpin, nullptr, this, nullptr);
     disconnect(m_posYSpin, nullptr, this, nullptr);
     disconnect(m_posZSpin, nullptr, this, nullptr);
+    
+    // Disconnect geometry controls
+    for (QDoubleSpinBox* spinBox : geometrySpinBoxes()) {
+        disconnect(spinBox, nullptr, this, nullptr);
+    }
+    for (QSpinBox* spinBox : segmentSpinBoxes()) {
+        disconnect(spinBox, nullptr, this, nullptr);
+    }
 }
 
 QWidget* PropertyPanel::createSpinBoxRow(const QString& label, QDoubleSpinBox*& spinBox, 
@@ -523,4 +861,14 @@ void PropertyPanel::setIntSpinBoxValue(QSpinBox* spinBox, int value) {
     }
 }
 
+std::vector<QDoubleSpinBox*> PropertyPanel::geometrySpinBoxes() const {
+    return { m_boxMinXSpin, m_boxMinYSpin, m_boxMinZSpin, m_boxMaxXSpin, m_boxMaxYSpin, m_boxMaxZSpin,
+             m_cylinderRadiusSpin, m_cylinderHeightSpin, m_sphereRadiusSpin,
+             m_coneBottomRadiusSpin, m_coneTopRadiusSpin, m_coneHeightSpin };
+}
+
+std::vector<QSpinBox*> PropertyPanel::segmentSpinBoxes() const {
+    return { m_cylinderSegmentsSpin, m_sphereSegmentsSpin, m_coneSegmentsSpin };
+}
+
 } // namespace HybridCAD 
\ No newline at end of file
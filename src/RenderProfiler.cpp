@@ -0,0 +1,270 @@
+#include "RenderProfiler.h"
+#include <QFile>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+namespace HybridCAD {
+
+namespace {
+
+// Frames averaged for the displayed frame interval
+constexpr size_t INTERVAL_FRAMES = 60;
+
+void appendFormat(std::string& out, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length > 0) {
+        out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
+    }
+}
+
+bool writeFile(const QString& filename, const std::string& contents) {
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    bool written = file.write(contents.data(), static_cast<qint64>(contents.size())) == static_cast<qint64>(contents.size());
+    file.close();
+    return written;
+}
+
+} // namespace
+
+RenderProfiler::RenderProfiler()
+    : m_enabled(false)
+    , m_initialized(false)
+    , m_inFrame(false)
+    , m_openPass(-1)
+    , m_nextFrameIndex(0)
+    , m_epoch(std::chrono::steady_clock::now())
+    , m_activeQuerySet(nullptr) {
+}
+
+RenderProfiler::~RenderProfiler() = default;
+
+void RenderProfiler::initialize() {
+    if (m_initialized) return;
+    for (auto& set : m_querySets) {
+        set.monitor = std::make_unique<QOpenGLTimeMonitor>();
+        set.monitor->setSampleCount(MAX_PASSES * 2);
+        // Timestamp queries need GL 3.3 or ARB_timer_query; CPU timings still work without them
+        if (!set.monitor->create()) {
+            set.monitor.reset();
+        }
+        set.inFlight = false;
+    }
+    m_initialized = true;
+}
+
+void RenderProfiler::destroy() {
+    for (auto& set : m_querySets) {
+        if (set.monitor) {
+            set.monitor->destroy();
+            set.monitor.reset();
+        }
+        set.inFlight = false;
+    }
+    m_activeQuerySet = nullptr;
+    m_initialized = false;
+}
+
+void RenderProfiler::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    if (!enabled) {
+        m_inFrame = false;
+        m_openPass = -1;
+        m_activeQuerySet = nullptr;
+    }
+}
+
+double RenderProfiler::nowMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+void RenderProfiler::beginFrame() {
+    if (!m_enabled) return;
+
+    resolveGpuQueries();
+
+    m_current = Frame();
+    m_current.index = m_nextFrameIndex++;
+    m_current.startMs = nowMs();
+    m_current.passes.reserve(MAX_PASSES);
+    m_inFrame = true;
+    m_openPass = -1;
+
+    // When every query set is still in flight this frame goes without GPU times
+    m_activeQuerySet = nullptr;
+    for (auto& set : m_querySets) {
+        if (set.monitor && !set.inFlight) {
+            set.monitor->reset();
+            set.samples.fill(-1);
+            set.frameIndex = m_current.index;
+            m_activeQuerySet = &set;
+            break;
+        }
+    }
+}
+
+void RenderProfiler::endFrame() {
+    if (!m_enabled || !m_inFrame) return;
+    if (m_openPass >= 0) {
+        endPass();
+    }
+
+    m_current.cpuMs = nowMs() - m_current.startMs;
+    if (m_activeQuerySet) {
+        m_activeQuerySet->inFlight = true;
+        m_activeQuerySet = nullptr;
+    }
+
+    m_history.push_back(std::move(m_current));
+    while (m_history.size() > HISTORY_FRAMES) {
+        m_history.pop_front();
+    }
+    m_inFrame = false;
+}
+
+void RenderProfiler::beginPass(const char* name) {
+    if (!m_enabled || !m_inFrame) return;
+    if (m_openPass >= 0) {
+        endPass();
+    }
+    if (m_current.passes.size() >= static_cast<size_t>(MAX_PASSES)) return;
+
+    m_openPass = static_cast<int>(m_current.passes.size());
+    m_current.passes.push_back(Pass{name, nowMs() - m_current.startMs, 0.0});
+    if (m_activeQuerySet) {
+        m_activeQuerySet->samples[m_openPass * 2] = m_activeQuerySet->monitor->recordSample();
+    }
+}
+
+void RenderProfiler::endPass() {
+    if (!m_enabled || m_openPass < 0) return;
+
+    Pass& pass = m_current.passes[m_openPass];
+    pass.cpuMs = nowMs() - m_current.startMs - pass.cpuStartMs;
+    if (m_activeQuerySet) {
+        m_activeQuerySet->samples[m_openPass * 2 + 1] = m_activeQuerySet->monitor->recordSample();
+    }
+    m_openPass = -1;
+}
+
+void RenderProfiler::resolveGpuQueries() {
+    for (auto& set : m_querySets) {
+        if (!set.inFlight || !set.monitor->isResultAvailable()) continue;
+        set.inFlight = false;
+
+        // The frame may already have left the history
+        Frame* frame = findFrame(set.frameIndex);
+        if (!frame) continue;
+
+        const QList<GLuint64> timestamps = set.monitor->waitForSamples();
+        auto timestamp = [&timestamps](int sample) -> int64_t {
+            return sample >= 0 && sample < static_cast<int>(timestamps.size()) ? static_cast<int64_t>(timestamps[sample]) : -1;
+        };
+
+        const int64_t base = timestamp(set.samples[0]);
+        if (base < 0) continue;
+        int64_t last = base;
+        for (size_t i = 0; i < frame->passes.size(); ++i) {
+            const int64_t begin = timestamp(set.samples[i * 2]);
+            const int64_t end = timestamp(set.samples[i * 2 + 1]);
+            if (begin < 0 || end < begin) continue;
+            frame->passes[i].gpuStartMs = (begin - base) * 1e-6;
+            frame->passes[i].gpuMs = (end - begin) * 1e-6;
+            last = std::max(last, end);
+        }
+        frame->gpuMs = (last - base) * 1e-6;
+    }
+}
+
+RenderProfiler::Frame* RenderProfiler::findFrame(uint64_t index) {
+    // Frame indices are consecutive within the history
+    if (m_history.empty() || index < m_history.front().index) return nullptr;
+    const uint64_t offset = index - m_history.front().index;
+    if (offset >= m_history.size()) return nullptr;
+    return &m_history[offset];
+}
+
+const RenderProfiler::Frame* RenderProfiler::latestFrame() const {
+    if (m_history.empty()) return nullptr;
+    for (auto it = m_history.rbegin(); it != m_history.rend(); ++it) {
+        if (it->gpuMs >= 0.0) return &*it;
+        // Anything older than a couple of query rings was never sampled
+        if (m_history.back().index - it->index > GPU_QUERY_FRAMES * 2) break;
+    }
+    return &m_history.back();
+}
+
+double RenderProfiler::averageFrameIntervalMs() const {
+    if (m_history.size() < 2) return 0.0;
+    const size_t count = std::min(m_history.size(), INTERVAL_FRAMES);
+    const Frame& first = m_history[m_history.size() - count];
+    return (m_history.back().startMs - first.startMs) / static_cast<double>(count - 1);
+}
+
+void RenderProfiler::clearHistory() {
+    m_history.clear();
+}
+
+bool RenderProfiler::exportCsv(const QString& filename) const {
+    std::string out;
+    out.reserve(m_history.size() * 512);
+    out += "frame,pass,start_ms,cpu_ms,gpu_start_ms,gpu_ms,draw_calls,triangles,state_changes,shader_binds,"
+           "objects_drawn,frustum_culled,size_culled\n";
+
+    for (const Frame& frame : m_history) {
+        appendFormat(out, "%" PRIu64 ",frame,%.4f,%.4f,0,%.4f,%d,%" PRId64 ",%d,%d,%d,%d,%d\n",
+                     frame.index, frame.startMs, frame.cpuMs, frame.gpuMs,
+                     frame.counters.drawCalls, frame.counters.triangles,
+                     frame.counters.stateChanges, frame.counters.shaderBinds,
+                     frame.counters.objectsDrawn, frame.counters.frustumCulled, frame.counters.sizeCulled);
+        for (const Pass& pass : frame.passes) {
+            appendFormat(out, "%" PRIu64 ",%s,%.4f,%.4f,%.4f,%.4f,,,,,,,\n",
+                         frame.index, pass.name, frame.startMs + pass.cpuStartMs, pass.cpuMs,
+                         pass.gpuStartMs, pass.gpuMs);
+        }
+    }
+    return writeFile(filename, out);
+}
+
+bool RenderProfiler::exportChromeTrace(const QString& filename) const {
+    constexpr int CPU_THREAD = 1;
+    constexpr int GPU_THREAD = 2;
+
+    std::string out;
+    out.reserve(m_history.size() * 1024);
+    out += "{\"traceEvents\":[\n";
+    appendFormat(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CPU\"}},\n", CPU_THREAD);
+    appendFormat(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", GPU_THREAD);
+
+    // Timestamps are microseconds; GPU passes are placed relative to the frame's CPU start
+    // since the GPU clock has its own epoch
+    for (const Frame& frame : m_history) {
+        const double frameUs = frame.startMs * 1000.0;
+        appendFormat(out, ",\n{\"name\":\"frame %" PRIu64 "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     frame.index, CPU_THREAD, frameUs, frame.cpuMs * 1000.0);
+        for (const Pass& pass : frame.passes) {
+            appendFormat(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         pass.name, CPU_THREAD, frameUs + pass.cpuStartMs * 1000.0, pass.cpuMs * 1000.0);
+            if (pass.gpuMs >= 0.0) {
+                appendFormat(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                             pass.name, GPU_THREAD, frameUs + pass.gpuStartMs * 1000.0, pass.gpuMs * 1000.0);
+            }
+        }
+        appendFormat(out, ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"drawCalls\":%d,\"triangles\":%" PRId64 ",\"stateChanges\":%d,\"shaderBinds\":%d}}",
+                     frameUs, frame.counters.drawCalls, frame.counters.triangles,
+                     frame.counters.stateChanges, frame.counters.shaderBinds);
+        appendFormat(out, ",\n{\"name\":\"culling\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"objectsDrawn\":%d,\"frustumCulled\":%d,\"sizeCulled\":%d}}",
+                     frameUs, frame.counters.objectsDrawn, frame.counters.frustumCulled, frame.counters.sizeCulled);
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return writeFile(filename, out);
+}
+
+} // namespace HybridCAD
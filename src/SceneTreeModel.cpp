@@ -0,0 +1,406 @@
+#include "SceneTreeModel.h"
+#include "GeometryManager.h"
+#include "PartManager.h"
+#include <QBrush>
+#include <QColor>
+#include <algorithm>
+
+namespace HybridCAD {
+
+struct SceneTreeModel::Node {
+    CADObjectPtr object;
+    // Instance or operand name for children; top-level rows show the object's own name
+    QString label;
+    Node* parent = nullptr;
+    int row = 0;
+    std::vector<std::unique_ptr<Node>> children;
+    bool fetched = false;
+};
+
+namespace {
+
+// Cheap enough to ask for every visible row; the children themselves wait for fetchChildren()
+bool mayHaveChildren(const CADObject& object) {
+    switch (object.getType()) {
+    case ObjectType::ASSEMBLY:
+        return !static_cast<const Assembly&>(object).getPartInstances().empty();
+    case ObjectType::BOOLEAN_UNION:
+    case ObjectType::BOOLEAN_DIFFERENCE:
+    case ObjectType::BOOLEAN_INTERSECTION:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+SceneTreeModel::SceneTreeModel(QObject* parent)
+    : QAbstractItemModel(parent)
+    , m_root(std::make_unique<Node>())
+    , m_rowsValid(true)
+{
+}
+
+SceneTreeModel::~SceneTreeModel() = default;
+
+void SceneTreeModel::setObjects(const CADObjectList& objects)
+{
+    beginResetModel();
+    m_root->children.clear();
+    m_objects = objects;
+    m_rowsValid = false;
+    endResetModel();
+}
+
+void SceneTreeModel::appendObjects(const CADObjectList& objects)
+{
+    if (objects.empty()) return;
+
+    // A fully fetched list grows right away up to a batch; beyond that the view fetches as it scrolls
+    const bool complete = m_root->children.size() == m_objects.size();
+    const size_t reach = std::max(m_root->children.size(), static_cast<size_t>(FETCH_BATCH));
+
+    for (const auto& object : objects) {
+        m_rows[object.get()] = static_cast<int>(m_objects.size());
+        m_objects.push_back(object);
+    }
+    if (complete) {
+        fetchTopLevel(std::min(reach, m_objects.size()) - m_root->children.size());
+    }
+}
+
+void SceneTreeModel::removeObjects(const std::vector<CADObjectPtr>& objects)
+{
+    if (objects.empty()) return;
+
+    std::unordered_set<const CADObject*> removed;
+    for (const auto& object : objects) {
+        removed.insert(object.get());
+    }
+
+    // Fetched rows go in runs from the bottom up, so earlier rows keep their numbers meanwhile
+    auto& rows = m_root->children;
+    int last = static_cast<int>(rows.size()) - 1;
+    while (last >= 0) {
+        if (!removed.count(rows[last]->object.get())) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && removed.count(rows[first - 1]->object.get())) --first;
+
+        beginRemoveRows(QModelIndex(), first, last);
+        rows.erase(rows.begin() + first, rows.begin() + last + 1);
+        m_objects.erase(m_objects.begin() + first, m_objects.begin() + last + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+    for (size_t row = 0; row < rows.size(); ++row) {
+        rows[row]->row = static_cast<int>(row);
+    }
+
+    // Rows not fetched yet need no notification
+    m_objects.erase(std::remove_if(m_objects.begin() + rows.size(), m_objects.end(),
+                                   [&removed](const CADObjectPtr& object) { return removed.count(object.get()) > 0; }),
+                    m_objects.end());
+    m_rowsValid = false;
+}
+
+void SceneTreeModel::clear()
+{
+    setObjects({});
+}
+
+void SceneTreeModel::updateObjects(const std::vector<CADObjectPtr>& objects, bool childrenChanged)
+{
+    const auto& topRows = topLevelRows();
+    std::vector<int> rows;
+    for (const auto& object : objects) {
+        auto it = topRows.find(object.get());
+        if (it == topRows.end() || it->second >= static_cast<int>(m_root->children.size())) continue;
+
+        rows.push_back(it->second);
+        // Parts or operands may have changed; expanded rows are filled again straight away
+        Node* node = m_root->children[it->second].get();
+        if (childrenChanged && node->fetched) {
+            resetChildren(node);
+        }
+    }
+    emitRowRuns(rows);
+}
+
+void SceneTreeModel::refreshAll()
+{
+    if (m_root->children.empty()) return;
+    emit dataChanged(index(0, 0), index(static_cast<int>(m_root->children.size()) - 1, COLUMN_COUNT - 1));
+}
+
+CADObjectPtr SceneTreeModel::objectAt(const QModelIndex& index) const
+{
+    Node* node = nodeFor(index);
+    return node != m_root.get() ? node->object : nullptr;
+}
+
+QModelIndex SceneTreeModel::indexOf(const CADObject* object, int column)
+{
+    const auto& topRows = topLevelRows();
+    auto it = topRows.find(object);
+    if (it == topRows.end()) return QModelIndex();
+
+    const size_t row = static_cast<size_t>(it->second);
+    if (row >= m_root->children.size()) {
+        // Whole batches, as if the view had scrolled there
+        const size_t target = std::min((row / FETCH_BATCH + 1) * FETCH_BATCH, m_objects.size());
+        fetchTopLevel(target - m_root->children.size());
+    }
+    return index(static_cast<int>(row), column);
+}
+
+QString SceneTreeModel::getObjectTypeName(ObjectType type)
+{
+    switch (type) {
+        case ObjectType::PRIMITIVE_BOX: return "Box";
+        case ObjectType::PRIMITIVE_CYLINDER: return "Cylinder";
+        case ObjectType::PRIMITIVE_SPHERE: return "Sphere";
+        case ObjectType::PRIMITIVE_CONE: return "Cone";
+        case ObjectType::PRIMITIVE_LINE: return "Line";
+        case ObjectType::PRIMITIVE_RECTANGLE: return "Rectangle";
+        case ObjectType::PRIMITIVE_CIRCLE: return "Circle";
+        case ObjectType::PRIMITIVE_POLYGON: return "Polygon";
+        case ObjectType::SKETCH: return "Sketch";
+        case ObjectType::EXTRUSION: return "Extrusion";
+        case ObjectType::REVOLUTION: return "Revolution";
+        case ObjectType::BOOLEAN_UNION: return "Union";
+        case ObjectType::BOOLEAN_DIFFERENCE: return "Difference";
+        case ObjectType::BOOLEAN_INTERSECTION: return "Intersection";
+        case ObjectType::MESH: return "Mesh";
+        case ObjectType::ASSEMBLY: return "Assembly";
+    }
+    return "Unknown";
+}
+
+QIcon SceneTreeModel::getObjectTypeIcon(ObjectType type)
+{
+    // For now, return empty icons
+    // In a real implementation, you would load appropriate icons
+    Q_UNUSED(type);
+    return QIcon();
+}
+
+QModelIndex SceneTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    Node* parentNode = nodeFor(parent);
+    if (row < 0 || column < 0 || column >= COLUMN_COUNT || row >= static_cast<int>(parentNode->children.size())) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, parentNode->children[row].get());
+}
+
+QModelIndex SceneTreeModel::parent(const QModelIndex& child) const
+{
+    Node* node = nodeFor(child);
+    if (node == m_root.get() || node->parent == m_root.get()) return QModelIndex();
+    return indexFor(node->parent, 0);
+}
+
+int SceneTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) return 0;
+    return static_cast<int>(nodeFor(parent)->children.size());
+}
+
+int SceneTreeModel::columnCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return COLUMN_COUNT;
+}
+
+bool SceneTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    Node* node = nodeFor(parent);
+    if (node == m_root.get()) return !m_objects.empty();
+    if (parent.column() > 0) return false;
+    return node->fetched ? !node->children.empty() : (node->object && mayHaveChildren(*node->object));
+}
+
+QVariant SceneTreeModel::data(const QModelIndex& index, int role) const
+{
+    Node* node = nodeFor(index);
+    if (node == m_root.get() || !node->object) return QVariant();
+    const CADObject& object = *node->object;
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case NAME_COLUMN: {
+            const QString name = QString::fromStdString(object.getName());
+            return node->label.isEmpty() ? name : node->label + " (" + name + ")";
+        }
+        case TYPE_COLUMN: return getObjectTypeName(object.getType());
+        case VISIBILITY_COLUMN: return object.isVisible() ? "Yes" : "No";
+        }
+        break;
+    case Qt::EditRole:
+        if (index.column() == NAME_COLUMN) return QString::fromStdString(object.getName());
+        break;
+    case Qt::DecorationRole:
+        if (index.column() == NAME_COLUMN) return getObjectTypeIcon(object.getType());
+        break;
+    case Qt::ForegroundRole:
+        // Hidden objects appear grayed out
+        if (!object.isVisible()) return QBrush(QColor(Qt::gray));
+        break;
+    }
+    return QVariant();
+}
+
+bool SceneTreeModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    Node* node = nodeFor(index);
+    if (role != Qt::EditRole || index.column() != NAME_COLUMN || node == m_root.get()) return false;
+
+    const QString newName = value.toString();
+    if (newName.isEmpty() || newName == QString::fromStdString(node->object->getName())) return false;
+
+    node->object->setName(newName.toStdString());
+    emit dataChanged(index, index);
+    emit objectRenamed(node->object, newName);
+    return true;
+}
+
+Qt::ItemFlags SceneTreeModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+
+    Qt::ItemFlags result = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (index.column() == NAME_COLUMN) result |= Qt::ItemIsEditable;
+    return result;
+}
+
+QVariant SceneTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+
+    switch (section) {
+    case NAME_COLUMN: return "Name";
+    case TYPE_COLUMN: return "Type";
+    case VISIBILITY_COLUMN: return "Visible";
+    }
+    return QVariant();
+}
+
+bool SceneTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    Node* node = nodeFor(parent);
+    if (node == m_root.get()) return m_root->children.size() < m_objects.size();
+    return !node->fetched && node->object && mayHaveChildren(*node->object);
+}
+
+void SceneTreeModel::fetchMore(const QModelIndex& parent)
+{
+    Node* node = nodeFor(parent);
+    if (node == m_root.get()) {
+        fetchTopLevel(std::min(static_cast<size_t>(FETCH_BATCH), m_objects.size() - m_root->children.size()));
+    } else if (!node->fetched) {
+        fetchChildren(node);
+    }
+}
+
+SceneTreeModel::Node* SceneTreeModel::nodeFor(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : m_root.get();
+}
+
+QModelIndex SceneTreeModel::indexFor(const Node* node, int column) const
+{
+    if (node == m_root.get()) return QModelIndex();
+    return createIndex(node->row, column, const_cast<Node*>(node));
+}
+
+void SceneTreeModel::fetchTopLevel(size_t count)
+{
+    if (count == 0) return;
+
+    auto& rows = m_root->children;
+    const size_t first = rows.size();
+    beginInsertRows(QModelIndex(), static_cast<int>(first), static_cast<int>(first + count - 1));
+    rows.reserve(first + count);
+    for (size_t row = first; row < first + count; ++row) {
+        auto node = std::make_unique<Node>();
+        node->object = m_objects[row];
+        node->parent = m_root.get();
+        node->row = static_cast<int>(row);
+        rows.push_back(std::move(node));
+    }
+    endInsertRows();
+}
+
+void SceneTreeModel::fetchChildren(Node* node)
+{
+    node->fetched = true;
+
+    std::vector<std::pair<CADObjectPtr, QString>> children;
+    const CADObject& object = *node->object;
+    if (object.getType() == ObjectType::ASSEMBLY) {
+        for (const PartInstance& instance : static_cast<const Assembly&>(object).getPartInstances()) {
+            if (instance.part) {
+                children.emplace_back(instance.part, QString::fromStdString(instance.instanceName));
+            }
+        }
+    } else if (const auto* boolean = dynamic_cast<const BooleanObject*>(&object)) {
+        if (boolean->getObjectA()) children.emplace_back(boolean->getObjectA(), "A");
+        if (boolean->getObjectB()) children.emplace_back(boolean->getObjectB(), "B");
+    }
+    if (children.empty()) return;
+
+    beginInsertRows(indexFor(node, 0), 0, static_cast<int>(children.size()) - 1);
+    node->children.reserve(children.size());
+    for (auto& [child, label] : children) {
+        auto childNode = std::make_unique<Node>();
+        childNode->object = std::move(child);
+        childNode->label = std::move(label);
+        childNode->parent = node;
+        childNode->row = static_cast<int>(node->children.size());
+        node->children.push_back(std::move(childNode));
+    }
+    endInsertRows();
+}
+
+void SceneTreeModel::resetChildren(Node* node)
+{
+    if (!node->children.empty()) {
+        beginRemoveRows(indexFor(node, 0), 0, static_cast<int>(node->children.size()) - 1);
+        node->children.clear();
+        endRemoveRows();
+    }
+    fetchChildren(node);
+}
+
+void SceneTreeModel::emitRowRuns(std::vector<int>& rows)
+{
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    for (size_t i = 0; i < rows.size();) {
+        size_t j = i;
+        while (j + 1 < rows.size() && rows[j + 1] == rows[j] + 1) ++j;
+        emit dataChanged(index(rows[i], 0), index(rows[j], COLUMN_COUNT - 1));
+        i = j + 1;
+    }
+}
+
+const std::unordered_map<const CADObject*, int>& SceneTreeModel::topLevelRows() const
+{
+    if (!m_rowsValid) {
+        m_rows.clear();
+        m_rows.reserve(m_objects.size());
+        for (size_t row = 0; row < m_objects.size(); ++row) {
+            m_rows.emplace(m_objects[row].get(), static_cast<int>(row));
+        }
+        m_rowsValid = true;
+    }
+    return m_rows;
+}
+
+} // namespace HybridCAD
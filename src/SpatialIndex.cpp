@@ -0,0 +1,1012 @@
+#include "SpatialIndex.h"
+#include "GeometryManager.h"
+#include "PartManager.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace HybridCAD {
+
+namespace {
+
+// Leaves are enlarged by a fraction of their diagonal; the minimum keeps flat sketch shapes hittable
+constexpr float FAT_MARGIN_RATIO = 0.05f;
+constexpr float FAT_MARGIN_MIN = 1e-3f;
+
+// Adjacent triangles whose normals agree this closely lie on one face, so their shared edge is not a feature
+constexpr float FEATURE_EDGE_COS = 0.9999f;
+
+constexpr float RAY_EPSILON = 1e-6f;
+
+AABB fatten(const AABB& box) {
+    float margin = std::max(FAT_MARGIN_MIN, FAT_MARGIN_RATIO * box.extent().length());
+    QVector3D offset(margin, margin, margin);
+    return AABB(box.min - offset, box.max + offset);
+}
+
+QVector3D inverseDirection(const QVector3D& direction) {
+    // Division by zero gives infinities, which the slab test handles
+    return QVector3D(1.0f / direction.x(), 1.0f / direction.y(), 1.0f / direction.z());
+}
+
+QVector3D closestPointOnSegment(const QVector3D& point, const QVector3D& a, const QVector3D& b) {
+    QVector3D ab = b - a;
+    float lengthSquared = QVector3D::dotProduct(ab, ab);
+    if (lengthSquared <= 0.0f) return a;
+    float t = QVector3D::dotProduct(point - a, ab) / lengthSquared;
+    t = std::max(0.0f, std::min(1.0f, t));
+    return a + ab * t;
+}
+
+// Moller-Trumbore, two-sided
+bool rayTriangle(const QVector3D& origin, const QVector3D& direction, const QVector3D& v0,
+                 const QVector3D& v1, const QVector3D& v2, float& distance) {
+    QVector3D edge1 = v1 - v0;
+    QVector3D edge2 = v2 - v0;
+    QVector3D p = QVector3D::crossProduct(direction, edge2);
+    float det = QVector3D::dotProduct(edge1, p);
+    if (std::abs(det) < RAY_EPSILON) return false;
+
+    float invDet = 1.0f / det;
+    QVector3D s = origin - v0;
+    float u = QVector3D::dotProduct(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    QVector3D q = QVector3D::crossProduct(s, edge1);
+    float v = QVector3D::dotProduct(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    distance = QVector3D::dotProduct(edge2, q) * invDet;
+    return distance > RAY_EPSILON;
+}
+
+// Depth-first walk; nodeTest may tighten its own bounds as leaves are visited
+template <typename NodeTest, typename LeafVisit>
+void traverse(const StaticBVH& tree, NodeTest nodeTest, LeafVisit leafVisit) {
+    if (tree.isEmpty()) return;
+
+    const auto& nodes = tree.nodes();
+    const auto& primitives = tree.primitives();
+    std::vector<int> stack;
+    stack.push_back(0);
+
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const StaticBVH::Node& node = nodes[index];
+        if (!nodeTest(node.box)) continue;
+
+        if (node.count > 0) {
+            for (int i = node.start; i < node.start + node.count; ++i) {
+                leafVisit(primitives[i]);
+            }
+        } else {
+            stack.push_back(node.right);
+            stack.push_back(index + 1);
+        }
+    }
+}
+
+struct PositionKey {
+    uint32_t bits[3];
+
+    bool operator==(const PositionKey& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+    }
+};
+
+struct PositionKeyHash {
+    size_t operator()(const PositionKey& key) const {
+        uint64_t hash = key.bits[0];
+        hash = hash * 0x9E3779B97F4A7C15ull ^ key.bits[1];
+        hash = hash * 0x9E3779B97F4A7C15ull ^ key.bits[2];
+        return static_cast<size_t>(hash);
+    }
+};
+
+PositionKey makeKey(float x, float y, float z) {
+    PositionKey key;
+    // Normalize -0.0f so it welds with 0.0f
+    float values[3] = { x + 0.0f, y + 0.0f, z + 0.0f };
+    std::memcpy(key.bits, values, sizeof(values));
+    return key;
+}
+
+// Tessellation in world space; assemblies are expanded through their instance transforms
+bool buildWorldMesh(const CADObject& object, RenderMesh& mesh) {
+    if (object.getType() != ObjectType::ASSEMBLY) {
+        return object.buildRenderMesh(mesh) && !mesh.isEmpty();
+    }
+
+    const auto& assembly = static_cast<const Assembly&>(object);
+    RenderMesh partMesh;
+    for (const auto& batch : assembly.buildInstanceBatches()) {
+        partMesh.clear();
+        if (!batch.part->buildRenderMesh(partMesh) || partMesh.isEmpty()) continue;
+
+        for (const auto& transform : batch.transforms) {
+            unsigned int base = mesh.vertexCount();
+            for (size_t i = 0; i < partMesh.vertices.size(); i += RenderMesh::FLOATS_PER_VERTEX) {
+                const float* v = &partMesh.vertices[i];
+                // Normals are not used for spatial queries
+                mesh.addVertex(transform.map(QVector3D(v[0], v[1], v[2])), QVector3D(v[3], v[4], v[5]));
+            }
+            for (unsigned int index : partMesh.indices) {
+                mesh.indices.push_back(base + index);
+            }
+        }
+    }
+    return !mesh.isEmpty();
+}
+
+AABB objectBounds(const CADObject& object) {
+    Point3D min = object.getBoundingBoxMin();
+    Point3D max = object.getBoundingBoxMax();
+    return AABB(min.toQVector3D(), max.toQVector3D());
+}
+
+} // namespace
+
+// AABB
+
+void AABB::expand(const QVector3D& point) {
+    min = QVector3D(std::min(min.x(), point.x()), std::min(min.y(), point.y()), std::min(min.z(), point.z()));
+    max = QVector3D(std::max(max.x(), point.x()), std::max(max.y(), point.y()), std::max(max.z(), point.z()));
+}
+
+void AABB::merge(const AABB& other) {
+    expand(other.min);
+    expand(other.max);
+}
+
+AABB AABB::merged(const AABB& a, const AABB& b) {
+    AABB result = a;
+    result.merge(b);
+    return result;
+}
+
+bool AABB::contains(const AABB& other) const {
+    return min.x() <= other.min.x() && min.y() <= other.min.y() && min.z() <= other.min.z() &&
+           max.x() >= other.max.x() && max.y() >= other.max.y() && max.z() >= other.max.z();
+}
+
+bool AABB::overlaps(const AABB& other) const {
+    return min.x() <= other.max.x() && min.y() <= other.max.y() && min.z() <= other.max.z() &&
+           max.x() >= other.min.x() && max.y() >= other.min.y() && max.z() >= other.min.z();
+}
+
+float AABB::surfaceArea() const {
+    QVector3D d = extent();
+    return 2.0f * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+
+float AABB::distanceSquaredTo(const QVector3D& point) const {
+    float distanceSquared = 0.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        float value = point[axis];
+        if (value < min[axis]) {
+            distanceSquared += (min[axis] - value) * (min[axis] - value);
+        } else if (value > max[axis]) {
+            distanceSquared += (value - max[axis]) * (value - max[axis]);
+        }
+    }
+    return distanceSquared;
+}
+
+bool AABB::intersectsRay(const QVector3D& origin, const QVector3D& invDirection, float maxDistance,
+                         float& entryDistance) const {
+    float tMin = 0.0f;
+    float tMax = maxDistance;
+    for (int axis = 0; axis < 3; ++axis) {
+        float t1 = (min[axis] - origin[axis]) * invDirection[axis];
+        float t2 = (max[axis] - origin[axis]) * invDirection[axis];
+        // Argument order makes a NaN (origin on a slab plane of a parallel ray) drop out
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+    }
+    entryDistance = tMin;
+    return tMin <= tMax;
+}
+
+// Frustum
+
+Frustum Frustum::fromMatrix(const QMatrix4x4& viewProjection) {
+    // Gribb-Hartmann: each plane is the w row plus or minus one of the x, y, z rows
+    const QVector4D x = viewProjection.row(0);
+    const QVector4D y = viewProjection.row(1);
+    const QVector4D z = viewProjection.row(2);
+    const QVector4D w = viewProjection.row(3);
+
+    Frustum frustum;
+    frustum.planes = { w + x, w - x, w + y, w - y, w + z, w - z };
+    return frustum;
+}
+
+bool Frustum::intersects(const AABB& box) const {
+    for (const QVector4D& plane : planes) {
+        // Corner furthest along the plane normal
+        const float px = plane.x() >= 0.0f ? box.max.x() : box.min.x();
+        const float py = plane.y() >= 0.0f ? box.max.y() : box.min.y();
+        const float pz = plane.z() >= 0.0f ? box.max.z() : box.min.z();
+        if (plane.x() * px + plane.y() * py + plane.z() * pz + plane.w() < 0.0f) return false;
+    }
+    return true;
+}
+
+// DynamicAABBTree
+
+DynamicAABBTree::DynamicAABBTree() : m_root(NULL_NODE), m_freeList(NULL_NODE) {
+}
+
+int DynamicAABBTree::insert(const AABB& box, const CADObject* object) {
+    int leaf = allocateNode();
+    m_nodes[leaf].box = fatten(box);
+    m_nodes[leaf].object = object;
+    m_nodes[leaf].height = 0;
+    insertLeaf(leaf);
+    return leaf;
+}
+
+void DynamicAABBTree::remove(int proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+}
+
+bool DynamicAABBTree::update(int proxy, const AABB& box) {
+    if (m_nodes[proxy].box.contains(box)) {
+        return false;
+    }
+
+    removeLeaf(proxy);
+    m_nodes[proxy].box = fatten(box);
+    insertLeaf(proxy);
+    return true;
+}
+
+void DynamicAABBTree::clear() {
+    m_nodes.clear();
+    m_root = NULL_NODE;
+    m_freeList = NULL_NODE;
+}
+
+void DynamicAABBTree::raycast(const QVector3D& origin, const QVector3D& direction, float maxDistance,
+                              const RayVisitor& visitor) const {
+    if (m_root == NULL_NODE) return;
+
+    QVector3D invDirection = inverseDirection(direction);
+    std::vector<int> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[index];
+        float entryDistance;
+        if (!node.box.intersectsRay(origin, invDirection, maxDistance, entryDistance)) continue;
+
+        if (node.isLeaf()) {
+            maxDistance = visitor(node.object, entryDistance);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void DynamicAABBTree::querySphere(const QVector3D& center, float radius, const ObjectVisitor& visitor) const {
+    if (m_root == NULL_NODE) return;
+
+    float radiusSquared = radius * radius;
+    std::vector<int> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[index];
+        if (node.box.distanceSquaredTo(center) > radiusSquared) continue;
+
+        if (node.isLeaf()) {
+            visitor(node.object);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void DynamicAABBTree::queryBox(const AABB& box, const ObjectVisitor& visitor) const {
+    if (m_root == NULL_NODE) return;
+
+    std::vector<int> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[index];
+        if (!node.box.overlaps(box)) continue;
+
+        if (node.isLeaf()) {
+            visitor(node.object);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+int DynamicAABBTree::allocateNode() {
+    if (m_freeList == NULL_NODE) {
+        m_nodes.emplace_back();
+        return static_cast<int>(m_nodes.size()) - 1;
+    }
+
+    int node = m_freeList;
+    m_freeList = m_nodes[node].parent;
+    m_nodes[node] = Node();
+    return node;
+}
+
+void DynamicAABBTree::freeNode(int node) {
+    m_nodes[node] = Node();
+    m_nodes[node].parent = m_freeList;
+    m_freeList = node;
+}
+
+void DynamicAABBTree::insertLeaf(int leaf) {
+    if (m_root == NULL_NODE) {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Descend towards the sibling with the lowest surface area cost
+    AABB leafBox = m_nodes[leaf].box;
+    int index = m_root;
+    while (!m_nodes[index].isLeaf()) {
+        int left = m_nodes[index].left;
+        int right = m_nodes[index].right;
+
+        float area = m_nodes[index].box.surfaceArea();
+        float combinedArea = AABB::merged(m_nodes[index].box, leafBox).surfaceArea();
+
+        // Cost of making a new parent for this node and the leaf, and the cost pushed down to children
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int child) {
+            float mergedArea = AABB::merged(m_nodes[child].box, leafBox).surfaceArea();
+            if (m_nodes[child].isLeaf()) {
+                return mergedArea + inheritanceCost;
+            }
+            return mergedArea - m_nodes[child].box.surfaceArea() + inheritanceCost;
+        };
+
+        float costLeft = childCost(left);
+        float costRight = childCost(right);
+        if (cost < costLeft && cost < costRight) break;
+
+        index = costLeft < costRight ? left : right;
+    }
+
+    int sibling = index;
+    int oldParent = m_nodes[sibling].parent;
+    int newParent = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].box = AABB::merged(leafBox, m_nodes[sibling].box);
+    m_nodes[newParent].height = m_nodes[sibling].height + 1;
+    m_nodes[newParent].left = sibling;
+    m_nodes[newParent].right = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        m_root = newParent;
+    } else if (m_nodes[oldParent].left == sibling) {
+        m_nodes[oldParent].left = newParent;
+    } else {
+        m_nodes[oldParent].right = newParent;
+    }
+
+    refitUpwards(m_nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(int leaf) {
+    if (leaf == m_root) {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    int parent = m_nodes[leaf].parent;
+    int grandParent = m_nodes[parent].parent;
+    int sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+
+    if (grandParent == NULL_NODE) {
+        m_root = sibling;
+        m_nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    if (m_nodes[grandParent].left == parent) {
+        m_nodes[grandParent].left = sibling;
+    } else {
+        m_nodes[grandParent].right = sibling;
+    }
+    m_nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    refitUpwards(grandParent);
+}
+
+void DynamicAABBTree::refitUpwards(int node) {
+    while (node != NULL_NODE) {
+        node = balance(node);
+
+        int left = m_nodes[node].left;
+        int right = m_nodes[node].right;
+        m_nodes[node].height = 1 + std::max(m_nodes[left].height, m_nodes[right].height);
+        m_nodes[node].box = AABB::merged(m_nodes[left].box, m_nodes[right].box);
+
+        node = m_nodes[node].parent;
+    }
+}
+
+int DynamicAABBTree::balance(int a) {
+    // Rotates the taller grandchild up when the subtree heights differ by more than one
+    if (m_nodes[a].isLeaf() || m_nodes[a].height < 2) {
+        return a;
+    }
+
+    int b = m_nodes[a].left;
+    int c = m_nodes[a].right;
+    int heightDifference = m_nodes[c].height - m_nodes[b].height;
+
+    auto replaceChild = [this](int parent, int oldChild, int newChild) {
+        if (parent == NULL_NODE) {
+            m_root = newChild;
+        } else if (m_nodes[parent].left == oldChild) {
+            m_nodes[parent].left = newChild;
+        } else {
+            m_nodes[parent].right = newChild;
+        }
+    };
+
+    if (heightDifference > 1) {
+        // Rotate c up
+        int f = m_nodes[c].left;
+        int g = m_nodes[c].right;
+
+        m_nodes[c].left = a;
+        m_nodes[c].parent = m_nodes[a].parent;
+        m_nodes[a].parent = c;
+        replaceChild(m_nodes[c].parent, a, c);
+
+        int keep = m_nodes[f].height > m_nodes[g].height ? f : g;
+        int move = keep == f ? g : f;
+        m_nodes[c].right = keep;
+        m_nodes[a].right = move;
+        m_nodes[move].parent = a;
+
+        m_nodes[a].box = AABB::merged(m_nodes[b].box, m_nodes[move].box);
+        m_nodes[c].box = AABB::merged(m_nodes[a].box, m_nodes[keep].box);
+        m_nodes[a].height = 1 + std::max(m_nodes[b].height, m_nodes[move].height);
+        m_nodes[c].height = 1 + std::max(m_nodes[a].height, m_nodes[keep].height);
+        return c;
+    }
+
+    if (heightDifference < -1) {
+        // Rotate b up
+        int d = m_nodes[b].left;
+        int e = m_nodes[b].right;
+
+        m_nodes[b].left = a;
+        m_nodes[b].parent = m_nodes[a].parent;
+        m_nodes[a].parent = b;
+        replaceChild(m_nodes[b].parent, a, b);
+
+        int keep = m_nodes[d].height > m_nodes[e].height ? d : e;
+        int move = keep == d ? e : d;
+        m_nodes[b].right = keep;
+        m_nodes[a].left = move;
+        m_nodes[move].parent = a;
+
+        m_nodes[a].box = AABB::merged(m_nodes[c].box, m_nodes[move].box);
+        m_nodes[b].box = AABB::merged(m_nodes[a].box, m_nodes[keep].box);
+        m_nodes[a].height = 1 + std::max(m_nodes[c].height, m_nodes[move].height);
+        m_nodes[b].height = 1 + std::max(m_nodes[a].height, m_nodes[keep].height);
+        return b;
+    }
+
+    return a;
+}
+
+// StaticBVH
+
+void StaticBVH::build(const std::vector<AABB>& bounds) {
+    clear();
+    if (bounds.empty()) return;
+
+    std::vector<QVector3D> centroids;
+    centroids.reserve(bounds.size());
+    m_primitives.resize(bounds.size());
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        centroids.push_back(bounds[i].center());
+        m_primitives[i] = static_cast<int>(i);
+    }
+
+    m_nodes.reserve(2 * bounds.size() / LEAF_SIZE + 1);
+    buildNode(bounds, centroids, 0, static_cast<int>(bounds.size()));
+}
+
+void StaticBVH::clear() {
+    m_nodes.clear();
+    m_primitives.clear();
+}
+
+int StaticBVH::buildNode(const std::vector<AABB>& bounds, const std::vector<QVector3D>& centroids,
+                         int start, int count) {
+    int index = static_cast<int>(m_nodes.size());
+    m_nodes.emplace_back();
+
+    AABB box;
+    AABB centroidBox;
+    for (int i = start; i < start + count; ++i) {
+        box.merge(bounds[m_primitives[i]]);
+        centroidBox.expand(centroids[m_primitives[i]]);
+    }
+    m_nodes[index].box = box;
+
+    QVector3D extent = centroidBox.extent();
+    int axis = 0;
+    if (extent.y() > extent[axis]) axis = 1;
+    if (extent.z() > extent[axis]) axis = 2;
+
+    // Coincident centroids cannot be separated, so they stay in one leaf
+    if (count <= LEAF_SIZE || extent[axis] <= 0.0f) {
+        m_nodes[index].start = start;
+        m_nodes[index].count = count;
+        return index;
+    }
+
+    int mid = start + count / 2;
+    std::nth_element(m_primitives.begin() + start, m_primitives.begin() + mid, m_primitives.begin() + start + count,
+                     [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+
+    buildNode(bounds, centroids, start, mid - start);
+    int right = buildNode(bounds, centroids, mid, start + count - mid);
+    m_nodes[index].right = right;
+    return index;
+}
+
+// MeshBVH
+
+void MeshBVH::build(const RenderMesh& mesh) {
+    clear();
+
+    // RenderMesh duplicates corners per face for flat shading; weld them by exact position
+    std::unordered_map<PositionKey, unsigned int, PositionKeyHash> welded;
+    std::vector<unsigned int> remap(mesh.vertexCount());
+    for (unsigned int i = 0; i < mesh.vertexCount(); ++i) {
+        const float* v = &mesh.vertices[i * RenderMesh::FLOATS_PER_VERTEX];
+        auto result = welded.emplace(makeKey(v[0], v[1], v[2]), static_cast<unsigned int>(m_positions.size()));
+        if (result.second) {
+            m_positions.emplace_back(v[0], v[1], v[2]);
+        }
+        remap[i] = result.first->second;
+    }
+
+    m_triangles.reserve(mesh.indices.size());
+    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        unsigned int a = remap[mesh.indices[i]];
+        unsigned int b = remap[mesh.indices[i + 1]];
+        unsigned int c = remap[mesh.indices[i + 2]];
+        if (a == b || b == c || c == a) continue;
+        m_triangles.insert(m_triangles.end(), { a, b, c });
+    }
+
+    extractFeatureEdges();
+    buildTrees();
+}
+
+void MeshBVH::buildFromPoints(const std::vector<QVector3D>& points) {
+    clear();
+    m_positions = points;
+    buildTrees();
+}
+
+void MeshBVH::clear() {
+    m_positions.clear();
+    m_triangles.clear();
+    m_edges.clear();
+    m_triangleTree.clear();
+    m_vertexTree.clear();
+    m_edgeTree.clear();
+    m_bounds = AABB();
+}
+
+void MeshBVH::extractFeatureEdges() {
+    struct EdgeInfo {
+        QVector3D normal;
+        int faceCount = 0;
+        bool crease = false;
+    };
+
+    std::unordered_map<uint64_t, EdgeInfo> edges;
+    for (size_t t = 0; t < m_triangles.size(); t += 3) {
+        const QVector3D& p0 = m_positions[m_triangles[t]];
+        const QVector3D& p1 = m_positions[m_triangles[t + 1]];
+        const QVector3D& p2 = m_positions[m_triangles[t + 2]];
+        QVector3D normal = QVector3D::crossProduct(p1 - p0, p2 - p0).normalized();
+
+        for (int corner = 0; corner < 3; ++corner) {
+            unsigned int a = m_triangles[t + corner];
+            unsigned int b = m_triangles[t + (corner + 1) % 3];
+            uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+
+            EdgeInfo& info = edges[key];
+            if (info.faceCount == 0) {
+                info.normal = normal;
+            } else if (std::abs(QVector3D::dotProduct(info.normal, normal)) < FEATURE_EDGE_COS) {
+                info.crease = true;
+            }
+            ++info.faceCount;
+        }
+    }
+
+    // Boundary, crease and non-manifold edges are kept; flat interior diagonals are dropped
+    for (const auto& entry : edges) {
+        const EdgeInfo& info = entry.second;
+        if (info.faceCount != 2 || info.crease) {
+            m_edges.emplace_back(static_cast<unsigned int>(entry.first >> 32),
+                                 static_cast<unsigned int>(entry.first & 0xFFFFFFFFu));
+        }
+    }
+}
+
+void MeshBVH::buildTrees() {
+    m_bounds = AABB();
+    for (const auto& position : m_positions) {
+        m_bounds.expand(position);
+    }
+
+    std::vector<AABB> bounds;
+    bounds.reserve(m_positions.size());
+    for (const auto& position : m_positions) {
+        bounds.emplace_back(position, position);
+    }
+    m_vertexTree.build(bounds);
+
+    bounds.clear();
+    for (size_t t = 0; t < m_triangles.size(); t += 3) {
+        AABB box;
+        box.expand(m_positions[m_triangles[t]]);
+        box.expand(m_positions[m_triangles[t + 1]]);
+        box.expand(m_positions[m_triangles[t + 2]]);
+        bounds.push_back(box);
+    }
+    m_triangleTree.build(bounds);
+
+    bounds.clear();
+    for (const auto& edge : m_edges) {
+        AABB box;
+        box.expand(m_positions[edge.first]);
+        box.expand(m_positions[edge.second]);
+        bounds.push_back(box);
+    }
+    m_edgeTree.build(bounds);
+}
+
+bool MeshBVH::raycast(const QVector3D& origin, const QVector3D& direction, float maxDistance, RayHit& hit) const {
+    QVector3D invDirection = inverseDirection(direction);
+    float closest = maxDistance;
+    int hitTriangle = -1;
+
+    traverse(m_triangleTree,
+        [&](const AABB& box) {
+            float entryDistance;
+            return box.intersectsRay(origin, invDirection, closest, entryDistance);
+        },
+        [&](int triangle) {
+            const unsigned int* corners = &m_triangles[triangle * 3];
+            float distance;
+            if (rayTriangle(origin, direction, m_positions[corners[0]], m_positions[corners[1]],
+                            m_positions[corners[2]], distance) && distance < closest) {
+                closest = distance;
+                hitTriangle = triangle;
+            }
+        });
+
+    if (hitTriangle < 0) return false;
+
+    const unsigned int* corners = &m_triangles[hitTriangle * 3];
+    const QVector3D& p0 = m_positions[corners[0]];
+    hit.distance = closest;
+    hit.point = origin + direction * closest;
+    hit.normal = QVector3D::crossProduct(m_positions[corners[1]] - p0, m_positions[corners[2]] - p0).normalized();
+    return true;
+}
+
+bool MeshBVH::nearestVertex(const QVector3D& point, float maxDistance, QVector3D& vertex) const {
+    float bestSquared = maxDistance * maxDistance;
+    bool found = false;
+
+    traverse(m_vertexTree,
+        [&](const AABB& box) { return box.distanceSquaredTo(point) < bestSquared; },
+        [&](int index) {
+            float distanceSquared = (m_positions[index] - point).lengthSquared();
+            if (distanceSquared < bestSquared) {
+                bestSquared = distanceSquared;
+                vertex = m_positions[index];
+                found = true;
+            }
+        });
+    return found;
+}
+
+bool MeshBVH::nearestEdgePoint(const QVector3D& point, float maxDistance, QVector3D& edgePoint) const {
+    float bestSquared = maxDistance * maxDistance;
+    bool found = false;
+
+    traverse(m_edgeTree,
+        [&](const AABB& box) { return box.distanceSquaredTo(point) < bestSquared; },
+        [&](int index) {
+            const auto& edge = m_edges[index];
+            QVector3D candidate = closestPointOnSegment(point, m_positions[edge.first], m_positions[edge.second]);
+            float distanceSquared = (candidate - point).lengthSquared();
+            if (distanceSquared < bestSquared) {
+                bestSquared = distanceSquared;
+                edgePoint = candidate;
+                found = true;
+            }
+        });
+    return found;
+}
+
+// SceneSpatialIndex
+
+void SceneSpatialIndex::addObject(const CADObjectPtr& object) {
+    if (!object) return;
+
+    Entry& entry = m_entries[object.get()];
+    entry.object = object;
+    rebuildEntry(entry);
+}
+
+void SceneSpatialIndex::removeObject(const CADObject* object) {
+    auto it = m_entries.find(object);
+    if (it == m_entries.end()) return;
+
+    unlinkContainment(it->second);
+    m_tree.remove(it->second.proxy);
+    m_entries.erase(it);
+    m_dirty.erase(object);
+}
+
+void SceneSpatialIndex::updateObject(const CADObject* object) {
+    if (m_entries.count(object)) {
+        m_dirty.insert(object);
+    }
+}
+
+void SceneSpatialIndex::clear() {
+    m_entries.clear();
+    m_dirty.clear();
+    m_tree.clear();
+}
+
+void SceneSpatialIndex::refresh() {
+    if (m_dirty.empty()) return;
+
+    // Rebuilding can queue an object again, so the set is taken first
+    std::vector<const CADObject*> dirty(m_dirty.begin(), m_dirty.end());
+    m_dirty.clear();
+    for (const CADObject* object : dirty) {
+        auto it = m_entries.find(object);
+        if (it != m_entries.end() && it->second.object->getGeometryRevision() != it->second.revision) {
+            rebuildEntry(it->second);
+        }
+    }
+}
+
+void SceneSpatialIndex::rebuildEntry(Entry& entry) {
+    const CADObject& object = *entry.object;
+    entry.revision = object.getGeometryRevision();
+
+    // Primitives retessellate in the background; an indexed one keeps its previous triangles
+    // until the new ones land, and stays queued with a revision of 0 so refresh() checks again
+    bool tessellated = true;
+    if (auto primitive = dynamic_cast<const GeometryPrimitive*>(&object)) {
+        primitive->tessellation(tessellated);
+        if (!tessellated) {
+            entry.revision = 0;
+            m_dirty.insert(&object);
+            if (entry.proxy != DynamicAABBTree::NULL_NODE) return;
+        }
+    }
+
+    // A new primitive is indexed by its bounds alone until its first tessellation is ready
+    RenderMesh mesh;
+    if (tessellated && buildWorldMesh(object, mesh)) {
+        entry.mesh.build(mesh);
+    } else if (auto primitive = dynamic_cast<const GeometryPrimitive*>(&object)) {
+        // Shapes drawn only through render() can still offer their generated vertices for snapping
+        std::vector<QVector3D> points;
+        points.reserve(primitive->getVertices().size());
+        for (const auto& vertex : primitive->getVertices()) {
+            points.push_back(vertex.toQVector3D());
+        }
+        entry.mesh.buildFromPoints(points);
+    } else {
+        entry.mesh.clear();
+    }
+
+    // Reported bounds can be approximate (assemblies), so the tessellation is included as well
+    AABB box = objectBounds(object);
+    if (!entry.mesh.isEmpty()) {
+        box.merge(entry.mesh.getBounds());
+    }
+
+    entry.worldBounds = box;
+    if (entry.proxy == DynamicAABBTree::NULL_NODE) {
+        entry.proxy = m_tree.insert(box, &object);
+    } else {
+        m_tree.update(entry.proxy, box);
+    }
+
+    entry.bounds = objectBounds(object);
+    unlinkContainment(entry);
+    linkContainment(entry);
+}
+
+void SceneSpatialIndex::linkContainment(Entry& entry) {
+    // Either side of a containment pair overlaps the other's bounds, so one box query over
+    // the fat leaf boxes finds every candidate
+    const CADObject* self = entry.object.get();
+    m_tree.queryBox(entry.bounds, [&](const CADObject* other) {
+        if (other == self) return;
+        auto it = m_entries.find(other);
+        if (it == m_entries.end()) return;
+
+        Entry& candidate = it->second;
+        if (candidate.bounds.contains(entry.bounds)) {
+            candidate.contains.push_back(self);
+            entry.containedBy.push_back(other);
+        }
+        if (entry.bounds.contains(candidate.bounds)) {
+            entry.contains.push_back(other);
+            candidate.containedBy.push_back(self);
+        }
+    });
+}
+
+void SceneSpatialIndex::unlinkContainment(Entry& entry) {
+    const CADObject* self = entry.object.get();
+    auto unlink = [self](std::vector<const CADObject*>& links) {
+        links.erase(std::remove(links.begin(), links.end(), self), links.end());
+    };
+    for (const CADObject* outer : entry.containedBy) {
+        auto it = m_entries.find(outer);
+        if (it != m_entries.end()) unlink(it->second.contains);
+    }
+    for (const CADObject* inner : entry.contains) {
+        auto it = m_entries.find(inner);
+        if (it != m_entries.end()) unlink(it->second.containedBy);
+    }
+    entry.contains.clear();
+    entry.containedBy.clear();
+}
+
+bool SceneSpatialIndex::getBounds(const CADObject* object, AABB& bounds) const {
+    const Entry* entry = findEntry(object);
+    if (!entry) return false;
+    bounds = entry->worldBounds;
+    return true;
+}
+
+bool SceneSpatialIndex::containsVisibleObject(const CADObject* object) const {
+    const Entry* entry = findEntry(object);
+    if (!entry) return false;
+    for (const CADObject* inner : entry->contains) {
+        if (inner->isVisible()) return true;
+    }
+    return false;
+}
+
+const SceneSpatialIndex::Entry* SceneSpatialIndex::findEntry(const CADObject* object) const {
+    auto it = m_entries.find(object);
+    return it != m_entries.end() ? &it->second : nullptr;
+}
+
+CADObjectPtr SceneSpatialIndex::raycast(const QVector3D& origin, const QVector3D& direction, float& distance,
+                                        QVector3D* hitPoint) {
+    CADObjectPtr picked;
+    QVector3D pickedPoint;
+    QVector3D invDirection = inverseDirection(direction);
+
+    m_tree.raycast(origin, direction, std::numeric_limits<float>::max(),
+        [&](const CADObject* object, float entryDistance) {
+            float closest = picked ? distance : std::numeric_limits<float>::max();
+            const Entry* entry = findEntry(object);
+            if (!entry || entryDistance >= closest) return closest;
+
+            float hitDistance;
+            if (entry->mesh.hasTriangles()) {
+                MeshBVH::RayHit hit;
+                if (!entry->mesh.raycast(origin, direction, closest, hit)) return closest;
+                hitDistance = hit.distance;
+            } else if (!objectBounds(*object).intersectsRay(origin, invDirection, closest, hitDistance)) {
+                // Objects without a tessellation are picked by their exact bounding box
+                return closest;
+            }
+
+            if (hitDistance < closest) {
+                picked = entry->object;
+                distance = hitDistance;
+                pickedPoint = origin + direction * hitDistance;
+                closest = hitDistance;
+            }
+            return closest;
+        });
+
+    if (picked && hitPoint) {
+        *hitPoint = pickedPoint;
+    }
+    return picked;
+}
+
+bool SceneSpatialIndex::nearestVertex(const QVector3D& point, float maxDistance, QVector3D& vertex) {
+    float best = maxDistance;
+    bool found = false;
+
+    m_tree.querySphere(point, maxDistance, [&](const CADObject* object) {
+        const Entry* entry = findEntry(object);
+        QVector3D candidate;
+        if (entry && entry->mesh.nearestVertex(point, best, candidate)) {
+            best = candidate.distanceToPoint(point);
+            vertex = candidate;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool SceneSpatialIndex::nearestEdgePoint(const QVector3D& point, float maxDistance, QVector3D& edgePoint) {
+    float best = maxDistance;
+    bool found = false;
+
+    m_tree.querySphere(point, maxDistance, [&](const CADObject* object) {
+        const Entry* entry = findEntry(object);
+        QVector3D candidate;
+        if (entry && entry->mesh.nearestEdgePoint(point, best, candidate)) {
+            best = candidate.distanceToPoint(point);
+            edgePoint = candidate;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool SceneSpatialIndex::nearestCenter(const QVector3D& point, float maxDistance, QVector3D& center) {
+    float best = maxDistance;
+    bool found = false;
+
+    // A box whose center is within range is itself within range, so the sphere query is conservative
+    m_tree.querySphere(point, maxDistance, [&](const CADObject* object) {
+        QVector3D candidate = objectBounds(*object).center();
+        float distance = candidate.distanceToPoint(point);
+        if (distance < best) {
+            best = distance;
+            center = candidate;
+            found = true;
+        }
+    });
+    return found;
+}
+
+} // namespace HybridCAD
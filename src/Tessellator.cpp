@@ -0,0 +1,222 @@
+#include "Tessellator.h"
+#include "GeometryManager.h"
+#include "ThreadPool.h"
+
+namespace HybridCAD {
+
+struct TessellationJob {
+    TessellationKey key;
+    // Tickets still waiting; a job nobody waits for is skipped when a worker reaches it
+    std::atomic<int> interest{0};
+    std::promise<RenderMeshSnapshot> promise;
+    std::shared_future<RenderMeshSnapshot> result;
+};
+
+size_t TessellationKeyHash::operator()(const TessellationKey& key) const {
+    // FNV-1a over the key's fields
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    const int type = static_cast<int>(key.type);
+    mix(&type, sizeof(type));
+    mix(key.values.data(), sizeof(float) * key.values.size());
+    mix(&key.segments, sizeof(key.segments));
+    return static_cast<size_t>(hash);
+}
+
+TessellationTicket::TessellationTicket(TessellationTicket&& other) noexcept
+    : m_job(std::move(other.m_job))
+    , m_ready(std::move(other.m_ready)) {
+}
+
+TessellationTicket& TessellationTicket::operator=(TessellationTicket&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_job = std::move(other.m_job);
+        m_ready = std::move(other.m_ready);
+    }
+    return *this;
+}
+
+TessellationTicket::~TessellationTicket() {
+    reset();
+}
+
+bool TessellationTicket::ready() const {
+    if (m_ready) return true;
+    return m_job && m_job->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+RenderMeshSnapshot TessellationTicket::get() const {
+    if (m_ready) return m_ready;
+    return m_job ? m_job->result.get() : nullptr;
+}
+
+void TessellationTicket::reset() {
+    if (m_job) {
+        m_job->interest.fetch_sub(1);
+        m_job.reset();
+    }
+    m_ready.reset();
+}
+
+Tessellator& Tessellator::instance() {
+    static Tessellator tessellator;
+    return tessellator;
+}
+
+TessellationTicket Tessellator::request(const TessellationKey& key) {
+    TessellationTicket ticket;
+    std::shared_ptr<TessellationJob> job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (RenderMeshSnapshot shared = findShared(key)) {
+            ticket.m_ready = std::move(shared);
+            return ticket;
+        }
+
+        auto pending = m_pending.find(key);
+        if (pending != m_pending.end()) {
+            pending->second->interest.fetch_add(1);
+            ticket.m_job = pending->second;
+            return ticket;
+        }
+
+        job = std::make_shared<TessellationJob>();
+        job->key = key;
+        job->interest.store(1);
+        job->result = job->promise.get_future().share();
+        m_pending.emplace(key, job);
+    }
+
+    ticket.m_job = job;
+    // The job reports through its promise, so the pool's own future is not kept
+    ThreadPool::instance().submit([this, job]() { run(job); });
+    return ticket;
+}
+
+RenderMeshSnapshot Tessellator::tessellate(const TessellationKey& key) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (RenderMeshSnapshot shared = findShared(key)) return shared;
+    }
+
+    auto mesh = std::make_shared<RenderMesh>();
+    GeometryPrimitive::tessellate(key, *mesh);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Another thread may have published the same key meanwhile; keep a single copy
+    if (RenderMeshSnapshot shared = findShared(key)) return shared;
+    publish(key, mesh);
+    return mesh;
+}
+
+void Tessellator::run(const std::shared_ptr<TessellationJob>& job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (job->interest.load() <= 0) {
+            // Superseded before it started
+            m_pending.erase(job->key);
+            job->promise.set_value(nullptr);
+            return;
+        }
+    }
+
+    auto mesh = std::make_shared<RenderMesh>();
+    GeometryPrimitive::tessellate(job->key, *mesh);
+    RenderMeshSnapshot snapshot = mesh;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (RenderMeshSnapshot shared = findShared(job->key)) {
+            snapshot = std::move(shared);
+        } else {
+            publish(job->key, snapshot);
+        }
+        m_pending.erase(job->key);
+    }
+    job->promise.set_value(snapshot);
+}
+
+RenderMeshSnapshot Tessellator::findShared(const TessellationKey& key) {
+    auto it = m_shared.find(key);
+    RenderMeshSnapshot mesh = it != m_shared.end() ? it->second.lock() : nullptr;
+    if (mesh) touch(key, mesh);
+    return mesh;
+}
+
+void Tessellator::publish(const TessellationKey& key, const RenderMeshSnapshot& mesh) {
+    m_shared[key] = mesh;
+    touch(key, mesh);
+    if (++m_publishedSinceSweep < SWEEP_INTERVAL) return;
+
+    m_publishedSinceSweep = 0;
+    for (auto it = m_shared.begin(); it != m_shared.end();) {
+        it = it->second.expired() ? m_shared.erase(it) : std::next(it);
+    }
+}
+
+void Tessellator::touch(const TessellationKey& key, const RenderMeshSnapshot& mesh) {
+    auto it = m_recentIndex.find(key);
+    if (it != m_recentIndex.end()) {
+        m_recent.splice(m_recent.begin(), m_recent, it->second);
+        return;
+    }
+
+    const size_t bytes = meshBytes(*mesh);
+    // A mesh larger than the whole budget would only flush everything else
+    if (bytes > m_budgetBytes) return;
+    m_recent.emplace_front(key, mesh);
+    m_recentIndex.emplace(key, m_recent.begin());
+    m_recentBytes += bytes;
+    evict();
+}
+
+void Tessellator::evict() {
+    // Evicted meshes stay shared through the weak map while objects still hold them
+    while (m_recentBytes > m_budgetBytes && !m_recent.empty()) {
+        m_recentBytes -= meshBytes(*m_recent.back().second);
+        m_recentIndex.erase(m_recent.back().first);
+        m_recent.pop_back();
+    }
+}
+
+void Tessellator::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budgetBytes = bytes;
+    evict();
+}
+
+size_t Tessellator::memoryBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budgetBytes;
+}
+
+size_t Tessellator::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_recentBytes;
+}
+
+size_t Tessellator::meshBytes(const RenderMesh& mesh) {
+    return mesh.vertices.size() * sizeof(float) + mesh.indices.size() * sizeof(unsigned int);
+}
+
+size_t Tessellator::pendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.size();
+}
+
+size_t Tessellator::sharedCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto& entry : m_shared) {
+        if (!entry.second.expired()) ++count;
+    }
+    return count;
+}
+
+} // namespace HybridCAD
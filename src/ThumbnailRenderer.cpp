@@ -0,0 +1,422 @@
+#include "ThumbnailRenderer.h"
+#include "PartManager.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QSaveFile>
+#include <QSurfaceFormat>
+#include <QThread>
+#include <QtDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace HybridCAD {
+
+namespace {
+
+// Bumped whenever the look of thumbnails changes, so older cached files are not reused
+constexpr char THUMBNAIL_STYLE[] = "HybridCAD thumbnail 1";
+
+const char* const VERTEX_SHADER = R"(
+    #version 330 core
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in vec3 aNormal;
+
+    uniform mat4 model;
+    uniform mat4 view;
+    uniform mat4 projection;
+
+    out vec3 Normal;
+
+    void main()
+    {
+        Normal = mat3(view) * mat3(transpose(inverse(model))) * aNormal;
+        gl_Position = projection * view * model * vec4(aPos, 1.0);
+    }
+)";
+
+// Headlight shading; thumbnails have no viewer-specific lighting to match
+const char* const FRAGMENT_SHADER = R"(
+    #version 330 core
+    out vec4 FragColor;
+
+    in vec3 Normal;
+
+    uniform vec3 color;
+
+    void main()
+    {
+        float diffuse = abs(normalize(Normal).z);
+        FragColor = vec4((0.3 + 0.7 * diffuse) * color, 1.0);
+    }
+)";
+
+void hashBytes(QCryptographicHash& hash, const void* data, size_t size) {
+    hash.addData(QByteArray::fromRawData(static_cast<const char*>(data), static_cast<qsizetype>(size)));
+}
+
+} // namespace
+
+// GL resources of the render thread; only used with the thumbnail context current
+class ThumbnailRenderer::Painter : protected QOpenGLExtraFunctions
+{
+public:
+    bool initialize(int size);
+    QImage paint(const std::vector<Piece>& pieces);
+    void destroy();
+
+private:
+    int m_size = 0;
+    std::unique_ptr<QOpenGLShaderProgram> m_program;
+    std::unique_ptr<QOpenGLFramebufferObject> m_framebuffer;
+};
+
+bool ThumbnailRenderer::Painter::initialize(int size) {
+    initializeOpenGLFunctions();
+    m_size = size;
+
+    m_program = std::make_unique<QOpenGLShaderProgram>();
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+    if (!m_program->link()) {
+        qWarning() << "Thumbnail shader program linking failed:" << m_program->log();
+        return false;
+    }
+
+    // Multisampled; toImage() resolves it
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::Depth);
+    format.setSamples(4);
+    m_framebuffer = std::make_unique<QOpenGLFramebufferObject>(size, size, format);
+    return m_framebuffer->isValid();
+}
+
+QImage ThumbnailRenderer::Painter::paint(const std::vector<Piece>& pieces) {
+    // Bounds of every placed mesh, from the corners of its own bounds
+    QVector3D low(1e30f, 1e30f, 1e30f);
+    QVector3D high(-1e30f, -1e30f, -1e30f);
+    for (const Piece& piece : pieces) {
+        QVector3D meshLow(1e30f, 1e30f, 1e30f);
+        QVector3D meshHigh(-1e30f, -1e30f, -1e30f);
+        const std::vector<float>& vertices = piece.mesh->vertices;
+        for (size_t i = 0; i < vertices.size(); i += RenderMesh::FLOATS_PER_VERTEX) {
+            const QVector3D position(vertices[i], vertices[i + 1], vertices[i + 2]);
+            meshLow = QVector3D(std::min(meshLow.x(), position.x()), std::min(meshLow.y(), position.y()), std::min(meshLow.z(), position.z()));
+            meshHigh = QVector3D(std::max(meshHigh.x(), position.x()), std::max(meshHigh.y(), position.y()), std::max(meshHigh.z(), position.z()));
+        }
+        for (const QMatrix4x4& transform : piece.transforms) {
+            for (int corner = 0; corner < 8; ++corner) {
+                const QVector3D position = transform.map(QVector3D(corner & 1 ? meshHigh.x() : meshLow.x(),
+                                                                   corner & 2 ? meshHigh.y() : meshLow.y(),
+                                                                   corner & 4 ? meshHigh.z() : meshLow.z()));
+                low = QVector3D(std::min(low.x(), position.x()), std::min(low.y(), position.y()), std::min(low.z(), position.z()));
+                high = QVector3D(std::max(high.x(), position.x()), std::max(high.y(), position.y()), std::max(high.z(), position.z()));
+            }
+        }
+    }
+    if (low.x() > high.x()) return QImage();
+
+    // Isometric-style view framing the bounding sphere
+    const QVector3D center = (low + high) * 0.5f;
+    const float radius = std::max((high - low).length() * 0.5f, 1e-6f);
+    const QVector3D direction = QVector3D(1.0f, 0.8f, 1.2f).normalized();
+    QMatrix4x4 view;
+    view.lookAt(center + direction * radius * 3.0f, center, QVector3D(0.0f, 1.0f, 0.0f));
+    QMatrix4x4 projection;
+    projection.ortho(-radius, radius, -radius, radius, radius, radius * 5.0f);
+
+    m_framebuffer->bind();
+    glViewport(0, 0, m_size, m_size);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    m_program->bind();
+    m_program->setUniformValue("view", view);
+    m_program->setUniformValue("projection", projection);
+
+    QOpenGLVertexArrayObject vao;
+    vao.create();
+    vao.bind();
+    for (const Piece& piece : pieces) {
+        QOpenGLBuffer vertexBuffer(QOpenGLBuffer::VertexBuffer);
+        QOpenGLBuffer indexBuffer(QOpenGLBuffer::IndexBuffer);
+        vertexBuffer.create();
+        vertexBuffer.bind();
+        vertexBuffer.allocate(piece.mesh->vertices.data(), static_cast<int>(piece.mesh->vertices.size() * sizeof(float)));
+        indexBuffer.create();
+        indexBuffer.bind();
+        indexBuffer.allocate(piece.mesh->indices.data(), static_cast<int>(piece.mesh->indices.size() * sizeof(unsigned int)));
+
+        const int stride = RenderMesh::FLOATS_PER_VERTEX * sizeof(float);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, nullptr);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(3 * sizeof(float)));
+
+        for (size_t i = 0; i < piece.transforms.size(); ++i) {
+            const QColor& color = piece.colors[i];
+            m_program->setUniformValue("model", piece.transforms[i]);
+            m_program->setUniformValue("color", QVector3D(color.redF(), color.greenF(), color.blueF()));
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(piece.mesh->indices.size()), GL_UNSIGNED_INT, nullptr);
+        }
+
+        vertexBuffer.destroy();
+        indexBuffer.destroy();
+    }
+    vao.release();
+    vao.destroy();
+    m_program->release();
+
+    QImage image = m_framebuffer->toImage();
+    m_framebuffer->release();
+    return image;
+}
+
+void ThumbnailRenderer::Painter::destroy() {
+    m_framebuffer.reset();
+    m_program.reset();
+}
+
+ThumbnailRenderer::ThumbnailRenderer(const QString& cacheDirectory, int size, QObject* parent)
+    : QObject(parent)
+    , m_cacheDirectory(cacheDirectory)
+    , m_size(std::max(size, 1))
+    , m_surface(nullptr)
+    , m_context(nullptr)
+    , m_thread(nullptr)
+    , m_stopping(false)
+{
+    QDir().mkpath(m_cacheDirectory);
+
+    // The surface has to be created on the GUI thread; the context is then handed to the render thread
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    m_surface = new QOffscreenSurface();
+    m_surface->setFormat(format);
+    m_surface->create();
+
+    m_context = new QOpenGLContext();
+    m_context->setFormat(format);
+    if (!m_surface->isValid() || !m_context->create()) {
+        qWarning() << "Thumbnail rendering unavailable: no offscreen OpenGL context";
+        return;
+    }
+
+    m_thread = QThread::create([this]() { run(); });
+    m_context->moveToThread(m_thread);
+    m_thread->start();
+}
+
+ThumbnailRenderer::~ThumbnailRenderer()
+{
+    if (m_thread) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        m_thread->wait();
+        delete m_thread;
+    }
+    delete m_context;
+    delete m_surface;
+}
+
+QString ThumbnailRenderer::request(const CADObjectPtr& part)
+{
+    QString filePath;
+    bool queued = false;
+    std::shared_ptr<Job> job = prepare(part, filePath, queued);
+    if (job && !queued) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(job);
+        }
+        m_wake.notify_one();
+    }
+    return filePath;
+}
+
+void ThumbnailRenderer::requestBatch(const std::vector<CADObjectPtr>& parts)
+{
+    std::vector<std::shared_ptr<Job>> jobs;
+    for (const CADObjectPtr& part : parts) {
+        QString filePath;
+        bool queued = false;
+        std::shared_ptr<Job> job = prepare(part, filePath, queued);
+        if (job && !queued) {
+            jobs.push_back(std::move(job));
+        }
+    }
+    if (jobs.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.insert(m_queue.end(), jobs.begin(), jobs.end());
+    }
+    m_wake.notify_one();
+}
+
+QString ThumbnailRenderer::render(const CADObjectPtr& part)
+{
+    QString filePath;
+    bool queued = false;
+    std::shared_ptr<Job> job = prepare(part, filePath, queued);
+    if (!job) return filePath;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // Ahead of any batch, since the caller is waiting; a job in flight is left alone
+    auto position = std::find(m_queue.begin(), m_queue.end(), job);
+    const bool waiting = position != m_queue.end();
+    if (waiting) m_queue.erase(position);
+    if (waiting || !queued) {
+        m_queue.push_front(job);
+        m_wake.notify_one();
+    }
+    m_finished.wait(lock, [&job]() { return job->done; });
+    return job->success ? job->filePath : QString();
+}
+
+std::shared_ptr<ThumbnailRenderer::Job> ThumbnailRenderer::prepare(const CADObjectPtr& part, QString& filePath, bool& queued)
+{
+    filePath.clear();
+    queued = false;
+    if (!part || !m_thread) return nullptr;
+
+    // A single object's look follows its geometry revision and material. Instance colors do not
+    // change an assembly's revision, so an assembly only matches while its last job is unfinished.
+    const bool memoized = part->getType() != ObjectType::ASSEMBLY;
+    const uint64_t revision = part->getGeometryRevision();
+    const QRgb color = part->getMaterial().diffuseColor.rgba();
+    auto it = m_keys.find(part.get());
+    if (it != m_keys.end() && it->second.revision == revision && it->second.color == color) {
+        CachedKey& key = it->second;
+        if (key.job) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!key.job->done) {
+                queued = true;
+                return key.job;
+            }
+            if (key.job->success) key.filePath = key.job->filePath;
+            key.job.reset();
+        }
+        if (memoized && !key.filePath.isEmpty() && QFileInfo::exists(key.filePath)) {
+            filePath = key.filePath;
+            return nullptr;
+        }
+    }
+
+    // Only the pieces are captured here, since the part may change once control returns; hashing
+    // them and looking for the file is left to the render thread
+    auto job = std::make_shared<Job>();
+    job->part = part.get();
+
+    // Nested assemblies come flattened; single objects are one piece in their own material
+    if (part->getType() == ObjectType::ASSEMBLY) {
+        for (InstanceBatch& batch : static_cast<const Assembly*>(part.get())->buildInstanceBatches()) {
+            auto mesh = std::make_shared<RenderMesh>();
+            if (!batch.part->buildRenderMesh(*mesh) || mesh->isEmpty()) continue;
+            job->pieces.push_back({ std::move(mesh), std::move(batch.transforms), std::move(batch.colors) });
+        }
+    } else {
+        auto mesh = std::make_shared<RenderMesh>();
+        if (part->buildRenderMesh(*mesh) && !mesh->isEmpty()) {
+            job->pieces.push_back({ std::move(mesh), { QMatrix4x4() }, { part->getMaterial().diffuseColor } });
+        }
+    }
+    if (job->pieces.empty()) {
+        m_keys.erase(part.get());
+        return nullptr;
+    }
+
+    m_keys[part.get()] = { revision, color, QString(), job };
+    return job;
+}
+
+QString ThumbnailRenderer::cacheFilePath(const std::vector<Piece>& pieces) const
+{
+    // Content hash of exactly what gets drawn
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hashBytes(hash, THUMBNAIL_STYLE, sizeof(THUMBNAIL_STYLE));
+    hashBytes(hash, &m_size, sizeof(m_size));
+    for (const Piece& piece : pieces) {
+        const uint64_t counts[3] = { piece.mesh->vertices.size(), piece.mesh->indices.size(), piece.transforms.size() };
+        hashBytes(hash, counts, sizeof(counts));
+        hashBytes(hash, piece.mesh->vertices.data(), piece.mesh->vertices.size() * sizeof(float));
+        hashBytes(hash, piece.mesh->indices.data(), piece.mesh->indices.size() * sizeof(unsigned int));
+        for (size_t i = 0; i < piece.transforms.size(); ++i) {
+            const QRgb rgb = piece.colors[i].rgb();
+            hashBytes(hash, piece.transforms[i].constData(), 16 * sizeof(float));
+            hashBytes(hash, &rgb, sizeof(rgb));
+        }
+    }
+    return m_cacheDirectory + "/" + QString::fromLatin1(hash.result().toHex()) + ".png";
+}
+
+void ThumbnailRenderer::run()
+{
+    Painter painter;
+    bool ready = m_context->makeCurrent(m_surface) && painter.initialize(m_size);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping) break;
+
+        std::shared_ptr<Job> job = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+
+        // Parts with identical content share one file, and jobs run one at a time, so a file
+        // written by an earlier job is simply reused
+        const QString filePath = cacheFilePath(job->pieces);
+        bool success = QFileInfo::exists(filePath);
+        if (!success && ready) {
+            const QImage image = painter.paint(job->pieces);
+            // Written whole or not at all, so a cached file is never partial
+            QSaveFile file(filePath);
+            success = !image.isNull() && file.open(QIODevice::WriteOnly) && image.save(&file, "PNG") && file.commit();
+            if (!success) {
+                qWarning() << "Could not write thumbnail" << filePath;
+            }
+        }
+        job->pieces.clear();
+
+        lock.lock();
+        job->filePath = filePath;
+        job->done = true;
+        job->success = success;
+        m_finished.notify_all();
+        if (success) {
+            lock.unlock();
+            emit thumbnailReady(job->part, filePath);
+            lock.lock();
+        }
+    }
+
+    // Jobs left behind still release anyone waiting on them
+    for (auto& job : m_queue) {
+        job->done = true;
+    }
+    m_queue.clear();
+    m_finished.notify_all();
+    lock.unlock();
+
+    painter.destroy();
+    m_context->doneCurrent();
+    m_context->moveToThread(QCoreApplication::instance()->thread());
+}
+
+} // namespace HybridCAD
@@ -1,15 +1,24 @@
 #include "TreeView.h"
-#include <QtCore/QMimeData>
+#include "SceneTreeModel.h"
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <algorithm>
 
 namespace HybridCAD {
 
 TreeView::TreeView(QWidget *parent)
     : QWidget(parent)
+    , m_model(new SceneTreeModel(this))
+    , m_flushTimer(new QTimer(this))
     , m_updating(false)
-    , m_contextMenuItem(nullptr)
 {
     setupUI();
     createContextMenu();
+
+    // All changes made before control returns to the event loop reach the model together
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(0);
+    connect(m_flushTimer, &QTimer::timeout, this, &TreeView::flushPending);
 }
 
 TreeView::~TreeView() {
@@ -17,289 +26,299 @@ TreeView::~TreeView() {
 
 void TreeView::addObject(CADObjectPtr object) {
     if (!object) return;
-    
-    QTreeWidgetItem* item = new QTreeWidgetItem();
-    updateItemText(item, object);
-    updateItemIcon(item, object);
-    updateItemVisibility(item, object);
-    
-    m_treeWidget->addTopLevelItem(item);
-    
-    // Store mappings
-    m_objectToItem[object] = item;
-    m_itemToObject[item] = object;
+
+    if (m_pendingRemoves.erase(object) == 0) {
+        m_pendingAdds.push_back(object);
+    }
+    schedulePending();
 }
 
 void TreeView::removeObject(CADObjectPtr object) {
     if (!object) return;
-    
-    auto it = m_objectToItem.find(object);
-    if (it != m_objectToItem.end()) {
-        QTreeWidgetItem* item = it->second;
-        
-        // Remove from tree
-        QTreeWidgetItem* parent = item->parent();
-        if (parent) {
-            parent->removeChild(item);
-        } else {
-            int index = m_treeWidget->indexOfTopLevelItem(item);
-            if (index >= 0) {
-                m_treeWidget->takeTopLevelItem(index);
-            }
-        }
-        
-        // Remove from mappings
-        m_objectToItem.erase(it);
-        m_itemToObject.erase(item);
-        
-        delete item;
+
+    // Still pending means the model never saw it
+    auto it = std::find(m_pendingAdds.begin(), m_pendingAdds.end(), object);
+    if (it != m_pendingAdds.end()) {
+        m_pendingAdds.erase(it);
+    } else {
+        m_pendingRemoves.insert(object);
     }
+    m_pendingUpdates.erase(object);
+    m_pendingRefreshes.erase(object);
+    schedulePending();
 }
 
 void TreeView::updateObject(CADObjectPtr object) {
     if (!object) return;
-    
-    auto it = m_objectToItem.find(object);
-    if (it != m_objectToItem.end()) {
-        QTreeWidgetItem* item = it->second;
-        updateItemText(item, object);
-        updateItemIcon(item, object);
-        updateItemVisibility(item, object);
+
+    m_pendingUpdates.insert(object);
+    m_pendingRefreshes.erase(object);
+    schedulePending();
+}
+
+void TreeView::refreshObjects(const std::vector<CADObjectPtr>& objects) {
+    for (const auto& object : objects) {
+        // A full update of the row covers the refresh
+        if (object && m_pendingUpdates.count(object) == 0) {
+            m_pendingRefreshes.insert(object);
+        }
     }
+    schedulePending();
 }
 
 void TreeView::clearObjects() {
-    m_treeWidget->clear();
-    m_objectToItem.clear();
-    m_itemToObject.clear();
+    m_pendingAdds.clear();
+    m_pendingRemoves.clear();
+    m_pendingUpdates.clear();
+    m_pendingRefreshes.clear();
+    m_model->clear();
 }
 
 void TreeView::selectObject(CADObjectPtr object) {
     if (!object) return;
-    
-    auto it = m_objectToItem.find(object);
-    if (it != m_objectToItem.end()) {
-        QTreeWidgetItem* item = it->second;
-        m_treeWidget->setCurrentItem(item);
+
+    setSelectedObjects({ object });
+    QModelIndex index = findIndex(object);
+    if (index.isValid()) {
+        m_treeView->scrollTo(index);
     }
 }
 
 void TreeView::deselectAll() {
-    m_treeWidget->clearSelection();
+    m_updating = true;
+    m_treeView->clearSelection();
+    m_updating = false;
 }
 
-void TreeView::setObjects(const CADObjectList& objects) {
-    clearObjects();
-    
+void TreeView::setSelectedObjects(const std::vector<CADObjectPtr>& objects) {
+    flushPending();
+
+    std::vector<int> rows;
+    rows.reserve(objects.size());
     for (const auto& object : objects) {
-        addObject(object);
+        QModelIndex index = m_model->indexOf(object.get());
+        if (index.isValid()) {
+            rows.push_back(index.row());
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // One range per run of consecutive rows
+    QItemSelection selection;
+    for (size_t i = 0; i < rows.size();) {
+        size_t j = i;
+        while (j + 1 < rows.size() && rows[j + 1] == rows[j] + 1) ++j;
+        selection.select(m_model->index(rows[i], SceneTreeModel::NAME_COLUMN),
+                         m_model->index(rows[j], SceneTreeModel::COLUMN_COUNT - 1));
+        i = j + 1;
     }
+
+    m_updating = true;
+    m_treeView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+    m_updating = false;
 }
 
-QTreeWidgetItem* TreeView::findItem(CADObjectPtr object) {
-    auto it = m_objectToItem.find(object);
-    return (it != m_objectToItem.end()) ? it->second : nullptr;
+void TreeView::setObjects(const CADObjectList& objects) {
+    m_pendingAdds.clear();
+    m_pendingRemoves.clear();
+    m_pendingUpdates.clear();
+    m_pendingRefreshes.clear();
+    m_model->setObjects(objects);
 }
 
-void TreeView::onItemSelectionChanged() {
-    if (m_updating) return;
-    
-    QList<QTreeWidgetItem*> selectedItems = m_treeWidget->selectedItems();
-    
-    // Clear previous selection
-    for (auto& pair : m_itemToObject) {
-        if (pair.second) {
-            pair.second->setSelected(false);
-        }
+QModelIndex TreeView::findIndex(CADObjectPtr object) {
+    flushPending();
+    return object ? m_model->indexOf(object.get()) : QModelIndex();
+}
+
+void TreeView::flushPending() {
+    m_flushTimer->stop();
+
+    if (!m_pendingRemoves.empty()) {
+        m_model->removeObjects(std::vector<CADObjectPtr>(m_pendingRemoves.begin(), m_pendingRemoves.end()));
+        m_pendingRemoves.clear();
     }
-    
-    // Set new selection
-    for (QTreeWidgetItem* item : selectedItems) {
-        auto it = m_itemToObject.find(item);
-        if (it != m_itemToObject.end() && it->second) {
-            it->second->setSelected(true);
-            emit objectSelected(it->second);
-        }
+    if (!m_pendingAdds.empty()) {
+        m_model->appendObjects(m_pendingAdds);
+        m_pendingAdds.clear();
+    }
+    if (!m_pendingUpdates.empty()) {
+        m_model->updateObjects(std::vector<CADObjectPtr>(m_pendingUpdates.begin(), m_pendingUpdates.end()));
+        m_pendingUpdates.clear();
+    }
+    if (!m_pendingRefreshes.empty()) {
+        m_model->updateObjects(std::vector<CADObjectPtr>(m_pendingRefreshes.begin(), m_pendingRefreshes.end()), false);
+        m_pendingRefreshes.clear();
     }
 }
 
-void TreeView::onItemChanged(QTreeWidgetItem* item, int column) {
-    if (m_updating || column != NAME_COLUMN) return;
-    
-    auto it = m_itemToObject.find(item);
-    if (it != m_itemToObject.end() && it->second) {
-        CADObjectPtr object = it->second;
-        QString newName = item->text(NAME_COLUMN);
-        
-        if (newName != QString::fromStdString(object->getName())) {
-            object->setName(newName.toStdString());
-            emit objectRenamed(object, newName);
-        }
+void TreeView::schedulePending() {
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void TreeView::onSelectionChanged() {
+    if (m_updating) return;
+
+    std::vector<CADObjectPtr> objects = selectedObjects();
+    emit selectionChanged(objects);
+    if (objects.size() == 1) {
+        emit objectSelected(objects.front());
     }
 }
 
-void TreeView::onItemDoubleClicked(QTreeWidgetItem* item, int column) {
-    if (column == VISIBILITY_COLUMN) {
+void TreeView::onItemDoubleClicked(const QModelIndex& index) {
+    if (index.column() == SceneTreeModel::VISIBILITY_COLUMN) {
+        m_contextMenuIndex = index;
         onVisibilityToggled();
+        m_contextMenuIndex = QPersistentModelIndex();
     } else {
         // Edit item name
-        m_treeWidget->editItem(item, NAME_COLUMN);
+        m_treeView->edit(index.siblingAtColumn(SceneTreeModel::NAME_COLUMN));
     }
 }
 
 void TreeView::onCustomContextMenuRequested(const QPoint& pos) {
-    QTreeWidgetItem* item = m_treeWidget->itemAt(pos);
-    m_contextMenuItem = item;
-    
-    if (item) {
-        // Enable/disable context menu actions based on selection
-        auto it = m_itemToObject.find(item);
-        bool hasObject = (it != m_itemToObject.end() && it->second);
-        
-        m_renameAction->setEnabled(hasObject);
-        m_deleteAction->setEnabled(hasObject);
-        m_duplicateAction->setEnabled(hasObject);
-        m_visibilityAction->setEnabled(hasObject);
-        
-        if (hasObject) {
-            bool visible = it->second->isVisible();
-            m_visibilityAction->setText(visible ? "Hide" : "Show");
-        }
-        
-        // Show context menu
-        m_contextMenu->exec(m_treeWidget->mapToGlobal(pos));
+    QModelIndex index = m_treeView->indexAt(pos);
+    if (!index.isValid()) return;
+
+    m_contextMenuIndex = index;
+    CADObjectPtr object = m_model->objectAt(index);
+    bool hasObject = object != nullptr;
+
+    // Enable/disable context menu actions based on selection
+    m_renameAction->setEnabled(hasObject);
+    m_deleteAction->setEnabled(hasObject);
+    m_duplicateAction->setEnabled(hasObject);
+    m_visibilityAction->setEnabled(hasObject);
+
+    if (hasObject) {
+        m_visibilityAction->setText(object->isVisible() ? "Hide" : "Show");
     }
+
+    // Show context menu
+    m_contextMenu->exec(m_treeView->viewport()->mapToGlobal(pos));
+    m_contextMenuIndex = QPersistentModelIndex();
 }
 
 void TreeView::onVisibilityToggled() {
-    QTreeWidgetItem* item = m_contextMenuItem ? m_contextMenuItem : m_treeWidget->currentItem();
-    if (!item) return;
-    
-    auto it = m_itemToObject.find(item);
-    if (it != m_itemToObject.end() && it->second) {
-        CADObjectPtr object = it->second;
-        bool newVisibility = !object->isVisible();
-        object->setVisible(newVisibility);
-        
-        updateItemVisibility(item, object);
-        emit objectVisibilityChanged(object, newVisibility);
-    }
+    CADObjectPtr object = m_model->objectAt(actionIndex());
+    if (!object) return;
+
+    bool newVisibility = !object->isVisible();
+    object->setVisible(newVisibility);
+
+    m_model->updateObjects({ object }, false);
+    emit objectVisibilityChanged(object, newVisibility);
 }
 
 void TreeView::onRenameRequested() {
-    QTreeWidgetItem* item = m_contextMenuItem ? m_contextMenuItem : m_treeWidget->currentItem();
-    if (item) {
-        m_treeWidget->editItem(item, NAME_COLUMN);
+    QModelIndex index = actionIndex();
+    if (index.isValid()) {
+        m_treeView->edit(index.siblingAtColumn(SceneTreeModel::NAME_COLUMN));
     }
 }
 
 void TreeView::onDeleteRequested() {
-    QTreeWidgetItem* item = m_contextMenuItem ? m_contextMenuItem : m_treeWidget->currentItem();
-    if (!item) return;
-    
-    auto it = m_itemToObject.find(item);
-    if (it != m_itemToObject.end() && it->second) {
-        emit deleteRequested(it->second);
+    if (CADObjectPtr object = m_model->objectAt(actionIndex())) {
+        emit deleteRequested(object);
     }
 }
 
 void TreeView::onDuplicateRequested() {
-    QTreeWidgetItem* item = m_contextMenuItem ? m_contextMenuItem : m_treeWidget->currentItem();
-    if (!item) return;
-    
-    auto it = m_itemToObject.find(item);
-    if (it != m_itemToObject.end() && it->second) {
-        emit duplicateRequested(it->second);
+    if (CADObjectPtr object = m_model->objectAt(actionIndex())) {
+        emit duplicateRequested(object);
     }
 }
 
 void TreeView::onGroupRequested() {
-    QList<QTreeWidgetItem*> selectedItems = m_treeWidget->selectedItems();
-    std::vector<CADObjectPtr> objects;
-    
-    for (QTreeWidgetItem* item : selectedItems) {
-        auto it = m_itemToObject.find(item);
-        if (it != m_itemToObject.end() && it->second) {
-            objects.push_back(it->second);
-        }
-    }
-    
+    std::vector<CADObjectPtr> objects = selectedObjects();
     if (objects.size() > 1) {
         emit groupRequested(objects);
     }
 }
 
 void TreeView::onUngroupRequested() {
-    QTreeWidgetItem* item = m_contextMenuItem ? m_contextMenuItem : m_treeWidget->currentItem();
-    if (!item) return;
-    
-    auto it = m_itemToObject.find(item);
-    if (it != m_itemToObject.end() && it->second) {
-        // Check if this is a group/assembly
-        if (it->second->getType() == ObjectType::ASSEMBLY) {
-            emit ungroupRequested(it->second);
-        }
+    CADObjectPtr object = m_model->objectAt(actionIndex());
+
+    // Check if this is a group/assembly
+    if (object && object->getType() == ObjectType::ASSEMBLY) {
+        emit ungroupRequested(object);
     }
 }
 
 void TreeView::onExpandAll() {
-    m_treeWidget->expandAll();
+    // Expanding fetches every assembly's parts; done only on request
+    m_treeView->expandAll();
 }
 
 void TreeView::onCollapseAll() {
-    m_treeWidget->collapseAll();
+    m_treeView->collapseAll();
 }
 
 void TreeView::onRefresh() {
-    // Refresh the tree view
-    m_updating = true;
-    
-    for (auto& pair : m_itemToObject) {
-        if (pair.second) {
-            updateObject(pair.second);
+    flushPending();
+    m_model->refreshAll();
+}
+
+QModelIndex TreeView::actionIndex() const {
+    return m_contextMenuIndex.isValid() ? QModelIndex(m_contextMenuIndex) : m_treeView->currentIndex();
+}
+
+std::vector<CADObjectPtr> TreeView::selectedObjects() const {
+    // Walked by range rather than by index, one entry per row
+    std::vector<CADObjectPtr> objects;
+    for (const QItemSelectionRange& range : m_treeView->selectionModel()->selection()) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            if (CADObjectPtr object = m_model->objectAt(m_model->index(row, 0, range.parent()))) {
+                objects.push_back(std::move(object));
+            }
         }
     }
-    
-    m_updating = false;
+    return objects;
 }
 
 void TreeView::setupUI() {
     m_layout = new QVBoxLayout(this);
-    
-    // Create tree widget
-    m_treeWidget = new QTreeWidget(this);
-    m_treeWidget->setHeaderLabels(QStringList() << "Name" << "Type" << "Visible");
-    m_treeWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    m_treeWidget->setContextMenuPolicy(Qt::CustomContextMenu);
-    m_treeWidget->setDragDropMode(QAbstractItemView::InternalMove);
-    m_treeWidget->setDefaultDropAction(Qt::MoveAction);
-    
+
+    // Create tree view
+    m_treeView = new QTreeView(this);
+    m_treeView->setModel(m_model);
+    m_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_treeView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_treeView->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_treeView->setEditTriggers(QAbstractItemView::EditKeyPressed);
+    // Lets the view lay out rows without measuring each one
+    m_treeView->setUniformRowHeights(true);
+
     // Create button layout
     m_buttonLayout = new QHBoxLayout();
-    
+
     m_expandAllButton = new QPushButton("Expand All", this);
     m_collapseAllButton = new QPushButton("Collapse All", this);
     m_refreshButton = new QPushButton("Refresh", this);
-    
+
     m_buttonLayout->addWidget(m_expandAllButton);
     m_buttonLayout->addWidget(m_collapseAllButton);
     m_buttonLayout->addWidget(m_refreshButton);
     m_buttonLayout->addStretch();
-    
+
     // Add to main layout
-    m_layout->addWidget(m_treeWidget);
+    m_layout->addWidget(m_treeView);
     m_layout->addLayout(m_buttonLayout);
-    
+
     // Connect signals
-    connect(m_treeWidget, &QTreeWidget::itemSelectionChanged,
-            this, &TreeView::onItemSelectionChanged);
-    connect(m_treeWidget, &QTreeWidget::itemChanged,
-            this, &TreeView::onItemChanged);
-    connect(m_treeWidget, &QTreeWidget::itemDoubleClicked,
+    connect(m_treeView->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &TreeView::onSelectionChanged);
+    connect(m_treeView, &QTreeView::doubleClicked,
             this, &TreeView::onItemDoubleClicked);
-    connect(m_treeWidget, &QTreeWidget::customContextMenuRequested,
+    connect(m_treeView, &QTreeView::customContextMenuRequested,
             this, &TreeView::onCustomContextMenuRequested);
-    
+    connect(m_model, &SceneTreeModel::objectRenamed,
+            this, &TreeView::objectRenamed);
+
     connect(m_expandAllButton, &QPushButton::clicked,
             this, &TreeView::onExpandAll);
     connect(m_collapseAllButton, &QPushButton::clicked,
@@ -310,14 +329,14 @@ void TreeView::setupUI() {
 
 void TreeView::createContextMenu() {
     m_contextMenu = new QMenu(this);
-    
+
     m_renameAction = new QAction("Rename", this);
     m_deleteAction = new QAction("Delete", this);
     m_duplicateAction = new QAction("Duplicate", this);
     m_groupAction = new QAction("Group", this);
     m_ungroupAction = new QAction("Ungroup", this);
     m_visibilityAction = new QAction("Toggle Visibility", this);
-    
+
     m_contextMenu->addAction(m_renameAction);
     m_contextMenu->addSeparator();
     m_contextMenu->addAction(m_duplicateAction);
@@ -327,7 +346,7 @@ void TreeView::createContextMenu() {
     m_contextMenu->addAction(m_ungroupAction);
     m_contextMenu->addSeparator();
     m_contextMenu->addAction(m_visibilityAction);
-    
+
     // Connect actions
     connect(m_renameAction, &QAction::triggered, this, &TreeView::onRenameRequested);
     connect(m_deleteAction, &QAction::triggered, this, &TreeView::onDeleteRequested);
@@ -337,55 +356,4 @@ void TreeView::createContextMenu() {
     connect(m_visibilityAction, &QAction::triggered, this, &TreeView::onVisibilityToggled);
 }
 
-void TreeView::updateItemIcon(QTreeWidgetItem* item, CADObjectPtr object) {
-    if (!item || !object) return;
-    
-    QIcon icon = getObjectTypeIcon(object->getType());
-    item->setIcon(NAME_COLUMN, icon);
-}
-
-void TreeView::updateItemText(QTreeWidgetItem* item, CADObjectPtr object) {
-    if (!item || !object) return;
-    
-    item->setText(NAME_COLUMN, QString::fromStdString(object->getName()));
-    item->setText(TYPE_COLUMN, getObjectTypeName(object->getType()));
-}
-
-void TreeView::updateItemVisibility(QTreeWidgetItem* item, CADObjectPtr object) {
-    if (!item || !object) return;
-    
-    item->setText(VISIBILITY_COLUMN, object->isVisible() ? "Yes" : "No");
-    
-    // Make item appear grayed out if not visible
-    QColor color = object->isVisible() ? Qt::black : Qt::gray;
-    for (int col = 0; col < m_treeWidget->columnCount(); ++col) {
-        item->setForeground(col, QBrush(color));
-    }
-}
-
-QString TreeView::getObjectTypeName(ObjectType type) const {
-    switch (type) {
-        case ObjectType::PRIMITIVE_BOX: return "Box";
-        case ObjectType::PRIMITIVE_CYLINDER: return "Cylinder";
-        case ObjectType::PRIMITIVE_SPHERE: return "Sphere";
-        case ObjectType::PRIMITIVE_CONE: return "Cone";
-        case ObjectType::PRIMITIVE_LINE: return "Line";
-        case ObjectType::SKETCH: return "Sketch";
-        case ObjectType::EXTRUSION: return "Extrusion";
-        case ObjectType::REVOLUTION: return "Revolution";
-        case ObjectType::BOOLEAN_UNION: return "Union";
-        case ObjectType::BOOLEAN_DIFFERENCE: return "Difference";
-        case ObjectType::BOOLEAN_INTERSECTION: return "Intersection";
-        case ObjectType::MESH: return "Mesh";
-        case ObjectType::ASSEMBLY: return "Assembly";
-    }
-    return "Unknown";
-}
-
-QIcon TreeView::getObjectTypeIcon(ObjectType type) const {
-    // For now, return empty icons
-    // In a real implementation, you would load appropriate icons
-    return QIcon();
-}
-
-} // namespace HybridCAD 
\ No newline at end of file
+} // namespace HybridCAD
@@ -0,0 +1,238 @@
+#include "UndoHistory.h"
+#include "MeshManager.h"
+#include "PartManager.h"
+#include <algorithm>
+
+namespace HybridCAD {
+
+size_t UndoCommand::memoryUsage(std::unordered_set<const void*>& counted) const {
+    (void)counted;
+    return sizeof(*this) + m_description.capacity();
+}
+
+// UndoGroup implementation
+void UndoGroup::undo() {
+    for (auto it = m_commands.rbegin(); it != m_commands.rend(); ++it) {
+        (*it)->undo();
+    }
+}
+
+void UndoGroup::redo() {
+    for (auto& command : m_commands) {
+        command->redo();
+    }
+}
+
+size_t UndoGroup::memoryUsage(std::unordered_set<const void*>& counted) const {
+    size_t bytes = UndoCommand::memoryUsage(counted) + m_commands.capacity() * sizeof(UndoCommandPtr);
+    for (const auto& command : m_commands) {
+        bytes += command->memoryUsage(counted);
+    }
+    return bytes;
+}
+
+// TransformCommand implementation
+TransformCommand::TransformCommand(const std::string& description, const std::shared_ptr<Assembly>& assembly,
+                                   const std::string& instanceName, const Transform& before, const Transform& after)
+    : UndoCommand(description), m_assembly(assembly), m_instanceName(instanceName), m_before(before), m_after(after) {
+}
+
+void TransformCommand::undo() {
+    if (auto assembly = m_assembly.lock()) {
+        assembly->setPartTransform(m_instanceName, m_before);
+    }
+}
+
+void TransformCommand::redo() {
+    if (auto assembly = m_assembly.lock()) {
+        assembly->setPartTransform(m_instanceName, m_after);
+    }
+}
+
+// MeshVertexCommand implementation
+MeshVertexCommand::MeshVertexCommand(const std::string& description, const std::shared_ptr<MeshObject>& mesh)
+    : UndoCommand(description), m_mesh(mesh) {
+}
+
+void MeshVertexCommand::addVertex(int vertex, const QVector3D& before, const QVector3D& after) {
+    m_vertices.push_back(vertex);
+    m_before.insert(m_before.end(), { before.x(), before.y(), before.z() });
+    m_after.insert(m_after.end(), { after.x(), after.y(), after.z() });
+}
+
+void MeshVertexCommand::apply(const std::vector<float>& positions) {
+    auto mesh = m_mesh.lock();
+    if (!mesh) return;
+
+    const int count = static_cast<int>(mesh->vertexCount());
+    for (size_t i = 0; i < m_vertices.size(); ++i) {
+        if (m_vertices[i] >= count) continue;
+        mesh->setVertexPosition(m_vertices[i], QVector3D(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]));
+    }
+    mesh->recalculateNormals();
+}
+
+void MeshVertexCommand::undo() {
+    apply(m_before);
+}
+
+void MeshVertexCommand::redo() {
+    apply(m_after);
+}
+
+size_t MeshVertexCommand::memoryUsage(std::unordered_set<const void*>& counted) const {
+    return UndoCommand::memoryUsage(counted) + m_vertices.capacity() * sizeof(int) +
+           (m_before.capacity() + m_after.capacity()) * sizeof(float);
+}
+
+// MeshSnapshotCommand implementation
+MeshSnapshotCommand::MeshSnapshotCommand(const std::string& description, const std::shared_ptr<MeshObject>& mesh,
+                                         std::shared_ptr<const MeshSnapshot> before,
+                                         std::shared_ptr<const MeshSnapshot> after)
+    : UndoCommand(description), m_mesh(mesh), m_before(std::move(before)), m_after(std::move(after)) {
+}
+
+void MeshSnapshotCommand::undo() {
+    auto mesh = m_mesh.lock();
+    if (mesh && m_before) mesh->restoreSnapshot(*m_before);
+}
+
+void MeshSnapshotCommand::redo() {
+    auto mesh = m_mesh.lock();
+    if (mesh && m_after) mesh->restoreSnapshot(*m_after);
+}
+
+size_t MeshSnapshotCommand::memoryUsage(std::unordered_set<const void*>& counted) const {
+    size_t bytes = UndoCommand::memoryUsage(counted);
+    if (m_before) bytes += m_before->memoryUsage(counted);
+    if (m_after) bytes += m_after->memoryUsage(counted);
+    return bytes;
+}
+
+// UndoHistory implementation
+void UndoHistory::push(UndoCommandPtr command) {
+    if (!command || m_replaying) return;
+
+    if (!m_openGroups.empty()) {
+        m_openGroups.back()->add(std::move(command));
+        return;
+    }
+
+    m_undoStack.push_back(std::move(command));
+    m_redoStack.clear();
+    enforceLimits();
+    notifyChanged();
+}
+
+void UndoHistory::beginGroup(const std::string& description) {
+    m_openGroups.push_back(std::make_unique<UndoGroup>(description));
+}
+
+void UndoHistory::endGroup() {
+    if (m_openGroups.empty()) return;
+
+    std::unique_ptr<UndoGroup> group = std::move(m_openGroups.back());
+    m_openGroups.pop_back();
+    if (!group->isEmpty()) {
+        push(std::move(group));
+    }
+}
+
+bool UndoHistory::undo() {
+    // Undoing in the middle of a group would leave the group's first edits unrecorded
+    if (m_undoStack.empty() || !m_openGroups.empty()) return false;
+
+    UndoCommandPtr command = std::move(m_undoStack.back());
+    m_undoStack.pop_back();
+    m_replaying = true;
+    command->undo();
+    m_replaying = false;
+    m_redoStack.push_back(std::move(command));
+    notifyChanged();
+    return true;
+}
+
+bool UndoHistory::redo() {
+    if (m_redoStack.empty() || !m_openGroups.empty()) return false;
+
+    UndoCommandPtr command = std::move(m_redoStack.back());
+    m_redoStack.pop_back();
+    m_replaying = true;
+    command->redo();
+    m_replaying = false;
+    m_undoStack.push_back(std::move(command));
+    notifyChanged();
+    return true;
+}
+
+void UndoHistory::clear() {
+    m_undoStack.clear();
+    m_redoStack.clear();
+    m_openGroups.clear();
+    m_lastSnapshots.clear();
+    notifyChanged();
+}
+
+std::string UndoHistory::undoDescription() const {
+    return m_undoStack.empty() ? std::string() : m_undoStack.back()->getDescription();
+}
+
+std::string UndoHistory::redoDescription() const {
+    return m_redoStack.empty() ? std::string() : m_redoStack.back()->getDescription();
+}
+
+void UndoHistory::setMaxCommands(size_t count) {
+    m_maxCommands = std::max<size_t>(count, 1);
+    enforceLimits();
+}
+
+void UndoHistory::setMemoryBudget(size_t bytes) {
+    m_memoryBudget = bytes;
+    enforceLimits();
+}
+
+size_t UndoHistory::memoryUsage() const {
+    std::unordered_set<const void*> counted;
+    size_t bytes = 0;
+    for (const auto& command : m_undoStack) bytes += command->memoryUsage(counted);
+    for (const auto& command : m_redoStack) bytes += command->memoryUsage(counted);
+    return bytes;
+}
+
+std::shared_ptr<const MeshSnapshot> UndoHistory::snapshotMesh(const MeshObject& mesh) {
+    std::shared_ptr<const MeshSnapshot> base;
+    auto it = m_lastSnapshots.find(&mesh);
+    if (it != m_lastSnapshots.end()) base = it->second.lock();
+
+    std::shared_ptr<const MeshSnapshot> snapshot = mesh.takeSnapshot(base.get());
+    m_lastSnapshots[&mesh] = snapshot;
+
+    // Entries for meshes whose snapshots have all been dropped would otherwise pile up
+    for (auto entry = m_lastSnapshots.begin(); entry != m_lastSnapshots.end();) {
+        entry = entry->second.expired() ? m_lastSnapshots.erase(entry) : std::next(entry);
+    }
+    return snapshot;
+}
+
+void UndoHistory::enforceLimits() {
+    if (m_undoStack.size() > m_maxCommands) {
+        const size_t excess = m_undoStack.size() - m_maxCommands;
+        m_undoStack.erase(m_undoStack.begin(), m_undoStack.begin() + excess);
+    }
+
+    // Newest first, so buffers shared with older states are charged to the newest holder and
+    // dropping the oldest commands frees exactly what they alone hold
+    std::unordered_set<const void*> counted;
+    size_t bytes = 0;
+    for (const auto& command : m_redoStack) bytes += command->memoryUsage(counted);
+
+    size_t keep = 0;
+    for (auto it = m_undoStack.rbegin(); it != m_undoStack.rend(); ++it, ++keep) {
+        bytes += (*it)->memoryUsage(counted);
+        // The latest edit stays undoable however large it is
+        if (bytes > m_memoryBudget && keep > 0) break;
+    }
+    m_undoStack.erase(m_undoStack.begin(), m_undoStack.end() - keep);
+}
+
+} // namespace HybridCAD